@@ -9,8 +9,23 @@
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
+#if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+#define SIMULATE_REALTIME       ((uint32_t)0)           //δʱӣǽʱ
+#define SIMULATE_UNLIMITED      ((uint32_t)0xffffffff)  //ʱӾܿƽ
+#endif
+
 /* Exported function prototypes ----------------------------------------------*/
 extern const struct __jiffy jiffy;
 extern void jitter_update(uint16_t val);
 
+#if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+extern void simulate_start(uint32_t speed, uint64_t epoch);
+extern uint32_t simulate_speed(void);
+extern void simulate_step(uint32_t msecond);
+extern void simulate_pace(uint32_t msecond);
+extern uint64_t simulate_elapsed(void);
+extern uint64_t simulate_time(void);
+extern void simulate_set(uint64_t stamp);
+#endif
+
 #endif /* __JIFFY_H__ */
@@ -75,6 +75,17 @@ static DWORD CALLBACK ThreadTick(PVOID pvoid)
 	{
 	    if(!in_sleep)
 	    {
+	        if(simulate_speed() != SIMULATE_REALTIME)
+	        {
+	            //ʱںѭƽ
+#if defined ( __linux )
+	            usleep(5*1000);
+#else
+	            Sleep(5);
+#endif
+	            continue;
+	        }
+	        
 #if defined ( __linux )
 			gettimeofday(&tv, NULL);
 			Start = tv.tv_sec*1000000 + tv.tv_usec;
@@ -103,16 +114,20 @@ static DWORD CALLBACK ThreadTick(PVOID pvoid)
 	    }
 	    else
 	    {
-#if defined ( __linux )
-            usleep(KERNEL_LOOP_SLEEPED*1000);
-#else
-            Sleep(KERNEL_LOOP_SLEEPED);
-#endif
+	        //δʱʱǽʱӵȴ
+            simulate_pace(KERNEL_LOOP_SLEEPED);
 			in_sleep = 0;
 			
 			if(intr_status == INTR_ENABLED)
 			{
-				jitter_update(KERNEL_LOOP_SLEEPED);
+			    if(simulate_speed() != SIMULATE_REALTIME)
+			    {
+			        simulate_step(KERNEL_LOOP_SLEEPED);
+			    }
+			    else
+			    {
+				    jitter_update(KERNEL_LOOP_SLEEPED);
+			    }
                 
                 if((hooks[0] != 0) && (hooks[0] == hooks_redundance[0]))
                 {
@@ -256,7 +271,8 @@ static void cpu_core_sleep(void)
 static void cpu_core_idle(uint16_t tick)
 {
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
-	if(cpu_level == CPU_NORMAL)
+	//ʱ¿ʱѼںѭƽ
+	if((cpu_level == CPU_NORMAL) && (simulate_speed() == SIMULATE_REALTIME))
 	{
 #if defined ( __linux )
 		usleep(tick*1000);
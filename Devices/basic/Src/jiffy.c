@@ -8,12 +8,25 @@
 #include "jiffy.h"
 #include "cpu.h"
 
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+#include <windows.h>
+#elif defined ( __linux )
+#include <sched.h>
+#include <unistd.h>
+#endif
+
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 static volatile uint32_t __jiffy = 0;
 
+#if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+static volatile uint32_t sim_speed = SIMULATE_REALTIME;
+static volatile uint64_t sim_epoch = 0;
+static volatile uint64_t sim_elapsed = 0;
+#endif
+
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 /**
@@ -58,3 +71,93 @@ void jitter_update(uint16_t val)
 {
     __jiffy += val;
 }
+
+#if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+/**
+  * @brief  ʱ
+  * speed ΪǽʱӵļٱSIMULATE_UNLIMITED ʾȴ
+  * epoch Ϊʱ㣨룩
+  * ú jiffyRTC ں˵ھʱƽ
+  */
+void simulate_start(uint32_t speed, uint64_t epoch)
+{
+    sim_epoch = epoch;
+    sim_elapsed = 0;
+    sim_speed = speed;
+}
+
+/**
+  * @brief  ʱӼٱSIMULATE_REALTIME ʾδ
+  */
+uint32_t simulate_speed(void)
+{
+    return(sim_speed);
+}
+
+/**
+  * @brief  ʱǰ msecond 룬ͬƽ jiffy
+  */
+void simulate_step(uint32_t msecond)
+{
+    sim_elapsed += msecond;
+    __jiffy += msecond;
+}
+
+/**
+  * @brief  ٱ㲢ȴ msecond ʱӦǽʱ
+  */
+void simulate_pace(uint32_t msecond)
+{
+    uint64_t usecond;
+    
+    if(sim_speed == SIMULATE_REALTIME)
+    {
+        usecond = (uint64_t)msecond * 1000;
+    }
+    else if(sim_speed == SIMULATE_UNLIMITED)
+    {
+        usecond = 0;
+    }
+    else
+    {
+        usecond = (uint64_t)msecond * 1000 / sim_speed;
+    }
+    
+#if defined ( __linux )
+    if(usecond)
+    {
+        usleep((useconds_t)usecond);
+    }
+    else
+    {
+        sched_yield();
+    }
+#else
+    Sleep((DWORD)(usecond / 1000));
+#endif
+}
+
+/**
+  * @brief  ʱĺ
+  */
+uint64_t simulate_elapsed(void)
+{
+    return(sim_elapsed);
+}
+
+/**
+  * @brief  ǰʱ䣨룩
+  */
+uint64_t simulate_time(void)
+{
+    return(sim_epoch + sim_elapsed / 1000);
+}
+
+/**
+  * @brief  У׼ʱ䣨룩
+  */
+void simulate_set(uint64_t stamp)
+{
+    sim_epoch = stamp - sim_elapsed / 1000;
+}
+#endif
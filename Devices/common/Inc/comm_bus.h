@@ -0,0 +1,105 @@
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __COMM_BUS_H__
+#define __COMM_BUS_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  豸߹ڴ沼
+  * û VM_BUS=<name> 󣬱ӳ /dev/shm/vm_bus.<name>ⲿģӳͬһ򼴿͹۲
+  * ÿζţ
+  * meteringlcd ˳ʹãдд֮ǰżһдټһżǰζͬżʱЧ
+  * keys Ϊߵ߶Уģд¼ head һȡ¼ tail һ
+  * sensorsrelay ֱӶдǰ״̬relay.sequence ڱÿβ̵һ
+  * ״ֵ̬Ϊ enum __switch_statusenum __key_status ֵ
+  */
+#define DEVBUS_MAGIC                ((uint32_t)0x53554256) //"VBUS"
+#define DEVBUS_VERSION              ((uint32_t)1)
+#define DEVBUS_METERING_AMOUNT      ((uint16_t)42)
+#define DEVBUS_LCD_SIZE             ((uint16_t)512)
+#define DEVBUS_KEY_EVENTS           ((uint16_t)8)
+
+struct __devbus_region
+{
+    uint32_t                        magic;
+    uint32_t                        version;
+    uint32_t                        size; //sizeof(struct __devbus_region)
+    volatile uint32_t               pid; //һӳıƽ
+    
+    struct
+    {
+        volatile uint32_t           sequence;
+        volatile int32_t            data[DEVBUS_METERING_AMOUNT]; //UDP֡ͬ42ĴܼĴΪۼֵ
+        
+    }                               metering; //ģдƶ
+    
+    struct
+    {
+        volatile uint32_t           sequence;
+        volatile uint32_t           length;
+        volatile uint8_t            data[DEVBUS_LCD_SIZE]; //UDP֡ͬ
+        
+    }                               lcd; //дģ
+    
+    struct
+    {
+        volatile uint32_t           head;
+        volatile uint32_t           tail;
+        
+        struct
+        {
+            volatile uint16_t       id;
+            volatile uint16_t       status;
+            
+        }                           event[DEVBUS_KEY_EVENTS];
+        
+    }                               keys; //ģд밴¼ȡ
+    
+    struct
+    {
+        volatile uint32_t           main_cover;
+        volatile uint32_t           sub_cover;
+        volatile uint32_t           magnetic;
+        
+    }                               sensors; //ģдƶ
+    
+    struct
+    {
+        volatile uint32_t           sequence;
+        volatile uint32_t           state; //д뵱ǰ״̬ģд SWITCH_UNKNOWN ģ̵
+        
+    }                               relay;
+};
+
+/**
+  * @brief  豸߽ӿ
+  */
+struct __devbus
+{
+    struct __devbus_region          *(*open)(void); // VM_BUS ӳ乲ڴ棬δʱؿ
+    struct __devbus_region          *(*region)(void); //ӳĹڴ棬δʱؿ
+    const char                      *(*name)(void); //ƣδʱؿ
+    
+    void                            (*begin)(volatile uint32_t *sequence); //ʼдűΪ
+    void                            (*end)(volatile uint32_t *sequence); //дɣűΪż
+    uint32_t                        (*acquire)(volatile uint32_t *sequence); //ȡţ֮Ķǰ
+    uint32_t                        (*verify)(volatile uint32_t *sequence, uint32_t before); //ɣδ仯ʱط
+    void                            (*release)(volatile uint32_t *counter, uint32_t value); //֮ǰĶдɺٸ¼
+};
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported macro ------------------------------------------------------------*/
+/* Exported function prototypes ----------------------------------------------*/
+extern const struct __devbus devbus;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COMM_BUS_H__ */
@@ -0,0 +1,204 @@
+/**
+ * @brief		豸
+ * @details		ùڴģUDP˿ںѯ̣֧߳ linux
+ * @date		2026-10-19
+ **/
+
+/* Includes ------------------------------------------------------------------*/
+#include "comm_bus.h"
+#include "device.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined ( __linux )
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define DEVBUS_NAME_SIZE            ((uint16_t)48)
+
+/* Private macro -------------------------------------------------------------*/
+#if defined ( __GNUC__ )
+#define devbus_fence()              __sync_synchronize()
+#else
+#define devbus_fence()
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static struct __devbus_region *bus = (struct __devbus_region *)0;
+static char bus_name[DEVBUS_NAME_SIZE];
+
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  ЧʱָΪϵĬ״̬
+  */
+static void devbus_format(struct __devbus_region *region)
+{
+    memset((void *)region, 0, sizeof(struct __devbus_region));
+    
+    region->version = DEVBUS_VERSION;
+    region->size = sizeof(struct __devbus_region);
+    region->sensors.main_cover = SWITCH_CLOSE;
+    region->sensors.sub_cover = SWITCH_CLOSE;
+    region->sensors.magnetic = SWITCH_OPEN;
+    region->relay.state = SWITCH_UNKNOWN;
+    
+    devbus_fence();
+    region->magic = DEVBUS_MAGIC;
+}
+
+/**
+  * @brief
+  */
+static struct __devbus_region *devbus_open(void)
+{
+#if defined ( __linux )
+    const char *name;
+    char path[DEVBUS_NAME_SIZE + 16];
+    struct stat st;
+    void *addr;
+    int fd;
+    
+    if(bus)
+    {
+        return(bus);
+    }
+    
+    name = getenv("VM_BUS");
+    if(!name || !*name || (strlen(name) >= DEVBUS_NAME_SIZE) || strchr(name, '/'))
+    {
+        return((struct __devbus_region *)0);
+    }
+    
+    strcpy(path, "/vm_bus.");
+    strcat(path, name);
+    
+    //ģȴдóʼ룬ֻСʱչ
+    fd = shm_open(path, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+    if(fd < 0)
+    {
+        return((struct __devbus_region *)0);
+    }
+    
+    if((fstat(fd, &st) != 0) || \
+        ((st.st_size < (off_t)sizeof(struct __devbus_region)) && (ftruncate(fd, sizeof(struct __devbus_region)) != 0)))
+    {
+        close(fd);
+        return((struct __devbus_region *)0);
+    }
+    
+    addr = mmap((void *)0, sizeof(struct __devbus_region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    
+    if(addr == MAP_FAILED)
+    {
+        return((struct __devbus_region *)0);
+    }
+    
+    bus = (struct __devbus_region *)addr;
+    
+    if((bus->magic != DEVBUS_MAGIC) || \
+        (bus->version != DEVBUS_VERSION) || \
+        (bus->size != sizeof(struct __devbus_region)))
+    {
+        devbus_format(bus);
+    }
+    
+    bus->pid = (uint32_t)getpid();
+    strcpy(bus_name, name);
+    
+    return(bus);
+#else
+    return((struct __devbus_region *)0);
+#endif
+}
+
+/**
+  * @brief
+  */
+static struct __devbus_region *devbus_region(void)
+{
+    return(bus);
+}
+
+/**
+  * @brief
+  */
+static const char *devbus_name(void)
+{
+    if(!bus)
+    {
+        return((const char *)0);
+    }
+    
+    return(bus_name);
+}
+
+/**
+  * @brief
+  */
+static void devbus_begin(volatile uint32_t *sequence)
+{
+    *sequence += 1;
+    devbus_fence();
+}
+
+/**
+  * @brief
+  */
+static void devbus_end(volatile uint32_t *sequence)
+{
+    devbus_fence();
+    *sequence += 1;
+}
+
+/**
+  * @brief
+  */
+static uint32_t devbus_acquire(volatile uint32_t *sequence)
+{
+    uint32_t value = *sequence;
+    
+    devbus_fence();
+    
+    return(value);
+}
+
+/**
+  * @brief
+  */
+static uint32_t devbus_verify(volatile uint32_t *sequence, uint32_t before)
+{
+    devbus_fence();
+    
+    return((uint32_t)(!(before & 1) && (*sequence == before)));
+}
+
+/**
+  * @brief
+  */
+static void devbus_release(volatile uint32_t *counter, uint32_t value)
+{
+    devbus_fence();
+    *counter = value;
+}
+
+/**
+  * @brief
+  */
+const struct __devbus devbus =
+{
+    .open               = devbus_open,
+    .region             = devbus_region,
+    .name               = devbus_name,
+    .begin              = devbus_begin,
+    .end                = devbus_end,
+    .acquire            = devbus_acquire,
+    .verify             = devbus_verify,
+    .release            = devbus_release,
+};
@@ -9,12 +9,14 @@
 
 #if defined ( _WIN32 ) || defined ( _WIN64 )
 #include "comm_socket.h"
+#include "comm_bus.h"
 #include <windows.h>
 #include "trace.h"
 #elif defined ( __linux )
 #include <unistd.h>
 #include <pthread.h>
 #include "comm_socket.h"
+#include "comm_bus.h"
 #include "trace.h"
 #else
 
@@ -99,6 +101,13 @@ static void key_init(enum __dev_state state)
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
 	KeyData.status = KEY_NONE;
 	
+	//ʹ豸ʱҪ˿ںͽ߳
+	if(devbus.region())
+	{
+		status = DEVICE_INIT;
+		return;
+	}
+	
 	sock = receiver.open(50006);
 
 	if (sock == INVALID_SOCKET)
@@ -181,7 +190,36 @@ static void key_suspend(void)
 static void key_runner(uint16_t msecond)
 {
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
-    if(key_changed && (KeyData.status != KEY_NONE))
+    struct __devbus_region *bus = devbus.region();
+    uint32_t head;
+    uint32_t tail;
+    
+    if(bus)
+    {
+        head = devbus.acquire(&bus->keys.head);
+        tail = bus->keys.tail;
+        
+        //ģдʱ¼
+        if((head - tail) > DEVBUS_KEY_EVENTS)
+        {
+            tail = head - DEVBUS_KEY_EVENTS;
+        }
+        
+        for(; tail != head; tail++)
+        {
+            KeyData.id = bus->keys.event[tail % DEVBUS_KEY_EVENTS].id;
+            KeyData.status = (enum __key_status)bus->keys.event[tail % DEVBUS_KEY_EVENTS].status;
+            
+            if(key_changed && (KeyData.status != KEY_NONE))
+            {
+                key_changed(KeyData.id, KeyData.status);
+            }
+        }
+        
+        KeyData.status = KEY_NONE;
+        devbus.release(&bus->keys.tail, tail);
+    }
+    else if(key_changed && (KeyData.status != KEY_NONE))
     {
     	key_changed(KeyData.id, KeyData.status);
     	KeyData.status = KEY_NONE;
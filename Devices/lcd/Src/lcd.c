@@ -9,7 +9,10 @@
 #include "lcd.h"
 
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+#include "stddef.h"
+#include "stdlib.h"
 #include "comm_socket.h"
+#include "comm_bus.h"
 #else
 
 #if defined (BUILD_REAL_WORLD)
@@ -22,6 +25,12 @@
 #endif
 
 /* Private define ------------------------------------------------------------*/
+#if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+#define LCD_KEEPALIVE           ((uint16_t)1000)        //显示无变化时完整帧的发送间隔（毫秒）
+#define LCD_DELTA_MAGIC         ((uint32_t)0x4444434C)  //差异帧标识 "LCDD"
+#define LCD_DELTA_GAP           ((uint16_t)4)           //相邻差异区间间隔小于该值时合并
+#endif
+
 #if defined (BUILD_REAL_WORLD)
 #define deviic      viic3
 #define GDRAM_SIZE  35
@@ -116,6 +125,21 @@ struct __win_lcd_message
         
     }                           backlight;
 };
+
+/**
+  * @brief  差异帧
+  * 由若干 {uint16_t offset; uint8_t length; uint8_t data[length]} 区间组成，
+  * 描述相对上一帧的 struct __win_lcd_message 中发生变化的字节
+  * sequence 在每次发送完整帧后清零，接收方发现序号不连续时应等待下一个完整帧
+  */
+struct __win_lcd_delta
+{
+    uint32_t                    magic;
+    uint16_t                    sequence;
+    uint8_t                     amount;
+    uint8_t                     reserved;
+    uint8_t                     data[sizeof(struct __win_lcd_message)];
+};
 #else
 
 #if defined (BUILD_REAL_WORLD)
@@ -144,6 +168,10 @@ static enum __dev_status status = DEVICE_NOTINIT;
 static SOCKADDR_IN src;
 static SOCKET sock = INVALID_SOCKET;
 static struct __win_lcd_message lcd_message;
+static struct __win_lcd_message lcd_published; //最近一次发送的显示内容
+static struct __win_lcd_delta lcd_delta;
+static uint16_t lcd_silence = 0; //距离上次发送完整帧的时间（毫秒）
+static uint8_t lcd_delta_enable = 0; //设置环境变量 VM_LCD_DELTA 后启用差异帧
 #else
 
 #if defined (BUILD_REAL_WORLD)
@@ -221,6 +249,109 @@ static void lcd_label_off(uint8_t channel);
 
 /* Private functions ---------------------------------------------------------*/
 
+#if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+/**
+  * @brief  发送完整帧
+  */
+static bool lcd_publish(void)
+{
+    struct __devbus_region *bus = devbus.region();
+    
+    memcpy(&lcd_published, &lcd_message, sizeof(lcd_published));
+    lcd_silence = 0;
+    lcd_delta.sequence = 0;
+    
+    //设备总线上直接更新显示内容
+    if(bus)
+    {
+        devbus.begin(&bus->lcd.sequence);
+        memcpy((void *)bus->lcd.data, &lcd_message, sizeof(lcd_message));
+        bus->lcd.length = sizeof(lcd_message);
+        devbus.end(&bus->lcd.sequence);
+        
+        return(true);
+    }
+    
+    return(emitter.write(sock, &src, (uint8_t *)&lcd_message, sizeof(lcd_message)) == sizeof(lcd_message));
+}
+
+/**
+  * @brief  发送差异帧，差异帧不比完整帧小时改为发送完整帧
+  */
+static bool lcd_publish_delta(void)
+{
+    const uint8_t *now = (const uint8_t *)&lcd_message;
+    uint8_t *before = (uint8_t *)&lcd_published;
+    uint16_t offset = 0;
+    uint16_t start;
+    uint16_t end;
+    uint16_t same;
+    uint16_t length = 0;
+    uint16_t size;
+    
+    lcd_delta.magic = LCD_DELTA_MAGIC;
+    lcd_delta.amount = 0;
+    
+    while(offset < sizeof(lcd_message))
+    {
+        if(now[offset] == before[offset])
+        {
+            offset += 1;
+            continue;
+        }
+        
+        //找出差异区间，间隔较小的区间合并
+        start = offset;
+        end = offset + 1;
+        same = 0;
+        
+        for(offset=end; offset<sizeof(lcd_message); offset++)
+        {
+            if((end - start) >= 0xff)
+            {
+                break;
+            }
+            
+            if(now[offset] != before[offset])
+            {
+                end = offset + 1;
+                same = 0;
+            }
+            else if(++same >= LCD_DELTA_GAP)
+            {
+                break;
+            }
+        }
+        
+        size = end - start;
+        offset = end;
+        
+        if(((length + 3 + size) >= sizeof(lcd_message)) || (lcd_delta.amount == 0xff))
+        {
+            return(lcd_publish());
+        }
+        
+        lcd_delta.data[length + 0] = (uint8_t)(start & 0xff);
+        lcd_delta.data[length + 1] = (uint8_t)(start >> 8);
+        lcd_delta.data[length + 2] = (uint8_t)size;
+        memcpy(&lcd_delta.data[length + 3], &now[start], size);
+        memcpy(&before[start], &now[start], size);
+        length += 3 + size;
+        lcd_delta.amount += 1;
+    }
+    
+    if(!lcd_delta.amount)
+    {
+        return(true);
+    }
+    
+    lcd_delta.sequence += 1;
+    size = offsetof(struct __win_lcd_delta, data) + length;
+    
+    return(emitter.write(sock, &src, (uint8_t *)&lcd_delta, size) == size);
+}
+#endif
+
 /**
   * @brief  
   */
@@ -239,6 +370,22 @@ static void lcd_init(enum __dev_state state)
     
     lcd_message.global = LCD_GLO_SHOW_NONE;
     lcd_message.backlight = LCD_BKL_NONE;
+    lcd_delta_enable = getenv("VM_LCD_DELTA")? 0xff:0;
+    
+    if(devbus.region())
+    {
+        if(sizeof(lcd_message) > DEVBUS_LCD_SIZE)
+        {
+            status = DEVICE_ERROR;
+        }
+        else
+        {
+            lcd_publish();
+            status = DEVICE_INIT;
+        }
+        
+        return;
+    }
 
 	sock = emitter.open(50001, &src);
 
@@ -248,7 +395,7 @@ static void lcd_init(enum __dev_state state)
     }
     else
     {
-		emitter.write(sock, &src, (uint8_t *)&lcd_message, sizeof(lcd_message));
+		lcd_publish();
         status = DEVICE_INIT;
     }
 #else
@@ -304,9 +451,16 @@ static void lcd_suspend(void)
     memset(&lcd_message, 0, sizeof(lcd_message));
     lcd_message.global = LCD_GLO_SHOW_NONE;
     
-    if(sock != INVALID_SOCKET)
+    if(devbus.region())
+    {
+        if(status == DEVICE_INIT)
+        {
+            lcd_publish();
+        }
+    }
+    else if(sock != INVALID_SOCKET)
     {
-		emitter.write(sock, &src, (uint8_t *)&lcd_message, sizeof(lcd_message));
+		lcd_publish();
 		emitter.close(sock);
 		sock = INVALID_SOCKET;
     }
@@ -332,9 +486,34 @@ static void lcd_suspend(void)
 static void lcd_runner(uint16_t msecond)
 {
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
-    if((sock != INVALID_SOCKET) && (status == DEVICE_INIT))
+    bool result = true;
+    
+    if(devbus.region())
+    {
+        //设备总线上没有丢帧，不需要周期性发送完整帧
+        if((status == DEVICE_INIT) && (memcmp(&lcd_message, &lcd_published, sizeof(lcd_message)) != 0))
+        {
+            lcd_publish();
+        }
+    }
+    else if((sock != INVALID_SOCKET) && (status == DEVICE_INIT))
     {
-        if(emitter.write(sock, &src, (uint8_t *)&lcd_message, sizeof(lcd_message)) != sizeof(lcd_message))
+        //仅在显示内容变化时发送，无变化时按 LCD_KEEPALIVE 周期发送完整帧
+        if(lcd_silence < (0xffff - msecond))
+        {
+            lcd_silence += msecond;
+        }
+        
+        if(lcd_silence >= LCD_KEEPALIVE)
+        {
+            result = lcd_publish();
+        }
+        else if(memcmp(&lcd_message, &lcd_published, sizeof(lcd_message)) != 0)
+        {
+            result = lcd_delta_enable? lcd_publish_delta() : lcd_publish();
+        }
+        
+        if(!result)
         {
 			emitter.close(sock);
 			sock = INVALID_SOCKET;
@@ -343,10 +522,11 @@ static void lcd_runner(uint16_t msecond)
     else
     {
 		sock = emitter.open(50001, &src);
-
+		
 		if (sock != INVALID_SOCKET)
 		{
 			status = DEVICE_INIT;
+			lcd_publish();
 		}
     }
 #else
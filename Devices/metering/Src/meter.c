@@ -11,11 +11,16 @@
 
 #if defined ( _WIN32 ) || defined ( _WIN64 )
 #include "comm_socket.h"
+#include "comm_bus.h"
+#include "jiffy.h"
 #include <windows.h>
 #elif defined ( __linux )
 #include <unistd.h>
 #include <pthread.h>
+#include <sys/time.h>
 #include "comm_socket.h"
+#include "comm_bus.h"
+#include "jiffy.h"
 #else
 
 #if defined (BUILD_REAL_WORLD)
@@ -42,6 +47,10 @@ static uint8_t calibrate = 0;
 static SOCKET sock = INVALID_SOCKET;
 static volatile int32_t metering_data[42] = {0};
 static volatile uint8_t updating = 0;
+static int64_t metering_residue[42] = {0};
+static int32_t metering_total[42] = {0}; //豸һζۼƵ
+static uint32_t metering_sequence = 0; //豸һζ
+static uint8_t metering_primed = 0;
 #else
 
 #if defined (BUILD_REAL_WORLD)
@@ -53,6 +62,106 @@ struct __calibrate_base calibase;
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+/**
+  * @brief  ǽʱӣ룩
+  */
+static uint64_t wall_msecond(void)
+{
+#if defined ( __linux )
+    struct timeval tv;
+    
+    gettimeofday(&tv, NULL);
+    return((uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000);
+#else
+    return((uint64_t)GetTickCount64());
+#endif
+}
+
+/**
+  * @brief  յһ֡ĴݣܼĴΪ֡
+  */
+static void meter_absorb(int32_t *buff)
+{
+    static uint64_t wall_stamp = 0, virtual_stamp = 0;
+    uint64_t wall_now, virtual_now;
+    int64_t scaled;
+    uint32_t j;
+    
+	//ʱ£֡ʱǽʱ֮һ֡
+	wall_now = wall_msecond();
+	virtual_now = simulate_elapsed();
+	if ((simulate_speed() != SIMULATE_REALTIME) && wall_stamp && (wall_now > wall_stamp))
+	{
+		for (j = 0; j<(int)R_ESC; j++)
+		{
+			scaled = (int64_t)buff[j] * (int64_t)(virtual_now - virtual_stamp) + metering_residue[j];
+			buff[j] = (int32_t)(scaled / (int64_t)(wall_now - wall_stamp));
+			metering_residue[j] = scaled % (int64_t)(wall_now - wall_stamp);
+		}
+	}
+	wall_stamp = wall_now;
+	virtual_stamp = virtual_now;
+	
+	if (status == DEVICE_INIT)
+	{
+		for (j = 0; j<(int)R_ESC; j++)
+		{
+			metering_data[j] += buff[j];
+		}
+	}
+	
+	for (j = (int)R_ESC; j<(int)R_FREQ; j++)
+	{
+		metering_data[j] = buff[j];
+	}
+}
+
+/**
+  * @brief  豸ʱ룬ܼĴۼֵΪ
+  */
+static void meter_bus_poll(void)
+{
+    struct __devbus_region *bus = devbus.region();
+    int32_t buff[42];
+    int32_t total;
+    uint32_t sequence;
+    uint32_t j;
+    
+    if(!bus)
+    {
+        return;
+    }
+    
+    sequence = devbus.acquire(&bus->metering.sequence);
+    if((sequence & 1) || (metering_primed && (sequence == metering_sequence)))
+    {
+        return;
+    }
+    
+    for(j=0; j<42; j++)
+    {
+        buff[j] = bus->metering.data[j];
+    }
+    
+    if(!devbus.verify(&bus->metering.sequence, sequence))
+    {
+        return;
+    }
+    
+    //״ζۼֵֻΪ
+    for(j=0; j<(int)R_ESC; j++)
+    {
+        total = buff[j];
+        buff[j] = metering_primed? (int32_t)((uint32_t)total - (uint32_t)metering_total[j]):0;
+        metering_total[j] = total;
+    }
+    
+    metering_sequence = sequence;
+    metering_primed = 0xff;
+    
+    meter_absorb(buff);
+}
+
 #if defined ( __linux )
 static void *ThreadRecvMail(void *arg)
 #else
@@ -61,7 +170,6 @@ static DWORD CALLBACK ThreadRecvMail(PVOID pvoid)
 {
     int32_t buff[42];
 	int32_t recv_size;
-    uint32_t j;
     
     while(1)
     {
@@ -90,19 +198,8 @@ static DWORD CALLBACK ThreadRecvMail(PVOID pvoid)
     	Sleep(2);
 #endif
 
-		if (status == DEVICE_INIT)
-		{
-			for (j = 0; j<(int)R_ESC; j++)
-			{
-				metering_data[j] += buff[j];
-			}
-		}
-
-		for (j = (int)R_ESC; j<(int)R_FREQ; j++)
-		{
-			metering_data[j] = buff[j];
-		}
-
+		meter_absorb(buff);
+		
 		updating = 0;
     }
     
@@ -114,6 +211,8 @@ static DWORD CALLBACK ThreadRecvMail(PVOID pvoid)
   */
 uint8_t is_powered(void)
 {
+    meter_bus_poll();
+    
     //ֻҪκһѹڵ1V
 	if(metering_data[R_UA - 1] >= 1000 || \
         metering_data[R_UB - 1] >= 1000 || \
@@ -141,6 +240,15 @@ static enum __dev_status meter_status(void)
 static void meter_init(enum __dev_state state)
 {
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+	//ʹ豸ʱҪ˿ںͽ߳
+	if(devbus.region())
+	{
+		meter_callback = (void(*)(void *))0;
+		meter_callback_check = 0;
+		status = DEVICE_INIT;
+		return;
+	}
+	
 	sock = receiver.open(50002);
 	
 	if(sock == INVALID_SOCKET)
@@ -482,6 +590,8 @@ static int32_t meter_data_read(enum __metering_meta id)
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
     int32_t result;
     
+    meter_bus_poll();
+    
     if(updating)
     {
 #if defined ( __linux )
@@ -9,12 +9,14 @@
 
 #if defined ( _WIN32 ) || defined ( _WIN64 )
 #include "comm_socket.h"
+#include "comm_bus.h"
 #include <windows.h>
 #include "trace.h"
 #elif defined ( __linux )
 #include <unistd.h>
 #include <pthread.h>
 #include "comm_socket.h"
+#include "comm_bus.h"
 #include "trace.h"
 #else
 
@@ -96,6 +98,13 @@ static enum __dev_status relay_status(void)
 static void relay_init(enum __dev_state state)
 {
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+	//ʹ豸ʱҪ˿ںͽ߳
+	if(devbus.region())
+	{
+		status = DEVICE_INIT;
+		return;
+	}
+	
 	sock = receiver.open(50004);
 
 	if (sock == INVALID_SOCKET)
@@ -178,6 +187,14 @@ static void relay_runner(uint16_t msecond)
 static enum __switch_status relay_get(void)
 {
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+	struct __devbus_region *bus = devbus.region();
+	
+	//ģϰ״̬Ϊ SWITCH_UNKNOWN
+	if(bus)
+	{
+		relay_state = (enum __switch_status)bus->relay.state;
+	}
+	
 	return(relay_state);
 #else
     
@@ -198,7 +215,16 @@ static enum __switch_status relay_get(void)
 static uint8_t relay_set(enum __switch_status status)
 {
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+	struct __devbus_region *bus = devbus.region();
+	
 	relay_state = status;
+	
+	if(bus)
+	{
+		bus->relay.state = (uint32_t)relay_state;
+		devbus.release(&bus->relay.sequence, bus->relay.sequence + 1);
+	}
+	
 	return((uint8_t)relay_state);
 #else
     
@@ -8,6 +8,10 @@
 #include "rtc.h"
 #include <time.h>
 
+#if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+#include "jiffy.h"
+#endif
+
 #if defined (BUILD_REAL_WORLD)
 #include <stdbool.h>
 #include <string.h>
@@ -136,6 +140,12 @@ static uint64_t rtc_read(void)
 {
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
 	time_t stamp;
+	
+	if(simulate_speed() != SIMULATE_REALTIME)
+	{
+	    return(simulate_time());
+	}
+	
 	time(&stamp);
 	
 	return((uint64_t)stamp);
@@ -191,6 +201,13 @@ static uint64_t rtc_read(void)
 static uint64_t rtc_write(uint64_t stamp)
 {
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+	//ʱУʱ
+	if(simulate_speed() != SIMULATE_REALTIME)
+	{
+	    simulate_set(stamp);
+	    return(stamp);
+	}
+	
 	return(0);
 #else
     
@@ -9,12 +9,14 @@
 
 #if defined ( _WIN32 ) || defined ( _WIN64 )
 #include "comm_socket.h"
+#include "comm_bus.h"
 #include <windows.h>
 #include "trace.h"
 #elif defined ( __linux )
 #include <unistd.h>
 #include <pthread.h>
 #include "comm_socket.h"
+#include "comm_bus.h"
 #include "trace.h"
 #else
 
@@ -84,6 +86,13 @@ static DWORD CALLBACK ThreadRecvMail(PVOID pvoid)
 
 enum __switch_status mailslot_magnetic(void)
 {
+    struct __devbus_region *bus = devbus.region();
+    
+    if(bus)
+    {
+        return((enum __switch_status)bus->sensors.magnetic);
+    }
+    
     return(status_magnetic);
 }
 #endif
@@ -110,6 +119,13 @@ static enum __dev_status main_cover_status(void)
 static void main_cover_init(enum __dev_state state)
 {
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+	//ʹ豸ʱҪ˿ںͽ߳
+	if(devbus.region())
+	{
+		status = DEVICE_INIT;
+		return;
+	}
+	
 	sock = receiver.open(50003);
     
     if(sock == INVALID_SOCKET)
@@ -174,6 +190,13 @@ static void main_cover_suspend(void)
 static enum __switch_status main_cover_get(void)
 {
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+    struct __devbus_region *bus = devbus.region();
+    
+    if(bus)
+    {
+        return((enum __switch_status)bus->sensors.main_cover);
+    }
+    
     return(status_main_cover);
 #else
 
@@ -245,6 +268,13 @@ static void sub_cover_runner(uint16_t msecond)
 static enum __switch_status sub_cover_get(void)
 {
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+    struct __devbus_region *bus = devbus.region();
+    
+    if(bus)
+    {
+        return((enum __switch_status)bus->sensors.sub_cover);
+    }
+    
     return(status_sub_cover);
 #else
 
@@ -20,6 +20,14 @@ struct __nvram
 {
     void                        *(*address)(const char *name);
     uint32_t                    (*size)(const char *name);
+    
+    struct
+    {
+        uint8_t                 (*enroll)(const char *name, uint32_t offset, const void *blob, uint16_t size); //Ǽǵݿ飬Ӧļ name  offset 
+        void                    (*dirty)(uint8_t handle); //ݿ޸ģδдļ
+        void                    (*clean)(uint8_t handle); //ݿдļ
+        
+    }                           journal;
 };
 
 /**
@@ -75,6 +83,7 @@ struct __file
 	{
 		uint32_t				(*read)(const char *name, uint32_t index, uint32_t size, void *buff, bool reverse);
 		uint32_t				(*append)(const char *name, uint32_t size, const void *buff);
+		uint32_t				(*append_many)(const char *name, uint32_t amount, uint32_t size, const void *buff);
 		uint32_t				(*truncate)(const char *name, uint32_t amount, bool reverse);
 		bool					(*info)(const char *name, struct __ring_info *ring_info);
 		bool					(*reset)(const char *name);
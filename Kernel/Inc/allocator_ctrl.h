@@ -10,6 +10,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stdint.h"
+#include "stdbool.h"
 
 /* Exported types ------------------------------------------------------------*/
 /**
@@ -21,6 +22,17 @@ enum __heap_unlock
     HEAP_UNLOCK_FREE = 0x30,//heap_free
 };
 
+/**
+  * @brief  ־δǨƵļĿ
+  */
+struct __journal_entry
+{
+    const char                      *name; //ļ
+    uint32_t                        offset; //ļƫ
+    uint16_t                        size; //ݳ
+    const void                      *data; //
+};
+
 /* Exported constants --------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
 /**
@@ -32,6 +44,7 @@ struct __disk_ctrl
     void                            (*lock)(void);
     void                            (*unlock)(void);
     void                            (*idle)(void);
+    void                            (*maintain)(uint32_t budget);
     void                            (*format)(void);
 };
 
@@ -46,7 +59,20 @@ struct __heap_ctrl
 };
 
 
+/**
+  * @brief  ʧڴƽӿ
+  */
+struct __nvram_ctrl
+{
+    void                            (*release)(void); //ݿǼ
+    uint16_t                        (*fastsave)(uint32_t budget); // budgetusڰ޸ĵݿд־д
+    uint16_t                        (*amount)(void); //־Ŀ
+    bool                            (*pending)(uint16_t index, struct __journal_entry *entry); //־ĿδǨ
+    void                            (*retire)(uint16_t index); //־ĿǨ
+};
+
 /* Exported function prototypes ----------------------------------------------*/
+extern const struct __nvram_ctrl nvram_ctrl;
 extern const struct __disk_ctrl disk_ctrl;
 extern const struct __heap_ctrl heap_ctrl;
 
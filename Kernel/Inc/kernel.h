@@ -35,6 +35,8 @@ enum __klevel
 #define KERNEL_LOOP_SLEEPED             ((uint32_t)1000)
 //״̬task loop ѯ
 #define PERIOD_RUNNING                  ((uint32_t)((KERNEL_LOOP_FREQ >= 10 && KERNEL_LOOP_FREQ <= 1000)? (1000 / KERNEL_LOOP_FREQ) : 10))
+//ʱݿ浽 nvram ʱԤ㣬λ΢
+#define KERNEL_FASTSAVE_BUDGET          ((uint32_t)200)
 
 /* Exported macro -------------------------------------------------------------*/
 //taskﵱǰ loop ѯ
@@ -47,4 +49,9 @@ enum __klevel
 extern enum __klevel system_status(void);
 extern uint16_t system_usage(void);
 
+#if defined ( __linux )
+extern void system_lock_shared(void);
+extern void system_unlock_shared(void);
+#endif
+
 #endif /* __KERNEL_H__ */
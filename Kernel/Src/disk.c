@@ -10,16 +10,22 @@
 #include "allocator_ctrl.h"
 #include "tasks.h"
 #include "string.h"
+#include "stddef.h"
 #include "trace.h"
 #include "lfs.h"
 #include "crc.h"
 #include "ecc.h"
 
 #include "cpu.h"
+#include "jiffy.h"
 #include "power.h"
 #include "flash.h"
 #include "eeprom.h"
 
+#if defined ( __linux )
+#include <pthread.h>
+#endif
+
 /* Private typedef -----------------------------------------------------------*/
 /**
   * @brief  
@@ -32,6 +38,19 @@ enum __container_type
     CT_PARALLEL = 0x18,//
 };
 
+/**
+  * @brief  lfs ȹؼ¼ nvram 
+  * generation ÿ flash ̻ʱһʱֵһ˵ѹ
+  */
+struct __lfs_warm
+{
+	uint32_t				generation; //flash д
+	uint32_t				check; //magic  snapshot У
+	uint32_t				magic;
+	uint32_t				taken; //ʱд
+	lfs_snapshot_t			snapshot;
+};
+
 /**
   * @brief  ζͷ
   */
@@ -65,6 +84,31 @@ struct __file_entry
     enum __container_type		attr;
 };
 
+/**
+  * @brief  ζл
+  * ͷУפڴ棬׷ӵĿȻ棬ٺϲΪһдһζͷύ
+  */
+struct __ring_queue_cache
+{
+	uint8_t entry; //Ӧļ0xff Ϊδʹ
+	uint8_t pending; //ύĿ
+	uint16_t start; //һύĿλ
+	uint32_t stamp; //һύĿ׷ʱ
+	struct __ring_queue_header header; //ͷѼύĿ
+};
+
+/**
+  * @brief  򿪵 CT_SECURE ļ
+  * ECC ΪļûԣʱԪݶرʱļһԭύ
+  */
+struct __secure_file
+{
+	lfs_file_t					file;
+	struct lfs_file_config		config;
+	struct lfs_attr				attr;
+	uint8_t						*table; //ʶ + ÿҳ ECC
+};
+
 /* Private define ------------------------------------------------------------*/
 static int lfs_low_read(const struct lfs_config *c, lfs_block_t block,
 		lfs_off_t off, void *buffer, lfs_size_t size);
@@ -72,9 +116,47 @@ static int lfs_low_prog(const struct lfs_config *c, lfs_block_t block,
 		lfs_off_t off, const void *buffer, lfs_size_t size);
 static int lfs_low_erase(const struct lfs_config *c, lfs_block_t block);
 static int lfs_low_sync(const struct lfs_config *c);
+static uint32_t parameter_store(uint16_t loop, uint32_t offset, uint32_t size, const void *buff);
+
+#if !defined ( RING_CACHE_AMOUNT )
+#define RING_CACHE_AMOUNT		((uint8_t)2) //פڴĻζͷ
+#endif
+
+#if !defined ( RING_PENDING_SIZE )
+#define RING_PENDING_SIZE		((uint16_t)512) //ÿζдύĿĻֽ
+#endif
+
+#if !defined ( DISK_MAINTAIN_SLACK )
+#define DISK_MAINTAIN_SLACK		((uint32_t)10) //ʣʱ䲻ڸֵmsʱſʼһ̨ά
+#endif
+
+#if !defined ( DISK_PREERASE_AMOUNT )
+#define DISK_PREERASE_AMOUNT	((uint16_t)4) //Ԥп
+#endif
+
+#define LFS_WARM_MAGIC			((uint32_t)0x4c465357) //ȹؼ¼Чʶ
+
+#if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+#define LFS_BLOCK_SIZE			((uint32_t)4096)
+#define LFS_BLOCK_COUNT			((uint32_t)256)
+#else
+#define LFS_BLOCK_SIZE			((uint32_t)512)
+#define LFS_BLOCK_COUNT			((uint32_t)2048)
+#endif
+
+#if !defined ( RING_PENDING_LATENCY )
+#define RING_PENDING_LATENCY	((uint32_t)1000) //ύĿڴеפʱ䣨msΪ0ʱÿ׷ύ
+#endif
+
+#define SECURE_PAGE_SIZE		((uint32_t)256) //CT_SECURE ļÿ ECC ҳݳ
+#define SECURE_CODE_SIZE		((uint32_t)3) //ÿҳ ECC ĳ
+#define SECURE_ATTR_TYPE		((uint8_t)0x45) //ECC Ӧ lfs û
 
 /* Private macro -------------------------------------------------------------*/
 #define AMOUNT_FILE			    ((uint16_t)(sizeof(file_entry)/sizeof(struct __file_entry)))
+#define SECURE_PAGES(s)			(((s) + SECURE_PAGE_SIZE - 1) / SECURE_PAGE_SIZE)
+#define SECURE_TABLE_SIZE(s)	(sizeof(uint32_t) + SECURE_PAGES(s) * SECURE_CODE_SIZE)
+#define SECURE_TAG(s)			((uint32_t)(0x45430000 | SECURE_PAGES(s))) //ECC ʶҳļȱ仯Ҫؽ
 
 /* Private variables ---------------------------------------------------------*/
 /**
@@ -93,13 +175,24 @@ static const struct __file_entry file_entry[] =
     {"lexicon",             64*1024,        CT_SECURE},		//ʵ
     {"disconnect",          512,            CT_SECURE},		//̵
     {"display",             4*1024,         CT_SECURE},		//ʾ
+    {"calendar",            4*1024,         CT_SECURE},		//
+    {"events.status",       128,            CT_NORMAL},		//¼״̬
+    {"events.standard",     16*1024,        CT_RING},		//׼¼¼
+    {"events.power",        16*1024,        CT_RING},		//Դ¼¼
     {"firmware",            512*1024,       CT_PARALLEL},	//̼
 };
 
 static uint8_t lock = 0;
+static bool checked = false; //ļռռУ
+
+/**
+  * @brief  ζл棬ԼӦĴύĿ
+  */
+static struct __ring_queue_cache ring_cache[RING_CACHE_AMOUNT];
+static uint8_t ring_pending[RING_CACHE_AMOUNT][RING_PENDING_SIZE];
 
 /**
-  * @brief  оƬǰ1M Bytesָlfsļϵͳļ֧10K Bytes
+  * @brief  оƬǰ1M Bytesָlfsļϵͳļ֧ file_maxɹ̼
   */
 static const struct lfs_config lfs_cfg = 
 {
@@ -108,15 +201,8 @@ static const struct lfs_config lfs_cfg =
 	.erase			= lfs_low_erase,
 	.sync			= lfs_low_sync,
 	
-#if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
-    .block_size = 4096,
-    .block_count = 256,
-#else
-#if defined (BUILD_REAL_WORLD)
-    .block_size = 512,
-    .block_count = 2048,
-#endif
-#endif
+    .block_size = LFS_BLOCK_SIZE,
+    .block_count = LFS_BLOCK_COUNT,
     .read_size		= 128,
     .prog_size		= 256,
     .cache_size		= 512,
@@ -124,13 +210,106 @@ static const struct lfs_config lfs_cfg =
     .block_cycles	= 300,
 	
     .name_max		= 64,
-    .file_max		= 10*1024,
+    .file_max		= 520*1024,
 };
 static lfs_t lfs_lfs;
 static int lfs_err = -1;
 
+/**
+  * @brief  ̨ά״̬
+  * Ԥ֮δдĿ飬lfs ٴβʱֱ
+  */
+static uint8_t lfs_erased[(LFS_BLOCK_COUNT + 7) / 8];
+static uint16_t lfs_erased_amount = 0;
+static lfs_block_t lfs_gc_cursor[2] = {(lfs_block_t)-1, (lfs_block_t)-1};
+static bool lfs_gc_dirty = true; //һԪ֮йд
+
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  nvram еȹؼ¼
+  */
+static struct __lfs_warm *lfs_warm_entry(void)
+{
+	if(nvram.size("lfs") < sizeof(struct __lfs_warm))
+	{
+		return((void *)0);
+	}
+	
+	return((struct __lfs_warm *)nvram.address("lfs"));
+}
+
+/**
+  * @brief  ȹؼ¼Уֵ
+  */
+static uint32_t lfs_warm_check(const struct __lfs_warm *warm)
+{
+	return(crc32(&warm->magic, (uint16_t)(sizeof(struct __lfs_warm) - offsetof(struct __lfs_warm, magic)), 0xffffffff));
+}
+
+/**
+  * @brief  flash ݷ仯еĿʧЧ
+  */
+static void lfs_warm_touch(void)
+{
+	struct __lfs_warm *warm = lfs_warm_entry();
+	
+	if(warm)
+	{
+		warm->generation += 1;
+	}
+}
+
+/**
+  * @brief  жǰգ´ιʱֻУĿ¼
+  */
+static void lfs_warm_save(void)
+{
+	struct __lfs_warm *warm = lfs_warm_entry();
+	
+	if(!warm)
+	{
+		return;
+	}
+	
+	warm->magic = 0;
+	
+	if(lfs_snapshot(&lfs_lfs, &warm->snapshot) != LFS_ERR_OK)
+	{
+		return;
+	}
+	
+	warm->magic = LFS_WARM_MAGIC;
+	warm->taken = warm->generation;
+	warm->check = lfs_warm_check(warm);
+}
+
+/**
+  * @brief   lfsЧʱȹأɨԪ
+  */
+static int lfs_warm_mount(void)
+{
+	struct __lfs_warm *warm = lfs_warm_entry();
+	bool valid;
+	
+	if(warm)
+	{
+		valid = ((warm->magic == LFS_WARM_MAGIC) && \
+				(warm->taken == warm->generation) && \
+				(warm->check == lfs_warm_check(warm)));
+		
+		//ֻʹһΣغд쳣λõɿ
+		warm->magic = 0;
+		
+		if(valid && (lfs_mount_snapshot(&lfs_lfs, &lfs_cfg, &warm->snapshot) == LFS_ERR_OK))
+		{
+			return(LFS_ERR_OK);
+		}
+	}
+	
+	return(lfs_mount(&lfs_lfs, &lfs_cfg));
+}
+
 static void lfs_low_restart(void)
 {
 	enum __power_status status;
@@ -141,7 +320,7 @@ static void lfs_low_restart(void)
 		
 		if((status == SUPPLY_AC) || (status == SUPPLY_DC) || (status == SUPPLY_AUX))
 		{
-			lfs_err = lfs_mount(&lfs_lfs, &lfs_cfg);
+			lfs_err = lfs_warm_mount();
 		}
 	}
 }
@@ -154,6 +333,7 @@ static void lfs_low_checkup(void)
 	{
 		if((status != SUPPLY_AC) && (status != SUPPLY_DC) && (status != SUPPLY_AUX))
 		{
+			lfs_warm_save();
 			lfs_unmount(&lfs_lfs);
 			lfs_err = -1;
 		}
@@ -189,6 +369,16 @@ static int lfs_low_prog(const struct lfs_config *c, lfs_block_t block,
 {
 	uint8_t times = 5;
 	
+	lfs_warm_touch();
+	
+	if(lfs_erased[block / 8] & (1 << (block % 8)))
+	{
+		lfs_erased[block / 8] &= ~(1 << (block % 8));
+		lfs_erased_amount -= 1;
+	}
+	
+	lfs_gc_dirty = true;
+	
 retry:
 	times -= 1;
 	cpu.watchdog.feed();
@@ -212,6 +402,17 @@ static int lfs_low_erase(const struct lfs_config *c, lfs_block_t block)
 {
 	uint8_t times = 5;
 	
+	lfs_warm_touch();
+	lfs_gc_dirty = true;
+	
+	//ʱѾ
+	if(lfs_erased[block / 8] & (1 << (block % 8)))
+	{
+		lfs_erased[block / 8] &= ~(1 << (block % 8));
+		lfs_erased_amount -= 1;
+		return(LFS_ERR_OK);
+	}
+	
 retry:
 	times -= 1;
 	cpu.watchdog.feed();
@@ -236,105 +437,982 @@ static int lfs_low_sync(const struct lfs_config *c)
 	return(LFS_ERR_OK);
 }
 
-
+/**
+  * @brief  ̨ά״̬δڼݲٿ
+  */
+static void lfs_maintain_reset(void)
+{
+	memset(lfs_erased, 0, sizeof(lfs_erased));
+	lfs_erased_amount = 0;
+	lfs_gc_cursor[0] = (lfs_block_t)-1;
+	lfs_gc_cursor[1] = (lfs_block_t)-1;
+	lfs_gc_dirty = true;
+}
 
 /**
-  * @brief  
+  * @brief  ԤһĿп
+  * lfs ǰհ˳䣬 free.i ֮δλĿ鶼ǿп
   */
-static void disk_ctrl_start(void)
+static bool lfs_maintain_preerase(void)
 {
-	uint16_t loop;
-	uint32_t flash_size = 0;
+	lfs_block_t off;
+	lfs_block_t block;
 	
-	if((system_status() != SYSTEM_RUN) && (system_status() != SYSTEM_WAKEUP))
+	if(lfs_erased_amount >= DISK_PREERASE_AMOUNT)
 	{
-		return;
+		return(false);
 	}
-    
-    if(system_status() == SYSTEM_RUN)
-    {
-        cpu.watchdog.feed();
-        flash.control.init(DEVICE_NORMAL);
-		eeprom.control.init(DEVICE_NORMAL);
-    }
-    else
-    {
-        cpu.watchdog.feed();
-        flash.control.init(DEVICE_LOWPOWER);
-		eeprom.control.init(DEVICE_LOWPOWER);
-    }
-    
-#if 1
-	
-    for(loop=0; loop<AMOUNT_FILE; loop++)
-    {
-        if(file_entry[loop].attr == CT_NORMAL)
-        {
-			//CT_NORMAL ļռռ
-            flash_size += file_entry[loop].size;
-        }
-        else if(file_entry[loop].attr == CT_SECURE)
-        {
-			//CT_SECURE ļռ+ECCռ
-            flash_size += (file_entry[loop].size * 3);
-        }
-		else if(file_entry[loop].attr == CT_RING)
-        {
-			//CT_RING ļռ+ļϢṹռ
-			flash_size += (sizeof(struct __ring_queue_header) * 2);
-            flash_size += file_entry[loop].size;
-        }
-		else if(file_entry[loop].attr == CT_PARALLEL)
-        {
-			//CT_PARALLEL ļռ+ļϢṹռ
-			flash_size += (sizeof(struct __parallel_buffer_header) * 2);
-            flash_size += file_entry[loop].size;
-        }
-    }
-	
-#endif
-	
-    ASSERT((flash_size * 7) > (flash.info.chipsize() * 8));
-	ASSERT(lfs_cfg.block_size > flash.info.blocksize());
-	ASSERT(lfs_cfg.block_count > flash.info.blockcount());
-	ASSERT((lfs_cfg.block_size * lfs_cfg.block_count) != 1*1024*1024);
 	
-	if(lfs_err)
+	for(off=lfs_lfs.free.i; off<lfs_lfs.free.size; off++)
 	{
-		lfs_err = lfs_mount(&lfs_lfs, &lfs_cfg);
+		if(lfs_lfs.free.buffer[off / 32] & (1U << (off % 32)))
+		{
+			continue;
+		}
+		
+		block = (lfs_lfs.free.off + off) % LFS_BLOCK_COUNT;
+		
+		if(lfs_erased[block / 8] & (1 << (block % 8)))
+		{
+			continue;
+		}
+		
+		cpu.watchdog.feed();
+		
+		if(flash.block.erase(block) != LFS_BLOCK_SIZE)
+		{
+			return(false);
+		}
+		
+		lfs_erased[block / 8] |= (1 << (block % 8));
+		lfs_erased_amount += 1;
+		
+		return(true);
 	}
+	
+	return(false);
 }
 
-/**
-  * @brief  
-  */
-static void disk_ctrl_unlock(void)
-{
-    lock = 0x5a;
-}
+
 
 /**
-  * @brief  
+  * @brief  ȡУ黷ζͷ
   */
-static void disk_ctrl_lock(void)
+static bool ring_header_read(uint16_t loop, struct __ring_queue_header *header)
 {
-    lock = 0;
+	lfs_file_t lfs_file;
+	lfs_ssize_t readsize;
+	struct __ring_queue_header *queue_header;
+	uint32_t check, calc;
+	char *info;
+	int err;
+	
+	info = heap.dzalloc(strlen(file_entry[loop].name) + strlen(".r0") + 1);
+	
+	if(!info)
+	{
+		return(false);
+	}
+	
+	strcpy(info, file_entry[loop].name);
+	strcat(info, ".r0");
+	
+	err = lfs_file_open(&lfs_lfs, &lfs_file, info, LFS_O_RDONLY);
+	heap.free(info);
+	
+	if(err)
+	{
+		lfs_low_checkup();
+		return(false);
+	}
+	
+	queue_header = heap.dzalloc(256);
+	if(!queue_header)
+	{
+		lfs_file_close(&lfs_lfs, &lfs_file);
+		return(false);
+	}
+	
+	readsize = lfs_file_read(&lfs_lfs, &lfs_file, (void *)queue_header, sizeof(struct __ring_queue_header));
+	
+	lfs_file_close(&lfs_lfs, &lfs_file);
+	
+	if(readsize != sizeof(struct __ring_queue_header))
+	{
+		heap.free(queue_header);
+		lfs_low_checkup();
+		return(false);
+	}
+	
+	check = queue_header->check;
+	queue_header->check = 0;
+	
+	__nand_calculate_ecc((void *)queue_header, 256, (uint8_t *)&calc);
+	
+	if(calc != check)
+	{
+		if(__nand_correct_data((void *)queue_header, (uint8_t *)&check, (uint8_t *)&calc, 256) < 0)
+		{
+			heap.free(queue_header);
+			return(false);
+		}
+	}
+	
+	if(!queue_header->capacity || (queue_header->current >= queue_header->capacity))
+	{
+		heap.free(queue_header);
+		return(false);
+	}
+	
+	heap.copy(header, queue_header, sizeof(struct __ring_queue_header));
+	heap.free(queue_header);
+	
+	return(true);
 }
 
 /**
-  * @brief  
+  * @brief  д뻷ζͷ
   */
-static void disk_ctrl_idle(void)
+static bool ring_header_write(uint16_t loop, const struct __ring_queue_header *header)
 {
-	if(!lfs_err)
+	lfs_file_t lfs_file;
+	struct __ring_queue_header *queue_header;
+	uint32_t calc;
+	char *info;
+	int err;
+	
+	info = heap.dzalloc(strlen(file_entry[loop].name) + strlen(".r0") + 1);
+	
+	if(!info)
 	{
-		cpu.watchdog.feed();
-		lfs_unmount(&lfs_lfs);
-		lfs_err = -1;
+		return(false);
+	}
+	
+	strcpy(info, file_entry[loop].name);
+	strcat(info, ".r0");
+	
+	err = lfs_file_open(&lfs_lfs, &lfs_file, info, LFS_O_RDWR);
+	heap.free(info);
+	
+	if(err)
+	{
+		lfs_low_checkup();
+		return(false);
+	}
+	
+	queue_header = heap.dzalloc(256);
+	if(!queue_header)
+	{
+		lfs_file_close(&lfs_lfs, &lfs_file);
+		return(false);
+	}
+	
+	heap.copy(queue_header, header, sizeof(struct __ring_queue_header));
+	
+	queue_header->check = 0;
+	__nand_calculate_ecc((void *)queue_header, 256, (uint8_t *)&calc);
+	queue_header->check = calc;
+	
+	if(lfs_file_size(&lfs_lfs, &lfs_file) != sizeof(struct __ring_queue_header))
+	{
+		lfs_file_truncate(&lfs_lfs, &lfs_file, sizeof(struct __ring_queue_header));
+	}
+	
+	if(lfs_file_write(&lfs_lfs, &lfs_file, (void *)queue_header, sizeof(struct __ring_queue_header)) != sizeof(struct __ring_queue_header))
+	{
+		lfs_file_close(&lfs_lfs, &lfs_file);
+		heap.free(queue_header);
+		lfs_low_checkup();
+		return(false);
+	}
+	
+	lfs_file_close(&lfs_lfs, &lfs_file);
+	heap.free(queue_header);
+	
+	return(true);
+}
+
+/**
+  * @brief  д뻷ζ
+  */
+static bool ring_data_write(uint16_t loop, uint32_t offset, uint32_t size, const void *buff)
+{
+	lfs_file_t lfs_file;
+	lfs_ssize_t operatesize;
+	int err;
+	
+	err = lfs_file_open(&lfs_lfs, &lfs_file, file_entry[loop].name, LFS_O_RDWR | LFS_O_CREAT);
+	if(err)
+	{
+		lfs_low_checkup();
+		return(false);
+	}
+	
+	if(lfs_file_seek(&lfs_lfs, &lfs_file, offset, LFS_SEEK_SET) < 0)
+	{
+		lfs_file_close(&lfs_lfs, &lfs_file);
+		lfs_low_checkup();
+		return(false);
+	}
+	
+	operatesize = lfs_file_write(&lfs_lfs, &lfs_file, buff, size);
+	lfs_file_close(&lfs_lfs, &lfs_file);
+	
+	if(operatesize != size)
+	{
+		lfs_low_checkup();
+		return(false);
+	}
+	
+	return(true);
+}
+
+/**
+  * @brief  ύζлеĴύĿ
+  * ύĿļţһдݣдһζͷ
+  * ύʧʱĿͶͷڴУ´ύʱ
+  */
+static bool ring_cache_commit(uint8_t slot)
+{
+	struct __ring_queue_cache *cache = &ring_cache[slot];
+	uint32_t stride;
+	bool result;
+	
+	if((cache->entry == 0xff) || !cache->pending)
+	{
+		return(true);
+	}
+	
+	lfs_low_restart();
+	
+	stride = (uint32_t)cache->header.length + 4;
+	
+	result = false;
+	
+	if(!lfs_err)
+	{
+		cpu.watchdog.feed();
+		
+		if(ring_data_write(cache->entry, (cache->start * stride), (cache->pending * stride), ring_pending[slot]))
+		{
+			result = ring_header_write(cache->entry, &cache->header);
+		}
+	}
+	
+	if(result)
+	{
+		cache->pending = 0;
+	}
+	
+	return(result);
+}
+
+/**
+  * @brief  ύͷŻζл
+  * ύʧʱԱͷţ false
+  */
+static bool ring_cache_release(uint16_t loop)
+{
+	uint8_t slot;
+	bool result = true;
+	
+	for(slot=0; slot<RING_CACHE_AMOUNT; slot++)
+	{
+		if(ring_cache[slot].entry == loop)
+		{
+			result = ring_cache_commit(slot);
+			ring_cache[slot].entry = 0xff;
+			ring_cache[slot].pending = 0;
+		}
+	}
+	
+	return(result);
+}
+
+/**
+  * @brief  ύζл
+  * all Ϊ false ʱֻύפʱ䳬 RING_PENDING_LATENCY Ŀ
+  */
+static void ring_cache_flush(bool all)
+{
+	uint8_t slot;
+	
+	for(slot=0; slot<RING_CACHE_AMOUNT; slot++)
+	{
+		if((ring_cache[slot].entry == 0xff) || !ring_cache[slot].pending)
+		{
+			continue;
+		}
+		
+		if(all || (jiffy.after(ring_cache[slot].stamp) >= RING_PENDING_LATENCY))
+		{
+			ring_cache_commit(slot);
+		}
+	}
+}
+
+/**
+  * @brief  ȡζл棬δʱļضͷ
+  */
+static int16_t ring_cache_load(uint16_t loop)
+{
+	uint8_t slot;
+	uint8_t victim = 0;
+	
+	for(slot=0; slot<RING_CACHE_AMOUNT; slot++)
+	{
+		if(ring_cache[slot].entry == loop)
+		{
+			return(slot);
+		}
+	}
+	
+	//ʹÿеĻ棬ûдύĿĻ
+	for(slot=0; slot<RING_CACHE_AMOUNT; slot++)
+	{
+		if(ring_cache[slot].entry == 0xff)
+		{
+			victim = slot;
+			break;
+		}
+		
+		if(!ring_cache[slot].pending)
+		{
+			victim = slot;
+		}
+	}
+	
+	//ύĿ޷дʱŲøû
+	if(!ring_cache_commit(victim))
+	{
+		return(-1);
+	}
+	
+	ring_cache[victim].entry = 0xff;
+	ring_cache[victim].pending = 0;
+	
+	if(!ring_header_read(loop, &ring_cache[victim].header))
+	{
+		return(-1);
+	}
+	
+	ring_cache[victim].entry = loop;
+	
+	return(victim);
+}
+
+/**
+  * @brief  ζл׷һ¼
+  */
+static uint32_t ring_cache_append(uint8_t slot, uint32_t size, const void *buff)
+{
+	struct __ring_queue_cache *cache = &ring_cache[slot];
+	uint32_t stride;
+	uint32_t length;
+	
+	stride = (uint32_t)cache->header.length + 4;
+	length = (size<cache->header.length?size:cache->header.length);
+	
+	if(((uint32_t)cache->header.current * stride + stride) > file_entry[cache->entry].size)
+	{
+		return(0);
+	}
+	
+	if(stride > RING_PENDING_SIZE)
+	{
+		//¼ڻ壬ֱд
+		if(!ring_data_write(cache->entry, ((uint32_t)cache->header.current * stride), length, buff))
+		{
+			cache->entry = 0xff;
+			return(0);
+		}
+	}
+	else
+	{
+		//
+		if(((uint32_t)cache->pending + 1) * stride > RING_PENDING_SIZE)
+		{
+			if(!ring_cache_commit(slot))
+			{
+				return(0);
+			}
+		}
+		
+		//ύĿļϴλʱδύύ
+		if(cache->pending && ((cache->start + cache->pending) != cache->header.current))
+		{
+			if(!ring_cache_commit(slot))
+			{
+				return(0);
+			}
+		}
+		
+		if(!cache->pending)
+		{
+			cache->start = cache->header.current;
+			cache->stamp = jiffy.value();
+		}
+		
+		//Чݺ4ֽڱ0
+		heap.set(&ring_pending[slot][cache->pending * stride], 0, stride);
+		heap.copy(&ring_pending[slot][cache->pending * stride], buff, length);
+		cache->pending += 1;
+	}
+	
+	if(cache->header.amount < cache->header.capacity)
+	{
+		cache->header.amount += 1;
+	}
+	
+	cache->header.current += 1;
+	cache->header.current = cache->header.current % cache->header.capacity;
+	
+	if(!cache->pending)
+	{
+		if(!ring_header_write(cache->entry, &cache->header))
+		{
+			cache->entry = 0xff;
+			return(0);
+		}
+	}
+	else if(!cache->header.current)
+	{
+		//лƣύĿļύ
+		//ύʧʱĿԱڻУ´׷ǰ
+		ring_cache_commit(slot);
+	}
+	
+	return(length);
+}
+
+/**
+  * @brief  Ҳļ
+  */
+static uint16_t parameter_entry(const char *name)
+{
+	uint16_t loop;
+    
+    for(loop=0; loop<AMOUNT_FILE; loop++)
+    {
+        if((file_entry[loop].attr == CT_NORMAL) || (file_entry[loop].attr == CT_SECURE))
+        {
+			if(strcmp(file_entry[loop].name, name) == 0)
+			{
+				break;
+			}
+        }
+    }
+	
+	return(loop);
+}
+
+/**
+  * @brief  δǨƵĿ־ӵĲϣ־ʱ˳УµĿǽϾɵ
+  */
+static void journal_overlay(uint16_t loop, uint32_t offset, uint32_t size, void *buff)
+{
+	struct __journal_entry entry;
+	uint32_t start;
+	uint32_t end;
+	uint16_t index;
+	
+	for(index=0; index<nvram_ctrl.amount(); index++)
+	{
+		if(!nvram_ctrl.pending(index, &entry) || (strcmp(entry.name, file_entry[loop].name) != 0))
+		{
+			continue;
+		}
+		
+		start = (entry.offset > offset)? entry.offset : offset;
+		end = ((entry.offset + entry.size) < (offset + size))? (entry.offset + entry.size) : (offset + size);
+		
+		if(start >= end)
+		{
+			continue;
+		}
+		
+		memcpy((uint8_t *)buff + (start - offset), (const uint8_t *)entry.data + (start - entry.offset), end - start);
+	}
+}
+
+/**
+  * @brief  дǰȰд뷶ΧصĿ־ǨƵļ
+  * д뷶ΧȫǵĿֱ
+  */
+static void journal_settle(uint16_t loop, uint32_t offset, uint32_t size)
+{
+	struct __journal_entry entry;
+	uint16_t index;
+	
+	for(index=0; index<nvram_ctrl.amount(); index++)
+	{
+		if(!nvram_ctrl.pending(index, &entry) || (strcmp(entry.name, file_entry[loop].name) != 0))
+		{
+			continue;
+		}
+		
+		if(((entry.offset + entry.size) <= offset) || (entry.offset >= (offset + size)))
+		{
+			continue;
+		}
+		
+		if((entry.offset < offset) || ((entry.offset + entry.size) > (offset + size)))
+		{
+			if(parameter_store(loop, entry.offset, entry.size, entry.data) != entry.size)
+			{
+				continue;
+			}
+		}
+		
+		nvram_ctrl.retire(index);
+	}
+}
+
+/**
+  * @brief  Ǩһ־ļûҪǨƵĿʱ false
+  */
+static bool journal_migrate(void)
+{
+	struct __journal_entry entry;
+	uint16_t index;
+	uint16_t loop;
+	
+	for(index=0; index<nvram_ctrl.amount(); index++)
+	{
+		if(!nvram_ctrl.pending(index, &entry))
+		{
+			continue;
+		}
+		
+		loop = parameter_entry(entry.name);
+		
+		if((loop >= AMOUNT_FILE) || \
+			((entry.offset + entry.size) > file_entry[loop].size) || \
+			(parameter_store(loop, entry.offset, entry.size, entry.data) == entry.size))
+		{
+			//ĿļѲڻǨ
+			nvram_ctrl.retire(index);
+			return(true);
+		}
+		
+		return(false);
+	}
+	
+	return(false);
+}
+
+/**
+  * @brief   CT_SECURE ļͬʱ ECC 
+  */
+static int secure_open(uint16_t loop, struct __secure_file *secure, int flags)
+{
+	int err;
+	
+	heap.set(secure, 0, sizeof(struct __secure_file));
+	
+	secure->table = heap.dzalloc(SECURE_TABLE_SIZE(file_entry[loop].size));
+	if(!secure->table)
+	{
+		return(LFS_ERR_NOMEM);
+	}
+	
+	secure->attr.type = SECURE_ATTR_TYPE;
+	secure->attr.buffer = secure->table;
+	secure->attr.size = SECURE_TABLE_SIZE(file_entry[loop].size);
+	secure->config.attrs = &secure->attr;
+	secure->config.attr_count = 1;
+	
+	err = lfs_file_opencfg(&lfs_lfs, &secure->file, file_entry[loop].name, flags, &secure->config);
+	if(err)
+	{
+		heap.free(secure->table);
+		secure->table = (uint8_t *)0;
+	}
+	
+	return(err);
+}
+
+/**
+  * @brief  ر CT_SECURE ļ޸Ĺ ECC ļһύ
+  * abandon Ϊʱδύ޸ģΪ lfs_file_close ύϱԭ
+  */
+static int secure_close(struct __secure_file *secure, bool abandon)
+{
+	int err;
+	
+	if(abandon)
+	{
+		secure->file.flags |= LFS_F_ERRED;
+	}
+	
+	err = lfs_file_close(&lfs_lfs, &secure->file);
+	
+	heap.free(secure->table);
+	secure->table = (uint8_t *)0;
+	
+	return(err);
+}
+
+/**
+  * @brief  ECC Ƿѽ뵱ǰļһ
+  */
+static bool secure_valid(uint16_t loop, const struct __secure_file *secure)
+{
+	uint32_t tag;
+	
+	heap.copy(&tag, secure->table, sizeof(tag));
+	
+	return(tag == SECURE_TAG(file_entry[loop].size));
+}
+
+/**
+  * @brief   CT_SECURE ļ [start, end) Ǹҳд buff  ECC
+  * ȶҳԭеݣٵ [offset, offset + size) ݣʱĶļ
+  * ҳʱٶȡļĩβĲְ 0 
+  */
+static bool secure_encode(uint16_t loop, struct __secure_file *secure, uint32_t start, uint32_t end, \
+						  uint32_t offset, uint32_t size, const void *buff)
+{
+	uint8_t *code = secure->table + sizeof(uint32_t);
+	uint8_t *page;
+	lfs_ssize_t readsize;
+	uint32_t index;
+	uint32_t length;
+	uint32_t from, to;
+	
+	page = heap.dzalloc(SECURE_PAGE_SIZE);
+	if(!page)
+	{
+		return(false);
+	}
+	
+	for(index=(start / SECURE_PAGE_SIZE); index<SECURE_PAGES(end); index++)
+	{
+		from = index * SECURE_PAGE_SIZE;
+		
+		//ĩҳֻһЧɸʽļ֮ ECC ܶ
+		length = file_entry[loop].size - from;
+		if(length > SECURE_PAGE_SIZE)
+		{
+			length = SECURE_PAGE_SIZE;
+		}
+		
+		if((from >= offset) && ((from + length) <= (offset + size)))
+		{
+			readsize = 0;
+		}
+		else
+		{
+			if(lfs_file_seek(&lfs_lfs, &secure->file, from, LFS_SEEK_SET) < 0)
+			{
+				heap.free(page);
+				return(false);
+			}
+			
+			readsize = lfs_file_read(&lfs_lfs, &secure->file, page, length);
+			if(readsize < 0)
+			{
+				heap.free(page);
+				return(false);
+			}
+		}
+		
+		heap.set(page + readsize, 0, SECURE_PAGE_SIZE - readsize);
+		
+		//ӱҳнҪдĲ
+		to = from + SECURE_PAGE_SIZE;
+		if(from < offset)
+		{
+			from = offset;
+		}
+		if(to > (offset + size))
+		{
+			to = offset + size;
+		}
+		
+		if(from < to)
+		{
+			heap.copy(page + (from % SECURE_PAGE_SIZE), (const uint8_t *)buff + (from - offset), to - from);
+		}
+		
+		__nand_calculate_ecc(page, SECURE_PAGE_SIZE, &code[index * SECURE_CODE_SIZE]);
+	}
+	
+	heap.free(page);
+	
+	return(true);
+}
+
+/**
+  * @brief  ҳȡ CT_SECURE ļ ECC У飬ش͵ؾ
+  * ţλһ֮˳ȡ
+  * ضȡĳȣ޷Ĵʱ 0
+  */
+static uint32_t secure_decode(uint16_t loop, struct __secure_file *secure, uint32_t offset, uint32_t size, void *buff)
+{
+	uint8_t *code = secure->table + sizeof(uint32_t);
+	uint8_t calc[SECURE_CODE_SIZE];
+	uint8_t *page;
+	uint32_t index;
+	uint32_t from, to, stored;
+	lfs_soff_t length;
+	
+	page = heap.dzalloc(SECURE_PAGE_SIZE);
+	if(!page)
+	{
+		return(0);
+	}
+	
+	length = lfs_file_size(&lfs_lfs, &secure->file);
+	
+	if((length < 0) || \
+		(lfs_file_seek(&lfs_lfs, &secure->file, (offset / SECURE_PAGE_SIZE) * SECURE_PAGE_SIZE, LFS_SEEK_SET) < 0))
+	{
+		heap.free(page);
+		return(0);
+	}
+	
+	for(index=(offset / SECURE_PAGE_SIZE); index<SECURE_PAGES(offset + size); index++)
+	{
+		from = index * SECURE_PAGE_SIZE;
+		to = from + SECURE_PAGE_SIZE;
+		
+		if(to > file_entry[loop].size)
+		{
+			to = file_entry[loop].size;
+		}
+		
+		//ļֻдһдλãļĩβ֮Ĳְ 0 㣬һ
+		stored = ((lfs_soff_t)to > length) ? (((lfs_soff_t)from < length) ? ((uint32_t)length - from) : 0) : (to - from);
+		
+		if(stored < SECURE_PAGE_SIZE)
+		{
+			heap.set(page, 0, SECURE_PAGE_SIZE);
+		}
+		
+		if(stored && (lfs_file_read(&lfs_lfs, &secure->file, page, stored) != (lfs_ssize_t)stored))
+		{
+			heap.free(page);
+			return(0);
+		}
+		
+		__nand_calculate_ecc(page, SECURE_PAGE_SIZE, calc);
+		
+		if(memcmp(calc, &code[index * SECURE_CODE_SIZE], SECURE_CODE_SIZE) != 0)
+		{
+			if(__nand_correct_data(page, &code[index * SECURE_CODE_SIZE], calc, SECURE_PAGE_SIZE) < 0)
+			{
+				heap.free(page);
+				return(0);
+			}
+		}
+		
+		//ֻȡΧصĲ
+		if(from < offset)
+		{
+			from = offset;
+		}
+		
+		if(to > (offset + size))
+		{
+			to = offset + size;
+		}
+		
+		heap.copy((uint8_t *)buff + (from - offset), page + (from % SECURE_PAGE_SIZE), to - from);
+	}
+	
+	heap.free(page);
+	
+	return(size);
+}
+
+/**
+  * @brief  
+  */
+static void disk_ctrl_start(void)
+{
+	uint16_t loop;
+	uint32_t flash_size = 0;
+	
+	if((system_status() != SYSTEM_RUN) && (system_status() != SYSTEM_WAKEUP))
+	{
+		return;
+	}
+    
+    if(system_status() == SYSTEM_RUN)
+    {
+        cpu.watchdog.feed();
+        flash.control.init(DEVICE_NORMAL);
+		eeprom.control.init(DEVICE_NORMAL);
+    }
+    else
+    {
+        cpu.watchdog.feed();
+        flash.control.init(DEVICE_LOWPOWER);
+		eeprom.control.init(DEVICE_LOWPOWER);
+    }
+    
+	//ļ flash ڼ䲻䣬ֻ״ʱУ
+	if(!checked)
+	{
+	    for(loop=0; loop<AMOUNT_FILE; loop++)
+	    {
+	        if(file_entry[loop].attr == CT_NORMAL)
+	        {
+				//CT_NORMAL ļռռ
+	            flash_size += file_entry[loop].size;
+	        }
+	        else if(file_entry[loop].attr == CT_SECURE)
+	        {
+				//CT_SECURE ļռռãECCԪ
+	            flash_size += file_entry[loop].size;
+				
+				//ECCܳ lfs ûԵĳ
+				ASSERT(SECURE_TABLE_SIZE(file_entry[loop].size) > LFS_ATTR_MAX);
+	        }
+			else if(file_entry[loop].attr == CT_RING)
+	        {
+				//CT_RING ļռ+ļϢṹռ
+				flash_size += (sizeof(struct __ring_queue_header) * 2);
+	            flash_size += file_entry[loop].size;
+	        }
+			else if(file_entry[loop].attr == CT_PARALLEL)
+	        {
+				//CT_PARALLEL ļռ+ļϢṹռ
+				flash_size += (sizeof(struct __parallel_buffer_header) * 2);
+	            flash_size += file_entry[loop].size;
+	        }
+	    }
+		
+	    ASSERT((flash_size * 7) > (flash.info.chipsize() * 8));
+		ASSERT(lfs_cfg.block_size > flash.info.blocksize());
+		ASSERT(lfs_cfg.block_count > flash.info.blockcount());
+		ASSERT((lfs_cfg.block_size * lfs_cfg.block_count) != 1*1024*1024);
+		
+		checked = true;
+	}
+	
+	for(loop=0; loop<RING_CACHE_AMOUNT; loop++)
+	{
+		ring_cache[loop].entry = 0xff;
+		ring_cache[loop].pending = 0;
+	}
+	
+	lfs_maintain_reset();
+	
+	if(lfs_err)
+	{
+		lfs_err = lfs_warm_mount();
+		
+		//øʽľڳм¼˸С file_maxʱãǰ
+		if((lfs_err == LFS_ERR_OK) && (lfs_lfs.file_max < lfs_cfg.file_max))
+		{
+			if(lfs_fs_upgrade(&lfs_lfs) != LFS_ERR_OK)
+			{
+				TRACE(TRACE_WARN, "File system file_max upgrade failed, limit stays at %u bytes.", lfs_lfs.file_max);
+			}
+		}
+	}
+}
+
+/**
+  * @brief  
+  */
+static void disk_ctrl_unlock(void)
+{
+    lock = 0x5a;
+}
+
+/**
+  * @brief  
+  */
+static void disk_ctrl_lock(void)
+{
+	//ύפʱĻζĿ
+	ring_cache_flush(false);
+	
+    lock = 0;
+}
+
+/**
+  * @brief  
+  */
+static void disk_ctrl_idle(void)
+{
+	uint8_t slot;
+	
+	//ǰύлζĿ
+	ring_cache_flush(true);
+	
+	for(slot=0; slot<RING_CACHE_AMOUNT; slot++)
+	{
+		ring_cache[slot].entry = 0xff;
+	}
+	
+	lfs_maintain_reset();
+	
+	if(!lfs_err)
+	{
+		cpu.watchdog.feed();
+		lfs_warm_save();
+		lfs_unmount(&lfs_lfs);
+		lfs_err = -1;
+	}
+	cpu.watchdog.feed();
+	flash.control.suspend();
+	eeprom.control.suspend();
+}
+
+/**
+  * @brief  ÿʱ lfs άǰ̨дʱʱԪݡɨǰհںͲ
+  * budget ΪʣĿʱ䣨msÿһɷָһܳԤ
+  */
+static void disk_ctrl_maintain(uint32_t budget)
+{
+	uint32_t start = jiffy.value();
+	int result;
+	
+	if(lfs_err || (lock == 0x5a))
+	{
+		return;
+	}
+	
+	while((jiffy.after(start) + DISK_MAINTAIN_SLACK) <= budget)
+	{
+		cpu.watchdog.feed();
+		
+		//ϴεʱĿ־ǨƵļ
+		if(journal_migrate())
+		{
+			continue;
+		}
+		
+		//ӽдԪݶԣһɺ󲹳ǰհ
+		if(lfs_gc_dirty)
+		{
+			result = lfs_fs_gc(&lfs_lfs, lfs_gc_cursor);
+			
+			if(result < 0)
+			{
+				lfs_gc_cursor[0] = (lfs_block_t)-1;
+				lfs_gc_cursor[1] = (lfs_block_t)-1;
+				return;
+			}
+			
+			if(result == 0)
+			{
+				lfs_gc_dirty = false;
+			}
+			
+			continue;
+		}
+		
+		//ԤĿп
+		if(!lfs_maintain_preerase())
+		{
+			break;
+		}
 	}
-	cpu.watchdog.feed();
-	flash.control.suspend();
-	eeprom.control.suspend();
 }
 
 /**
@@ -342,6 +1420,24 @@ static void disk_ctrl_idle(void)
   */
 static void disk_ctrl_format(void)
 {
+	uint8_t slot;
+	uint16_t index;
+	
+	//ʽ󻺴ĶͷʧЧ
+	for(slot=0; slot<RING_CACHE_AMOUNT; slot++)
+	{
+		ring_cache[slot].entry = 0xff;
+		ring_cache[slot].pending = 0;
+	}
+	
+	lfs_maintain_reset();
+	
+	//ʽ־ʧЧ
+	for(index=nvram_ctrl.amount(); index>0; index--)
+	{
+		nvram_ctrl.retire(index - 1);
+	}
+	
 	if(!lfs_err)
 	{
 		cpu.watchdog.feed();
@@ -350,6 +1446,7 @@ static void disk_ctrl_format(void)
 	}
 	
 	cpu.watchdog.feed();
+	lfs_warm_touch();
 	flash.erase();
 	cpu.watchdog.feed();
 	
@@ -375,6 +1472,7 @@ const struct __disk_ctrl disk_ctrl =
     .lock               = disk_ctrl_lock,
     .unlock             = disk_ctrl_unlock,
     .idle               = disk_ctrl_idle,
+    .maintain           = disk_ctrl_maintain,
     .format             = disk_ctrl_format,
 };
 
@@ -387,7 +1485,9 @@ static uint32_t disk_parameter_read(const char *name, uint32_t offset, uint32_t
 {
 	uint16_t loop;
 	lfs_file_t lfs_file;
+	struct __secure_file secure;
 	lfs_ssize_t readsize;
+	lfs_soff_t filesize;
 	int err;
 	
 	lfs_low_restart();
@@ -459,44 +1559,63 @@ static uint32_t disk_parameter_read(const char *name, uint32_t offset, uint32_t
 			lfs_low_checkup();
 		}
 		
+		journal_overlay(loop, offset, readsize, buff);
+		
 		return(readsize);
 	}
 	else
 	{
-		//TODO: CT_SECURE Ҫȡļбȶ
-		err = lfs_file_open(&lfs_lfs, &lfs_file, file_entry[loop].name, LFS_O_RDONLY);
+		err = secure_open(loop, &secure, LFS_O_RDONLY);
 		if(err)
 		{
 			lfs_low_checkup();
 			return(0);
 		}
 		
-		if(lfs_file_size(&lfs_lfs, &lfs_file) < (offset + size))
+		filesize = lfs_file_size(&lfs_lfs, &secure.file);
+		
+		if(filesize < (offset + size))
 		{
-			lfs_file_close(&lfs_lfs, &lfs_file);
+			secure_close(&secure, false);
 			return(0);
 		}
 		
-		if(lfs_file_seek(&lfs_lfs, &lfs_file, offset, LFS_SEEK_SET) < 0)
+		if(secure_valid(loop, &secure))
 		{
-			lfs_file_close(&lfs_lfs, &lfs_file);
-			return(0);
+			//ҳУ鲢
+			readsize = secure_decode(loop, &secure, offset, size, buff);
+			if(readsize <= 0)
+			{
+				secure_close(&secure, false);
+				return(0);
+			}
 		}
-		
-		readsize = lfs_file_read(&lfs_lfs, &lfs_file, buff, size);
-		if(readsize <= 0)
+		else
 		{
-			lfs_file_close(&lfs_lfs, &lfs_file);
-			lfs_low_checkup();
-			return(0);
+			//δ ECC ľļ״дʱ
+			if(lfs_file_seek(&lfs_lfs, &secure.file, offset, LFS_SEEK_SET) < 0)
+			{
+				secure_close(&secure, false);
+				return(0);
+			}
+			
+			readsize = lfs_file_read(&lfs_lfs, &secure.file, buff, size);
+			if(readsize <= 0)
+			{
+				secure_close(&secure, false);
+				lfs_low_checkup();
+				return(0);
+			}
 		}
 		
-		err = lfs_file_close(&lfs_lfs, &lfs_file);
+		err = secure_close(&secure, false);
 		if(err)
 		{
 			lfs_low_checkup();
 		}
 		
+		journal_overlay(loop, offset, readsize, buff);
+		
 		return(readsize);
 	}
 }
@@ -507,9 +1626,6 @@ static uint32_t disk_parameter_read(const char *name, uint32_t offset, uint32_t
 static uint32_t disk_parameter_write(const char *name, uint32_t offset, uint32_t size, const void *buff)
 {
 	uint16_t loop;
-	lfs_file_t lfs_file;
-	lfs_ssize_t writesize;
-	int err;
 	
 	lfs_low_restart();
 	
@@ -545,6 +1661,25 @@ static uint32_t disk_parameter_write(const char *name, uint32_t offset, uint32_t
 		return(0);
     }
 	
+	//дλδǨƵĿ־
+	journal_settle(loop, offset, size);
+	
+	return(parameter_store(loop, offset, size, buff));
+}
+
+/**
+  * @brief  дļ
+  */
+static uint32_t parameter_store(uint16_t loop, uint32_t offset, uint32_t size, const void *buff)
+{
+	lfs_file_t lfs_file;
+	struct __secure_file secure;
+	lfs_ssize_t writesize;
+	uint32_t start, end;
+	uint32_t tag;
+	bool rebuild;
+	int err;
+	
 	if(file_entry[loop].attr == CT_NORMAL)
 	{
 		err = lfs_file_open(&lfs_lfs, &lfs_file, file_entry[loop].name, LFS_O_RDWR | LFS_O_CREAT);
@@ -581,30 +1716,52 @@ static uint32_t disk_parameter_write(const char *name, uint32_t offset, uint32_t
 	}
 	else
 	{
-		//TODO: CT_SECURE Ҫͬʱ±ļ
-		err = lfs_file_open(&lfs_lfs, &lfs_file, file_entry[loop].name, LFS_O_RDWR | LFS_O_CREAT);
+		err = secure_open(loop, &secure, LFS_O_RDWR | LFS_O_CREAT);
 		if(err)
 		{
 			lfs_low_checkup();
 			return(0);
 		}
 		
-		if(lfs_file_seek(&lfs_lfs, &lfs_file, offset, LFS_SEEK_SET) < 0)
+		//ECC δļȲļɸʽļʱ¼
+		rebuild = !secure_valid(loop, &secure);
+		
+		if(rebuild)
 		{
-			lfs_file_close(&lfs_lfs, &lfs_file);
+			start = 0;
+			end = file_entry[loop].size;
+		}
+		else
+		{
+			start = offset;
+			end = offset + size;
+		}
+		
+		//ECC дǰ㣬ʧʱļδĶ
+		if(!secure_encode(loop, &secure, start, end, offset, size, buff))
+		{
+			secure_close(&secure, true);
 			return(0);
 		}
 		
-		writesize = lfs_file_write(&lfs_lfs, &lfs_file, buff, size);
+		tag = SECURE_TAG(file_entry[loop].size);
+		heap.copy(secure.table, &tag, sizeof(tag));
 		
-		if(writesize <= 0)
+		//ECC ļڹرʱһύһʧܶ޸
+		//ɸʽļ֮ ECC ʹãһص
+		if((rebuild && (lfs_file_size(&lfs_lfs, &secure.file) > (lfs_soff_t)file_entry[loop].size) && \
+			(lfs_file_truncate(&lfs_lfs, &secure.file, file_entry[loop].size) < 0)) || \
+			(lfs_file_seek(&lfs_lfs, &secure.file, offset, LFS_SEEK_SET) < 0) || \
+			(lfs_file_write(&lfs_lfs, &secure.file, buff, size) != (lfs_ssize_t)size))
 		{
-			lfs_file_close(&lfs_lfs, &lfs_file);
+			secure_close(&secure, true);
 			lfs_low_checkup();
 			return(0);
 		}
 		
-		err = lfs_file_close(&lfs_lfs, &lfs_file);
+		writesize = size;
+		
+		err = secure_close(&secure, false);
 		
 		if(err)
 		{
@@ -683,6 +1840,18 @@ static uint32_t disk_ring_read(const char *name, uint32_t index, uint32_t size,
 		return(0);
 	}
 	
+	//ύеĿ
+	for(check=0; check<RING_CACHE_AMOUNT; check++)
+	{
+		if(ring_cache[check].entry == loop)
+		{
+			if(!ring_cache_commit(check))
+			{
+				return(0);
+			}
+		}
+	}
+	
 	info = heap.dzalloc(strlen(file_entry[loop].name) + strlen(".r0") + 1);
 	
 	if(!info)
@@ -792,17 +1961,13 @@ static uint32_t disk_ring_read(const char *name, uint32_t index, uint32_t size,
 
 /**
   * @brief  ζ
+  * ĿȽڴ滺棬 append_manyлơפʱ disk_ctrl.idle ύ
   */
 static uint32_t disk_ring_append(const char *name, uint32_t size, const void *buff)
 {
 	uint16_t loop;
-	lfs_file_t lfs_file_info, lfs_file_data;
-	lfs_ssize_t operatesize;
-	struct __ring_queue_header *queue_header;
-	uint32_t check, calc;
-	uint32_t offset;
-	char *info;
-	int err;
+	int16_t slot;
+	uint32_t operatesize;
 	
 	lfs_low_restart();
 	
@@ -827,147 +1992,79 @@ static uint32_t disk_ring_append(const char *name, uint32_t size, const void *bu
 		return(0);
 	}
 	
-	info = heap.dzalloc(strlen(file_entry[loop].name) + strlen(".r0") + 1);
-	
-	if(!info)
-	{
-		return(0);
-	}
-	
-	strcpy(info, file_entry[loop].name);
-	strcat(info, ".r0");
-	
-	err = lfs_file_open(&lfs_lfs, &lfs_file_info, info, LFS_O_RDWR);
-	if(err)
-	{
-		heap.free(info);
-		lfs_low_checkup();
-		return(0);
-	}
-	
-	heap.free(info);
-	
-	if(lfs_file_rewind(&lfs_lfs, &lfs_file_info) < 0)
-	{
-		lfs_file_close(&lfs_lfs, &lfs_file_info);
-		lfs_low_checkup();
-		return(0);
-	}
-	
-	queue_header = heap.dzalloc(256);
-	if(!queue_header)
-	{
-		lfs_file_close(&lfs_lfs, &lfs_file_info);
-		return(0);
-	}
-	
-	operatesize = lfs_file_read(&lfs_lfs, &lfs_file_info, (void *)queue_header, sizeof(struct __ring_queue_header));
-	
-	if(operatesize != sizeof(struct __ring_queue_header))
+	slot = ring_cache_load(loop);
+	if(slot < 0)
 	{
-		lfs_file_close(&lfs_lfs, &lfs_file_info);
-		heap.free(queue_header);
-		lfs_low_checkup();
 		return(0);
 	}
 	
-	check = queue_header->check;
-	queue_header->check = 0;
-	
-	__nand_calculate_ecc((void *)queue_header, 256, (uint8_t *)&calc);
+	operatesize = ring_cache_append(slot, size, buff);
 	
-	if(calc != check)
+	if(operatesize && !RING_PENDING_LATENCY)
 	{
-		if(__nand_correct_data((void *)queue_header, (uint8_t *)&check, (uint8_t *)&calc, 256) < 0)
+		if(!ring_cache_commit(slot))
 		{
-			lfs_file_close(&lfs_lfs, &lfs_file_info);
-			heap.free(queue_header);
 			return(0);
 		}
 	}
 	
-	if(queue_header->current >= queue_header->capacity)
-	{
-		lfs_file_close(&lfs_lfs, &lfs_file_info);
-		heap.free(queue_header);
-		return(0);
-	}
-	
-	offset = (uint32_t)queue_header->current * (queue_header->length + 4);
-	
-	if((offset + (queue_header->length + 4)) > file_entry[loop].size)
-	{
-		lfs_file_close(&lfs_lfs, &lfs_file_info);
-		heap.free(queue_header);
-		return(0);
-	}
+	return(operatesize);
+}
+
+/**
+  * @brief  ζ
+  * ׷ amount ¼ÿ size ֽڣϲΪһдһζͷύ
+  * سɹ׷ӵĿ
+  */
+static uint32_t disk_ring_append_many(const char *name, uint32_t amount, uint32_t size, const void *buff)
+{
+	uint16_t loop;
+	int16_t slot;
+	uint32_t cnt;
 	
-	err = lfs_file_open(&lfs_lfs, &lfs_file_data, file_entry[loop].name, LFS_O_RDWR | LFS_O_CREAT);
-	if(err)
-	{
-		lfs_file_close(&lfs_lfs, &lfs_file_info);
-		heap.free(queue_header);
-		lfs_low_checkup();
-		return(0);
-	}
+	lfs_low_restart();
 	
-	if(lfs_file_seek(&lfs_lfs, &lfs_file_data, offset, LFS_SEEK_SET) < 0)
+	if(!name || !amount || !size || !buff || lfs_err || (lock != 0x5a))
 	{
-		lfs_file_close(&lfs_lfs, &lfs_file_data);
-		lfs_file_close(&lfs_lfs, &lfs_file_info);
-		heap.free(queue_header);
-		lfs_low_checkup();
 		return(0);
 	}
 	
-	//TODO: Чݺ4ֽECCУ飬
-	operatesize = lfs_file_write(&lfs_lfs, &lfs_file_data, buff, (size<queue_header->length?size:queue_header->length));
-	lfs_file_close(&lfs_lfs, &lfs_file_data);
+    for(loop=0; loop<AMOUNT_FILE; loop++)
+    {
+        if(file_entry[loop].attr == CT_RING)
+        {
+			if(strcmp(file_entry[loop].name, name) == 0)
+			{
+				break;
+			}
+        }
+    }
 	
-	if(operatesize != (size<queue_header->length?size:queue_header->length))
+	if(loop >= AMOUNT_FILE)
 	{
-		lfs_file_close(&lfs_lfs, &lfs_file_info);
-		heap.free(queue_header);
-		lfs_low_checkup();
 		return(0);
 	}
 	
-	if(lfs_file_rewind(&lfs_lfs, &lfs_file_info) < 0)
+	slot = ring_cache_load(loop);
+	if(slot < 0)
 	{
-		lfs_file_close(&lfs_lfs, &lfs_file_info);
-		heap.free(queue_header);
-		lfs_low_checkup();
 		return(0);
 	}
 	
-	if(queue_header->amount < queue_header->capacity)
-	{
-		queue_header->amount += 1;
-	}
-	
-	queue_header->current += 1;
-	queue_header->current = queue_header->current % queue_header->capacity;
-	
-	queue_header->check = 0;
-	__nand_calculate_ecc((void *)queue_header, 256, (uint8_t *)&calc);
-	queue_header->check = calc;
-	
-	if(lfs_file_size(&lfs_lfs, &lfs_file_info) != sizeof(struct __ring_queue_header))
+	for(cnt=0; cnt<amount; cnt++)
 	{
-		lfs_file_truncate(&lfs_lfs, &lfs_file_info, sizeof(struct __ring_queue_header));
+		if(!ring_cache_append(slot, size, ((const uint8_t *)buff + cnt * size)))
+		{
+			return(cnt);
+		}
 	}
 	
-	if(lfs_file_write(&lfs_lfs, &lfs_file_info, (void *)queue_header, sizeof(struct __ring_queue_header)) != sizeof(struct __ring_queue_header))
+	if(!ring_cache_commit(slot))
 	{
-		lfs_file_close(&lfs_lfs, &lfs_file_info);
-		heap.free(queue_header);
-		lfs_low_checkup();
 		return(0);
 	}
 	
-	lfs_file_close(&lfs_lfs, &lfs_file_info);
-	heap.free(queue_header);
-	return(operatesize);
+	return(cnt);
 }
 
 /**
@@ -1006,6 +2103,12 @@ static uint32_t disk_ring_truncate(const char *name, uint32_t amount, bool rever
 		return(0);
 	}
 	
+	//ͷдύͷŻ
+	if(!ring_cache_release(loop))
+	{
+		return(0);
+	}
+	
 	info = heap.dzalloc(strlen(file_entry[loop].name) + strlen(".r0") + 1);
 	
 	if(!info)
@@ -1120,12 +2223,7 @@ static uint32_t disk_ring_truncate(const char *name, uint32_t amount, bool rever
 static bool disk_ring_info(const char *name, struct __ring_info *ring_info)
 {
 	uint16_t loop;
-	lfs_file_t lfs_file;
-	lfs_ssize_t readsize;
-	struct __ring_queue_header *queue_header;
-	uint32_t check, calc;
-	char *info;
-	int err;
+	int16_t slot;
 	
 	lfs_low_restart();
 	
@@ -1150,69 +2248,17 @@ static bool disk_ring_info(const char *name, struct __ring_info *ring_info)
 		return(false);
 	}
 	
-	info = heap.dzalloc(strlen(file_entry[loop].name) + strlen(".r0") + 1);
-	
-	if(!info)
-	{
-		return(false);
-	}
-	
-	strcpy(info, file_entry[loop].name);
-	strcat(info, ".r0");
-	
-	err = lfs_file_open(&lfs_lfs, &lfs_file, info, LFS_O_RDONLY);
-	if(err)
-	{
-		heap.free(info);
-		lfs_low_checkup();
-		return(false);
-	}
-	
-	heap.free(info);
-	
-	if(lfs_file_rewind(&lfs_lfs, &lfs_file) < 0)
-	{
-		lfs_file_close(&lfs_lfs, &lfs_file);
-		lfs_low_checkup();
-		return(false);
-	}
-	
-	queue_header = heap.dzalloc(256);
-	if(!queue_header)
-	{
-		return(false);
-	}
-	
-	readsize = lfs_file_read(&lfs_lfs, &lfs_file, (void *)queue_header, sizeof(struct __ring_queue_header));
-	
-	lfs_file_close(&lfs_lfs, &lfs_file);
-	
-	if(readsize != sizeof(struct __ring_queue_header))
+	//ڴеĶͷѼύĿ
+	slot = ring_cache_load(loop);
+	if(slot < 0)
 	{
-		heap.free(queue_header);
-		lfs_low_checkup();
 		return(false);
 	}
 	
-	check = queue_header->check;
-	queue_header->check = 0;
-	
-	__nand_calculate_ecc((void *)queue_header, 256, (uint8_t *)&calc);
-	
-	if(calc != check)
-	{
-		if(__nand_correct_data((void *)queue_header, (uint8_t *)&check, (uint8_t *)&calc, 256) < 0)
-		{
-			heap.free(queue_header);
-			return(false);
-		}
-	}
-	
-	ring_info->amount = queue_header->amount;
-	ring_info->capacity = queue_header->capacity;
-	ring_info->length = queue_header->capacity;
+	ring_info->amount = ring_cache[slot].header.amount;
+	ring_info->capacity = ring_cache[slot].header.capacity;
+	ring_info->length = ring_cache[slot].header.length;
 	
-	heap.free(queue_header);
 	return(true);
 }
 
@@ -1251,6 +2297,9 @@ static bool disk_ring_reset(const char *name)
 		return(false);
 	}
 	
+	//нգͷŻ棬δύĿһ
+	ring_cache_release(loop);
+	
 	info = heap.dzalloc(strlen(file_entry[loop].name) + strlen(".r0") + 1);
 	
 	if(!info)
@@ -1376,6 +2425,9 @@ static bool disk_ring_init(const char *name, uint32_t length)
 		return(false);
 	}
 	
+	//нգͷŻ棬δύĿһ
+	ring_cache_release(loop);
+	
 	info = heap.dzalloc(strlen(file_entry[loop].name) + strlen(".r0") + 1);
 	
 	if(!info)
@@ -1539,7 +2591,8 @@ static uint32_t disk_parallel_read(const char *name, uint32_t index, uint32_t si
 		}
 	}
 	
-	offset = (index % buffer_header->capacity) * (buffer_header->length + 4);
+	//¼ȽУҳ
+	offset = (index % buffer_header->capacity) * buffer_header->length;
 	
 	//TODO:ȡmap
 	
@@ -1559,7 +2612,6 @@ static uint32_t disk_parallel_read(const char *name, uint32_t index, uint32_t si
 		return(0);
 	}
 	
-	//TODO: Чݺ4ֽECCУ飬֤
 	readsize = lfs_file_read(&lfs_lfs, &lfs_file, buff, (size<buffer_header->length?size:buffer_header->length));
 	
 	lfs_file_close(&lfs_lfs, &lfs_file);
@@ -1665,7 +2717,8 @@ static uint32_t disk_parallel_write(const char *name, uint32_t index, uint32_t s
 		}
 	}
 	
-	offset = (index % buffer_header->capacity) * (buffer_header->length + 4);
+	//¼ȽУҳ
+	offset = (index % buffer_header->capacity) * buffer_header->length;
 	
 	err = lfs_file_open(&lfs_lfs, &lfs_file, file_entry[loop].name, LFS_O_RDWR | LFS_O_CREAT);
 	if(err)
@@ -1683,7 +2736,6 @@ static uint32_t disk_parallel_write(const char *name, uint32_t index, uint32_t s
 		return(0);
 	}
 	
-	//TODO: Чݺ4ֽECCУ飬֤
 	operatesize = lfs_file_write(&lfs_lfs, &lfs_file, buff, (size<buffer_header->length?size:buffer_header->length));
 	
 	lfs_file_close(&lfs_lfs, &lfs_file);
@@ -1712,6 +2764,7 @@ static bool disk_parallel_signature(const char *name, uint32_t *signature)
 	struct __parallel_buffer_header *buffer_header;
 	uint32_t check, calc;
 	uint32_t index;
+	uint32_t amount;
 	char *info;
 	int err;
 	
@@ -1812,8 +2865,16 @@ static bool disk_parallel_signature(const char *name, uint32_t *signature)
 		return(false);
 	}
 	
-	if(lfs_file_size(&lfs_lfs, &lfs_file) < buffer_header->capacity * (buffer_header->length + 4))
+	//ǩдļ¼
+	amount = lfs_file_size(&lfs_lfs, &lfs_file) / buffer_header->length;
+	if(amount > buffer_header->capacity)
 	{
+		amount = buffer_header->capacity;
+	}
+	
+	if(!amount)
+	{
+		lfs_file_close(&lfs_lfs, &lfs_file);
 		heap.free(buffer_header);
 		return(false);
 	}
@@ -1825,7 +2886,7 @@ static bool disk_parallel_signature(const char *name, uint32_t *signature)
 		return(false);
 	}
 	
-	info = heap.dzalloc(buffer_header->length + 4);
+	info = heap.dzalloc(buffer_header->length);
 	
 	if(!info)
 	{
@@ -1833,9 +2894,9 @@ static bool disk_parallel_signature(const char *name, uint32_t *signature)
 		return(false);
 	}
 	
-	for(index=0; index<buffer_header->capacity; index++)
+	for(index=0; index<amount; index++)
 	{
-		if(lfs_file_read(&lfs_lfs, &lfs_file, info, (buffer_header->length + 4)) != (buffer_header->length + 4))
+		if(lfs_file_read(&lfs_lfs, &lfs_file, info, buffer_header->length) != buffer_header->length)
 		{
 			lfs_file_close(&lfs_lfs, &lfs_file);
 			heap.free(buffer_header);
@@ -2333,7 +3394,7 @@ static bool disk_parallel_init(const char *name, uint32_t length)
 	}
 	
 	buffer_header->length = length;
-	buffer_header->capacity = file_entry[loop].size / (buffer_header->length + 4);
+	buffer_header->capacity = file_entry[loop].size / buffer_header->length;
 	
 	if(lfs_file_rewind(&lfs_lfs, &lfs_file) < 0)
 	{
@@ -2389,6 +3450,45 @@ static bool disk_parallel_init(const char *name, uint32_t length)
 }
 
 
+#if defined ( __linux )
+/**
+  * @brief  ļ⣬Эջ̻ͨ߳ͬʱļ
+  */
+static pthread_mutex_t file_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#define DISK_LOCKED(type, func, params, args) \
+static type func##_locked params \
+{ \
+    type result; \
+    pthread_mutex_lock(&file_lock); \
+    result = func args; \
+    pthread_mutex_unlock(&file_lock); \
+    return(result); \
+}
+
+DISK_LOCKED(uint32_t, disk_parameter_read, (const char *name, uint32_t offset, uint32_t size, void *buff), (name, offset, size, buff))
+DISK_LOCKED(uint32_t, disk_parameter_write, (const char *name, uint32_t offset, uint32_t size, const void *buff), (name, offset, size, buff))
+DISK_LOCKED(uint32_t, disk_parameter_size, (const char *name), (name))
+DISK_LOCKED(uint32_t, disk_ring_read, (const char *name, uint32_t index, uint32_t size, void *buff, bool reverse), (name, index, size, buff, reverse))
+DISK_LOCKED(uint32_t, disk_ring_append, (const char *name, uint32_t size, const void *buff), (name, size, buff))
+DISK_LOCKED(uint32_t, disk_ring_append_many, (const char *name, uint32_t amount, uint32_t size, const void *buff), (name, amount, size, buff))
+DISK_LOCKED(uint32_t, disk_ring_truncate, (const char *name, uint32_t amount, bool reverse), (name, amount, reverse))
+DISK_LOCKED(bool, disk_ring_info, (const char *name, struct __ring_info *ring_info), (name, ring_info))
+DISK_LOCKED(bool, disk_ring_reset, (const char *name), (name))
+DISK_LOCKED(bool, disk_ring_init, (const char *name, uint32_t length), (name, length))
+DISK_LOCKED(uint32_t, disk_parallel_read, (const char *name, uint32_t index, uint32_t size, void *buff), (name, index, size, buff))
+DISK_LOCKED(uint32_t, disk_parallel_write, (const char *name, uint32_t index, uint32_t size, const void *buff), (name, index, size, buff))
+DISK_LOCKED(bool, disk_parallel_signature, (const char *name, uint32_t *signature), (name, signature))
+DISK_LOCKED(bool, disk_parallel_status, (const char *name, uint32_t index), (name, index))
+DISK_LOCKED(bool, disk_parallel_renew, (const char *name, uint32_t index), (name, index))
+DISK_LOCKED(bool, disk_parallel_info, (const char *name, struct __parallel_info *parallel_info), (name, parallel_info))
+DISK_LOCKED(bool, disk_parallel_reset, (const char *name), (name))
+DISK_LOCKED(bool, disk_parallel_init, (const char *name, uint32_t length), (name, length))
+
+#define DISK_ENTRY(func)        func##_locked
+#else
+#define DISK_ENTRY(func)        func
+#endif
 
 /**
   * @brief  ӿ
@@ -2397,30 +3497,31 @@ struct __file file =
 {
 	.parameter		= 
 	{
-		.read		= disk_parameter_read,
-		.write		= disk_parameter_write,
-		.size		= disk_parameter_size,
+		.read		= DISK_ENTRY(disk_parameter_read),
+		.write		= DISK_ENTRY(disk_parameter_write),
+		.size		= DISK_ENTRY(disk_parameter_size),
 	},
 	
 	.ring			= 
 	{
-		.read		=  disk_ring_read,
-		.append		=  disk_ring_append,
-		.truncate	=  disk_ring_truncate,
-		.info		=  disk_ring_info,
-		.reset		=  disk_ring_reset,
-		.init		=  disk_ring_init,
+		.read		=  DISK_ENTRY(disk_ring_read),
+		.append		=  DISK_ENTRY(disk_ring_append),
+		.append_many	=  DISK_ENTRY(disk_ring_append_many),
+		.truncate	=  DISK_ENTRY(disk_ring_truncate),
+		.info		=  DISK_ENTRY(disk_ring_info),
+		.reset		=  DISK_ENTRY(disk_ring_reset),
+		.init		=  DISK_ENTRY(disk_ring_init),
 	},
 	
 	.parallel			= 
 	{
-		.read		=  disk_parallel_read,
-		.write		=  disk_parallel_write,
-		.signature	= disk_parallel_signature,
-		.status		=  disk_parallel_status,
-		.renew		=  disk_parallel_renew,
-		.info		=  disk_parallel_info,
-		.reset		=  disk_parallel_reset,
-		.init		=  disk_parallel_init,
+		.read		=  DISK_ENTRY(disk_parallel_read),
+		.write		=  DISK_ENTRY(disk_parallel_write),
+		.signature	= DISK_ENTRY(disk_parallel_signature),
+		.status		=  DISK_ENTRY(disk_parallel_status),
+		.renew		=  DISK_ENTRY(disk_parallel_renew),
+		.info		=  DISK_ENTRY(disk_parallel_info),
+		.reset		=  DISK_ENTRY(disk_parallel_reset),
+		.init		=  DISK_ENTRY(disk_parallel_init),
 	},
 };
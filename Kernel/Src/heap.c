@@ -12,6 +12,10 @@
 #include "tasks.h"
 #include "trace.h"
 
+#if defined ( __linux )
+#include <pthread.h>
+#endif
+
 /* Private typedef -----------------------------------------------------------*/
 /**
   * @brief  ڴ¼
@@ -28,9 +32,24 @@ struct __mem_entry
 #define MAX_DHEAP               ((uint32_t)(1024*8)) //Ķʱڴ
 
 /* Private macro -------------------------------------------------------------*/
+#if defined ( __linux )
+//רڴΪ̹߳ãʱڴÿ̸߳һݣɸ߳ͷ
+#define HEAP_THREAD_LOCAL       __thread
+#define SHEAP_LOCK()            pthread_mutex_lock(&slock)
+#define SHEAP_UNLOCK()          pthread_mutex_unlock(&slock)
+#else
+#define HEAP_THREAD_LOCAL
+#define SHEAP_LOCK()
+#define SHEAP_UNLOCK()
+#endif
+
 /* Private variables ---------------------------------------------------------*/
 static struct __mem_entry *slist = (struct __mem_entry *)0;
-static struct __mem_entry *dlist = (struct __mem_entry *)0;
+static HEAP_THREAD_LOCAL struct __mem_entry *dlist = (struct __mem_entry *)0;
+
+#if defined ( __linux )
+static pthread_mutex_t slock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
@@ -41,12 +60,16 @@ static void heap_sinit(void)
 {
     struct __mem_entry *p;
     
+    SHEAP_LOCK();
+    
     while(slist)
     {
         p = slist;
         slist = slist->next;
         free(p);
     }
+    
+    SHEAP_UNLOCK();
 }
 
 /**
@@ -69,8 +92,8 @@ static void heap_dinit(void)
   */
 static void heap_recycle(void)
 {
-    struct __mem_entry *p = slist;
-    struct __mem_entry *previous = slist;
+    struct __mem_entry *p;
+    struct __mem_entry *previous;
     unsigned long magic;
     
 #if defined ( __GNUC__ )
@@ -89,6 +112,11 @@ static void heap_recycle(void)
         return;
     }
     
+    SHEAP_LOCK();
+    
+    p = slist;
+    previous = slist;
+    
     while(p)
     {
         if((p->magic == magic) || (p->magic == 0))
@@ -119,6 +147,8 @@ static void heap_recycle(void)
             p = p->next;
         }
     }
+    
+    SHEAP_UNLOCK();
 }
 
 /**
@@ -137,7 +167,7 @@ const struct __heap_ctrl heap_ctrl =
 static void *heap_salloc(const char *name, uint32_t size)
 {
     void *address;
-    struct __mem_entry *p = slist;
+    struct __mem_entry *p;
     uint32_t mem_allcoked = 0;
     unsigned long magic;
     
@@ -175,6 +205,10 @@ static void *heap_salloc(const char *name, uint32_t size)
         return((void *)0);
     }
     
+    SHEAP_LOCK();
+    
+    p = slist;
+    
     while(p)
     {
         if(p->magic == magic)
@@ -187,6 +221,7 @@ static void *heap_salloc(const char *name, uint32_t size)
     
     if((mem_allcoked + size) > MAX_SHEAP_PER_TASK)
     {
+        SHEAP_UNLOCK();
         TRACE(TRACE_ERR,\
 		"Heap salloc failed (heap overflow), task name is: %s.",\
 		name);
@@ -197,6 +232,7 @@ static void *heap_salloc(const char *name, uint32_t size)
     address = malloc(size + sizeof(struct __mem_entry));
     if(!address)
     {
+        SHEAP_UNLOCK();
         TRACE(TRACE_ERR,\
 		"Heap salloc failed (system memory overflow), task name is: %s.",\
 		name);
@@ -208,6 +244,8 @@ static void *heap_salloc(const char *name, uint32_t size)
     ((struct __mem_entry *)address)->next = slist;
     slist = ((struct __mem_entry *)address);
     
+    SHEAP_UNLOCK();
+    
     TRACE(TRACE_INFO,\
 	"Heap salloc success, task name: %s, address: %08X, size: %08X.",\
 	name,\
@@ -233,7 +271,7 @@ static void *heap_szalloc(const char *name, uint32_t size)
 {
 	void *result = heap_salloc(name, size);
 	
-	if(!result)
+	if(result)
 	{
 		memset(result, 0, size);
 	}
@@ -246,7 +284,7 @@ static void *heap_szalloc(const char *name, uint32_t size)
   */
 static void *heap_scalloc(const char *name, uint32_t n, uint32_t size)
 {
-    return(heap_salloc(name, n * size));
+    return(heap_szalloc(name, n * size));
 }
 
 /**
@@ -315,7 +353,7 @@ static void *heap_dzalloc(uint32_t size)
 {
 	void *result = heap_dalloc(size);
 	
-	if(!result)
+	if(result)
 	{
 		memset(result, 0, size);
 	}
@@ -328,7 +366,7 @@ static void *heap_dzalloc(uint32_t size)
   */
 static void *heap_dcalloc(uint32_t n, uint32_t size)
 {
-    return(heap_dalloc(n * size));
+    return(heap_dzalloc(n * size));
 }
 
 /**
@@ -385,6 +423,8 @@ static void heap_free(void *address)
         }
     }
     
+    SHEAP_LOCK();
+    
     p = slist;
     previous = slist;
     
@@ -420,6 +460,8 @@ static void heap_free(void *address)
         }
     }
     
+    SHEAP_UNLOCK();
+
 #if defined ( __GNUC__ )
 #pragma GCC diagnostic pop
 #endif
@@ -459,6 +501,8 @@ static uint32_t heap_copy(void *dst, const void *src, uint32_t size)
         p = p->next;
     }
     
+    SHEAP_LOCK();
+    
     p = slist;
     
     while(p)
@@ -471,6 +515,7 @@ static uint32_t heap_copy(void *dst, const void *src, uint32_t size)
 		if((((unsigned long)dst) < ((unsigned long)p + sizeof(struct __mem_entry))) && \
 		(((unsigned long)dst + size) > ((unsigned long)p)))
 		{
+            SHEAP_UNLOCK();
             TRACE(TRACE_ERR,\
 			"Heap copy address conflict.");
 			return(0);
@@ -482,6 +527,8 @@ static uint32_t heap_copy(void *dst, const void *src, uint32_t size)
         p = p->next;
     }
     
+    SHEAP_UNLOCK();
+    
     memcpy(dst, src, size);
     
     return(size);
@@ -520,6 +567,8 @@ static uint32_t heap_set(void *address, uint8_t ch, uint32_t size)
         p = p->next;
     }
     
+    SHEAP_LOCK();
+    
     p = slist;
     
     while(p)
@@ -532,6 +581,7 @@ static uint32_t heap_set(void *address, uint8_t ch, uint32_t size)
 		if((((unsigned long)address) < ((unsigned long)p + sizeof(struct __mem_entry))) && \
 		(((unsigned long)address + size) > ((unsigned long)p)))
 		{
+            SHEAP_UNLOCK();
             TRACE(TRACE_ERR,\
 			"Heap set address conflict.");
 			return(0);
@@ -543,6 +593,8 @@ static uint32_t heap_set(void *address, uint8_t ch, uint32_t size)
         p = p->next;
     }
     
+    SHEAP_UNLOCK();
+    
     memset(address, ch, size);
     
     return(size);
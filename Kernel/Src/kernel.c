@@ -10,21 +10,28 @@
 #include "power.h"
 #include "kernel.h"
 #include "tasks_sched.h"
+#include "allocator_ctrl.h"
 #include "trace.h"
 
 #if defined ( _WIN32 ) || defined ( _WIN64 )
 #include <windows.h>
 #include <conio.h>
 #include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
 #elif defined ( __linux )
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <pthread.h>
 #include "stdio.h"
 #include "stdlib.h"
 #include "string.h"
+#include "time.h"
+#include "comm_bus.h"
 #endif
 
 /* Private typedef -----------------------------------------------------------*/
@@ -37,6 +44,13 @@ static uint32_t consumption = 0;
 static uint16_t calcu_loop = 0;
 static uint16_t cpu_load = 0;
 
+#if defined ( __linux )
+/**
+  * @brief  ߳ task ʱռЭջ̴߳ʱ
+  */
+static pthread_rwlock_t sched_lock;
+#endif
+
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 /**
@@ -110,6 +124,12 @@ static void tasks_sched(enum __klevel level)
                 {
                 	enum __klevel level_back = level;
                     
+                    //ʱȰѵǼǵݿ浽 nvram˳
+                    if((level_before == SYSTEM_RUN) && (level == SYSTEM_SLEEP))
+                    {
+                        nvram_ctrl.fastsave(KERNEL_FASTSAVE_BUDGET);
+                    }
+                	
                 	level = level_before;
                     tasks.exit();
                     level = level_back;
@@ -194,6 +214,12 @@ static void tasks_sched(enum __klevel level)
             calcu_loop = 0;
         }
 		
+        //ʱñʣĿʱ洢̨ά
+        if((level == SYSTEM_RUN) && (relative < PERIOD_RUNNING))
+        {
+            disk_ctrl.maintain(PERIOD_RUNNING - relative);
+        }
+        
         if((level == SYSTEM_WAKEUP) && (relative < (PERIOD_RUNNING * 3 / 4)) && (cpu_load < 50))
 		{
 			//cpu idle
@@ -210,6 +236,51 @@ static void tasks_sched(enum __klevel level)
     }
 }
 
+#if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+/**
+  * @brief  ݻʱ
+  * VM_SPEED Ϊٱȡ "max" ʱܿƽ
+  * VM_EPOCH Ϊʱ㣨룩ȱʡΪǰʱ
+  */
+static void simulate_setup(void)
+{
+    const char *speed = getenv("VM_SPEED");
+    const char *epoch = getenv("VM_EPOCH");
+    uint32_t factor;
+    uint64_t start;
+    
+    if(!speed || !*speed)
+    {
+        return;
+    }
+    
+    if(strcmp(speed, "max") == 0)
+    {
+        factor = SIMULATE_UNLIMITED;
+    }
+    else
+    {
+        factor = (uint32_t)strtoul(speed, (char **)0, 10);
+        if(!factor)
+        {
+            return;
+        }
+    }
+    
+    if(epoch && *epoch)
+    {
+        start = (uint64_t)strtoull(epoch, (char **)0, 10);
+    }
+    else
+    {
+        start = (uint64_t)time((time_t *)0);
+    }
+    
+    simulate_start(factor, start);
+    TRACE(TRACE_INFO, "Virtual clock started, speed %s.", speed);
+}
+#endif
+
 /**
   * @brief
   */
@@ -267,11 +338,12 @@ int main(void)
 	
     proc_self = argv[0];
 #elif defined ( __linux )
-    const unsigned char *lock = "/tmp/virtual_meter.pid";
+    char lock[80] = "/tmp/virtual_meter.pid";
     int fd;
     struct flock fl;
     char mypid[16];
-    
+    pthread_rwlockattr_t sched_attr;
+
 #if defined ( BUILD_DAEMON )
 	if(daemon(0, 0) < 0)
 	{
@@ -280,6 +352,14 @@ int main(void)
 	}
 #endif
     
+    //ÿ豸߶Ӧһʵ
+    if(devbus.open())
+    {
+        strcpy(lock, "/tmp/virtual_meter.");
+        strcat(lock, devbus.name());
+        strcat(lock, ".pid");
+    }
+    
     fd = open(lock, O_RDWR|O_CREAT, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
     if(fd < 0)
     {
@@ -320,13 +400,49 @@ int main(void)
     proc_self = argv[0];
 #endif
     
+#if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+    simulate_setup();
+#endif
+    
+#if defined ( __linux )
+    if(devbus.name())
+    {
+        TRACE(TRACE_INFO, "Device bus %s attached.", devbus.name());
+    }
+    
+    //дȣ̳߳ռʱȲ
+    pthread_rwlockattr_init(&sched_attr);
+    pthread_rwlockattr_setkind_np(&sched_attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    pthread_rwlock_init(&sched_lock, &sched_attr);
+    pthread_rwlockattr_destroy(&sched_attr);
+#endif
+    
 	TRACE(TRACE_INFO, "System started.");
     power.init();
     
     while(1)
     {
         klevel = get_state();
+#if defined ( __linux )
+        pthread_rwlock_wrlock(&sched_lock);
         tasks_sched(klevel);
+        pthread_rwlock_unlock(&sched_lock);
+#else
+        tasks_sched(klevel);
+#endif
+
+#if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
+        if(simulate_speed() != SIMULATE_REALTIME)
+        {
+            //ʱÿƽһڣʱɵδ߳ƽ
+            if(klevel != SYSTEM_SLEEP)
+            {
+                simulate_step(PERIOD_RUNNING);
+                simulate_pace(PERIOD_RUNNING);
+            }
+            continue;
+        }
+#endif
         
 #if defined ( _WIN32 ) || defined ( _WIN64 )
         Sleep(5);
@@ -361,3 +477,21 @@ uint16_t system_usage(void)
     return(cpu_load);
 }
 
+#if defined ( __linux )
+/**
+  * @brief  빲ڼ̲߳ task
+  */
+void system_lock_shared(void)
+{
+    pthread_rwlock_rdlock(&sched_lock);
+}
+
+/**
+  * @brief  ˳
+  */
+void system_unlock_shared(void)
+{
+    pthread_rwlock_unlock(&sched_lock);
+}
+#endif
+
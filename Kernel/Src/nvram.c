@@ -10,6 +10,15 @@
 #include "allocator_ctrl.h"
 #include "tasks.h"
 #include "string.h"
+#include "crc.h"
+
+#if defined ( __linux )
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
 
 /* Private typedef -----------------------------------------------------------*/
 /**
@@ -21,28 +30,96 @@ struct __nvram_entry
     uint32_t					size;
 };
 
+/**
+  * @brief  Ǽǵĵݿ
+  */
+struct __nvram_blob
+{
+	const char					*name; //ļ
+	uint32_t					offset; //ļƫ
+	const void					*blob; //ݿַ
+	uint16_t					size; //ݿ鳤
+	bool						dirty; //޸ģδдļ
+};
+
+/**
+  * @brief  ־ͷ
+  * ־ͷݣд롣ÿύдŽϾɵһݣУд룬
+  * деʱһȻЧеĿᶪʧ
+  */
+struct __journal_header
+{
+	uint32_t					magic;
+	uint16_t					amount; //Ŀ
+	uint16_t					used; //Ŀռõֽ
+	uint32_t					sequence; //ύţݶЧʱŽµһЧ
+	uint32_t					check; //magic  sequence У
+};
+
+/**
+  * @brief  ־Ŀݽ󣬰4ֽڶ
+  */
+struct __journal_record
+{
+	char						name[16]; //ļ
+	uint32_t					offset; //ļƫ
+	uint16_t					size; //ݳ
+	uint16_t					state; //JOURNAL_LIVE ʾδǨƣУ
+	uint32_t					check; //name  size ԼݵУ
+};
+
 /* Private define ------------------------------------------------------------*/
+#if !defined ( NVRAM_BLOB_AMOUNT )
+#define NVRAM_BLOB_AMOUNT			((uint8_t)8) //Ǽǵĵݿ
+#endif
+
+#if !defined ( NVRAM_COPY_RATE )
+#define NVRAM_COPY_RATE				((uint32_t)16) //д nvram ٶȣֽ/usڹʱ
+#endif
+
+#if !defined ( NVRAM_COPY_SETUP )
+#define NVRAM_COPY_SETUP			((uint32_t)4) //ÿĿĹ̶usУ
+#endif
+
+#define JOURNAL_MAGIC				((uint32_t)0x4a524e4c)
+#define JOURNAL_LIVE				((uint16_t)0x5a5a)
+
 /* Private macro -------------------------------------------------------------*/
 #define NVRAM_ENTRY_AMOUNT			((uint16_t)(sizeof(nvram_entry)/sizeof(struct __nvram_entry)))
 #define NVRAM_SIZE                  ((uint32_t)(2*1024))
+#define JOURNAL_HEADS				((uint32_t)(2 * sizeof(struct __journal_header)))
+#define JOURNAL_SPAN(size)			((uint32_t)(sizeof(struct __journal_record) + (((size) + 3) & ~3)))
 
 /* Private variables ---------------------------------------------------------*/
-#if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
-static uint8_t nvpool[NVRAM_SIZE];
+#if defined ( __linux )
+static uint32_t nvpool_fallback[NVRAM_SIZE / 4];
+static uint32_t *nvpool = (uint32_t *)0;
+#elif defined ( _WIN32 ) || defined ( _WIN64 )
+static uint32_t nvpool[NVRAM_SIZE / 4];
 #else
 
 #if defined ( __ICCARM__ )
-__no_init static uint8_t nvpool[NVRAM_SIZE];
+__no_init static uint32_t nvpool[NVRAM_SIZE / 4];
 #elif defined ( __CC_ARM )
-__attribute__((zero_init)) static uint8_t nvpool[NVRAM_SIZE];
+__attribute__((zero_init)) static uint32_t nvpool[NVRAM_SIZE / 4];
 #elif defined ( __GNUC__ )
-static uint8_t nvpool[NVRAM_SIZE] __attribute__ ((section ("noinit")));
+static uint32_t nvpool[NVRAM_SIZE / 4] __attribute__ ((section ("noinit")));
 #else
 #error compiler not support.
 #endif
 
 #endif
 
+#if defined ( __linux )
+#if defined ( BUILD_DAEMON )
+#define FIL_PATH    "/var/virtual_meter/nvram.bin"
+#define DIR_PATH    "/var/virtual_meter"
+#else
+#define FIL_PATH    "./memory/nvram.bin"
+#define DIR_PATH    "./memory"
+#endif
+#endif
+
 
 /**
   * @brief  ϵͳļ
@@ -50,12 +127,66 @@ static uint8_t nvpool[NVRAM_SIZE] __attribute__ ((section ("noinit")));
 static const struct __nvram_entry nvram_entry[] = 
 {
     /* ļ  ļС(Ҫ֤8) */
-	{"energy", 256},
+	{"journal", 1024}, //־
+	{"lfs", 128}, //ļϵͳȹؿ
 };
 
+/**
+  * @brief  Ǽǵĵݿ飬Ǽ˳棬ԽǼȼԽ
+  */
+static struct __nvram_blob blobs[NVRAM_BLOB_AMOUNT];
+static uint8_t blob_amount = 0;
+
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 
+/**
+  * @brief  nvram ڴ
+  * Linux ӳ䵽ļģȻ
+  */
+static uint8_t *nvram_pool(void)
+{
+#if defined ( __linux )
+    void *addr;
+    int fd;
+    
+    if(nvpool)
+    {
+        return((uint8_t *)nvpool);
+    }
+    
+    //ӳʧʱ˻صڴ棬ֻǲ̱ܿ
+    nvpool = nvpool_fallback;
+    
+    if(access(FIL_PATH, 0) != 0)
+    {
+        mkdir(DIR_PATH, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    }
+    
+    fd = open(FIL_PATH, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if(fd < 0)
+    {
+        return((uint8_t *)nvpool);
+    }
+    
+    if(ftruncate(fd, NVRAM_SIZE) != 0)
+    {
+        close(fd);
+        return((uint8_t *)nvpool);
+    }
+    
+    addr = mmap((void *)0, NVRAM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    
+    if(addr != MAP_FAILED)
+    {
+        nvpool = (uint32_t *)addr;
+    }
+#endif
+    
+    return((uint8_t *)nvpool);
+}
+
 /**
   * @brief  
   */
@@ -73,7 +204,7 @@ static void * nvram_address(const char *name)
                 return((void *)0);
             }
             
-            return(nvpool + address);
+            return(nvram_pool() + address);
         }
         
         address += nvram_entry[loop].size;
@@ -118,6 +249,423 @@ static uint32_t nvram_size(const char *name)
     return(0);
 }
 
+/**
+  * @brief  ־ͷУֵ
+  */
+static uint32_t journal_header_check(const struct __journal_header *header)
+{
+	return(crc32(header, (uint16_t)STRUCT_OFFSET(struct __journal_header, check), 0xffffffff));
+}
+
+/**
+  * @brief  ־ĿУֵ
+  */
+static uint32_t journal_record_check(const struct __journal_record *record)
+{
+	uint32_t check;
+	
+	check = crc32(record, (uint16_t)STRUCT_OFFSET(struct __journal_record, state), 0xffffffff);
+	
+	return(crc32((const uint8_t *)(record + 1), record->size, check));
+}
+
+/**
+  * @brief  ־־ͷ־ռ䲻ʱؿ
+  */
+static struct __journal_header *journal_slots(void)
+{
+	if(nvram_size("journal") <= JOURNAL_HEADS)
+	{
+		return((struct __journal_header *)0);
+	}
+	
+	return((struct __journal_header *)nvram_address("journal"));
+}
+	
+/**
+  * @brief  ־Ŀ־ͷ֮
+  */
+static uint8_t *journal_area(void)
+{
+	struct __journal_header *slots = journal_slots();
+	
+	if(!slots)
+	{
+		return((uint8_t *)0);
+	}
+	
+	return((uint8_t *)(slots + 2));
+}
+
+/**
+  * @brief  жһ־ͷǷЧ
+  */
+static bool journal_header_valid(const struct __journal_header *header)
+{
+	if((header->magic != JOURNAL_MAGIC) || (header->check != journal_header_check(header)))
+	{
+		return(false);
+	}
+	
+	if(header->used > (nvram_size("journal") - JOURNAL_HEADS))
+	{
+		return(false);
+	}
+	
+	return(true);
+}
+
+/**
+  * @brief  ǰЧ־ͷݶЧʱؿ
+  */
+static const struct __journal_header *journal_header(void)
+{
+	struct __journal_header *slots = journal_slots();
+	bool valid[2];
+	
+	if(!slots)
+	{
+		return((const struct __journal_header *)0);
+	}
+	
+	valid[0] = journal_header_valid(&slots[0]);
+	valid[1] = journal_header_valid(&slots[1]);
+	
+	if(valid[0] && valid[1])
+	{
+		//ŻʱֵȽ
+		if((int32_t)(slots[1].sequence - slots[0].sequence) > 0)
+		{
+			return(&slots[1]);
+		}
+		
+		return(&slots[0]);
+	}
+	else if(valid[0])
+	{
+		return(&slots[0]);
+	}
+	else if(valid[1])
+	{
+		return(&slots[1]);
+	}
+	
+	return((const struct __journal_header *)0);
+}
+
+/**
+  * @brief  ύµ־ͷ
+  * д뵱ǰЧ־ͷ֮һݣУд룬д֮ǰǰ־ͷЧ
+  */
+static const struct __journal_header *journal_commit(const struct __journal_header *active, uint16_t amount, uint16_t used)
+{
+	struct __journal_header *slots = journal_slots();
+	struct __journal_header *header;
+	
+	if(!slots)
+	{
+		return((const struct __journal_header *)0);
+	}
+	
+	header = (active == &slots[0])? &slots[1] : &slots[0];
+	
+	header->check = 0;
+	header->magic = JOURNAL_MAGIC;
+	header->amount = amount;
+	header->used = used;
+	header->sequence = active? (active->sequence + 1) : 1;
+	header->check = journal_header_check(header);
+	
+	return(header);
+}
+
+/**
+  * @brief  ¿ʼһ־
+  */
+static const struct __journal_header *journal_renew(void)
+{
+	return(journal_commit(journal_header(), 0, 0));
+}
+
+/**
+  * @brief  Ų־ĿԽЧʱؿ
+  */
+static struct __journal_record *journal_record(const struct __journal_header *header, uint16_t index)
+{
+	struct __journal_record *record;
+	uint8_t *area = journal_area();
+	uint32_t offset = 0;
+	uint16_t loop;
+	
+	if(!area)
+	{
+		return((struct __journal_record *)0);
+	}
+	
+	for(loop=0; loop<header->amount; loop++)
+	{
+		if((offset + sizeof(struct __journal_record)) > header->used)
+		{
+			return((struct __journal_record *)0);
+		}
+		
+		record = (struct __journal_record *)(area + offset);
+		
+		if((offset + JOURNAL_SPAN(record->size)) > header->used)
+		{
+			return((struct __journal_record *)0);
+		}
+		
+		if(loop == index)
+		{
+			if((record->name[sizeof(record->name) - 1] != 0) || (record->check != journal_record_check(record)))
+			{
+				return((struct __journal_record *)0);
+			}
+			
+			return(record);
+		}
+		
+		offset += JOURNAL_SPAN(record->size);
+	}
+	
+	return((struct __journal_record *)0);
+}
+
+/**
+  * @brief  Ǽһݿ飬ͬһַظǼʱ¶Ӧļλ
+  */
+static uint8_t nvram_journal_enroll(const char *name, uint32_t offset, const void *blob, uint16_t size)
+{
+	uint8_t loop;
+	
+	if(!name || !blob || !size || (strlen(name) >= STRUCT_SIZE(struct __journal_record, name)))
+	{
+		return(0xff);
+	}
+	
+	if(JOURNAL_SPAN(size) > (nvram_size("journal") - JOURNAL_HEADS))
+	{
+		return(0xff);
+	}
+	
+	for(loop=0; loop<blob_amount; loop++)
+	{
+		if(blobs[loop].blob == blob)
+		{
+			break;
+		}
+	}
+	
+	if(loop >= NVRAM_BLOB_AMOUNT)
+	{
+		return(0xff);
+	}
+	
+	if(loop >= blob_amount)
+	{
+		blob_amount = loop + 1;
+		blobs[loop].dirty = false;
+	}
+	
+	blobs[loop].name = name;
+	blobs[loop].offset = offset;
+	blobs[loop].blob = blob;
+	blobs[loop].size = size;
+	
+	return(loop);
+}
+
+/**
+  * @brief
+  */
+static void nvram_journal_dirty(uint8_t handle)
+{
+	if(handle < blob_amount)
+	{
+		blobs[handle].dirty = true;
+	}
+}
+
+/**
+  * @brief
+  */
+static void nvram_journal_clean(uint8_t handle)
+{
+	if(handle < blob_amount)
+	{
+		blobs[handle].dirty = false;
+	}
+}
+
+/**
+  * @brief
+  */
+static void nvram_ctrl_release(void)
+{
+	heap.set(blobs, 0, sizeof(blobs));
+	blob_amount = 0;
+}
+
+/**
+  * @brief  ʱ޸ĵݿ׷ӵ־
+  * Ǽ˳Ԥƺʱ budgetus־ռ䲻ʱֹͣʣݿ˳д
+  */
+static uint16_t nvram_ctrl_fastsave(uint32_t budget)
+{
+	const struct __journal_header *header;
+	struct __journal_record *record;
+	struct __journal_record *older;
+	uint32_t capacity;
+	uint32_t expense;
+	uint32_t cost = 0;
+	uint16_t saved = 0;
+	uint16_t index;
+	uint8_t loop;
+	
+	header = journal_header();
+	
+	if(!header)
+	{
+		header = journal_renew();
+		
+		if(!header)
+		{
+			return(0);
+		}
+	}
+	
+	capacity = nvram_size("journal") - JOURNAL_HEADS;
+	
+	for(loop=0; loop<blob_amount; loop++)
+	{
+		if(!blobs[loop].dirty)
+		{
+			continue;
+		}
+		
+		expense = NVRAM_COPY_SETUP + (JOURNAL_SPAN(blobs[loop].size) + NVRAM_COPY_RATE - 1) / NVRAM_COPY_RATE;
+		
+		if((cost + expense) > budget)
+		{
+			break;
+		}
+		
+		if((header->used + JOURNAL_SPAN(blobs[loop].size)) > capacity)
+		{
+			break;
+		}
+		
+		//дĿύ־ͷ
+		record = (struct __journal_record *)(journal_area() + header->used);
+		heap.set(record->name, 0, sizeof(record->name));
+		strcpy(record->name, blobs[loop].name);
+		record->offset = blobs[loop].offset;
+		record->size = blobs[loop].size;
+		heap.copy((void *)(record + 1), blobs[loop].blob, blobs[loop].size);
+		record->check = journal_record_check(record);
+		record->state = JOURNAL_LIVE;
+		
+		header = journal_commit(header, (header->amount + 1), (header->used + JOURNAL_SPAN(blobs[loop].size)));
+		
+		//ͬһλøĿѱ
+		for(index=0; index<(header->amount - 1); index++)
+		{
+			older = journal_record(header, index);
+			
+			if(older && (older->state == JOURNAL_LIVE) && \
+				(older->offset == record->offset) && \
+				(older->size == record->size) && \
+				(strcmp(older->name, record->name) == 0))
+			{
+				older->state = 0;
+			}
+		}
+		
+		cost += expense;
+		saved += 1;
+	}
+	
+	return(saved);
+}
+
+/**
+  * @brief
+  */
+static uint16_t nvram_ctrl_amount(void)
+{
+	const struct __journal_header *header = journal_header();
+	
+	if(!header)
+	{
+		return(0);
+	}
+	
+	return(header->amount);
+}
+
+/**
+  * @brief
+  */
+static bool nvram_ctrl_pending(uint16_t index, struct __journal_entry *entry)
+{
+	const struct __journal_header *header = journal_header();
+	struct __journal_record *record;
+	
+	if(!header || !entry)
+	{
+		return(false);
+	}
+	
+	record = journal_record(header, index);
+	
+	if(!record || (record->state != JOURNAL_LIVE))
+	{
+		return(false);
+	}
+	
+	entry->name = record->name;
+	entry->offset = record->offset;
+	entry->size = record->size;
+	entry->data = (const void *)(record + 1);
+	
+	return(true);
+}
+
+/**
+  * @brief  ĿȫǨƺ־ͷſռ
+  */
+static void nvram_ctrl_retire(uint16_t index)
+{
+	const struct __journal_header *header = journal_header();
+	struct __journal_record *record;
+	uint16_t loop;
+	
+	if(!header)
+	{
+		return;
+	}
+	
+	record = journal_record(header, index);
+	
+	if(record)
+	{
+		record->state = 0;
+	}
+	
+	for(loop=0; loop<header->amount; loop++)
+	{
+		record = journal_record(header, loop);
+		
+		if(record && (record->state == JOURNAL_LIVE))
+		{
+			return;
+		}
+	}
+	
+	journal_renew();
+}
+
 
 /**
   * @brief  
@@ -126,4 +674,23 @@ struct __nvram nvram =
 {
 	.address            = nvram_address,
 	.size				= nvram_size,
+	
+	.journal			=
+	{
+		.enroll			= nvram_journal_enroll,
+		.dirty			= nvram_journal_dirty,
+		.clean			= nvram_journal_clean,
+	},
+};
+
+/**
+  * @brief
+  */
+const struct __nvram_ctrl nvram_ctrl =
+{
+	.release			= nvram_ctrl_release,
+	.fastsave			= nvram_ctrl_fastsave,
+	.amount				= nvram_ctrl_amount,
+	.pending			= nvram_ctrl_pending,
+	.retire				= nvram_ctrl_retire,
 };
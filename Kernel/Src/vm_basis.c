@@ -136,6 +136,29 @@ static int file_ring_append(lua_State *L)
 	return 1;
 }
 
+static int file_ring_append_many(lua_State *L)
+{
+	size_t len;
+	const char *name;
+	uint32_t amount;
+	uint32_t size;
+	void *buff;
+	uint32_t result = 0;
+	
+	name = (const char *)luaL_checklstring(L, 1, &len);
+	amount = (uint32_t)luaL_checknumber(L, 2);
+	size = (uint32_t)luaL_checknumber(L, 3);
+	buff = (void *)luaL_checklstring(L, 4, &len);
+	
+	if(size && ((len / size) >= amount))
+	{
+		result = file.ring.append_many(name, amount, size, buff);
+	}
+    
+	lua_pushnumber(L, result);
+	return 1;
+}
+
 static int file_ring_truncate(lua_State *L)
 {
 	size_t len;
@@ -367,6 +390,7 @@ static const luaL_Tree basis_tree[] =
 	{"file",			"ring",			NULL},
 	{"ring",			"read",			file_ring_read},
 	{"ring",			"append",		file_ring_append},
+	{"ring",			"append_many",	file_ring_append_many},
 	{"ring",			"truncate",		file_ring_truncate},
 	{"ring",			"info",			file_ring_info},
 	{"ring",			"reset",		file_ring_reset},
@@ -1,5 +1,17 @@
 #include "ecc.h"
 
+/*
+ * 64 bit hosts compute the parities by quadwords, the MCU keeps
+ * the longword loop. Define NAND_ECC_WORD64 to 0 to force the latter.
+ */
+#if !defined(NAND_ECC_WORD64)
+#if defined(__GNUC__) && defined(__SIZEOF_POINTER__) && (__SIZEOF_POINTER__ == 8)
+#define NAND_ECC_WORD64	1
+#else
+#define NAND_ECC_WORD64	0
+#endif
+#endif
+
 /*
  * invparity is a 256 byte table that contains the odd parity
  * for each byte. So if the number of bits in a byte is even,
@@ -90,6 +102,166 @@ static const uint8_t addressbits[256] = {
 	0x0e, 0x0e, 0x0f, 0x0f, 0x0e, 0x0e, 0x0f, 0x0f
 };
 
+#if NAND_ECC_WORD64
+/*
+ * Word access that tolerates unaligned buffers (the disk layer hands in
+ * heap blocks which are only 32 bit aligned).
+ */
+typedef uint64_t __attribute__((__may_alias__, __aligned__(1))) ecc_word_t;
+
+/*
+ * Inverted parity of a 64 bit word. gcc lowers the builtin to popcnt
+ * (or the parity flag) when the target has it.
+ */
+#define invparity64(x)	((uint32_t)__builtin_parityll(x) ^ 1)
+
+#ifdef __BIG_ENDIAN
+#define ECC_MASK_RP0	0xff00ff00ff00ff00ULL
+#define ECC_MASK_RP2	0xffff0000ffff0000ULL
+#define ECC_MASK_RP4	0xffffffff00000000ULL
+#else
+#define ECC_MASK_RP0	0x00ff00ff00ff00ffULL
+#define ECC_MASK_RP2	0x0000ffff0000ffffULL
+#define ECC_MASK_RP4	0x00000000ffffffffULL
+#endif
+
+/**
+ * __nand_calculate_ecc - [NAND Interface] Calculate 3-byte ECC for 256/512-byte
+ *			 block
+ * @buf:	input buffer with raw data
+ * @eccsize:	data bytes per ECC step (256 or 512)
+ * @code:	output buffer with ECC
+ *
+ * Quadword variant for 64 bit hosts, the code is bit for bit the same
+ * as the longword variant below.
+ */
+void __nand_calculate_ecc(const uint8_t *buf, uint32_t eccsize, uint8_t *code)
+{
+	uint32_t i;
+	const ecc_word_t *bp = (const ecc_word_t *)buf;
+	/* 256 or 512 bytes/ecc  */
+	const uint32_t eccsize_mult = eccsize >> 8;
+	/* xor of word pairs 0/1, 2/3, 4/5 and 6/7 of this iteration */
+	uint64_t w01, w23, w45, w67;
+	/*
+	 * rp6..rp16 accumulate the words whose byte address has
+	 * bit 3..8 cleared, rp0..rp4 are found inside par
+	 */
+	uint64_t rp6, rp8, rp10, rp12, rp14, rp16;
+	uint64_t par;		/* the cumulative parity for all data */
+	uint64_t tmppar;	/* the cumulative parity for this iteration */
+	/* parity bits of all rows, odd rows follow from the even ones */
+	uint32_t pa, p0, p2, p4, p6, p8, p10, p12, p14, p16;
+
+	par = 0;
+	rp6 = 0;
+	rp8 = 0;
+	rp10 = 0;
+	rp12 = 0;
+	rp14 = 0;
+	rp16 = 0;
+
+	/*
+	 * Eight quadwords per iteration, so the word index inside the
+	 * iteration gives rp6, rp8 and rp10 and the iteration count
+	 * gives rp12, rp14 and rp16.
+	 */
+	for (i = 0; i < eccsize_mult << 2; i++) {
+		w01 = bp[0] ^ bp[1];
+		w23 = bp[2] ^ bp[3];
+		w45 = bp[4] ^ bp[5];
+		w67 = bp[6] ^ bp[7];
+
+		rp6 ^= bp[0] ^ bp[2] ^ bp[4] ^ bp[6];
+		rp8 ^= w01 ^ w45;
+		rp10 ^= w01 ^ w23;
+		tmppar = w01 ^ w23 ^ w45 ^ w67;
+		bp += 8;
+
+		par ^= tmppar;
+		if ((i & 0x1) == 0)
+			rp12 ^= tmppar;
+		if ((i & 0x2) == 0)
+			rp14 ^= tmppar;
+		if (eccsize_mult == 2 && (i & 0x4) == 0)
+			rp16 ^= tmppar;
+	}
+
+	/*
+	 * Only the parity of each accumulator matters, so there is no need
+	 * to fold them back to bytes first. rp0, rp2 and rp4 are the bytes
+	 * of par with byte address bit 0, 1 and 2 cleared.
+	 */
+	pa = invparity64(par);
+	p0 = invparity64(par & ECC_MASK_RP0);
+	p2 = invparity64(par & ECC_MASK_RP2);
+	p4 = invparity64(par & ECC_MASK_RP4);
+	p6 = invparity64(rp6);
+	p8 = invparity64(rp8);
+	p10 = invparity64(rp10);
+	p12 = invparity64(rp12);
+	p14 = invparity64(rp14);
+	p16 = invparity64(rp16);
+
+	/*
+	 * rp(n+1) = par ^ rp(n), which for the inverted parity bits
+	 * is p(n) ^ pa ^ 1
+	 */
+	pa ^= 1;
+
+	/* reduce par to 8 bits for the column parities */
+	par ^= (par >> 32);
+	par ^= (par >> 16);
+	par ^= (par >> 8);
+	par &= 0xff;
+
+#ifdef CONFIG_MTD_NAND_ECC_SMC
+	code[0] =
+#else
+	code[1] =
+#endif
+	    ((p6 ^ pa) << 7) |
+	    (p6 << 6) |
+	    ((p4 ^ pa) << 5) |
+	    (p4 << 4) |
+	    ((p2 ^ pa) << 3) |
+	    (p2 << 2) |
+	    ((p0 ^ pa) << 1) |
+	    (p0);
+#ifdef CONFIG_MTD_NAND_ECC_SMC
+	code[1] =
+#else
+	code[0] =
+#endif
+	    ((p14 ^ pa) << 7) |
+	    (p14 << 6) |
+	    ((p12 ^ pa) << 5) |
+	    (p12 << 4) |
+	    ((p10 ^ pa) << 3) |
+	    (p10 << 2) |
+	    ((p8 ^ pa) << 1)  |
+	    (p8);
+	if (eccsize_mult == 1)
+		code[2] =
+		    (invparity[par & 0xf0] << 7) |
+		    (invparity[par & 0x0f] << 6) |
+		    (invparity[par & 0xcc] << 5) |
+		    (invparity[par & 0x33] << 4) |
+		    (invparity[par & 0xaa] << 3) |
+		    (invparity[par & 0x55] << 2) |
+		    3;
+	else
+		code[2] =
+		    (invparity[par & 0xf0] << 7) |
+		    (invparity[par & 0x0f] << 6) |
+		    (invparity[par & 0xcc] << 5) |
+		    (invparity[par & 0x33] << 4) |
+		    (invparity[par & 0xaa] << 3) |
+		    (invparity[par & 0x55] << 2) |
+		    ((p16 ^ pa) << 1) |
+		    (p16 << 0);
+}
+#else
 /**
  * __nand_calculate_ecc - [NAND Interface] Calculate 3-byte ECC for 256/512-byte
  *			 block
@@ -352,6 +524,7 @@ void __nand_calculate_ecc(const uint8_t *buf, uint32_t eccsize, uint8_t *code)
 		    (invparity[rp17] << 1) |
 		    (invparity[rp16] << 0);
 }
+#endif /* NAND_ECC_WORD64 */
 
 /**
  * __nand_correct_data - [NAND Interface] Detect and correct bit error(s)
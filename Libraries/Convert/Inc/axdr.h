@@ -4,6 +4,8 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
 
 /* Exported types ------------------------------------------------------------*/
 /**
@@ -58,6 +60,28 @@ union __axdr_container
     double      vf64;
 };
 
+/**
+  * @brief   AXDR ¼еһԱ
+  * length ַЧOCTET/VISIBLE/UTF8 STRING ΪֽBIT STRING Ϊλ
+  * DATE_TIMEDATETIME ѱ 12/5/4 ֽ OCTET STRING 
+  */
+struct __axdr_member
+{
+    enum __axdr_type        type;
+    uint16_t                offset; //Աڼ¼еƫ
+    uint16_t                length;
+};
+
+/**
+  * @brief   AXDR ¼һ¼Ϊһ STRUCTURE
+  */
+struct __axdr_schema
+{
+    const struct __axdr_member  *member;
+    uint8_t                 amount; //Ա
+    uint16_t                size; //¼ڴеĴС鲽
+};
+
 /**
   * @brief   AXDR ӿ
   */
@@ -81,6 +105,14 @@ struct __axdr_conv
         
     }                       length;
     
+    struct
+    {
+        uint16_t            (*encode)(const struct __axdr_schema *schema, const void *records, uint16_t amount, uint8_t *dst, uint16_t size);
+        uint16_t            (*compact)(const struct __axdr_schema *schema, const void *records, uint16_t amount, uint8_t *dst, uint16_t size);
+        uint32_t            (*calc)(const struct __axdr_schema *schema, uint16_t amount, bool compact);
+        
+    }                       schema;
+    
 };
 
 /* Exported constants --------------------------------------------------------*/
@@ -89,6 +121,11 @@ struct __axdr_conv
                                     (type >= 15 && type <= 18)  || \
                                     (type >= 20 && type <= 24))
 
+//¼ rec ĳԱ field
+#define AXDR_MEMBER(rec, field, type, length)   {(type), (uint16_t)offsetof(rec, field), (length)}
+//ɳԱɼ¼
+#define AXDR_SCHEMA(rec, members)               {(members), (uint8_t)(sizeof(members) / sizeof(struct __axdr_member)), (uint16_t)sizeof(rec)}
+
 /* Exported function prototypes ----------------------------------------------*/
 extern const struct __axdr_conv axdr;
 
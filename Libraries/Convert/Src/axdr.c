@@ -509,13 +509,333 @@ static uint16_t axdr_decode(const uint8_t *src, enum __axdr_type *type, void *ds
     return(length_decode);
 }
 
+/**
+  * @brief  ռõֽ
+  */
+static uint8_t axdr_length_size(uint32_t length)
+{
+    if(length < 128)
+    {
+        return(1);
+    }
+    else if(length < 256)
+    {
+        return(2);
+    }
+    
+    return(3);
+}
 
+/**
+  * @brief  ¼Աͱǩı볤
+  *  0xffff ʾͲΪ¼Ա
+  */
+static uint16_t axdr_member_width(const struct __axdr_member *member)
+{
+    switch(member->type)
+    {
+        case AXDR_NULL:
+        {
+            return(0);
+        }
+        case AXDR_BOOLEAN:
+        case AXDR_INTEGER:
+        case AXDR_UNSIGNED:
+        case AXDR_ENUM:
+        {
+            return(1);
+        }
+        case AXDR_LONG:
+        case AXDR_LONG_UNSIGNED:
+        {
+            return(2);
+        }
+        case AXDR_DOUBLE_LONG:
+        case AXDR_DOUBLE_LONG_UNSIGNED:
+        case AXDR_FLOAT32:
+        {
+            return(4);
+        }
+        case AXDR_LONG64:
+        case AXDR_LONG64_UNSIGNED:
+        case AXDR_FLOAT64:
+        {
+            return(8);
+        }
+        case AXDR_BIT_STRING:
+        {
+            return(axdr_length_size(member->length) + ((member->length + 7) / 8));
+        }
+        case AXDR_OCTET_STRING:
+        case AXDR_VISIBLE_STRING:
+        case AXDR_UTF8_STRING:
+        case AXDR_BCD:
+        {
+            return(axdr_length_size(member->length) + member->length);
+        }
+        case AXDR_DATE_TIME:
+        {
+            return(1 + 12);
+        }
+        case AXDR_DATE:
+        {
+            return(1 + 5);
+        }
+        case AXDR_TIME:
+        {
+            return(1 + 4);
+        }
+        default:
+        {
+            return(0xffff);
+        }
+    }
+}
 
+/**
+  * @brief  д¼Ա򣨲ͱǩдĵַ
+  */
+static uint8_t *axdr_member_put(const struct __axdr_member *member, const uint8_t *record, uint8_t *dst)
+{
+    const uint8_t *src = record + member->offset;
+    
+    switch(member->type)
+    {
+        case AXDR_BOOLEAN:
+        case AXDR_INTEGER:
+        case AXDR_UNSIGNED:
+        case AXDR_ENUM:
+        {
+            *(dst++) = *src;
+            break;
+        }
+        case AXDR_LONG:
+        case AXDR_LONG_UNSIGNED:
+        {
+            uint16_t val = *((const uint16_t *)src);
+            *(dst++) = ((val >> 8) & 0xff);
+            *(dst++) = ((val >> 0) & 0xff);
+            break;
+        }
+        case AXDR_DOUBLE_LONG:
+        case AXDR_DOUBLE_LONG_UNSIGNED:
+        case AXDR_FLOAT32:
+        {
+            uint32_t val = *((const uint32_t *)src);
+            *(dst++) = ((val >> 24) & 0xff);
+            *(dst++) = ((val >> 16) & 0xff);
+            *(dst++) = ((val >> 8) & 0xff);
+            *(dst++) = ((val >> 0) & 0xff);
+            break;
+        }
+        case AXDR_LONG64:
+        case AXDR_LONG64_UNSIGNED:
+        case AXDR_FLOAT64:
+        {
+            uint64_t val = *((const uint64_t *)src);
+            *(dst++) = ((val >> 56) & 0xff);
+            *(dst++) = ((val >> 48) & 0xff);
+            *(dst++) = ((val >> 40) & 0xff);
+            *(dst++) = ((val >> 32) & 0xff);
+            *(dst++) = ((val >> 24) & 0xff);
+            *(dst++) = ((val >> 16) & 0xff);
+            *(dst++) = ((val >> 8) & 0xff);
+            *(dst++) = ((val >> 0) & 0xff);
+            break;
+        }
+        case AXDR_BIT_STRING:
+        {
+            dst += axdr_encode_length(member->length, dst);
+            memcpy(dst, src, ((member->length + 7) / 8));
+            dst += ((member->length + 7) / 8);
+            break;
+        }
+        case AXDR_OCTET_STRING:
+        case AXDR_VISIBLE_STRING:
+        case AXDR_UTF8_STRING:
+        case AXDR_BCD:
+        {
+            dst += axdr_encode_length(member->length, dst);
+            memcpy(dst, src, member->length);
+            dst += member->length;
+            break;
+        }
+        case AXDR_DATE_TIME:
+        {
+            *(dst++) = 12;
+            memcpy(dst, src, 12);
+            dst += 12;
+            break;
+        }
+        case AXDR_DATE:
+        {
+            *(dst++) = 5;
+            memcpy(dst, src, 5);
+            dst += 5;
+            break;
+        }
+        case AXDR_TIME:
+        {
+            *(dst++) = 4;
+            memcpy(dst, src, 4);
+            dst += 4;
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+    
+    return(dst);
+}
 
+/**
+  * @brief  һ¼гԱĳ֮ͣ¼Чʱ 0
+  */
+static uint32_t axdr_schema_width(const struct __axdr_schema *schema)
+{
+    uint32_t width = 0;
+    uint16_t member;
+    uint8_t cnt;
+    
+    if(!schema || !schema->member || !schema->amount)
+    {
+        return(0);
+    }
+    
+    for(cnt=0; cnt<schema->amount; cnt++)
+    {
+        member = axdr_member_width(&schema->member[cnt]);
+        if(member == 0xffff)
+        {
+            return(0);
+        }
+        
+        width += member;
+    }
+    
+    return(width);
+}
 
+/**
+  * @brief   amount ¼ı볤
+  * compact Ϊ false ʱΪ ARRAY of STRUCTUREΪ true ʱΪ COMPACT ARRAY
+  * ¼Чʱ 0
+  */
+static uint32_t axdr_schema_calc(const struct __axdr_schema *schema, uint16_t amount, bool compact)
+{
+    uint32_t width = axdr_schema_width(schema);
+    
+    if(!width)
+    {
+        return(0);
+    }
+    
+    if(compact)
+    {
+        //ǩ + STRUCTURE ǩԱԱͣ+ ݳ + 
+        return(1 + (1 + axdr_length_size(schema->amount) + schema->amount) + \
+               axdr_length_size(width * amount) + (width * amount));
+    }
+    
+    //ǩ + Ԫظ + ÿ¼STRUCTURE ǩԱÿԱͱǩݣ
+    return(1 + axdr_length_size(amount) + \
+           ((1 + axdr_length_size(schema->amount) + schema->amount + width) * amount));
+}
 
+/**
+  * @brief   amount ¼Ϊ ARRAY of STRUCTURE
+  * 岻¼Чʱ 0
+  */
+static uint16_t axdr_schema_encode(const struct __axdr_schema *schema, const void *records, uint16_t amount, uint8_t *dst, uint16_t size)
+{
+    const uint8_t *record = (const uint8_t *)records;
+    const struct __axdr_member *member;
+    uint32_t length;
+    uint8_t *out = dst;
+    uint8_t cnt;
+    
+    if(!dst || (!records && amount))
+    {
+        return(0);
+    }
+    
+    length = axdr_schema_calc(schema, amount, false);
+    if(!length || (length > size))
+    {
+        return(0);
+    }
+    
+    *(out++) = AXDR_ARRAY;
+    out += axdr_encode_length(amount, out);
+    
+    while(amount--)
+    {
+        *(out++) = AXDR_STRUCTURE;
+        out += axdr_encode_length(schema->amount, out);
+        
+        for(cnt=0, member=schema->member; cnt<schema->amount; cnt++, member++)
+        {
+            out += axdr_type_encode(member->type, out);
+            out = axdr_member_put(member, record, out);
+        }
+        
+        record += schema->size;
+    }
+    
+    return((uint16_t)(out - dst));
+}
 
-
+/**
+  * @brief   amount ¼Ϊ COMPACT ARRAY
+  * ֻгһΣ¼ݽУЯͱǩͽṹͷ
+  * 岻¼Чʱ 0
+  */
+static uint16_t axdr_schema_compact(const struct __axdr_schema *schema, const void *records, uint16_t amount, uint8_t *dst, uint16_t size)
+{
+    const uint8_t *record = (const uint8_t *)records;
+    const struct __axdr_member *member;
+    uint32_t length;
+    uint8_t *out = dst;
+    uint8_t cnt;
+    
+    if(!dst || (!records && amount))
+    {
+        return(0);
+    }
+    
+    length = axdr_schema_calc(schema, amount, true);
+    if(!length || (length > size))
+    {
+        return(0);
+    }
+    
+    *(out++) = AXDR_COMPACT_ARRAY;
+    
+    //contents-description
+    *(out++) = AXDR_STRUCTURE;
+    out += axdr_encode_length(schema->amount, out);
+    for(cnt=0; cnt<schema->amount; cnt++)
+    {
+        out += axdr_type_encode(schema->member[cnt].type, out);
+    }
+    
+    //array-contents
+    out += axdr_encode_length((uint16_t)(axdr_schema_width(schema) * amount), out);
+    
+    while(amount--)
+    {
+        for(cnt=0, member=schema->member; cnt<schema->amount; cnt++, member++)
+        {
+            out = axdr_member_put(member, record, out);
+        }
+        
+        record += schema->size;
+    }
+    
+    return((uint16_t)(out - dst));
+}
 
 
 
@@ -537,6 +857,13 @@ const struct __axdr_conv axdr =
         .calc           = axdr_calc_length,
         
     },
+    
+    .schema             = 
+    {
+        .encode         = axdr_schema_encode,
+        .compact        = axdr_schema_compact,
+        .calc           = axdr_schema_calc,
+    },
 };
 
 
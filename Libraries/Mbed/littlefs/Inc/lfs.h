@@ -412,6 +412,32 @@ typedef struct lfs {
 #endif
 } lfs_t;
 
+// Size of the lookahead buffer kept in a snapshot, larger lookahead
+// buffers are not kept and get rescanned after lfs_mount_snapshot
+#ifndef LFS_SNAPSHOT_LOOKAHEAD
+#define LFS_SNAPSHOT_LOOKAHEAD 16
+#endif
+
+// State of a mounted littlefs that survives an unmount, see lfs_snapshot
+typedef struct lfs_snapshot {
+    lfs_block_t root[2];
+    uint32_t rev;
+    lfs_off_t off;
+    uint32_t etag;
+    uint32_t seed;
+    lfs_gstate_t gstate;
+    lfs_size_t name_max;
+    lfs_size_t file_max;
+    lfs_size_t attr_max;
+
+    struct lfs_snapshot_free {
+        lfs_block_t off;
+        lfs_block_t size;
+        lfs_block_t i;
+        uint32_t buffer[LFS_SNAPSHOT_LOOKAHEAD/4];
+    } free;
+} lfs_snapshot_t;
+
 
 /// Filesystem functions ///
 
@@ -442,6 +468,30 @@ int lfs_mount(lfs_t *lfs, const struct lfs_config *config);
 // Returns a negative error code on failure.
 int lfs_unmount(lfs_t *lfs);
 
+// Records the state of a mounted littlefs
+//
+// Captures what lfs_mount would otherwise rebuild by walking the whole
+// metadata chain: the last commit of the root pair, the global state, the
+// superblock limits and the lookahead window. No files or directories may
+// be open. Take the snapshot right before lfs_unmount.
+//
+// Returns a negative error code on failure.
+int lfs_snapshot(lfs_t *lfs, lfs_snapshot_t *snapshot);
+
+// Mounts a littlefs from a snapshot
+//
+// Same as lfs_mount, but only the root pair is fetched and compared against
+// the snapshot instead of walking the metadata chain. The snapshot is only
+// valid as long as nothing has been written to the block device since it
+// was taken. The root pair check does not see writes to other metadata
+// pairs, so the caller has to keep track of writes on its own.
+//
+// Returns LFS_ERR_CORRUPT if the root pair no longer matches the snapshot,
+// or another negative error code on failure. lfs is not mounted on error,
+// fall back to lfs_mount.
+int lfs_mount_snapshot(lfs_t *lfs, const struct lfs_config *config,
+        const lfs_snapshot_t *snapshot);
+
 /// General operations ///
 
 #ifndef LFS_READONLY
@@ -664,6 +714,32 @@ lfs_ssize_t lfs_fs_size(lfs_t *lfs);
 // Returns a negative error code on failure.
 int lfs_fs_traverse(lfs_t *lfs, int (*cb)(void*, lfs_block_t), void *data);
 
+#ifndef LFS_READONLY
+// Do one step of janitorial work that would otherwise happen inside a write
+//
+// Walks the metadata pairs starting at cursor (a null pair starts at the
+// root) and compacts the first pair whose log is more than 7/8 full. Once
+// the walk reaches the end without compacting, the lookahead buffer is
+// repopulated if it has been exhausted. cursor is updated so the caller can
+// spread the work over several calls.
+//
+// Returns 1 if a metadata pair was compacted, 0 once the walk is complete,
+// or a negative error code on failure.
+int lfs_fs_gc(lfs_t *lfs, lfs_block_t cursor[2]);
+#endif
+
+#ifndef LFS_READONLY
+// Raise the file size limit recorded in the superblock to the configured one
+//
+// lfs_mount adopts a smaller file_max from the superblock, so a filesystem
+// formatted with an older configuration keeps the old limit. This rewrites
+// the superblock entry when the configured file_max is larger and updates
+// the mounted filesystem to match. Does nothing if the limit already fits.
+//
+// Returns a negative error code on failure.
+int lfs_fs_upgrade(lfs_t *lfs);
+#endif
+
 #ifndef LFS_READONLY
 #ifdef LFS_MIGRATE
 // Attempts to migrate a previous version of littlefs
@@ -529,6 +529,24 @@ static void lfs_alloc_drop(lfs_t *lfs) {
 }
 
 #ifndef LFS_READONLY
+// advance the lookahead window and find the mask of free blocks in it
+static int lfs_alloc_scan(lfs_t *lfs) {
+    lfs->free.off = (lfs->free.off + lfs->free.size)
+            % lfs->cfg->block_count;
+    lfs->free.size = lfs_min(8*lfs->cfg->lookahead_size, lfs->free.ack);
+    lfs->free.i = 0;
+
+    // find mask of free blocks from tree
+    memset(lfs->free.buffer, 0, lfs->cfg->lookahead_size);
+    int err = lfs_fs_rawtraverse(lfs, lfs_alloc_lookahead, lfs, true);
+    if (err) {
+        lfs_alloc_drop(lfs);
+        return err;
+    }
+
+    return 0;
+}
+
 static int lfs_alloc(lfs_t *lfs, lfs_block_t *block) {
     while (true) {
         while (lfs->free.i != lfs->free.size) {
@@ -560,16 +578,8 @@ static int lfs_alloc(lfs_t *lfs, lfs_block_t *block) {
             return LFS_ERR_NOSPC;
         }
 
-        lfs->free.off = (lfs->free.off + lfs->free.size)
-                % lfs->cfg->block_count;
-        lfs->free.size = lfs_min(8*lfs->cfg->lookahead_size, lfs->free.ack);
-        lfs->free.i = 0;
-
-        // find mask of free blocks from tree
-        memset(lfs->free.buffer, 0, lfs->cfg->lookahead_size);
-        int err = lfs_fs_rawtraverse(lfs, lfs_alloc_lookahead, lfs, true);
+        int err = lfs_alloc_scan(lfs);
         if (err) {
-            lfs_alloc_drop(lfs);
             return err;
         }
     }
@@ -3769,6 +3779,102 @@ static int lfs_rawunmount(lfs_t *lfs) {
     return lfs_deinit(lfs);
 }
 
+static int lfs_rawsnapshot(lfs_t *lfs, lfs_snapshot_t *snapshot) {
+    // open files and dirs are not part of the snapshot
+    if (lfs->mlist) {
+        return LFS_ERR_INVAL;
+    }
+
+    // the last commit to the root pair identifies the disk
+    lfs_mdir_t root;
+    int err = lfs_dir_fetch(lfs, &root, lfs->root);
+    if (err) {
+        return err;
+    }
+
+    memset(snapshot, 0, sizeof(lfs_snapshot_t));
+    snapshot->root[0] = lfs->root[0];
+    snapshot->root[1] = lfs->root[1];
+    snapshot->rev = root.rev;
+    snapshot->off = root.off;
+    snapshot->etag = root.etag;
+    snapshot->seed = lfs->seed;
+    snapshot->gstate = lfs->gdisk;
+    snapshot->name_max = lfs->name_max;
+    snapshot->file_max = lfs->file_max;
+    snapshot->attr_max = lfs->attr_max;
+
+    // keep the lookahead window if it fits, otherwise the first allocation
+    // after remount scans like after a normal mount
+    snapshot->free.off = lfs->free.off;
+    if (lfs->cfg->lookahead_size <= sizeof(snapshot->free.buffer)) {
+        snapshot->free.size = lfs->free.size;
+        snapshot->free.i = lfs->free.i;
+        memcpy(snapshot->free.buffer, lfs->free.buffer,
+                lfs->cfg->lookahead_size);
+    }
+
+    return 0;
+}
+
+static int lfs_rawmount_snapshot(lfs_t *lfs, const struct lfs_config *cfg,
+        const lfs_snapshot_t *snapshot) {
+    int err = lfs_init(lfs, cfg);
+    if (err) {
+        return err;
+    }
+
+    // limits from the superblock may only be tighter than ours
+    if (snapshot->name_max > lfs->name_max ||
+            snapshot->file_max > lfs->file_max ||
+            snapshot->attr_max > lfs->attr_max ||
+            snapshot->free.size > 8*lfs->cfg->lookahead_size ||
+            snapshot->free.i > snapshot->free.size ||
+            snapshot->free.off >= lfs->cfg->block_count ||
+            snapshot->root[0] >= lfs->cfg->block_count ||
+            snapshot->root[1] >= lfs->cfg->block_count) {
+        err = LFS_ERR_INVAL;
+        goto cleanup;
+    }
+
+    // only the root pair is fetched, it must still end with the same commit
+    lfs_mdir_t root;
+    err = lfs_dir_fetch(lfs, &root, snapshot->root);
+    if (err) {
+        goto cleanup;
+    }
+
+    if (root.rev != snapshot->rev || root.off != snapshot->off ||
+            root.etag != snapshot->etag) {
+        err = LFS_ERR_CORRUPT;
+        goto cleanup;
+    }
+
+    lfs->root[0] = snapshot->root[0];
+    lfs->root[1] = snapshot->root[1];
+    lfs->seed = snapshot->seed;
+    lfs->gstate = snapshot->gstate;
+    lfs->gdisk = snapshot->gstate;
+    lfs->name_max = snapshot->name_max;
+    lfs->file_max = snapshot->file_max;
+    lfs->attr_max = snapshot->attr_max;
+
+    lfs->free.off = snapshot->free.off;
+    lfs_alloc_drop(lfs);
+    if (snapshot->free.size) {
+        lfs->free.size = snapshot->free.size;
+        lfs->free.i = snapshot->free.i;
+        memcpy(lfs->free.buffer, snapshot->free.buffer,
+                lfs->cfg->lookahead_size);
+    }
+
+    return 0;
+
+cleanup:
+    lfs_rawunmount(lfs);
+    return err;
+}
+
 
 /// Filesystem filesystem operations ///
 int lfs_fs_rawtraverse(lfs_t *lfs,
@@ -4211,6 +4317,101 @@ static lfs_ssize_t lfs_fs_rawsize(lfs_t *lfs) {
     return size;
 }
 
+#ifndef LFS_READONLY
+static int lfs_fs_rawgc(lfs_t *lfs, lfs_block_t cursor[2]) {
+    // janitorial work, make sure we are consistent before committing
+    int err = lfs_fs_forceconsistency(lfs);
+    if (err) {
+        return err;
+    }
+
+    // compact the next metadata pair whose log is more than 7/8 full, so
+    // the compaction does not happen inside a later commit
+    lfs_mdir_t mdir = {.tail = {cursor[0], cursor[1]}};
+    if (lfs_pair_isnull(mdir.tail)) {
+        mdir.tail[0] = lfs->root[0];
+        mdir.tail[1] = lfs->root[1];
+    }
+
+    while (!lfs_pair_isnull(mdir.tail)) {
+        err = lfs_dir_fetch(lfs, &mdir, mdir.tail);
+        if (err) {
+            return err;
+        }
+
+        if (mdir.off > lfs->cfg->block_size - lfs->cfg->block_size/8) {
+            // the easiest way to trigger a compaction is to mark the
+            // mdir as unerased and add an empty commit
+            lfs_alloc_ack(lfs);
+            mdir.erased = false;
+            err = lfs_dir_commit(lfs, &mdir, NULL, 0);
+            if (err) {
+                return err;
+            }
+
+            cursor[0] = mdir.tail[0];
+            cursor[1] = mdir.tail[1];
+            return 1;
+        }
+    }
+
+    cursor[0] = LFS_BLOCK_NULL;
+    cursor[1] = LFS_BLOCK_NULL;
+
+    // populate the lookahead window if it is exhausted, so the next
+    // allocation does not need to traverse the filesystem
+    if (lfs->free.i == lfs->free.size && lfs->free.ack != 0) {
+        err = lfs_alloc_scan(lfs);
+        if (err) {
+            return err;
+        }
+    }
+
+    return 0;
+}
+#endif
+
+#ifndef LFS_READONLY
+static int lfs_fs_rawupgrade(lfs_t *lfs) {
+    lfs_size_t file_max = lfs->cfg->file_max;
+    if (!file_max) {
+        file_max = LFS_FILE_MAX;
+    }
+
+    // nothing to do if the superblock already allows the configured size
+    if (lfs->file_max >= file_max) {
+        return 0;
+    }
+
+    lfs_mdir_t root;
+    int err = lfs_dir_fetch(lfs, &root, lfs->root);
+    if (err) {
+        return err;
+    }
+
+    lfs_superblock_t superblock;
+    lfs_stag_t tag = lfs_dir_get(lfs, &root, LFS_MKTAG(0x7ff, 0x3ff, 0),
+            LFS_MKTAG(LFS_TYPE_INLINESTRUCT, 0, sizeof(superblock)),
+            &superblock);
+    if (tag < 0) {
+        return tag;
+    }
+    lfs_superblock_fromle32(&superblock);
+
+    superblock.file_max = file_max;
+
+    lfs_superblock_tole32(&superblock);
+    err = lfs_dir_commit(lfs, &root, LFS_MKATTRS(
+            {tag, &superblock}));
+    if (err) {
+        return err;
+    }
+
+    lfs->file_max = file_max;
+    return 0;
+}
+#endif
+
 #ifdef LFS_MIGRATE
 ////// Migration from littelfs v1 below this //////
 
@@ -4946,6 +5147,36 @@ int lfs_unmount(lfs_t *lfs) {
     return err;
 }
 
+int lfs_snapshot(lfs_t *lfs, lfs_snapshot_t *snapshot) {
+    int err = LFS_LOCK(lfs->cfg);
+    if (err) {
+        return err;
+    }
+    LFS_TRACE("lfs_snapshot(%p, %p)", (void*)lfs, (void*)snapshot);
+
+    err = lfs_rawsnapshot(lfs, snapshot);
+
+    LFS_TRACE("lfs_snapshot -> %d", err);
+    LFS_UNLOCK(lfs->cfg);
+    return err;
+}
+
+int lfs_mount_snapshot(lfs_t *lfs, const struct lfs_config *cfg,
+        const lfs_snapshot_t *snapshot) {
+    int err = LFS_LOCK(cfg);
+    if (err) {
+        return err;
+    }
+    LFS_TRACE("lfs_mount_snapshot(%p, %p, %p)",
+            (void*)lfs, (void*)cfg, (void*)snapshot);
+
+    err = lfs_rawmount_snapshot(lfs, cfg, snapshot);
+
+    LFS_TRACE("lfs_mount_snapshot -> %d", err);
+    LFS_UNLOCK(cfg);
+    return err;
+}
+
 #ifndef LFS_READONLY
 int lfs_remove(lfs_t *lfs, const char *path) {
     int err = LFS_LOCK(lfs->cfg);
@@ -5357,6 +5588,38 @@ int lfs_fs_traverse(lfs_t *lfs, int (*cb)(void *, lfs_block_t), void *data) {
     return err;
 }
 
+#ifndef LFS_READONLY
+int lfs_fs_gc(lfs_t *lfs, lfs_block_t cursor[2]) {
+    int err = LFS_LOCK(lfs->cfg);
+    if (err) {
+        return err;
+    }
+    LFS_TRACE("lfs_fs_gc(%p, %p)", (void*)lfs, (void*)cursor);
+
+    err = lfs_fs_rawgc(lfs, cursor);
+
+    LFS_TRACE("lfs_fs_gc -> %d", err);
+    LFS_UNLOCK(lfs->cfg);
+    return err;
+}
+#endif
+
+#ifndef LFS_READONLY
+int lfs_fs_upgrade(lfs_t *lfs) {
+    int err = LFS_LOCK(lfs->cfg);
+    if (err) {
+        return err;
+    }
+    LFS_TRACE("lfs_fs_upgrade(%p)", (void*)lfs);
+
+    err = lfs_fs_rawupgrade(lfs);
+
+    LFS_TRACE("lfs_fs_upgrade -> %d", err);
+    LFS_UNLOCK(lfs->cfg);
+    return err;
+}
+#endif
+
 #ifdef LFS_MIGRATE
 int lfs_migrate(lfs_t *lfs, const struct lfs_config *cfg) {
     int err = LFS_LOCK(cfg);
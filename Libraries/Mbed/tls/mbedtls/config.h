@@ -3027,8 +3027,15 @@
 /* To Use Function Macros MBEDTLS_PLATFORM_C must be enabled */
 /* MBEDTLS_PLATFORM_XXX_MACRO and MBEDTLS_PLATFORM_XXX_ALT cannot both be defined */
 #include "allocator.h"
+#if defined ( __linux )
+/* ECDSA may run on the DLMS crypto worker threads, which must not touch the heap */
+#include "dlms_crypto.h"
+#define MBEDTLS_PLATFORM_CALLOC_MACRO           dlms_crypto_calloc
+#define MBEDTLS_PLATFORM_FREE_MACRO             dlms_crypto_free
+#else
 #define MBEDTLS_PLATFORM_CALLOC_MACRO           heap.dcalloc
 #define MBEDTLS_PLATFORM_FREE_MACRO             heap.free
+#endif
 //#define MBEDTLS_PLATFORM_CALLOC_MACRO        calloc /**< Default allocator macro to use, can be undefined */
 //#define MBEDTLS_PLATFORM_FREE_MACRO            free /**< Default free macro to use, can be undefined */
 //#define MBEDTLS_PLATFORM_EXIT_MACRO            exit /**< Default exit macro to use, can be undefined */
@@ -0,0 +1,749 @@
+/**
+ * @brief		ȵ·΢׼
+ * @details		 VirtualMeter УڵǰĿ¼½ flash 
+ *               CSVbenchmark,iterations,ns_per_op,ops_per_sec
+ * @date		2026-10-19
+ **/
+
+/* Includes ------------------------------------------------------------------*/
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "kernel.h"
+#include "allocator.h"
+#include "allocator_ctrl.h"
+#include "crc.h"
+#include "ecc.h"
+#include "axdr.h"
+#include "dlms_types.h"
+#include "dlms_lexicon.h"
+#include "hdlc_datalink.h"
+#include "mbedtls/gcm.h"
+#include "mbedtls/md5.h"
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+#include <windows.h>
+#elif defined ( __linux )
+#include <time.h>
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  ׼
+  */
+struct __bench_case
+{
+    const char          *name;
+    uint32_t            iterations; //ÿִд
+    bool                (*prepare)(void); // false ʱΪʧ
+    void                (*run)(uint32_t iterations);
+};
+
+#pragma pack(push)
+#pragma pack(4)
+
+/**
+  * @brief  lexicon ļ֣ dlms_lexicon.c һ
+  */
+struct __bench_lex_header
+{
+    uint16_t amount;
+    uint16_t spread[8];
+    uint16_t reserve;
+    uint32_t check;
+};
+
+struct __bench_lex_info
+{
+    uint64_t version;
+    uint64_t date;
+    uint8_t md5[16];
+    uint32_t check;
+};
+
+struct __bench_lex_entry
+{
+    uint64_t key;
+    uint32_t oid;
+    uint32_t mid[3];
+    uint8_t right[16][3];
+    uint32_t check;
+};
+
+#pragma pack(pop)
+
+/**
+  * @brief  ߼¼ڼ¼
+  */
+struct __bench_profile
+{
+    uint8_t stamp[12]; //ѱ date-time
+    uint32_t energy[4];
+    uint8_t status;
+};
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_REPEAT            ((uint8_t)3)    //ÿظȡһ
+#define BENCH_LEX_ENTRIES       ((uint16_t)512) //ϳ lexicon 
+#define BENCH_LEX_ENTRY_SIZE    ((uint32_t)96)  //lexicon ÿռõֽ
+#define BENCH_PARAM_NAME        "display"       //дʹõļ
+
+#if !defined ( BENCH_RING_NAME )
+#define BENCH_RING_NAME         "events.standard" //ζ׷ʹõļΪ̱е CT_RING ļ
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define BENCH_CASES             ((uint16_t)(sizeof(bench_cases) / sizeof(struct __bench_case)))
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t bench_buff[1024];
+static uint8_t bench_out[1024];
+static volatile uint32_t bench_sink = 0; //ֹŻ
+static struct __cosem_request_desc bench_desc;
+static uint8_t bench_frame[160];
+static uint16_t bench_frame_length = 0;
+static mbedtls_gcm_context bench_gcm;
+static uint16_t bench_apdu = 0;
+
+static struct __bench_profile bench_profile[16];
+
+static const struct __axdr_member bench_profile_member[] = 
+{
+    AXDR_MEMBER(struct __bench_profile, stamp,      AXDR_DATE_TIME,             12),
+    AXDR_MEMBER(struct __bench_profile, energy[0],  AXDR_DOUBLE_LONG_UNSIGNED,  0),
+    AXDR_MEMBER(struct __bench_profile, energy[1],  AXDR_DOUBLE_LONG_UNSIGNED,  0),
+    AXDR_MEMBER(struct __bench_profile, energy[2],  AXDR_DOUBLE_LONG_UNSIGNED,  0),
+    AXDR_MEMBER(struct __bench_profile, energy[3],  AXDR_DOUBLE_LONG_UNSIGNED,  0),
+    AXDR_MEMBER(struct __bench_profile, status,     AXDR_UNSIGNED,              0),
+};
+
+static const struct __axdr_schema bench_profile_schema = AXDR_SCHEMA(struct __bench_profile, bench_profile_member);
+
+static const uint8_t bench_key[16] = 
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+};
+
+static const uint8_t bench_iv[12] = 
+{
+    0x4D, 0x4D, 0x4D, 0x00, 0x00, 0xBC, 0x61, 0x4E, 0x01, 0x23, 0x45, 0x67,
+};
+
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  ʱӣ룩
+  */
+static uint64_t bench_now(void)
+{
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    
+    return((uint64_t)(counter.QuadPart * (1000000000.0 / frequency.QuadPart)));
+#else
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+#endif
+}
+
+/**
+  * @brief  ̶ӵαݣ֤ÿеһ
+  */
+static void bench_fill(uint8_t *buff, uint32_t size, uint32_t seed)
+{
+    while(size--)
+    {
+        seed = seed * 1103515245 + 12345;
+        *buff++ = (uint8_t)(seed >> 16);
+    }
+}
+
+/**
+  * @brief   flash ϵļϵͳ
+  */
+static bool prepare_disk(void)
+{
+    static bool ready = false;
+    
+    if(!ready)
+    {
+        disk_ctrl.start();
+        disk_ctrl.unlock();
+        
+        //½ľҪȸʽ
+        if(file.parameter.write(BENCH_PARAM_NAME, 0, 64, bench_buff) != 64)
+        {
+            disk_ctrl.format();
+        }
+        
+        ready = true;
+    }
+    
+    return(file.parameter.write(BENCH_PARAM_NAME, 0, 64, bench_buff) == 64);
+}
+
+static void run_parameter_read(uint32_t iterations)
+{
+    while(iterations--)
+    {
+        bench_sink += file.parameter.read(BENCH_PARAM_NAME, (iterations % 16) * 64, 64, bench_out);
+    }
+}
+
+static void run_parameter_write(uint32_t iterations)
+{
+    while(iterations--)
+    {
+        bench_buff[0] = (uint8_t)iterations;
+        bench_sink += file.parameter.write(BENCH_PARAM_NAME, (iterations % 16) * 64, 64, bench_buff);
+    }
+}
+
+static bool prepare_ring(void)
+{
+    if(!prepare_disk())
+    {
+        return(false);
+    }
+    
+    return(file.ring.init(BENCH_RING_NAME, 64));
+}
+
+static void run_ring_append(uint32_t iterations)
+{
+    while(iterations--)
+    {
+        bench_buff[0] = (uint8_t)iterations;
+        bench_sink += file.ring.append(BENCH_RING_NAME, 64, bench_buff);
+    }
+    
+    //פĿύ
+    disk_ctrl.lock();
+    disk_ctrl.unlock();
+}
+
+/**
+  * @brief  ɺϳɵ lexiconBENCH_LEX_ENTRIES  Register 󣬰ֵ
+  */
+static bool prepare_lexicon(void)
+{
+    static bool ready = false;
+    struct __bench_lex_header *header;
+    struct __bench_lex_info *info;
+    struct __bench_lex_entry *entry;
+    uint8_t *image;
+    uint32_t size = BENCH_LEX_ENTRY_SIZE * (BENCH_LEX_ENTRIES + 1);
+    uint16_t cnt;
+    uint8_t n;
+    
+    if(ready)
+    {
+        return(true);
+    }
+    
+    if(!prepare_disk())
+    {
+        return(false);
+    }
+    
+    //ʵһд룬д flash ̫
+    image = calloc(1, size);
+    if(!image)
+    {
+        return(false);
+    }
+    
+    for(cnt=0; cnt<BENCH_LEX_ENTRIES; cnt++)
+    {
+        entry = (struct __bench_lex_entry *)(image + BENCH_LEX_ENTRY_SIZE * (cnt + 1));
+        
+        //{classID groupA groupB groupC groupD groupE groupF suit}
+        entry->key = ((uint64_t)3 << 56) | ((uint64_t)1 << 48) | ((uint64_t)(cnt >> 8) << 32) | \
+                     ((uint64_t)(cnt & 0xff) << 24) | ((uint64_t)8 << 16) | ((uint64_t)0xff << 8) | 0xff;
+        entry->oid = cnt;
+        entry->mid[0] = 0x10000000 + cnt;
+        entry->mid[1] = 0x20000000 + cnt;
+        
+        for(n=0; n<16; n++)
+        {
+            entry->right[n][0] = ATTR_READ;
+            entry->right[n][1] = ATTR_READ;
+            entry->right[n][2] = ATTR_READ;
+        }
+        
+        entry->check = crc32(entry, (sizeof(struct __bench_lex_entry) - sizeof(uint32_t)), 0);
+    }
+    
+    header = (struct __bench_lex_header *)image;
+    header->amount = BENCH_LEX_ENTRIES;
+    
+    for(n=0; n<8; n++)
+    {
+        header->spread[n] = BENCH_LEX_ENTRIES;
+    }
+    
+    header->check = crc32(header, (sizeof(struct __bench_lex_header) - sizeof(uint32_t)), 0);
+    
+    //ʵͨ md5 УŻᱻʹ
+    info = (struct __bench_lex_info *)(image + sizeof(struct __bench_lex_header));
+    info->version = 1;
+    mbedtls_md5_ret(image + BENCH_LEX_ENTRY_SIZE, BENCH_LEX_ENTRY_SIZE * BENCH_LEX_ENTRIES, info->md5);
+    info->check = crc32(info, (sizeof(struct __bench_lex_info) - sizeof(uint32_t)), 0);
+    
+    if(file.parameter.write("lexicon", 0, size, image) != size)
+    {
+        free(image);
+        return(false);
+    }
+    
+    free(image);
+    
+    bench_desc.suit = 1;
+    bench_desc.level = DLMS_ACCESS_LOW;
+    bench_desc.request = GET_REQUEST;
+    bench_desc.descriptor.classid = 3;
+    bench_desc.descriptor.index = 2;
+    bench_desc.descriptor.selector = 0;
+    bench_desc.descriptor.obis[0] = 1;
+    bench_desc.descriptor.obis[1] = 0;
+    bench_desc.descriptor.obis[4] = 0xff;
+    bench_desc.descriptor.obis[5] = 0xff;
+    
+    dlms_lex_init();
+    
+    if(!dlms_lex_check())
+    {
+        return(false);
+    }
+    
+    ready = true;
+    
+    return(true);
+}
+
+static void lexicon_lookup(uint32_t index)
+{
+    union __dlms_right right;
+    uint32_t oid;
+    uint32_t mid;
+    
+    index %= BENCH_LEX_ENTRIES;
+    bench_desc.descriptor.obis[2] = (uint8_t)(index >> 8);
+    bench_desc.descriptor.obis[3] = (uint8_t)(index & 0xff);
+    bench_desc.descriptor.obis[4] = 8;
+    
+    dlms_lex_parse(&bench_desc, &right, &oid, &mid, (TypeObject *)0);
+    bench_sink += oid + mid;
+}
+
+/**
+  * @brief  ң¼شʵ״βңʵδʱУ
+  */
+static void run_lexicon_cold(uint32_t iterations)
+{
+    while(iterations--)
+    {
+        dlms_lex_init();
+        dlms_lex_check();
+        lexicon_lookup(iterations * 7);
+    }
+}
+
+/**
+  * @brief  Ȳңгפ
+  */
+static void run_lexicon_warm(uint32_t iterations)
+{
+    while(iterations--)
+    {
+        lexicon_lookup(iterations * 7);
+    }
+}
+
+/**
+  * @brief  һ豸ַ I ֻ֡ HCS/FCS У
+  */
+static bool prepare_hdlc(void)
+{
+    uint16_t fcs;
+    uint16_t info = 64;
+    uint16_t length = 0;
+    uint16_t header;
+    
+    hdlc_init();
+    
+    bench_frame[length++] = 0x7E;
+    bench_frame[length++] = 0xA0;
+    bench_frame[length++] = 0x00;
+    bench_frame[length++] = 0x00; //ַ upper
+    bench_frame[length++] = 0x02;
+    bench_frame[length++] = 0xFE; //lower
+    bench_frame[length++] = 0xFF;
+    bench_frame[length++] = 0x21; //ͻ˵ַ
+    bench_frame[length++] = 0x10; //I ֡
+    header = length;
+    bench_frame[length++] = 0x00; //HCS
+    bench_frame[length++] = 0x00;
+    
+    bench_frame[length++] = 0xE6;
+    bench_frame[length++] = 0xE6;
+    bench_frame[length++] = 0x00;
+    bench_fill(&bench_frame[length], info, 0x1d1c);
+    length += info;
+    
+    //֡Ȳβ flag
+    bench_frame[1] = 0xA0 | (uint8_t)(((length + 2 + 1 - 2) >> 8) & 0x07);
+    bench_frame[2] = (uint8_t)((length + 2 + 1 - 2) & 0xff);
+    
+    fcs = crc16(&bench_frame[1], (header - 1), 0xffff);
+    bench_frame[header + 0] = (uint8_t)(fcs & 0xff);
+    bench_frame[header + 1] = (uint8_t)(fcs >> 8);
+    
+    fcs = crc16(&bench_frame[1], (length - 1), 0xffff);
+    bench_frame[length++] = (uint8_t)(fcs & 0xff);
+    bench_frame[length++] = (uint8_t)(fcs >> 8);
+    bench_frame[length++] = 0x7E;
+    
+    bench_frame_length = length;
+    
+    return(true);
+}
+
+static void run_hdlc_decode(uint32_t iterations)
+{
+    while(iterations--)
+    {
+        bench_sink += hdlc_request(0, bench_frame, bench_frame_length);
+    }
+}
+
+static void run_axdr_encode(uint32_t iterations)
+{
+    uint32_t value;
+    uint16_t length;
+    
+    while(iterations--)
+    {
+        value = iterations;
+        length = axdr.encode(&value, sizeof(value), AXDR_DOUBLE_LONG_UNSIGNED, bench_out);
+        length += axdr.encode(bench_buff, 16, AXDR_OCTET_STRING, bench_out + length);
+        bench_sink += length;
+    }
+}
+
+static bool prepare_axdr(void)
+{
+    uint32_t value = 0x12345678;
+    uint16_t length;
+    
+    bench_fill(bench_buff, 16, 0x5eed);
+    length = axdr.encode(&value, sizeof(value), AXDR_DOUBLE_LONG_UNSIGNED, bench_out);
+    axdr.encode(bench_buff, 16, AXDR_OCTET_STRING, bench_out + length);
+    
+    return(true);
+}
+
+static void run_axdr_decode(uint32_t iterations)
+{
+    enum __axdr_type type;
+    uint8_t value[32];
+    uint16_t length;
+    
+    while(iterations--)
+    {
+        length = axdr.decode(bench_out, &type, value);
+        length += axdr.decode(bench_out + length, &type, value);
+        bench_sink += length;
+    }
+}
+
+static bool prepare_data(void)
+{
+    bench_fill(bench_buff, sizeof(bench_buff), 0xc0ffee);
+    
+    return(true);
+}
+
+static void run_crc32(uint32_t iterations)
+{
+    while(iterations--)
+    {
+        bench_sink += crc32(bench_buff, 256, 0);
+    }
+}
+
+static void run_crc16(uint32_t iterations)
+{
+    while(iterations--)
+    {
+        bench_sink += crc16(bench_buff, 256, 0xffff);
+    }
+}
+
+static void run_nand_ecc(uint32_t iterations)
+{
+    while(iterations--)
+    {
+        __nand_calculate_ecc(bench_buff, 256, bench_out);
+        bench_sink += bench_out[0];
+    }
+}
+
+static bool prepare_gcm_64(void)
+{
+    prepare_data();
+    bench_apdu = 64;
+    mbedtls_gcm_free(&bench_gcm);
+    mbedtls_gcm_init(&bench_gcm);
+    
+    return(mbedtls_gcm_setkey(&bench_gcm, MBEDTLS_CIPHER_ID_AES, bench_key, 128) == 0);
+}
+
+static bool prepare_gcm_512(void)
+{
+    if(!prepare_gcm_64())
+    {
+        return(false);
+    }
+    
+    bench_apdu = 512;
+    
+    return(true);
+}
+
+static void run_gcm_encrypt(uint32_t iterations)
+{
+    uint8_t tag[12];
+    
+    while(iterations--)
+    {
+        //ݣȫֽ + ֤Կ
+        mbedtls_gcm_crypt_and_tag(&bench_gcm, MBEDTLS_GCM_ENCRYPT, bench_apdu, \
+                                  bench_iv, sizeof(bench_iv), bench_buff, 17, \
+                                  bench_buff, bench_out, sizeof(tag), tag);
+        bench_sink += tag[0];
+    }
+}
+
+static void run_gcm_decrypt(uint32_t iterations)
+{
+    uint8_t tag[12];
+    
+    mbedtls_gcm_crypt_and_tag(&bench_gcm, MBEDTLS_GCM_ENCRYPT, bench_apdu, \
+                              bench_iv, sizeof(bench_iv), bench_buff, 17, \
+                              bench_buff, bench_out, sizeof(tag), tag);
+    
+    while(iterations--)
+    {
+        bench_sink += mbedtls_gcm_auth_decrypt(&bench_gcm, bench_apdu, \
+                                               bench_iv, sizeof(bench_iv), bench_buff, 17, \
+                                               tag, sizeof(tag), bench_out, bench_out + 512);
+    }
+}
+
+static void run_heap_churn(uint32_t iterations)
+{
+    void *p[4];
+    uint8_t n;
+    
+    while(iterations--)
+    {
+        for(n=0; n<4; n++)
+        {
+            p[n] = heap.dalloc(32 << n);
+        }
+        
+        for(n=0; n<4; n++)
+        {
+            heap.free(p[(n + iterations) % 4]);
+        }
+    }
+}
+
+/**
+  * @brief  
+  */
+static bool prepare_profile(void)
+{
+    bench_fill((uint8_t *)bench_profile, sizeof(bench_profile), 0x7e57);
+    
+    return(true);
+}
+
+/**
+  * @brief  Ա axdr.encode ֹ 16 ¼
+  */
+static void run_profile_manual(uint32_t iterations)
+{
+    uint16_t length;
+    uint8_t cnt;
+    
+    while(iterations--)
+    {
+        bench_out[0] = AXDR_ARRAY;
+        bench_out[1] = 16;
+        length = 2;
+        
+        for(cnt=0; cnt<16; cnt++)
+        {
+            bench_out[length++] = AXDR_STRUCTURE;
+            bench_out[length++] = 6;
+            length += axdr.encode(bench_profile[cnt].stamp, 12, AXDR_OCTET_STRING, &bench_out[length]);
+            length += axdr.encode(&bench_profile[cnt].energy[0], 4, AXDR_DOUBLE_LONG_UNSIGNED, &bench_out[length]);
+            length += axdr.encode(&bench_profile[cnt].energy[1], 4, AXDR_DOUBLE_LONG_UNSIGNED, &bench_out[length]);
+            length += axdr.encode(&bench_profile[cnt].energy[2], 4, AXDR_DOUBLE_LONG_UNSIGNED, &bench_out[length]);
+            length += axdr.encode(&bench_profile[cnt].energy[3], 4, AXDR_DOUBLE_LONG_UNSIGNED, &bench_out[length]);
+            length += axdr.encode(&bench_profile[cnt].status, 1, AXDR_UNSIGNED, &bench_out[length]);
+        }
+        
+        bench_sink += length;
+    }
+}
+
+/**
+  * @brief  ¼ 16 ¼Ϊ ARRAY of STRUCTURE
+  */
+static void run_profile_schema(uint32_t iterations)
+{
+    while(iterations--)
+    {
+        bench_sink += axdr.schema.encode(&bench_profile_schema, bench_profile, 16, bench_out, sizeof(bench_out));
+    }
+}
+
+/**
+  * @brief  ¼ 16 ¼Ϊ COMPACT ARRAY
+  */
+static void run_profile_compact(uint32_t iterations)
+{
+    while(iterations--)
+    {
+        bench_sink += axdr.schema.compact(&bench_profile_schema, bench_profile, 16, bench_out, sizeof(bench_out));
+    }
+}
+
+/**
+  * @brief  ׼б
+  */
+static const struct __bench_case bench_cases[] = 
+{
+    {"disk_parameter_read",     100,        prepare_disk,       run_parameter_read},
+    {"disk_parameter_write",    20,         prepare_disk,       run_parameter_write},
+    {"disk_ring_append",        200,        prepare_ring,       run_ring_append},
+    {"dlms_lex_parse_cold",     1,          prepare_lexicon,    run_lexicon_cold},
+    {"dlms_lex_parse_warm",     100000,     prepare_lexicon,    run_lexicon_warm},
+    {"hdlc_decode_fcs",         100000,     prepare_hdlc,       run_hdlc_decode},
+    {"axdr_encode",             1000000,    prepare_axdr,       run_axdr_encode},
+    {"axdr_decode",             1000000,    prepare_axdr,       run_axdr_decode},
+    {"axdr_profile_manual",     100000,     prepare_profile,    run_profile_manual},
+    {"axdr_profile_schema",     100000,     prepare_profile,    run_profile_schema},
+    {"axdr_profile_compact",    100000,     prepare_profile,    run_profile_compact},
+    {"crc32_256",               100000,     prepare_data,       run_crc32},
+    {"crc16_256",               100000,     prepare_data,       run_crc16},
+    {"nand_ecc_256",            100000,     prepare_data,       run_nand_ecc},
+    {"gcm_encrypt_64",          50000,      prepare_gcm_64,     run_gcm_encrypt},
+    {"gcm_decrypt_64",          50000,      prepare_gcm_64,     run_gcm_decrypt},
+    {"gcm_encrypt_512",         10000,      prepare_gcm_512,    run_gcm_encrypt},
+    {"gcm_decrypt_512",         10000,      prepare_gcm_512,    run_gcm_decrypt},
+    {"heap_dalloc_free",        2000,       prepare_data,       run_heap_churn},
+};
+
+/**
+  * @brief  ں״̬׼ʼմ̬
+  */
+enum __klevel system_status(void)
+{
+    return(SYSTEM_RUN);
+}
+
+/**
+  * @brief  
+  */
+uint16_t system_usage(void)
+{
+    return(0);
+}
+
+#if defined ( __linux )
+/**
+  * @brief  ׼ûе̣߳軥
+  */
+void system_lock_shared(void)
+{
+}
+
+void system_unlock_shared(void)
+{
+}
+#endif
+
+/**
+  * @brief  vm_bench [filter]
+  * ֻа filter 
+  */
+int main(int argc, char *argv[])
+{
+    uint16_t cnt;
+    uint8_t loop;
+    uint64_t begin;
+    uint64_t best;
+    uint64_t elapsed;
+    const struct __bench_case *bench;
+    int failed = 0;
+    
+    printf("benchmark,iterations,ns_per_op,ops_per_sec\n");
+    
+    for(cnt=0; cnt<BENCH_CASES; cnt++)
+    {
+        bench = &bench_cases[cnt];
+        
+        if((argc > 1) && !strstr(bench->name, argv[1]))
+        {
+            continue;
+        }
+        
+        if(!bench->prepare())
+        {
+            printf("%s,0,failed,failed\n", bench->name);
+            fprintf(stderr, "%s: prepare failed\n", bench->name);
+            failed = 1;
+            continue;
+        }
+        
+        best = 0;
+        
+        for(loop=0; loop<BENCH_REPEAT; loop++)
+        {
+            begin = bench_now();
+            bench->run(bench->iterations);
+            elapsed = bench_now() - begin;
+            
+            if(!best || (elapsed < best))
+            {
+                best = elapsed;
+            }
+            
+            heap_ctrl.dinit();
+        }
+        
+        if(!best)
+        {
+            best = 1;
+        }
+        
+        printf("%s,%u,%.1f,%.2f\n", bench->name, (unsigned)bench->iterations, \
+               (double)best / bench->iterations, \
+               (double)bench->iterations * 1000000000.0 / best);
+        fflush(stdout);
+    }
+    
+    return(failed | (int)(bench_sink & 0));
+}
@@ -0,0 +1,1070 @@
+/**
+ * @brief		DLMS/HDLC ʱͳ
+ * @details		Ϊ HDLC վͨ/pty  TCP һ
+ *               SNRMAARQĿѭͶȡбе GET  RLRQDISC
+ *               CSVtarget,requests,errors,timeouts,rps,p50_us,p90_us,p99_us,max_us
+ * @date		2026-10-19
+ **/
+
+/* Includes ------------------------------------------------------------------*/
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdint.h"
+#include "stdbool.h"
+#include "crc.h"
+#include "axdr.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <termios.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  ȡбеһ
+  */
+struct __load_item
+{
+    uint16_t            classid;
+    uint8_t             obis[6];
+    int8_t              index;
+};
+
+/**
+  * @brief  һӺͳ
+  */
+struct __load_target
+{
+    const char          *name;
+    int                 fd;
+    char                link[128]; //pty ģʽ´ķ
+    
+    uint8_t             ns; // N(S)
+    uint8_t             nr; // N(R)
+    uint8_t             invoke;
+    
+    uint32_t            requests;
+    uint32_t            errors;
+    uint32_t            timeouts;
+    uint32_t            *latency; //ÿʱӣ΢룩
+    uint64_t            elapsed; //׶εܺʱ΢룩
+};
+
+/* Private define ------------------------------------------------------------*/
+#define LOAD_MAX_TARGETS        ((uint8_t)16)
+#define LOAD_MAX_ITEMS          ((uint16_t)256)
+#define LOAD_FRAME_SIZE         ((uint16_t)2048)
+#define LOAD_APDU_SIZE          ((uint16_t)8192)
+
+#define HDLC_FLAG               ((uint8_t)0x7E)
+#define HDLC_CTRL_SNRM          ((uint8_t)0x93)
+#define HDLC_CTRL_DISC          ((uint8_t)0x53)
+#define HDLC_CTRL_UA            ((uint8_t)0x73)
+#define HDLC_CTRL_DM            ((uint8_t)0x1F)
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static struct __load_target load_targets[LOAD_MAX_TARGETS];
+static uint8_t load_target_amount = 0;
+
+static struct __load_item load_items[LOAD_MAX_ITEMS];
+static uint16_t load_item_amount = 0;
+
+static uint32_t load_count = 100; //ÿ͵ GET 
+static uint32_t load_rate = 0; //ÿÿ0 ʾ
+static uint32_t load_timeout = 2000; //Ӧʱ룩
+static uint32_t load_delay = 0; // pty ȴ򿪶˿ڵʱ䣨룩
+static uint16_t load_client = 0x10; //ͻ SAP
+static uint16_t load_logic = 0x01; //߼ַ
+static uint16_t load_device = 0x10; //ַ
+static bool load_verbose = false;
+
+/**
+  * @brief  δָȡбʱʹõĬ
+  */
+static const struct __load_item load_defaults[] =
+{
+    {8,     {0, 0, 1, 0, 0, 255},       2}, //ʱ
+    {1,     {0, 0, 96, 1, 0, 255},      2}, //
+    {3,     {1, 0, 1, 8, 0, 255},       2}, //йܵ
+    {3,     {1, 0, 32, 7, 0, 255},      2}, //Aѹ
+};
+
+/**
+  * @brief  AARQLN á޼ܡͰȫȼ
+  */
+static const uint8_t load_aarq[] =
+{
+    0x60, 0x1D,
+    0xA1, 0x09, 0x06, 0x07, 0x60, 0x85, 0x74, 0x05, 0x08, 0x01, 0x01,
+    0xBE, 0x10, 0x04, 0x0E,
+    0x01, 0x00, 0x00, 0x00, 0x06,
+    0x5F, 0x1F, 0x04, 0x00, 0x00, 0x7E, 0x1F,
+    0xFF, 0xFF,
+};
+
+/**
+  * @brief  RLRQreason normal
+  */
+static const uint8_t load_rlrq[] =
+{
+    0x62, 0x03, 0x80, 0x01, 0x00,
+};
+
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  ʱӣ΢룩
+  */
+static uint64_t load_now(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+/**
+  * @brief  ˯ߵָĵʱʱ
+  */
+static void load_sleep_until(uint64_t due)
+{
+    uint64_t now = load_now();
+    struct timespec ts;
+    
+    if(due <= now)
+    {
+        return;
+    }
+    
+    ts.tv_sec = (time_t)((due - now) / 1000000);
+    ts.tv_nsec = (long)(((due - now) % 1000000) * 1000);
+    
+    while(nanosleep(&ts, &ts) != 0 && errno == EINTR);
+}
+
+/**
+  * @brief   OBISʽ a.b.c.d.e.f  a-b:c.d.e*f
+  */
+static bool load_parse_obis(const char *text, uint8_t *obis)
+{
+    unsigned int val[6];
+    uint8_t cnt;
+    
+    if(sscanf(text, "%u.%u.%u.%u.%u.%u", &val[0], &val[1], &val[2], &val[3], &val[4], &val[5]) != 6 && \
+       sscanf(text, "%u-%u:%u.%u.%u*%u", &val[0], &val[1], &val[2], &val[3], &val[4], &val[5]) != 6)
+    {
+        return(false);
+    }
+    
+    for(cnt=0; cnt<6; cnt++)
+    {
+        if(val[cnt] > 255)
+        {
+            return(false);
+        }
+        
+        obis[cnt] = (uint8_t)val[cnt];
+    }
+    
+    return(true);
+}
+
+/**
+  * @brief  ȡʽ "class obis attribute" "3 1.0.1.8.0.255 2"
+  */
+static bool load_parse_item(const char *text, struct __load_item *item)
+{
+    unsigned int classid;
+    int index;
+    char obis[32];
+    
+    if(sscanf(text, "%u %31s %d", &classid, obis, &index) != 3)
+    {
+        return(false);
+    }
+    
+    if((classid > 0xffff) || (index < -128) || (index > 127))
+    {
+        return(false);
+    }
+    
+    if(!load_parse_obis(obis, item->obis))
+    {
+        return(false);
+    }
+    
+    item->classid = (uint16_t)classid;
+    item->index = (int8_t)index;
+    
+    return(true);
+}
+
+/**
+  * @brief  ļضȡб# ͷΪע
+  */
+static bool load_read_list(const char *path)
+{
+    FILE *fp;
+    char line[128];
+    char *p;
+    
+    fp = fopen(path, "r");
+    if(!fp)
+    {
+        fprintf(stderr, "can not open %s\n", path);
+        return(false);
+    }
+    
+    while(fgets(line, sizeof(line), fp) && (load_item_amount < LOAD_MAX_ITEMS))
+    {
+        for(p=line; *p == ' ' || *p == '\t'; p++);
+        
+        if(*p == '#' || *p == '\r' || *p == '\n' || *p == 0)
+        {
+            continue;
+        }
+        
+        if(!load_parse_item(p, &load_items[load_item_amount]))
+        {
+            fprintf(stderr, "bad item in %s: %s", path, line);
+            fclose(fp);
+            return(false);
+        }
+        
+        load_item_amount += 1;
+    }
+    
+    fclose(fp);
+    
+    return(true);
+}
+
+/**
+  * @brief  Ϊԭʼģʽ9600 8E1 vuart һ
+  */
+static bool load_setup_serial(int fd)
+{
+    struct termios options;
+    
+    if(tcgetattr(fd, &options) != 0)
+    {
+        return(false);
+    }
+    
+    cfmakeraw(&options);
+    cfsetispeed(&options, B9600);
+    cfsetospeed(&options, B9600);
+    options.c_cflag |= PARENB | CREAD | CLOCAL;
+    options.c_cflag &= ~(PARODD | CSTOPB | CRTSCTS);
+    options.c_cc[VMIN] = 0;
+    options.c_cc[VTIME] = 0;
+    
+    if(tcsetattr(fd, TCSANOW, &options) != 0)
+    {
+        return(false);
+    }
+    
+    tcflush(fd, TCIOFLUSH);
+    
+    return(true);
+}
+
+/**
+  * @brief  򿪱
+  * tcp:host:port     TCP 
+  * pty:path          ½ pty path ӵӶˣ /dev/ttyS1ڵǰ
+  *               ѴڵĴڻ pty 豸
+  */
+static bool load_open(struct __load_target *target)
+{
+    const char *name = target->name;
+    
+    target->fd = -1;
+    target->link[0] = 0;
+    
+    if(strncmp(name, "tcp:", 4) == 0)
+    {
+        char host[128];
+        const char *port;
+        struct addrinfo hints;
+        struct addrinfo *result;
+        struct addrinfo *rp;
+        int nodelay = 1;
+        
+        port = strrchr(name + 4, ':');
+        if(!port || ((size_t)(port - (name + 4)) >= sizeof(host)))
+        {
+            return(false);
+        }
+        
+        memcpy(host, name + 4, (size_t)(port - (name + 4)));
+        host[port - (name + 4)] = 0;
+        
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        
+        if(getaddrinfo(host, port + 1, &hints, &result) != 0)
+        {
+            return(false);
+        }
+        
+        for(rp=result; rp; rp=rp->ai_next)
+        {
+            target->fd = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
+            if(target->fd < 0)
+            {
+                continue;
+            }
+            
+            if(connect(target->fd, rp->ai_addr, rp->ai_addrlen) == 0)
+            {
+                break;
+            }
+            
+            close(target->fd);
+            target->fd = -1;
+        }
+        
+        freeaddrinfo(result);
+        
+        if(target->fd < 0)
+        {
+            return(false);
+        }
+        
+        setsockopt(target->fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    }
+    else if(strncmp(name, "pty:", 4) == 0)
+    {
+        const char *slave;
+        
+        if(strlen(name + 4) >= sizeof(target->link))
+        {
+            return(false);
+        }
+        
+        target->fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if(target->fd < 0)
+        {
+            return(false);
+        }
+        
+        if(grantpt(target->fd) != 0 || unlockpt(target->fd) != 0 || !(slave = ptsname(target->fd)))
+        {
+            close(target->fd);
+            target->fd = -1;
+            return(false);
+        }
+        
+        load_setup_serial(target->fd);
+        
+        unlink(name + 4);
+        if(symlink(slave, name + 4) != 0)
+        {
+            close(target->fd);
+            target->fd = -1;
+            return(false);
+        }
+        
+        strcpy(target->link, name + 4);
+    }
+    else
+    {
+        target->fd = open(name, O_RDWR | O_NOCTTY);
+        if(target->fd < 0)
+        {
+            return(false);
+        }
+        
+        load_setup_serial(target->fd);
+    }
+    
+    return(true);
+}
+
+/**
+  * @brief  رձ
+  */
+static void load_close(struct __load_target *target)
+{
+    if(target->fd >= 0)
+    {
+        close(target->fd);
+        target->fd = -1;
+    }
+    
+    if(target->link[0])
+    {
+        unlink(target->link);
+        target->link[0] = 0;
+    }
+}
+
+/**
+  * @brief   HDLC ֡info ΪʱϢ FCS
+  * ˵̶ַ 4 ֽڸʽ hdlc_datalink.c  fill_server_address һ
+  */
+static uint16_t load_frame(uint8_t ctrl, bool segment, const uint8_t *info, uint16_t length, uint8_t *out)
+{
+    uint16_t frame_length;
+    uint16_t check;
+    uint16_t pos = 0;
+    
+    //ʽ HCS Ϊ 10 ֽ
+    frame_length = 10;
+    if(length)
+    {
+        frame_length += length + 2;
+    }
+    
+    out[pos++] = HDLC_FLAG;
+    out[pos++] = (uint8_t)(0xA0 | (segment ? 0x08 : 0) | ((frame_length >> 8) & 0x07));
+    out[pos++] = (uint8_t)(frame_length & 0xff);
+    
+    out[pos++] = (uint8_t)((load_logic >> 6) & 0xfe);
+    out[pos++] = (uint8_t)((load_logic << 1) & 0xfe);
+    out[pos++] = (uint8_t)((load_device >> 6) & 0xfe);
+    out[pos++] = (uint8_t)(((load_device << 1) & 0xfe) | 0x01);
+    out[pos++] = (uint8_t)((load_client << 1) | 0x01);
+    out[pos++] = ctrl;
+    
+    check = crc16(&out[1], (pos - 1), 0xffff);
+    out[pos++] = (uint8_t)(check & 0xff);
+    out[pos++] = (uint8_t)(check >> 8);
+    
+    if(length)
+    {
+        memcpy(&out[pos], info, length);
+        pos += length;
+        
+        check = crc16(&out[1], (pos - 1), 0xffff);
+        out[pos++] = (uint8_t)(check & 0xff);
+        out[pos++] = (uint8_t)(check >> 8);
+    }
+    
+    out[pos++] = HDLC_FLAG;
+    
+    return(pos);
+}
+
+/**
+  * @brief  ȫ
+  */
+static bool load_send(struct __load_target *target, const uint8_t *data, uint16_t length)
+{
+    ssize_t written;
+    
+    while(length)
+    {
+        written = write(target->fd, data, length);
+        if(written < 0)
+        {
+            if(errno == EINTR || errno == EAGAIN)
+            {
+                continue;
+            }
+            
+            return(false);
+        }
+        
+        data += written;
+        length -= (uint16_t)written;
+    }
+    
+    return(true);
+}
+
+/**
+  * @brief  һУȷ HDLC ֡
+  * ֡ȣʱ 0
+  */
+static uint16_t load_recv(struct __load_target *target, uint8_t *frame, uint64_t deadline)
+{
+    struct pollfd pfd;
+    uint16_t received = 0;
+    uint16_t expected = 0;
+    uint64_t now;
+    uint8_t byte;
+    ssize_t got;
+    
+    pfd.fd = target->fd;
+    pfd.events = POLLIN;
+    
+    for(;;)
+    {
+        now = load_now();
+        if(now >= deadline)
+        {
+            return(0);
+        }
+        
+        pfd.revents = 0;
+        if(poll(&pfd, 1, (int)((deadline - now + 999) / 1000)) <= 0)
+        {
+            continue;
+        }
+        
+        got = read(target->fd, &byte, 1);
+        if(got <= 0)
+        {
+            //pty Ӷδʱ read  EIO
+            if(got < 0 && errno == EIO)
+            {
+                usleep(1000);
+            }
+            
+            continue;
+        }
+        
+        if(!received)
+        {
+            if(byte == HDLC_FLAG)
+            {
+                frame[received++] = byte;
+            }
+            
+            continue;
+        }
+        
+        //֡־Ϊ֡Ŀʼ
+        if((received == 1) && (byte == HDLC_FLAG))
+        {
+            continue;
+        }
+        
+        frame[received++] = byte;
+        
+        if(received == 3)
+        {
+            expected = (uint16_t)(((frame[1] & 0x07) << 8) | frame[2]) + 2;
+            if(((frame[1] & 0xf0) != 0xA0) || (expected > LOAD_FRAME_SIZE) || (expected < 9))
+            {
+                received = 0;
+            }
+            
+            continue;
+        }
+        
+        if(expected && (received >= expected))
+        {
+            if((frame[received - 1] == HDLC_FLAG) && \
+               (crc16(&frame[1], (received - 4), 0xffff) == (frame[received - 3] | (frame[received - 2] << 8))))
+            {
+                return(received);
+            }
+            
+            received = 0;
+            expected = 0;
+        }
+    }
+}
+
+/**
+  * @brief  ޱ֡ȴ UA
+  */
+static bool load_unnumbered(struct __load_target *target, uint8_t ctrl)
+{
+    uint8_t frame[LOAD_FRAME_SIZE];
+    uint16_t length;
+    uint64_t deadline;
+    
+    length = load_frame(ctrl, false, (const uint8_t *)0, 0, frame);
+    
+    if(!load_send(target, frame, length))
+    {
+        return(false);
+    }
+    
+    deadline = load_now() + (uint64_t)load_timeout * 1000;
+    
+    for(;;)
+    {
+        length = load_recv(target, frame, deadline);
+        if(!length)
+        {
+            return(false);
+        }
+        
+        //ԴַΪ 4 ֽڷ˵ַڵ 9 ֽ
+        if(frame[8] == HDLC_CTRL_UA || frame[8] == HDLC_CTRL_DM)
+        {
+            return(frame[8] == HDLC_CTRL_UA);
+        }
+    }
+}
+
+/**
+  * @brief  һ APDU Ӧ APDU˵ķ֡
+  * Ӧ APDU ĳȣʱ 0
+  */
+static uint16_t load_transfer(struct __load_target *target, const uint8_t *apdu, uint16_t length, uint8_t *response)
+{
+    uint8_t info[LOAD_FRAME_SIZE];
+    uint8_t frame[LOAD_FRAME_SIZE];
+    uint16_t frame_length;
+    uint16_t info_length;
+    uint16_t filled = 0;
+    uint64_t deadline;
+    uint8_t ctrl;
+    
+    if(length + 3 > sizeof(info) - 16)
+    {
+        return(0);
+    }
+    
+    //LLC ͷ
+    info[0] = 0xE6;
+    info[1] = 0xE6;
+    info[2] = 0x00;
+    memcpy(&info[3], apdu, length);
+    
+    ctrl = (uint8_t)((target->nr << 5) | 0x10 | (target->ns << 1));
+    target->ns = (target->ns + 1) & 0x07;
+    
+    frame_length = load_frame(ctrl, false, info, (length + 3), frame);
+    if(!load_send(target, frame, frame_length))
+    {
+        return(0);
+    }
+    
+    deadline = load_now() + (uint64_t)load_timeout * 1000;
+    
+    for(;;)
+    {
+        frame_length = load_recv(target, frame, deadline);
+        if(!frame_length)
+        {
+            return(0);
+        }
+        
+        ctrl = frame[8];
+        
+        //ֻ I ֡
+        if(ctrl & 0x01)
+        {
+            continue;
+        }
+        
+        target->nr = (uint8_t)((((ctrl >> 1) & 0x07) + 1) & 0x07);
+        
+        info_length = frame_length - 14;
+        if(!filled && (info_length >= 3) && (frame[11] == 0xE6) && (frame[12] == 0xE7))
+        {
+            memcpy(response, &frame[14], info_length - 3);
+            filled = info_length - 3;
+        }
+        else if(filled + info_length <= LOAD_APDU_SIZE)
+        {
+            memcpy(response + filled, &frame[11], info_length);
+            filled += info_length;
+        }
+        
+        //˷֡ظ RR ȡһ֡
+        if(frame[1] & 0x08)
+        {
+            frame_length = load_frame((uint8_t)((target->nr << 5) | 0x11), false, (const uint8_t *)0, 0, frame);
+            if(!load_send(target, frame, frame_length))
+            {
+                return(0);
+            }
+            
+            deadline = load_now() + (uint64_t)load_timeout * 1000;
+            continue;
+        }
+        
+        return(filled);
+    }
+}
+
+/**
+  * @brief  ٵӦֱ· quiet 
+  */
+static void load_drain(struct __load_target *target, uint32_t quiet)
+{
+    uint8_t frame[LOAD_FRAME_SIZE];
+    
+    while(load_recv(target, frame, (load_now() + (uint64_t)quiet * 1000)));
+}
+
+/**
+  * @brief  ·Ӧ
+  */
+static bool load_connect(struct __load_target *target)
+{
+    uint8_t response[LOAD_APDU_SIZE];
+    uint16_t length;
+    uint16_t cnt;
+    
+    target->ns = 0;
+    target->nr = 0;
+    
+    if(!load_unnumbered(target, HDLC_CTRL_SNRM))
+    {
+        fprintf(stderr, "%s: SNRM no answer\n", target->name);
+        return(false);
+    }
+    
+    length = load_transfer(target, load_aarq, sizeof(load_aarq), response);
+    if(!length || response[0] != 0x61)
+    {
+        fprintf(stderr, "%s: AARQ no answer\n", target->name);
+        return(false);
+    }
+    
+    //association-result
+    for(cnt=2; cnt+4<length; cnt++)
+    {
+        if(response[cnt] == 0xA2 && response[cnt + 1] == 0x03 && response[cnt + 2] == 0x02)
+        {
+            if(response[cnt + 4] == 0)
+            {
+                return(true);
+            }
+            
+            break;
+        }
+    }
+    
+    fprintf(stderr, "%s: association rejected\n", target->name);
+    
+    return(false);
+}
+
+/**
+  * @brief  ͷӦӺ·
+  */
+static void load_disconnect(struct __load_target *target)
+{
+    uint8_t response[LOAD_APDU_SIZE];
+    
+    load_transfer(target, load_rlrq, sizeof(load_rlrq), response);
+    load_unnumbered(target, HDLC_CTRL_DISC);
+}
+
+/**
+  * @brief   GET-Response-Normal͵
+  */
+static bool load_check_response(const uint8_t *response, uint16_t length, uint8_t invoke)
+{
+    enum __axdr_type type;
+    
+    if((length < 5) || (response[0] != 0xC4) || (response[1] != 0x01) || ((response[2] & 0x0f) != (invoke & 0x0f)))
+    {
+        return(false);
+    }
+    
+    //Data-Access-Result
+    if(response[3] != 0)
+    {
+        return(length == 5);
+    }
+    
+    type = axdr.type.decode(&response[4]);
+    if(AXDR_CONTAINABLE(type) || type == AXDR_OCTET_STRING || type == AXDR_VISIBLE_STRING)
+    {
+        return((uint16_t)(5 + axdr.length.calc(&response[4])) <= length);
+    }
+    
+    return(true);
+}
+
+/**
+  * @brief  ĸ߳
+  */
+static void *load_thread(void *arg)
+{
+    struct __load_target *target = (struct __load_target *)arg;
+    const struct __load_item *item;
+    uint8_t request[16];
+    uint8_t response[LOAD_APDU_SIZE];
+    uint16_t length;
+    uint64_t begin;
+    uint64_t start;
+    uint64_t due;
+    uint32_t cnt;
+    
+    if(!load_connect(target))
+    {
+        target->errors = load_count;
+        return((void *)0);
+    }
+    
+    start = load_now();
+    due = start;
+    
+    for(cnt=0; cnt<load_count; cnt++)
+    {
+        item = &load_items[cnt % load_item_amount];
+        
+        if(load_rate)
+        {
+            load_sleep_until(due);
+            due += 1000000 / load_rate;
+        }
+        
+        target->invoke = (target->invoke + 1) & 0x0f;
+        
+        //GET-Request-Normal
+        request[0] = 0xC0;
+        request[1] = 0x01;
+        request[2] = (uint8_t)(0xC0 | target->invoke);
+        request[3] = (uint8_t)(item->classid >> 8);
+        request[4] = (uint8_t)(item->classid & 0xff);
+        memcpy(&request[5], item->obis, 6);
+        request[11] = (uint8_t)item->index;
+        request[12] = 0x00;
+        
+        begin = load_now();
+        length = load_transfer(target, request, 13, response);
+        target->latency[target->requests] = (uint32_t)(load_now() - begin);
+        target->requests += 1;
+        
+        if(!length)
+        {
+            target->timeouts += 1;
+            
+            if(load_verbose)
+            {
+                fprintf(stderr, "%s: %u-%u:%u.%u.%u*%u timeout\n", target->name, \
+                        item->obis[0], item->obis[1], item->obis[2], item->obis[3], item->obis[4], item->obis[5]);
+            }
+            
+            //·ſѴλٵӦϿ½
+            load_drain(target, load_timeout);
+            load_unnumbered(target, HDLC_CTRL_DISC);
+            
+            if(!load_connect(target))
+            {
+                target->errors += load_count - cnt - 1;
+                break;
+            }
+            
+            continue;
+        }
+        
+        if(!load_check_response(response, length, target->invoke))
+        {
+            target->errors += 1;
+            
+            if(load_verbose)
+            {
+                fprintf(stderr, "%s: %u-%u:%u.%u.%u*%u bad response\n", target->name, \
+                        item->obis[0], item->obis[1], item->obis[2], item->obis[3], item->obis[4], item->obis[5]);
+            }
+        }
+    }
+    
+    target->elapsed = load_now() - start;
+    
+    load_disconnect(target);
+    
+    return((void *)0);
+}
+
+/**
+  * @brief
+  */
+static int load_compare(const void *a, const void *b)
+{
+    uint32_t va = *(const uint32_t *)a;
+    uint32_t vb = *(const uint32_t *)b;
+    
+    return((va > vb) - (va < vb));
+}
+
+/**
+  * @brief  һͳƽsamples ᱻ
+  */
+static void load_report(const char *name, uint32_t *samples, uint32_t requests, \
+                        uint32_t errors, uint32_t timeouts, uint64_t elapsed)
+{
+    double rps = 0;
+    
+    if(!requests)
+    {
+        printf("%s,0,%u,%u,0,0,0,0,0\n", name, (unsigned)errors, (unsigned)timeouts);
+        return;
+    }
+    
+    qsort(samples, requests, sizeof(uint32_t), load_compare);
+    
+    if(elapsed)
+    {
+        rps = (double)(requests - timeouts) * 1000000.0 / elapsed;
+    }
+    
+    printf("%s,%u,%u,%u,%.2f,%u,%u,%u,%u\n", name, (unsigned)requests, (unsigned)errors, (unsigned)timeouts, rps, \
+           (unsigned)samples[(requests - 1) * 50 / 100], \
+           (unsigned)samples[(requests - 1) * 90 / 100], \
+           (unsigned)samples[(requests - 1) * 99 / 100], \
+           (unsigned)samples[requests - 1]);
+}
+
+/**
+  * @brief
+  */
+static void load_usage(void)
+{
+    fprintf(stderr, \
+            "usage: vm_load [options] target...\n" \
+            "target:\n" \
+            "  /dev/pts/N        existing serial or pty device\n" \
+            "  pty:/dev/ttyS1    create a pty and link the path to it (start before VirtualMeter)\n" \
+            "  tcp:host:port     TCP stream carrying raw HDLC frames\n" \
+            "options:\n" \
+            "  -n count          GET requests per target (100)\n" \
+            "  -r rate           requests per second per target, 0 unlimited (0)\n" \
+            "  -t ms             response timeout (2000)\n" \
+            "  -w ms             wait before connecting (0)\n" \
+            "  -l file           read list, one \"class obis attribute\" per line\n" \
+            "  -i item           add one read item, e.g. \"3 1.0.1.8.0.255 2\"\n" \
+            "  -c sap            client SAP (16)\n" \
+            "  -s logic          server logical address (1)\n" \
+            "  -a address        server physical address (16)\n" \
+            "  -v                report failed requests on stderr\n");
+}
+
+/**
+  * @brief  vm_load [options] target...
+  */
+int main(int argc, char *argv[])
+{
+    pthread_t threads[LOAD_MAX_TARGETS];
+    uint32_t *samples;
+    uint32_t requests = 0;
+    uint32_t errors = 0;
+    uint32_t timeouts = 0;
+    uint64_t elapsed = 0;
+    int opt;
+    uint8_t cnt;
+    
+    while((opt = getopt(argc, argv, "n:r:t:w:l:i:c:s:a:vh")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': load_count = (uint32_t)strtoul(optarg, (char **)0, 0); break;
+            case 'r': load_rate = (uint32_t)strtoul(optarg, (char **)0, 0); break;
+            case 't': load_timeout = (uint32_t)strtoul(optarg, (char **)0, 0); break;
+            case 'w': load_delay = (uint32_t)strtoul(optarg, (char **)0, 0); break;
+            case 'c': load_client = (uint16_t)strtoul(optarg, (char **)0, 0); break;
+            case 's': load_logic = (uint16_t)strtoul(optarg, (char **)0, 0); break;
+            case 'a': load_device = (uint16_t)strtoul(optarg, (char **)0, 0); break;
+            case 'v': load_verbose = true; break;
+            case 'l':
+            {
+                if(!load_read_list(optarg))
+                {
+                    return(1);
+                }
+                break;
+            }
+            case 'i':
+            {
+                if((load_item_amount >= LOAD_MAX_ITEMS) || !load_parse_item(optarg, &load_items[load_item_amount]))
+                {
+                    fprintf(stderr, "bad item: %s\n", optarg);
+                    return(1);
+                }
+                load_item_amount += 1;
+                break;
+            }
+            default:
+            {
+                load_usage();
+                return(1);
+            }
+        }
+    }
+    
+    if((optind >= argc) || !load_count)
+    {
+        load_usage();
+        return(1);
+    }
+    
+    if(!load_item_amount)
+    {
+        memcpy(load_items, load_defaults, sizeof(load_defaults));
+        load_item_amount = (uint16_t)(sizeof(load_defaults) / sizeof(struct __load_item));
+    }
+    
+    for(; (optind < argc) && (load_target_amount < LOAD_MAX_TARGETS); optind++)
+    {
+        struct __load_target *target = &load_targets[load_target_amount];
+        
+        memset(target, 0, sizeof(struct __load_target));
+        target->name = argv[optind];
+        target->latency = (uint32_t *)calloc(load_count, sizeof(uint32_t));
+        
+        if(!target->latency || !load_open(target))
+        {
+            fprintf(stderr, "%s: open failed\n", target->name);
+            return(1);
+        }
+        
+        load_target_amount += 1;
+    }
+    
+    if(load_delay)
+    {
+        load_sleep_until(load_now() + (uint64_t)load_delay * 1000);
+    }
+    
+    for(cnt=0; cnt<load_target_amount; cnt++)
+    {
+        pthread_create(&threads[cnt], (pthread_attr_t *)0, load_thread, &load_targets[cnt]);
+    }
+    
+    for(cnt=0; cnt<load_target_amount; cnt++)
+    {
+        pthread_join(threads[cnt], (void **)0);
+    }
+    
+    samples = (uint32_t *)calloc((size_t)load_count * load_target_amount, sizeof(uint32_t));
+    
+    printf("target,requests,errors,timeouts,rps,p50_us,p90_us,p99_us,max_us\n");
+    
+    for(cnt=0; cnt<load_target_amount; cnt++)
+    {
+        struct __load_target *target = &load_targets[cnt];
+        
+        if(samples)
+        {
+            memcpy(samples + requests, target->latency, target->requests * sizeof(uint32_t));
+        }
+        
+        requests += target->requests;
+        errors += target->errors;
+        timeouts += target->timeouts;
+        
+        if(target->elapsed > elapsed)
+        {
+            elapsed = target->elapsed;
+        }
+        
+        load_report(target->name, target->latency, target->requests, target->errors, target->timeouts, target->elapsed);
+        load_close(target);
+        free(target->latency);
+    }
+    
+    if(samples && (load_target_amount > 1))
+    {
+        //еУһʱ
+        load_report("total", samples, requests, errors, timeouts, elapsed);
+    }
+    
+    free(samples);
+    
+    return((errors || timeouts) ? 2 : 0);
+}
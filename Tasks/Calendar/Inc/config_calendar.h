@@ -5,6 +5,9 @@
 /* Includes ------------------------------------------------------------------*/
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
+#define CALENDAR_COMPILE_DAYS       ((uint8_t)7) //ÿԤлǰһ죩
+#define CALENDAR_SWITCH_MAX         ((CALENDAR_COMPILE_DAYS + 1) * CALENDER_MAX_DAY_POINT) //л
+
 /* Exported macro ------------------------------------------------------------*/
 #define NAME_CALENDAR   "task_calendar"
 
@@ -10,5 +10,6 @@
 /* Exported constants --------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
 /* Exported function prototypes ----------------------------------------------*/
+extern const struct __task_sched task_calendar;
 
 #endif /* __TASK_CALENDAR_H__ */
@@ -22,7 +22,7 @@
 #define CALENDER_MAX_INTERVAL               (50)        //ʱ1~24
 
 /**
- * @brief		
+ * @brief		ڼ  Ԫأʹõ selection year Ϊ 0xff ʾÿ
  **/
 struct __festival_entry
 {
@@ -43,7 +43,7 @@ struct __calender_festival_table
 
 
 /**
- * @brief		/  Ԫ
+ * @brief		/  Ԫأ month/day ÿ꣩ʹõ selection ܱ
  **/
 struct __month_entry
 {
@@ -87,7 +87,7 @@ struct __calender_week_table
 
 
 /**
- * @brief		  Ԫ1
+ * @brief		  Ԫ1 hour:min л selectionhour Ϊ 0xff ʾʱЧ
  **/
 struct __day_entry_point
 {
@@ -193,6 +193,8 @@ struct __calender_interface
             
         }                           day;
         
+        enum __calender_res         (*activate)(void); //лΪǰ
+        
     }                               passive;
     struct
     {
@@ -9,30 +9,987 @@
 #include "task_calendar.h"
 #include "types_calendar.h"
 #include "config_calendar.h"
+#include "types_timed.h"
+#include "types_metering.h"
+
+#include "rtc.h"
+#include "jiffy.h"
 
 /* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  洢ṹ
+  */
+struct __calendar_param
+{
+    struct __calender_table         active; //ǰ
+    struct __calender_table         passive; //
+};
+
+/**
+  * @brief  л
+  */
+struct __calendar_switch
+{
+    uint32_t                        stamp; //лʱ
+    uint8_t                         rate; //лķ
+};
+
 /* Private define ------------------------------------------------------------*/
+#define CALENDAR_DAY_SECONDS        ((uint32_t)86400)
+#define CALENDAR_RETRY_SECONDS      ((uint32_t)60) //лʧܺԼ
+
 /* Private macro -------------------------------------------------------------*/
+#define PASSIVE_OFFSET(member)      STRUCT_OFFSET(struct __calendar_param, passive.member)
+#define ACTIVE_OFFSET(member)       STRUCT_OFFSET(struct __calendar_param, active.member)
+#define TABLE_OFFSET(member)        STRUCT_OFFSET(struct __calendar_param, member)
+
 /* Private variables ---------------------------------------------------------*/
+static enum __task_status status = TASK_NOTINIT;
+
+/**
+  * @brief  Ԥķлʱ
+  */
+static struct __calendar_switch switches[CALENDAR_SWITCH_MAX];
+static uint16_t switch_amount = 0;
+static uint32_t window_begin = 0; //лǵʼʱ
+static uint32_t window_end = 0; //лǵĽʱ
+static uint8_t armed = 0; //һлѵǼǵʱ
+
 /* Private function prototypes -----------------------------------------------*/
+static void calendar_switch(void);
+static void calendar_changed(void);
+
 /* Private functions ---------------------------------------------------------*/
+/**
+  * @brief   1970-01-01 õ
+  */
+static void civil_from_days(uint32_t days, uint16_t *year, uint8_t *month, uint8_t *day)
+{
+    uint32_t era;
+    uint32_t doe;
+    uint32_t yoe;
+    uint32_t doy;
+    uint32_t mp;
+    
+    days += 719468;
+    era = days / 146097;
+    doe = days - era * 146097;
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp = (5 * doy + 2) / 153;
+    
+    *day = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+    *month = (uint8_t)((mp < 10)? (mp + 3) : (mp - 9));
+    *year = (uint16_t)(yoe + era * 400 + (*month <= 2));
+}
+
+/**
+  * @brief  ָʹõ
+  * @retval 0xff ʾûЧ
+  */
+static uint8_t calendar_day_profile(const struct __calender_table *table, uint32_t days)
+{
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t cnt;
+    uint8_t season = 0xff;
+    uint16_t start;
+    uint16_t best = 0;
+    uint16_t last = 0;
+    uint8_t wrap = 0xff;
+    const uint8_t *week;
+    
+    civil_from_days(days, &year, &month, &day);
+    
+    //ڼ
+    for(cnt=0; (cnt<table->festival.activated) && (cnt<CALENDER_MAX_FESTIVAL); cnt++)
+    {
+        if((table->festival.table[cnt].month != month) || (table->festival.table[cnt].day != day))
+        {
+            continue;
+        }
+        
+        if((table->festival.table[cnt].year != 0xff) && ((table->festival.table[cnt].year + 2000) != year))
+        {
+            continue;
+        }
+        
+        return(table->festival.table[cnt].selection);
+    }
+    
+    //ǰΪʼڲڽһڣûʱһһ
+    for(cnt=0; (cnt<table->month.activated) && (cnt<CALENDER_MAX_MONTH); cnt++)
+    {
+        start = ((uint16_t)table->month.table[cnt].month << 8) + table->month.table[cnt].day;
+        
+        if((start <= (((uint16_t)month << 8) + day)) && ((season == 0xff) || (start >= best)))
+        {
+            season = cnt;
+            best = start;
+        }
+        
+        if((wrap == 0xff) || (start >= last))
+        {
+            wrap = cnt;
+            last = start;
+        }
+    }
+    
+    if(season == 0xff)
+    {
+        season = wrap;
+    }
+    
+    if((season == 0xff) || (table->month.table[season].selection >= table->week.activated))
+    {
+        return(0xff);
+    }
+    
+    //ܱ ~ У1970-01-01 Ϊ
+    week = (const uint8_t *)&table->week.table[table->month.table[season].selection];
+    
+    return(week[(days + 4) % 7]);
+}
+
+/**
+  * @brief   [begin, begin + CALENDAR_COMPILE_DAYS + 1) ڵл switches
+  */
+static void calendar_compile(uint32_t now)
+{
+    struct __calender_table *table;
+    const struct __day_entry *entry;
+    uint32_t days;
+    uint32_t begin;
+    uint16_t minute;
+    uint16_t before;
+    uint8_t profile;
+    uint8_t cnt;
+    
+    switch_amount = 0;
+    begin = now / CALENDAR_DAY_SECONDS;
+    begin = begin? (begin - 1) : 0;
+    window_begin = begin * CALENDAR_DAY_SECONDS;
+    window_end = (begin + CALENDAR_COMPILE_DAYS + 1) * CALENDAR_DAY_SECONDS;
+    
+    table = heap.dalloc(sizeof(struct __calender_table));
+    
+    if(!table)
+    {
+        //ڴ治ʱոǷΧԺ
+        window_end = window_begin;
+        return;
+    }
+    
+    if(file.parameter.read("calendar", \
+                            TABLE_OFFSET(active), \
+                            sizeof(struct __calender_table), \
+                            table) != sizeof(struct __calender_table))
+    {
+        //ȡʧʱͬԺ
+        window_end = window_begin;
+        heap.free(table);
+        return;
+    }
+    
+    for(days=begin; days<(begin + CALENDAR_COMPILE_DAYS + 1); days++)
+    {
+        profile = calendar_day_profile(table, days);
+        
+        if((profile == 0xff) || (profile >= table->day.activated) || (profile >= CALENDER_MAX_DAY))
+        {
+            continue;
+        }
+        
+        entry = &table->day.table[profile];
+        before = 0;
+        
+        for(cnt=0; cnt<CALENDER_MAX_DAY_POINT; cnt++)
+        {
+            if((entry->point[cnt].hour >= 24) || (entry->point[cnt].min >= 60))
+            {
+                break;
+            }
+            
+            minute = entry->point[cnt].hour * 60 + entry->point[cnt].min;
+            
+            //ʱα
+            if(cnt && (minute <= before))
+            {
+                break;
+            }
+            
+            before = minute;
+            
+            //δ仯л㲻Ҫ
+            if(switch_amount && (switches[switch_amount - 1].rate == entry->point[cnt].selection))
+            {
+                continue;
+            }
+            
+            //ʱӸл´±
+            if(switch_amount >= CALENDAR_SWITCH_MAX)
+            {
+                window_end = days * CALENDAR_DAY_SECONDS + (uint32_t)minute * 60;
+                heap.free(table);
+                return;
+            }
+            
+            switches[switch_amount].stamp = days * CALENDAR_DAY_SECONDS + (uint32_t)minute * 60;
+            switches[switch_amount].rate = entry->point[cnt].selection;
+            switch_amount += 1;
+        }
+    }
+    
+    heap.free(table);
+}
+
+/**
+  * @brief  ֲҲ now һл
+  * @retval лswitch_amount ʾ now ȫл
+  */
+static uint16_t calendar_search(uint32_t now)
+{
+    uint16_t low = 0;
+    uint16_t high = switch_amount;
+    uint16_t middle;
+    
+    while(low < high)
+    {
+        middle = low + (high - low) / 2;
+        
+        if(switches[middle].stamp <= now)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    
+    return(low? (low - 1) : switch_amount);
+}
+
+/**
+  * @brief  ɵǰʱƵЧʣǼһл
+  */
+static void calendar_apply(void)
+{
+    struct __metering *metering = api("task_metering");
+    struct __timed *timed = api("task_timed");
+    struct __timed_conf conf;
+    uint32_t now;
+    uint32_t next;
+    uint16_t index;
+    
+    armed = 0;
+    now = (uint32_t)rtc.read();
+    
+    if(!now || !timed)
+    {
+        return;
+    }
+    
+    if((now < window_begin) || (now >= window_end))
+    {
+        calendar_compile(now);
+    }
+    
+    index = calendar_search(now);
+    
+    if(index < switch_amount)
+    {
+        if(metering && (metering->config.rate.read() != switches[index].rate))
+        {
+            metering->config.rate.change(switches[index].rate);
+        }
+        
+        next = ((index + 1) < switch_amount)? switches[index + 1].stamp : window_end;
+    }
+    else
+    {
+        next = switch_amount? switches[0].stamp : window_end;
+    }
+    
+    //лʧʱԺ
+    if(window_end <= window_begin)
+    {
+        next = now + CALENDAR_RETRY_SECONDS;
+    }
+    
+    //ǷΧûлʱʱ±
+    if(next <= now)
+    {
+        next = now + CALENDAR_DAY_SECONDS;
+    }
+    
+    conf.callback = calendar_switch;
+    conf.period = next;
+    conf.flags = TIMD_FLAG_ABSOLUTE | TIMD_FLAG_ONCE;
+    timed->remove(&conf);
+    
+    if(timed->create(&conf) == TIMD_SUCCESS)
+    {
+        armed = 0xff;
+    }
+}
+
+/**
+  * @brief  лʱ̵
+  */
+static void calendar_switch(void)
+{
+    calendar_apply();
+}
 
+/**
+  * @brief  ϵͳʱӱ޸ģƵЧ
+  */
+static void calendar_changed(void)
+{
+    calendar_apply();
+}
 
 /**
-
-ȡ
+  * @brief  
+  */
+static uint8_t calendar_table_amount(uint32_t offset, uint8_t max)
+{
+    uint8_t amount = 0;
+    
+    if(file.parameter.read("calendar", offset, sizeof(amount), &amount) != sizeof(amount))
+    {
+        return(0);
+    }
+    
+    return((amount > max)? max : amount);
+}
 
-ýڼձ
-ȡڼձ
+/**
+  * @brief  
+  */
+static uint8_t calendar_table_resize(uint32_t offset, uint8_t max, uint8_t amount)
+{
+    if(amount > max)
+    {
+        amount = max;
+    }
+    
+    if(file.parameter.write("calendar", offset, sizeof(amount), &amount) != sizeof(amount))
+    {
+        return(calendar_table_amount(offset, max));
+    }
+    
+    return(amount);
+}
 
-ȡǰķ
-**/
+/**
+  * @brief  
+  */
+static enum __calender_res calendar_table_read(uint32_t offset, uint32_t size, void *val)
+{
+    if(!val)
+    {
+        return(CALENDER_ERR_NODEF);
+    }
+    
+    if(file.parameter.read("calendar", offset, size, val) != size)
+    {
+        heap.set(val, 0, size);
+    }
+    
+    return(CALENDER_SUCCESS);
+}
 
+/**
+  * @brief  
+  */
+static enum __calender_res calendar_table_write(uint32_t offset, uint32_t size, const void *val)
+{
+    if(file.parameter.write("calendar", offset, size, val) != size)
+    {
+        return(CALENDER_ERR_NODEF);
+    }
+    
+    return(CALENDER_SUCCESS);
+}
 
 /**
   * @brief  
   */
+static enum __calender_res calendar_table_clear(uint32_t offset, uint32_t size)
+{
+    uint8_t zero[32];
+    uint32_t length;
+    
+    heap.set(zero, 0, sizeof(zero));
+    
+    while(size)
+    {
+        length = (size > sizeof(zero))? sizeof(zero) : size;
+        
+        if(file.parameter.write("calendar", offset, length, zero) != length)
+        {
+            return(CALENDER_ERR_NODEF);
+        }
+        
+        offset += length;
+        size -= length;
+    }
+    
+    return(CALENDER_SUCCESS);
+}
 
+/**
+  * @brief  
+  */
+static uint8_t passive_special_get_amount(void)
+{
+    return(calendar_table_amount(PASSIVE_OFFSET(festival.activated), CALENDER_MAX_FESTIVAL));
+}
 
+static uint8_t passive_special_set_amount(uint8_t amount)
+{
+    return(calendar_table_resize(PASSIVE_OFFSET(festival.activated), CALENDER_MAX_FESTIVAL, amount));
+}
+
+static enum __calender_res passive_special_get_entry(uint8_t index, struct __festival_entry *val)
+{
+    if(index >= CALENDER_MAX_FESTIVAL)
+    {
+        return(CALENDER_ERR_INDEX);
+    }
+    
+    return(calendar_table_read(PASSIVE_OFFSET(festival.table[index]), sizeof(struct __festival_entry), val));
+}
+
+static enum __calender_res passive_special_set_entry(uint8_t index, const struct __festival_entry *val)
+{
+    if(index >= CALENDER_MAX_FESTIVAL)
+    {
+        return(CALENDER_ERR_INDEX);
+    }
+    
+    if(!val)
+    {
+        return(CALENDER_ERR_NODEF);
+    }
+    
+    if((val->year != 0xff) && (val->year > 99))
+    {
+        return(CALENDER_ERR_DATE);
+    }
+    
+    if((val->month < 1) || (val->month > 12) || (val->day < 1) || (val->day > 31))
+    {
+        return(CALENDER_ERR_DATE);
+    }
+    
+    if(val->selection >= CALENDER_MAX_DAY)
+    {
+        return(CALENDER_ERR_GROUP);
+    }
+    
+    return(calendar_table_write(PASSIVE_OFFSET(festival.table[index]), sizeof(struct __festival_entry), val));
+}
+
+static enum __calender_res passive_special_clear(void)
+{
+    return(calendar_table_clear(PASSIVE_OFFSET(festival), STRUCT_SIZE(struct __calendar_param, passive.festival)));
+}
+
+/**
+  * @brief  
+  */
+static uint8_t passive_month_get_amount(void)
+{
+    return(calendar_table_amount(PASSIVE_OFFSET(month.activated), CALENDER_MAX_MONTH));
+}
+
+static uint8_t passive_month_set_amount(uint8_t amount)
+{
+    return(calendar_table_resize(PASSIVE_OFFSET(month.activated), CALENDER_MAX_MONTH, amount));
+}
+
+static enum __calender_res passive_month_get_entry(uint8_t index, struct __month_entry *val)
+{
+    if(index >= CALENDER_MAX_MONTH)
+    {
+        return(CALENDER_ERR_INDEX);
+    }
+    
+    return(calendar_table_read(PASSIVE_OFFSET(month.table[index]), sizeof(struct __month_entry), val));
+}
+
+static enum __calender_res passive_month_set_entry(uint8_t index, const struct __month_entry *val)
+{
+    if(index >= CALENDER_MAX_MONTH)
+    {
+        return(CALENDER_ERR_INDEX);
+    }
+    
+    if(!val)
+    {
+        return(CALENDER_ERR_NODEF);
+    }
+    
+    if((val->month < 1) || (val->month > 12) || (val->day < 1) || (val->day > 31))
+    {
+        return(CALENDER_ERR_DATE);
+    }
+    
+    if(val->selection >= CALENDER_MAX_WEEK)
+    {
+        return(CALENDER_ERR_GROUP);
+    }
+    
+    return(calendar_table_write(PASSIVE_OFFSET(month.table[index]), sizeof(struct __month_entry), val));
+}
+
+static enum __calender_res passive_month_clear(void)
+{
+    return(calendar_table_clear(PASSIVE_OFFSET(month), STRUCT_SIZE(struct __calendar_param, passive.month)));
+}
+
+/**
+  * @brief  
+  */
+static uint8_t passive_week_get_amount(void)
+{
+    return(calendar_table_amount(PASSIVE_OFFSET(week.activated), CALENDER_MAX_WEEK));
+}
 
+static uint8_t passive_week_set_amount(uint8_t amount)
+{
+    return(calendar_table_resize(PASSIVE_OFFSET(week.activated), CALENDER_MAX_WEEK, amount));
+}
 
+static enum __calender_res passive_week_get_entry(uint8_t index, struct __week_entry *val)
+{
+    if(index >= CALENDER_MAX_WEEK)
+    {
+        return(CALENDER_ERR_INDEX);
+    }
+    
+    return(calendar_table_read(PASSIVE_OFFSET(week.table[index]), sizeof(struct __week_entry), val));
+}
+
+static enum __calender_res passive_week_set_entry(uint8_t index, const struct __week_entry *val)
+{
+    const uint8_t *day = (const uint8_t *)val;
+    uint8_t cnt;
+    
+    if(index >= CALENDER_MAX_WEEK)
+    {
+        return(CALENDER_ERR_INDEX);
+    }
+    
+    if(!val)
+    {
+        return(CALENDER_ERR_NODEF);
+    }
+    
+    for(cnt=0; cnt<sizeof(struct __week_entry); cnt++)
+    {
+        if(day[cnt] >= CALENDER_MAX_DAY)
+        {
+            return(CALENDER_ERR_GROUP);
+        }
+    }
+    
+    return(calendar_table_write(PASSIVE_OFFSET(week.table[index]), sizeof(struct __week_entry), val));
+}
+
+static enum __calender_res passive_week_clear(void)
+{
+    return(calendar_table_clear(PASSIVE_OFFSET(week), STRUCT_SIZE(struct __calendar_param, passive.week)));
+}
+
+/**
+  * @brief  
+  */
+static uint8_t passive_day_get_amount(void)
+{
+    return(calendar_table_amount(PASSIVE_OFFSET(day.activated), CALENDER_MAX_DAY));
+}
+
+static uint8_t passive_day_set_amount(uint8_t amount)
+{
+    return(calendar_table_resize(PASSIVE_OFFSET(day.activated), CALENDER_MAX_DAY, amount));
+}
+
+static enum __calender_res passive_day_get_entry(uint8_t index, struct __day_entry *val)
+{
+    if(index >= CALENDER_MAX_DAY)
+    {
+        return(CALENDER_ERR_INDEX);
+    }
+    
+    return(calendar_table_read(PASSIVE_OFFSET(day.table[index]), sizeof(struct __day_entry), val));
+}
+
+static enum __calender_res passive_day_set_entry(uint8_t index, const struct __day_entry *val)
+{
+    struct __metering *metering = api("task_metering");
+    uint16_t minute;
+    uint16_t before = 0;
+    uint8_t cnt;
+    
+    if(index >= CALENDER_MAX_DAY)
+    {
+        return(CALENDER_ERR_INDEX);
+    }
+    
+    if(!val)
+    {
+        return(CALENDER_ERR_NODEF);
+    }
+    
+    for(cnt=0; cnt<CALENDER_MAX_DAY_POINT; cnt++)
+    {
+        //ʱЧ
+        if(val->point[cnt].hour == 0xff)
+        {
+            break;
+        }
+        
+        if((val->point[cnt].hour >= 24) || (val->point[cnt].min >= 60))
+        {
+            return(CALENDER_ERR_TIME);
+        }
+        
+        minute = val->point[cnt].hour * 60 + val->point[cnt].min;
+        
+        if(cnt && (minute <= before))
+        {
+            return(CALENDER_ERR_RELATION);
+        }
+        
+        before = minute;
+        
+        if(metering && (val->point[cnt].selection >= metering->config.rate.max()))
+        {
+            return(CALENDER_ERR_GROUP);
+        }
+    }
+    
+    return(calendar_table_write(PASSIVE_OFFSET(day.table[index]), sizeof(struct __day_entry), val));
+}
+
+static enum __calender_res passive_day_clear(void)
+{
+    return(calendar_table_clear(PASSIVE_OFFSET(day), STRUCT_SIZE(struct __calendar_param, passive.day)));
+}
+
+/**
+  * @brief  Ϊǰ±л
+  */
+static enum __calender_res passive_activate(void)
+{
+    struct __calender_table *table;
+    enum __calender_res result;
+    
+    table = heap.dalloc(sizeof(struct __calender_table));
+    
+    if(!table)
+    {
+        return(CALENDER_ERR_NODEF);
+    }
+    
+    //ñȡʧʱܼǰᱻ
+    if(file.parameter.read("calendar", \
+                            TABLE_OFFSET(passive), \
+                            sizeof(struct __calender_table), \
+                            table) != sizeof(struct __calender_table))
+    {
+        heap.free(table);
+        return(CALENDER_ERR_NODEF);
+    }
+    
+    result = calendar_table_write(TABLE_OFFSET(active), sizeof(struct __calender_table), table);
+    heap.free(table);
+    
+    if(result != CALENDER_SUCCESS)
+    {
+        return(result);
+    }
+    
+    window_begin = 0;
+    window_end = 0;
+    calendar_apply();
+    
+    return(CALENDER_SUCCESS);
+}
+
+/**
+  * @brief  
+  */
+static uint8_t active_special_get_amount(void)
+{
+    return(calendar_table_amount(ACTIVE_OFFSET(festival.activated), CALENDER_MAX_FESTIVAL));
+}
+
+static enum __calender_res active_special_get_entry(uint8_t index, struct __festival_entry *val)
+{
+    if(index >= CALENDER_MAX_FESTIVAL)
+    {
+        return(CALENDER_ERR_INDEX);
+    }
+    
+    return(calendar_table_read(ACTIVE_OFFSET(festival.table[index]), sizeof(struct __festival_entry), val));
+}
+
+static uint8_t active_month_get_amount(void)
+{
+    return(calendar_table_amount(ACTIVE_OFFSET(month.activated), CALENDER_MAX_MONTH));
+}
+
+static enum __calender_res active_month_get_entry(uint8_t index, struct __month_entry *val)
+{
+    if(index >= CALENDER_MAX_MONTH)
+    {
+        return(CALENDER_ERR_INDEX);
+    }
+    
+    return(calendar_table_read(ACTIVE_OFFSET(month.table[index]), sizeof(struct __month_entry), val));
+}
+
+static uint8_t active_week_get_amount(void)
+{
+    return(calendar_table_amount(ACTIVE_OFFSET(week.activated), CALENDER_MAX_WEEK));
+}
+
+static enum __calender_res active_week_get_entry(uint8_t index, struct __week_entry *val)
+{
+    if(index >= CALENDER_MAX_WEEK)
+    {
+        return(CALENDER_ERR_INDEX);
+    }
+    
+    return(calendar_table_read(ACTIVE_OFFSET(week.table[index]), sizeof(struct __week_entry), val));
+}
+
+static uint8_t active_day_get_amount(void)
+{
+    return(calendar_table_amount(ACTIVE_OFFSET(day.activated), CALENDER_MAX_DAY));
+}
+
+static enum __calender_res active_day_get_entry(uint8_t index, struct __day_entry *val)
+{
+    if(index >= CALENDER_MAX_DAY)
+    {
+        return(CALENDER_ERR_INDEX);
+    }
+    
+    return(calendar_table_read(ACTIVE_OFFSET(day.table[index]), sizeof(struct __day_entry), val));
+}
+
+/**
+  * @brief  ǰµЧʣO(log n) 
+  */
+static uint8_t active_rate(void)
+{
+    struct __metering *metering = api("task_metering");
+    uint32_t now = (uint32_t)rtc.read();
+    uint16_t index;
+    
+    if(now && (now >= window_begin) && (now < window_end))
+    {
+        index = calendar_search(now);
+        
+        if(index < switch_amount)
+        {
+            return(switches[index].rate);
+        }
+    }
+    
+    return(metering? metering->config.rate.read() : 0);
+}
+
+/**
+  * @brief  
+  */
+static const struct __calender_interface calendar = 
+{
+    .passive            =
+    {
+        .special        =
+        {
+            .get_amount = passive_special_get_amount,
+            .set_amount = passive_special_set_amount,
+            .get_entry  = passive_special_get_entry,
+            .set_entry  = passive_special_set_entry,
+            .clear      = passive_special_clear,
+        },
+        .month          =
+        {
+            .get_amount = passive_month_get_amount,
+            .set_amount = passive_month_set_amount,
+            .get_entry  = passive_month_get_entry,
+            .set_entry  = passive_month_set_entry,
+            .clear      = passive_month_clear,
+        },
+        .week           =
+        {
+            .get_amount = passive_week_get_amount,
+            .set_amount = passive_week_set_amount,
+            .get_entry  = passive_week_get_entry,
+            .set_entry  = passive_week_set_entry,
+            .clear      = passive_week_clear,
+        },
+        .day            =
+        {
+            .get_amount = passive_day_get_amount,
+            .set_amount = passive_day_set_amount,
+            .get_entry  = passive_day_get_entry,
+            .set_entry  = passive_day_set_entry,
+            .clear      = passive_day_clear,
+        },
+        .activate       = passive_activate,
+    },
+    .active             =
+    {
+        .special        =
+        {
+            .get_amount = active_special_get_amount,
+            .get_entry  = active_special_get_entry,
+        },
+        .month          =
+        {
+            .get_amount = active_month_get_amount,
+            .get_entry  = active_month_get_entry,
+        },
+        .week           =
+        {
+            .get_amount = active_week_get_amount,
+            .get_entry  = active_week_get_entry,
+        },
+        .day            =
+        {
+            .get_amount = active_day_get_amount,
+            .get_entry  = active_day_get_entry,
+        },
+        .rate           = active_rate,
+    },
+};
+
+
+
+
+
+
+/**
+  * @brief  
+  */
+static void calendar_init(void)
+{
+    struct __timed *timed;
+    struct __timed_conf conf;
+	
+	//ֻϵ״̬²У״̬²
+    if(system_status() == SYSTEM_RUN)
+    {
+        switch_amount = 0;
+        window_begin = 0;
+        window_end = 0;
+        armed = 0;
+        
+        //ϵͳʱӱ޸ʱƵ
+        timed = api("task_timed");
+        
+        if(timed)
+        {
+            conf.callback = calendar_changed;
+            conf.period = 0;
+            conf.flags = TIMD_FLAG_CHANGE;
+            timed->remove(&conf);
+            timed->create(&conf);
+        }
+        
+        //ϵʱƵǰ
+        calendar_apply();
+        
+        status = TASK_INIT;
+        
+        TRACE(TRACE_INFO, "Task calendar initialized.");
+    }
+}
+
+/**
+  * @brief  
+  */
+static void calendar_loop(void)
+{
+    static uint32_t timing = 0;
+	
+	//ֻϵ״̬²У״̬²
+    if(system_status() == SYSTEM_RUN)
+    {
+        //лɶʱֻڵǼʧܣʱδʱÿ
+        if(!armed && (jiffy.after(timing) >= 1000))
+        {
+            timing = jiffy.value();
+            calendar_apply();
+        }
+        
+        status = TASK_RUN;
+    }
+}
+
+/**
+  * @brief  
+  */
+static void calendar_exit(void)
+{
+    struct __timed *timed = api("task_timed");
+    struct __timed_conf conf;
+    
+    if(timed)
+    {
+        conf.callback = calendar_switch;
+        timed->remove(&conf);
+        conf.callback = calendar_changed;
+        timed->remove(&conf);
+    }
+    
+    armed = 0;
+	status = TASK_SUSPEND;
+    
+    TRACE(TRACE_INFO, "Task calendar exited.");
+}
+
+/**
+  * @brief  
+  */
+static void calendar_reset(void)
+{
+	status = TASK_NOTINIT;
+    
+    TRACE(TRACE_INFO, "Task calendar reset.");
+}
+
+/**
+  * @brief  
+  */
+static enum __task_status calendar_status(void)
+{
+    return(status);
+}
+
+
+/**
+  * @brief  
+  */
+const struct __task_sched task_calendar = 
+{
+    .name               = NAME_CALENDAR,
+    .init               = calendar_init,
+    .loop               = calendar_loop,
+    .exit               = calendar_exit,
+    .reset              = calendar_reset,
+    .status             = calendar_status,
+    .period             = 1000,
+    .phase              = 750,
+    .api                = (void *)&calendar,
+};
@@ -8,6 +8,11 @@
 /* Exported macro ------------------------------------------------------------*/
 #define NAME_CONSOLE   "task_console"
 
+#define CONSOLE_HOOK_COUNT              ((int)1000)         //ÿִжָһνűԤ
+#define CONSOLE_SLICE_INSTRUCTIONS      ((uint32_t)200000)  //ÿڽűִеָ
+#define CONSOLE_SLICE_TIME              ((uint32_t)10)      //ÿڽűռõʱ䣨룩ԼΪڵ֮һ
+#define CONSOLE_SCRIPT_CACHE            ((uint8_t)4)        //ѱűĻ
+
 /* Exported function prototypes ----------------------------------------------*/
 
 #endif /* __CONFIG_CONSOLE_H__ */
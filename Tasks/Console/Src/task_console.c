@@ -20,10 +20,13 @@
 #endif
 
 #include "console.h"
+#include "jiffy.h"
 #include "lua.h"
 #include "lauxlib.h"
 #include "lualib.h"
+#include "lstate.h"
 #include "stdio.h"
+#include <sys/stat.h>
 #include "stdlib.h"
 #include "info.h"
 #include "power.h"
@@ -43,6 +46,18 @@
 #include "vm_timed.h"
 
 /* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  ѱű棬Ժʽע
+  */
+struct __script_cache
+{
+	char			path[256];
+	time_t			mtime;
+	off_t			size;
+	int				ref;
+	uint32_t		used;
+};
+
 /* Private define ------------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 #define TREE_LIST_SIZE	((uint16_t)(sizeof(tree_list) / sizeof(const luaL_Reg *)))
@@ -69,6 +84,14 @@ static const luaL_Reg *const tree_list[] =
 static volatile uint8_t blocked = 0;
 static char script_path[256] = {0};
 
+static lua_State *lua_main = (lua_State *)0; //פ Lua л
+static lua_State *lua_co = (lua_State *)0; //еĽűЭ
+static int lua_co_ref = LUA_NOREF;
+static uint32_t slice_begin = 0;
+static uint32_t slice_count = 0;
+static uint32_t cache_used = 0;
+static struct __script_cache script_cache[CONSOLE_SCRIPT_CACHE];
+
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 static void luaL_opentrees(lua_State *L)
@@ -83,21 +106,180 @@ static void luaL_opentrees(lua_State *L)
 	}
 }
 
-static void luaL_execute(char *file)
+/**
+  * @brief  ÿ CONSOLE_HOOK_COUNT ָһԤ㣬ڷݶʱóЭ
+  */
+static void luaL_budget(lua_State *L, lua_Debug *ar)
 {
-	lua_State *L;
+	slice_count += CONSOLE_HOOK_COUNT;
 	
-	L = luaL_newstate(); /* Luaл */
-    
-	if(!L)
+	if((slice_count < CONSOLE_SLICE_INSTRUCTIONS) && (jiffy.after(slice_begin) < CONSOLE_SLICE_TIME))
 	{
 		return;
 	}
-    
-	luaL_openlibs(L);
-	luaL_opentrees(L);
-	luaL_dofile(L, script_path); /* Luaű */
-	lua_close(L);
+	
+	// C ãpcallԪȣڲʱ޷óȴһμ
+	if(L->nCcalls > L->baseCcalls)
+	{
+		return;
+	}
+	
+	lua_yield(L, 0);
+}
+
+/**
+  * @brief  ؽűѹջļδıʱֱʹûı
+  */
+static int luaL_loadcached(lua_State *L, const char *file)
+{
+	struct stat st;
+	uint8_t cnt;
+	uint8_t slot = 0;
+	
+	if(stat(file, &st) != 0)
+	{
+		lua_pushfstring(L, "cannot open %s", file);
+		return(LUA_ERRFILE);
+	}
+	
+	//·¼ʱ棬ضϺű
+	if(strlen(file) >= sizeof(script_cache[0].path))
+	{
+		return(luaL_loadfile(L, file));
+	}
+	
+	cache_used += 1;
+	
+	for(cnt=0; cnt<CONSOLE_SCRIPT_CACHE; cnt++)
+	{
+		if((script_cache[cnt].ref != LUA_NOREF) && (strcmp(script_cache[cnt].path, file) == 0))
+		{
+			if((script_cache[cnt].mtime == st.st_mtime) && (script_cache[cnt].size == st.st_size))
+			{
+				script_cache[cnt].used = cache_used;
+				lua_rawgeti(L, LUA_REGISTRYINDEX, script_cache[cnt].ref);
+				return(0);
+			}
+			
+			//ļ޸ģ±
+			slot = cnt;
+			break;
+		}
+		
+		//ѡлδʹõĻ
+		if((script_cache[cnt].ref == LUA_NOREF) || \
+			((script_cache[slot].ref != LUA_NOREF) && (script_cache[cnt].used < script_cache[slot].used)))
+		{
+			slot = cnt;
+		}
+	}
+	
+	if(luaL_loadfile(L, file) != 0)
+	{
+		return(LUA_ERRSYNTAX);
+	}
+	
+	luaL_unref(L, LUA_REGISTRYINDEX, script_cache[slot].ref);
+	lua_pushvalue(L, -1);
+	script_cache[slot].ref = luaL_ref(L, LUA_REGISTRYINDEX);
+	snprintf(script_cache[slot].path, sizeof(script_cache[slot].path), "%s", file);
+	script_cache[slot].mtime = st.st_mtime;
+	script_cache[slot].size = st.st_size;
+	script_cache[slot].used = cache_used;
+	
+	return(0);
+}
+
+/**
+  * @brief  ͷųפ Lua л
+  */
+static void luaL_release(void)
+{
+	uint8_t cnt;
+	
+	if(lua_main)
+	{
+		lua_close(lua_main);
+	}
+	
+	lua_main = (lua_State *)0;
+	lua_co = (lua_State *)0;
+	lua_co_ref = LUA_NOREF;
+	
+	for(cnt=0; cnt<CONSOLE_SCRIPT_CACHE; cnt++)
+	{
+		script_cache[cnt].ref = LUA_NOREF;
+	}
+}
+
+/**
+  * @brief  ڳפлΪűЭ
+  */
+static bool luaL_execute(char *file)
+{
+	if(!lua_main)
+	{
+		lua_main = luaL_newstate(); /* Luaл */
+		
+		if(!lua_main)
+		{
+			return(false);
+		}
+		
+		luaL_openlibs(lua_main);
+		luaL_opentrees(lua_main);
+	}
+	
+	lua_co = lua_newthread(lua_main);
+	lua_co_ref = luaL_ref(lua_main, LUA_REGISTRYINDEX);
+	
+	if(luaL_loadcached(lua_co, file) != 0)
+	{
+		TRACE(TRACE_WARN, "Script load failed: %s", lua_tostring(lua_co, -1));
+		luaL_unref(lua_main, LUA_REGISTRYINDEX, lua_co_ref);
+		lua_co = (lua_State *)0;
+		lua_co_ref = LUA_NOREF;
+		return(false);
+	}
+	
+	lua_sethook(lua_co, luaL_budget, LUA_MASKCOUNT, CONSOLE_HOOK_COUNT);
+	
+	return(true);
+}
+
+/**
+  * @brief  ָнűЭһʱƬűʱ true
+  */
+static bool luaL_continue(void)
+{
+	int result;
+	
+	if(!lua_co)
+	{
+		return(true);
+	}
+	
+	slice_begin = jiffy.value();
+	slice_count = 0;
+	
+	result = lua_resume(lua_co, 0); /* Luaű */
+	
+	if(result == LUA_YIELD)
+	{
+		return(false);
+	}
+	
+	if(result != 0)
+	{
+		TRACE(TRACE_WARN, "Script error: %s", lua_tostring(lua_co, -1));
+	}
+	
+	luaL_unref(lua_main, LUA_REGISTRYINDEX, lua_co_ref);
+	lua_co = (lua_State *)0;
+	lua_co_ref = LUA_NOREF;
+	lua_gc(lua_main, LUA_GCCOLLECT, 0);
+	
+	return(true);
 }
 
 
@@ -340,6 +522,13 @@ CMD_EXIT:
   */
 static void console_init(void)
 {
+    uint8_t cnt;
+    
+    for(cnt=0; cnt<CONSOLE_SCRIPT_CACHE; cnt++)
+    {
+        script_cache[cnt].ref = LUA_NOREF;
+    }
+    
     console.control.init(DEVICE_NORMAL);
     console.handler.filling(command_received);
     TRACE(TRACE_INFO, "Task console initialized.");
@@ -364,9 +553,19 @@ static void console_loop(void)
 	{
 		return;
 	}
-	else
+	
+	//űЭ̷ʽУÿִֻһʱƬ
+	if(!lua_co)
+	{
+		if(!luaL_execute(script_path))
+		{
+			heap.set(script_path, 0, sizeof(script_path));
+			return;
+		}
+	}
+	
+	if(luaL_continue())
 	{
-		luaL_execute(script_path);
 		heap.set(script_path, 0, sizeof(script_path));
 	}
 }
@@ -376,6 +575,8 @@ static void console_loop(void)
   */
 static void console_exit(void)
 {
+    luaL_release();
+    heap.set(script_path, 0, sizeof(script_path));
     console.handler.remove();
     console.control.suspend();
     
@@ -387,6 +588,8 @@ static void console_exit(void)
   */
 static void console_reset(void)
 {
+    luaL_release();
+    heap.set(script_path, 0, sizeof(script_path));
     console.handler.remove();
     console.control.suspend();
     
@@ -1090,16 +1090,17 @@ static void display_init(void)
 static void display_loop(void)
 {
 	struct __disp_entry entry;
-	
+	uint16_t elapsed = task_ctrl.elapsed();
+    
     if((system_status() == SYSTEM_RUN) || (system_status() == SYSTEM_WAKEUP))
     {
         status = TASK_RUN;
-        lcd.runner(KERNEL_PERIOD);
+        lcd.runner(elapsed);
         
         //ȫ֮ſʼʱˢ
         if(disp_runs.counter.start >= disp_runs.time.start)
         {
-            disp_runs.loop_flush += KERNEL_PERIOD;
+            disp_runs.loop_flush += elapsed;
         }
         
         //״̬£ֱӹرձ
@@ -1118,9 +1119,9 @@ static void display_loop(void)
 				lcd.backlight.open();
 			}
 			
-			if(disp_runs.insert_millisecond > KERNEL_PERIOD)
+			if(disp_runs.insert_millisecond > elapsed)
 			{
-				disp_runs.insert_millisecond -= KERNEL_PERIOD;
+				disp_runs.insert_millisecond -= elapsed;
 			}
 			else
 			{
@@ -1148,8 +1149,8 @@ static void display_loop(void)
 			return;
 		}
 		
-		disp_runs.loop_record += KERNEL_PERIOD;
-		
+		disp_runs.loop_record += elapsed;
+        
         //ʱ
 		if(disp_runs.loop_record > 999)
 		{
@@ -1355,6 +1356,7 @@ const struct __task_sched task_display =
     .exit               = display_exit,
     .reset              = display_reset,
     .status             = display_status,
+    .period             = 500,
     .api                = (void *)&display,
 };
 
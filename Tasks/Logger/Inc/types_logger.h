@@ -33,10 +33,35 @@ enum __event_status
     EVS_ENDED		= 0, //¼ѽ
 };
 
+/**
+  * @brief  ¼࣬ÿļ¼һζ
+  */
+enum __event_class
+{
+	EVC_STANDARD	= 0, //׼¼
+	EVC_POWER		= 1, //Դ¼
+	
+	EVC_MAX,
+};
+
+/**
+  * @brief  ¼¼
+  */
+struct __event_record
+{
+	uint64_t stamp; //¼ʱ
+	uint16_t id; //enum __event_id
+	uint16_t mapping; //ӳID
+	uint8_t status; //enum __event_status
+	uint8_t reserved[3];
+	int64_t snapshot[4]; //¼ʱļݣйܡйܡAѹA
+};
+
 
 /**
   * @brief  logger task Ķӿ
   *			void (*callback)(enum __event_id id, enum __event_status status, uint16_t mapping)
+  *			record.read  fromto ΪĿţһΪ 1to Ϊ 0 ʱһ DLMS entry_descriptor һ£
   */
 struct __logger
 {
@@ -53,6 +78,13 @@ struct __logger
 		
 	}								monitor;
 	
+	struct
+	{
+		uint32_t					(*amount)(enum __event_class cls); //ѱļ¼
+		uint32_t					(*read)(enum __event_class cls, uint32_t from, uint32_t to, struct __event_record *record, uint32_t size); //ĿΧȡ¼
+		
+	}								record;
+	
 	uint16_t						(*map)(enum __event_id id);
 	enum __event_id					(*unmap)(uint16_t mapping);
 };
@@ -10,11 +10,26 @@
 #include "task_logger.h"
 #include "types_logger.h"
 #include "config_logger.h"
+#include "types_metering.h"
 #include "crc.h"
+#include "rtc.h"
+#include "jiffy.h"
 
 /* Private define ------------------------------------------------------------*/
 #define MAX_MONITORS	((uint8_t)16)
 
+#if !defined ( LOGGER_STAGING_AMOUNT )
+#define LOGGER_STAGING_AMOUNT	((uint8_t)8) //ÿڴݴ¼¼
+#endif
+
+#if !defined ( LOGGER_COMMIT_LATENCY )
+#define LOGGER_COMMIT_LATENCY	((uint32_t)1000) //ݴ¼פʱ䣨msύ
+#endif
+
+#if !defined ( LOGGER_POWERUP_DELAY )
+#define LOGGER_POWERUP_DELAY	((uint32_t)2000) //ϵӳٴϵ¼msȴӼ
+#endif
+
 /* Private typedef -----------------------------------------------------------*/
 /**
   * @brief  ¼Ϊ
@@ -39,10 +54,12 @@ struct __logger_table
 	enum __event_id id; //¼ID
 	uint16_t mapping; //ӳID
 	uint16_t behaviors; //¼
+	enum __event_class cls; //¼
 };
 
 /**
   * @brief  ¼ǰ״̬
+  * check Ϊ value ֽۼӺȡ¼仯ʱ
   */
 struct __logger_status
 {
@@ -52,13 +69,25 @@ struct __logger_status
 
 /**
   * @brief  ¼
+  * صǰ amount check ֻӡɾʱ£ loop У
   */
 struct __logger_monitor
 {
 	void (*callback[MAX_MONITORS])(enum __event_id, enum __event_status, uint16_t);
+	uint8_t amount;
 	uint32_t check;
 };
 
+/**
+  * @brief  ¼¼ݴУÿһ׷ӵӦĻζ
+  */
+struct __logger_staging
+{
+	uint8_t amount; //ݴ
+	uint32_t stamp; //һݴ¼ʱ䣨jiffy
+	struct __event_record record[LOGGER_STAGING_AMOUNT];
+};
+
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 static enum __task_status task_status = TASK_NOTINIT;
@@ -68,9 +97,29 @@ static enum __task_status task_status = TASK_NOTINIT;
   */
 static const struct __logger_table table[] = 
 {
-	/** ¼ʶ		ӳʶ	¼Ϊ */
-	{EVI_POWERUP,		11,			(EVB_PU | EVB_STR | EVB_ENDPD | EVB_STRPU)},
-	{EVI_POWERDOWN,		12,			(EVB_PU | EVB_STR | EVB_ENDPU | EVB_STRPD)},
+	/** ¼ʶ		ӳʶ	¼Ϊ										¼ */
+	{EVI_POWERUP,		11,			(EVB_PU | EVB_STR | EVB_ENDPD | EVB_STRPU),		EVC_POWER},
+	{EVI_POWERDOWN,		12,			(EVB_PU | EVB_STR | EVB_ENDPU | EVB_STRPD),		EVC_POWER},
+};
+
+/**
+  * @brief  ¼ӦĻζļ
+  */
+static const char * const class_file[EVC_MAX] = 
+{
+	"events.standard",
+	"events.power",
+};
+
+/**
+  * @brief  ¼¼еļݿ
+  */
+static const struct __meta_identifier snapshot_list[] = 
+{
+	{.item = M_P_ENERGY, .phase = M_PHASE_T, .rate = 0, .scale = M_SCALE_ZP, .flex = (M_QUAD_I | M_QUAD_IV)},
+	{.item = M_P_ENERGY, .phase = M_PHASE_T, .rate = 0, .scale = M_SCALE_ZP, .flex = (M_QUAD_II | M_QUAD_III)},
+	{.item = M_VOLTAGE, .phase = M_PHASE_A, .rate = 0, .scale = M_SCALE_ZP, .flex = 0},
+	{.item = M_CURRENT, .phase = M_PHASE_A, .rate = 0, .scale = M_SCALE_ZP, .flex = 0},
 };
 
 /**
@@ -83,21 +132,200 @@ static struct __logger_status logger_status;
   */
 static struct __logger_monitor monitors;
 
+/**
+  * @brief  ¼¼ݴ
+  */
+static struct __logger_staging staging[EVC_MAX];
+
+/**
+  * @brief  ϵʱҪ¼δ
+  */
+static bool powerup_pending = false;
+static uint32_t powerup_stamp = 0;
+
+/**
+  * @brief  ¼״̬Ǵļлָģ
+  */
+static bool restored = false;
+static uint8_t journal = 0xff;
+
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 
 /**
-  * @brief  ȡָ¼״̬
+  * @brief  ¼״ֵ̬У
   */
-static enum __event_status logger_event_status_read(enum __event_id id)
+static uint32_t logger_status_sum(void)
 {
-	enum __event_id val = EVI_ALL;
+	uint32_t sum = 0;
+	
+	for(uint16_t n=0; n<sizeof(logger_status.value); n++)
+	{
+		sum += logger_status.value[n];
+	}
+	
+	return(~sum);
+}
+
+/**
+  * @brief  ֱ¼״̬¼֪ͨУֽڵı仯
+  */
+static void logger_status_write(enum __event_id id, enum __event_status status)
+{
+	uint8_t value;
+	
+	value = logger_status.value[id/4];
+	logger_status.value[id/4] &= ~(0x03 << ((id%4)*2));
+	logger_status.value[id/4] |= (((uint8_t)status) << ((id%4)*2));
+	logger_status.check += value;
+	logger_status.check -= logger_status.value[id/4];
+	
+	nvram.journal.dirty(journal);
+}
+
+/**
+  * @brief  ļж¼״̬У鲻ͨʱ
+  */
+static void logger_status_load(void)
+{
+	restored = false;
+	
+	if(file.parameter.read("events.status", 0, sizeof(logger_status), &logger_status) == sizeof(logger_status))
+	{
+		if(logger_status.check == logger_status_sum())
+		{
+			restored = true;
+			return;
+		}
+	}
+	
+	heap.set(&logger_status, 0, sizeof(logger_status));
+	logger_status.check = logger_status_sum();
+}
+
+/**
+  * @brief  бУ
+  */
+static uint32_t logger_monitor_check(void)
+{
+	return(crc32(&monitors, (sizeof(monitors) - sizeof(monitors.check)), 0));
+}
+
+/**
+  * @brief  ռб
+  */
+static void logger_monitor_clear(void)
+{
+    heap.set(&monitors, 0, sizeof(monitors));
+	monitors.check = logger_monitor_check();
+}
+
+/**
+  * @brief  һݴļ¼׷ӵζ
+  * ̲ʱݴ¼´ύ
+  */
+static void logger_commit(enum __event_class cls)
+{
+	struct __logger_staging *stage = &staging[cls];
+	uint32_t done;
 	
-	if(logger_status.check != crc32(&logger_status, (sizeof(logger_status) - sizeof(logger_status.check)), 0))
+	if(!stage->amount)
 	{
-		return(EVS_ENDED);
+		return;
 	}
 	
+	done = file.ring.append_many(class_file[cls], stage->amount, sizeof(struct __event_record), stage->record);
+	
+	if(!done)
+	{
+		return;
+	}
+	
+	if(done < stage->amount)
+	{
+		memmove(&stage->record[0], &stage->record[done], (stage->amount - done) * sizeof(struct __event_record));
+		stage->amount -= done;
+		stage->stamp = jiffy.value();
+	}
+	else
+	{
+		stage->amount = 0;
+	}
+}
+
+/**
+  * @brief  һ¼¼ݴ
+  */
+static void logger_capture(enum __event_id id, enum __event_status status, uint16_t mapping, enum __event_class cls)
+{
+	struct __logger_staging *stage;
+	struct __event_record *record;
+	struct __metering *metering = api("task_metering");
+	
+	if(cls >= EVC_MAX)
+	{
+		return;
+	}
+	
+	stage = &staging[cls];
+	
+	//ݴȳύ
+	if(stage->amount >= LOGGER_STAGING_AMOUNT)
+	{
+		logger_commit(cls);
+		
+		if(stage->amount >= LOGGER_STAGING_AMOUNT)
+		{
+			TRACE(TRACE_WARN, "Event record dropped.");
+			return;
+		}
+	}
+	
+	record = &stage->record[stage->amount];
+	heap.set(record, 0, sizeof(struct __event_record));
+	
+	record->stamp = rtc.read();
+	record->id = (uint16_t)id;
+	record->mapping = mapping;
+	record->status = (uint8_t)status;
+	
+	for(uint8_t n=0; (n<(sizeof(snapshot_list)/sizeof(struct __meta_identifier))) && (n<(sizeof(record->snapshot)/sizeof(int64_t))); n++)
+	{
+		if(!metering || (metering->instant(snapshot_list[n], &record->snapshot[n]) == M_NULL))
+		{
+			record->snapshot[n] = 0;
+		}
+	}
+	
+	if(!stage->amount)
+	{
+		stage->stamp = jiffy.value();
+	}
+	
+	stage->amount += 1;
+}
+
+/**
+  * @brief  ֪ͨм
+  */
+static void logger_notify(enum __event_id id, enum __event_status status, uint16_t mapping)
+{
+	for(uint8_t n=0; (n<monitors.amount) && (n<MAX_MONITORS); n++)
+	{
+		if(monitors.callback[n])
+		{
+			monitors.callback[n](id, status, mapping);
+		}
+	}
+}
+
+/**
+  * @brief  ȡָ¼״̬
+  */
+static enum __event_status logger_event_status_read(enum __event_id id)
+{
+	enum __event_id val = EVI_ALL;
+	
 	for(uint8_t n=0; n<(sizeof(table)/sizeof(struct __logger_table)); n++)
 	{
 		if(table[n].id == id)
@@ -115,14 +343,11 @@ static enum __event_status logger_event_status_read(enum __event_id id)
 static bool logger_event_status_toggle(enum __event_id id, enum __event_status status)
 {
 	uint16_t behaviors = 0;
+	uint16_t mapping = 0;
+	enum __event_class cls = EVC_STANDARD;
 	enum __event_status status_current;
 	
-	if((id > EVI_MAX) || (id <= EVI_ALL))
-	{
-		return(false);
-	}
-	
-	if(logger_status.check != crc32(&logger_status, (sizeof(logger_status) - sizeof(logger_status.check)), 0))
+	if((id >= EVI_MAX) || (id <= EVI_ALL))
 	{
 		return(false);
 	}
@@ -132,6 +357,8 @@ static bool logger_event_status_toggle(enum __event_id id, enum __event_status s
 		if(table[n].id == id)
 		{
 			behaviors = table[n].behaviors;
+			mapping = table[n].mapping;
+			cls = table[n].cls;
 			break;
 		}
 	}
@@ -156,20 +383,25 @@ static bool logger_event_status_toggle(enum __event_id id, enum __event_status s
 	}
 	
 	//״̬
-	logger_status.value[id/4] &= ~(0x03 << ((id%4)*2));
-	logger_status.value[id/4] |= (((uint8_t)status) << ((id%4)*2));
-	logger_status.check = crc32(&logger_status, (sizeof(logger_status) - sizeof(logger_status.check)), 0);
+	logger_status_write(id, status);
+	
+	if(status == status_current)
+	{
+		return(true);
+	}
 	
 	//¼ʼɴ
-	if(behaviors & EVB_STR)
+	if((behaviors & EVB_STR) && (status == EVS_STARTED))
 	{
-		
+		logger_capture(id, status, mapping, cls);
+		logger_notify(id, status, mapping);
 	}
 	
 	//¼ɴ
-	if(behaviors & EVB_END)
+	if((behaviors & EVB_END) && (status == EVS_ENDED))
 	{
-		
+		logger_capture(id, status, mapping, cls);
+		logger_notify(id, status, mapping);
 	}
 	
     return(true);
@@ -180,42 +412,32 @@ static bool logger_event_status_toggle(enum __event_id id, enum __event_status s
   */
 static bool logger_event_add_monitor(void (*callback)(enum __event_id, enum __event_status, uint16_t))
 {
-	uint16_t blank = 0xffff;
-	
 	if(!callback)
 	{
 		return(false);
 	}
 	
-	if(monitors.check != crc32(&monitors, (sizeof(monitors) - sizeof(monitors.check)), 0))
+	if(monitors.check != logger_monitor_check())
 	{
 		return(false);
 	}
 	
-	for(uint8_t n=0; n<MAX_MONITORS; n++)
+	for(uint8_t n=0; (n<monitors.amount) && (n<MAX_MONITORS); n++)
 	{
-		if((void *)(monitors.callback[n]) == (void *)0)
-		{
-			if(blank == 0xffff)
-			{
-				blank = n;
-			}
-			continue;
-		}
-		
 		if(monitors.callback[n] == callback)
 		{
 			return(false);
 		}
 	}
 	
-	if(blank >= MAX_MONITORS)
+	if(monitors.amount >= MAX_MONITORS)
 	{
 		return(false);
 	}
 	
-	monitors.callback[blank] = callback;
-	monitors.check = crc32(&monitors, (sizeof(monitors) - sizeof(monitors.check)), 0);
+	monitors.callback[monitors.amount] = callback;
+	monitors.amount += 1;
+	monitors.check = logger_monitor_check();
 	return(true);
 }
 
@@ -229,25 +451,24 @@ static bool logger_event_remove_monitor(void (*callback)(enum __event_id, enum _
 		return(false);
 	}
 	
-	if(monitors.check != crc32(&monitors, (sizeof(monitors) - sizeof(monitors.check)), 0))
+	if(monitors.check != logger_monitor_check())
 	{
 		return(false);
 	}
 	
-	for(uint8_t n=0; n<MAX_MONITORS; n++)
+	for(uint8_t n=0; (n<monitors.amount) && (n<MAX_MONITORS); n++)
 	{
-		if((void *)(monitors.callback[n]) == (void *)0)
-		{
-			continue;
-		}
-		
 		if(monitors.callback[n] == callback)
 		{
-			monitors.callback[n] = (void *)0;
+			//һλֻص
+			monitors.amount -= 1;
+			monitors.callback[n] = monitors.callback[monitors.amount];
+			monitors.callback[monitors.amount] = (void *)0;
+			break;
 		}
 	}
 	
-	monitors.check = crc32(&monitors, (sizeof(monitors) - sizeof(monitors.check)), 0);
+	monitors.check = logger_monitor_check();
 	return(true);
 }
 
@@ -283,6 +504,84 @@ static enum __event_id logger_event_unmap(uint16_t mapping)
 	return(EVI_ALL);
 }
 
+/**
+  * @brief  ȡѱļ¼δύݴ¼
+  */
+static uint32_t logger_record_amount(enum __event_class cls)
+{
+	struct __ring_info info;
+	
+	if(cls >= EVC_MAX)
+	{
+		return(0);
+	}
+	
+	logger_commit(cls);
+	
+	if(!file.ring.info(class_file[cls], &info))
+	{
+		return(staging[cls].amount);
+	}
+	
+	return(info.amount + staging[cls].amount);
+}
+
+/**
+  * @brief  ĿΧȡ¼ضȡ
+  * ύļ¼ӻζаһδύݴ¼
+  */
+static uint32_t logger_record_read(enum __event_class cls, uint32_t from, uint32_t to, struct __event_record *record, uint32_t size)
+{
+	struct __ring_info info;
+	uint32_t stored = 0;
+	uint32_t total;
+	uint32_t entry;
+	uint32_t cnt = 0;
+	
+	if((cls >= EVC_MAX) || !record || !size)
+	{
+		return(0);
+	}
+	
+	logger_commit(cls);
+	
+	if(file.ring.info(class_file[cls], &info))
+	{
+		stored = info.amount;
+	}
+	
+	total = stored + staging[cls].amount;
+	
+	if(!from)
+	{
+		from = 1;
+	}
+	
+	if(!to || (to > total))
+	{
+		to = total;
+	}
+	
+	for(entry=from; (entry<=to) && (cnt<size); entry++)
+	{
+		if(entry <= stored)
+		{
+			if(file.ring.read(class_file[cls], (entry - 1), sizeof(struct __event_record), &record[cnt], true) != sizeof(struct __event_record))
+			{
+				break;
+			}
+		}
+		else
+		{
+			heap.copy(&record[cnt], &staging[cls].record[entry - stored - 1], sizeof(struct __event_record));
+		}
+		
+		cnt += 1;
+	}
+	
+	return(cnt);
+}
+
 /**
   * @brief  
   */
@@ -300,6 +599,12 @@ static const struct __logger logger =
 		.remove		= logger_event_remove_monitor,
 	},
 	
+	.record			= 
+	{
+		.amount		= logger_record_amount,
+		.read		= logger_record_read,
+	},
+	
 	.map			= logger_event_map,
 	.unmap			= logger_event_unmap,
 };
@@ -311,6 +616,86 @@ static const struct __logger logger =
 
 
 
+/**
+  * @brief  ¼¼ļ¼Ȳʱ³ʼ
+  */
+static void logger_prepare(bool force)
+{
+	struct __ring_info info;
+	
+	for(uint8_t n=0; n<EVC_MAX; n++)
+	{
+		if(!force && file.ring.info(class_file[n], &info) && (info.length == sizeof(struct __event_record)))
+		{
+			continue;
+		}
+		
+		if(!file.ring.init(class_file[n], sizeof(struct __event_record)))
+		{
+			TRACE(TRACE_WARN, "Event log initialize failed.");
+		}
+	}
+	
+	heap.set(staging, 0, sizeof(staging));
+}
+
+/**
+  * @brief  ʱǿõ¼״̬´ϵ紦
+  */
+static void logger_powerdown(void)
+{
+	for(uint8_t n=0; n<(sizeof(table)/sizeof(struct __logger_table)); n++)
+	{
+		if(table[n].behaviors & EVB_STRPD)
+		{
+			logger_status_write(table[n].id, EVS_STARTING);
+		}
+		
+		if(table[n].behaviors & EVB_ENDPD)
+		{
+			logger_status_write(table[n].id, EVS_ENDING);
+		}
+	}
+}
+
+/**
+  * @brief  ϵʱǿƴ¼
+  */
+static void logger_powerup(void)
+{
+	//ϴεû˳ʱָǿ״̬紦
+	if(restored)
+	{
+		logger_powerdown();
+	}
+	
+	//ʱõ״̬
+	for(uint8_t n=0; n<(sizeof(table)/sizeof(struct __logger_table)); n++)
+	{
+		if(logger_event_status_read(table[n].id) == EVS_STARTING)
+		{
+			logger_event_status_toggle(table[n].id, EVS_STARTED);
+		}
+		else if(logger_event_status_read(table[n].id) == EVS_ENDING)
+		{
+			logger_event_status_toggle(table[n].id, EVS_ENDED);
+		}
+	}
+	
+	for(uint8_t n=0; n<(sizeof(table)/sizeof(struct __logger_table)); n++)
+	{
+		if(table[n].behaviors & EVB_STRPU)
+		{
+			logger_event_status_toggle(table[n].id, EVS_STARTED);
+		}
+		
+		if(table[n].behaviors & EVB_ENDPU)
+		{
+			logger_event_status_toggle(table[n].id, EVS_ENDED);
+		}
+	}
+}
+
 /**
   * @brief  
   */
@@ -323,13 +708,22 @@ static void task_logger_init(void)
     }
 	
 	//ʼб
-    heap.set(&monitors, 0, sizeof(monitors));
-	monitors.check = crc32(&monitors, (sizeof(monitors) - sizeof(monitors.check)), 0);
+	logger_monitor_clear();
 	
-	//...¼״̬
-	heap.set(&logger_status, 0, sizeof(logger_status));
+	//¼״̬Ǽǵ
+	logger_status_load();
+	journal = nvram.journal.enroll("events.status", 0, &logger_status, sizeof(logger_status));
 	
-	//...¼ϵʱҪ¼ӳٴ
+	//¼ϵʱҪ¼ӳٴ
+	heap.set(staging, 0, sizeof(staging));
+	powerup_pending = false;
+	
+	if(system_status() == SYSTEM_RUN)
+	{
+		logger_prepare(false);
+		powerup_pending = true;
+		powerup_stamp = jiffy.value();
+	}
 	
 	TRACE(TRACE_INFO, "Task logger initialized.");
 }
@@ -344,6 +738,39 @@ static void task_logger_loop(void)
     {
 	    task_status = TASK_INIT;
     }
+	
+	//У¼״ֺ̬ͼб
+	if(logger_status.check != logger_status_sum())
+	{
+		heap.set(&logger_status, 0, sizeof(logger_status));
+		logger_status.check = logger_status_sum();
+	}
+	
+	if(monitors.check != logger_monitor_check())
+	{
+		logger_monitor_clear();
+	}
+	
+	if(powerup_pending && (jiffy.after(powerup_stamp) >= LOGGER_POWERUP_DELAY))
+	{
+		powerup_pending = false;
+		logger_powerup();
+	}
+	
+	//ݴ¼פʱύ
+	for(uint8_t n=0; n<EVC_MAX; n++)
+	{
+		if(!staging[n].amount)
+		{
+			continue;
+		}
+		
+		if((staging[n].amount >= (LOGGER_STAGING_AMOUNT / 2)) || \
+			(jiffy.after(staging[n].stamp) >= LOGGER_COMMIT_LATENCY))
+		{
+			logger_commit((enum __event_class)n);
+		}
+	}
 }
 
 /**
@@ -351,7 +778,30 @@ static void task_logger_loop(void)
   */
 static void task_logger_exit(void)
 {
-	//...¼״̬
+	//ύݴ¼
+	for(uint8_t n=0; n<EVC_MAX; n++)
+	{
+		logger_commit((enum __event_class)n);
+	}
+	
+	heap.set(staging, 0, sizeof(staging));
+	powerup_pending = false;
+	
+	//¼״ֻ̬к˳ʱ
+	if(task_status != TASK_NOTINIT)
+	{
+		logger_powerdown();
+		
+		if(file.parameter.write("events.status", 0, sizeof(logger_status), &logger_status) != sizeof(logger_status))
+		{
+			TRACE(TRACE_WARN, "Event status save failed.");
+		}
+		else
+		{
+			nvram.journal.clean(journal);
+		}
+	}
+	
 	heap.set(&logger_status, 0, sizeof(logger_status));
 	
 	task_status = TASK_NOTINIT;
@@ -365,13 +815,16 @@ static void task_logger_exit(void)
 static void task_logger_reset(void)
 {
 	//ʼб
-    heap.set(&monitors, 0, sizeof(monitors));
-	monitors.check = crc32(&monitors, (sizeof(monitors) - sizeof(monitors.check)), 0);
+	logger_monitor_clear();
 	
-	//...ʼ¼״̬
+	//ʼ¼״̬
 	heap.set(&logger_status, 0, sizeof(logger_status));
-	logger_status.check = crc32(&logger_status, (sizeof(logger_status) - sizeof(logger_status.check)), 0);
-	//...д
+	logger_status.check = logger_status_sum();
+	file.parameter.write("events.status", 0, sizeof(logger_status), &logger_status);
+	
+	//¼¼
+	logger_prepare(true);
+	powerup_pending = false;
 	
 	task_status = TASK_NOTINIT;
 	
@@ -398,5 +851,7 @@ const struct __task_sched task_logger =
     .exit               = task_logger_exit,
     .reset              = task_logger_reset,
     .status             = task_logger_status,
+    .period             = 1000,
+    .phase              = 250,
     .api                = (void *)&logger,
 };
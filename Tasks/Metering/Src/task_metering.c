@@ -83,9 +83,29 @@ static uint8_t quad = 0;
 static uint8_t group = 0;
 static uint16_t period = 0;
 static uint16_t flush[4][3] = {0};
+static uint8_t journal = 0xff; //
 
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Ƿлûдļĵ
+  */
+static bool metering_unsaved(void)
+{
+	for(uint8_t n=0; n<4; n++)
+	{
+		for(uint8_t g=0; g<3; g++)
+		{
+			if(flush[n][g])
+			{
+				return(true);
+			}
+		}
+	}
+	
+	return(false);
+}
+
 /**
   * @brief  
   */
@@ -925,6 +945,9 @@ static uint8_t config_rate_change(uint8_t rate)
 		TRACE(TRACE_ERR, "Task metering config_rate_change 2.");
 	}
 	
+	//λʱ仯
+	journal = nvram.journal.enroll("measurements", STRUCT_OFFSET(struct __metering_data, energy[mp.rate]), mc, sizeof(mc));
+	
 	return(mp.rate);
 }
 
@@ -1257,6 +1280,8 @@ static void config_energy_clear(void)
 			TRACE(TRACE_ERR, "Task metering metering_loop.");
 		}
 	}
+	
+	nvram.journal.clean(journal);
 }
 
 
@@ -1634,6 +1659,9 @@ static void metering_init(void)
 		//ˢ±
 		heap.set(flush, 0, sizeof(flush));
 		
+		//Ǽǵ棬ѰϴεʱδǨƵĿ
+		journal = nvram.journal.enroll("measurements", STRUCT_OFFSET(struct __metering_data, energy[mp.rate]), mc, sizeof(mc));
+		
 		step = 0;
 		quad = 0;
 		group = 0;
@@ -2144,6 +2172,7 @@ static void metering_loop(void)
 				}
 				
 				mc[n].group[g].check = crc32(&mc[n].group[g], (sizeof(mc[n].group[g]) - sizeof(mc[n].group[g].check)), 0);
+				nvram.journal.dirty(journal);
 			}
 		}
 		
@@ -2168,6 +2197,12 @@ static void metering_loop(void)
 				}
 				
 				flush[quad][group] = 0;
+				
+				//еܶдļ󣬵ʱҪ
+				if(!metering_unsaved())
+				{
+					nvram.journal.clean(journal);
+				}
 			}
 			
 			quad += 1;
@@ -2185,28 +2220,24 @@ static void metering_exit(void)
 {
     DEV_M.control.suspend();
 	
-	//жǷлûдĵ
+	//жǷлûдĵܣд룬ͬʱʱĿ־
 	config_check();
 	
-	for(uint8_t n=0; n<4; n++)
+	if(metering_unsaved())
 	{
-		for(uint8_t g=0; g<3; g++)
+		if(file.parameter.write("measurements", \
+								STRUCT_OFFSET(struct __metering_data, energy[mp.rate]), \
+								sizeof(mc), \
+								(void *)mc) != sizeof(mc))
 		{
-			if(!flush[n][g])
-			{
-				continue;
-			}
-			
-			if(file.parameter.write("measurements", \
-									STRUCT_OFFSET(struct __metering_data, energy[mp.rate][n].group[g]), \
-									sizeof(mc[n].group[g]), \
-									(void *)&(mc[n].group[g])) != sizeof(mc[n].group[g]))
-			{
-				TRACE(TRACE_ERR, "Task metering metering_loop.");
-			}
-			
-			flush[n][g] = 0;
+			TRACE(TRACE_ERR, "Task metering metering_loop.");
 		}
+		else
+		{
+			nvram.journal.clean(journal);
+		}
+		
+		heap.set(flush, 0, sizeof(flush));
 	}
     
     status = TASK_SUSPEND;
@@ -64,6 +64,7 @@ typedef struct
     {
         uint32_t    From; //ʼĿ
         uint32_t    To; //Ŀ
+        uint16_t    Offset; //ǰĿֽĿʱʹã
         uint8_t     Status; //ǰ״̬
         
     }               Iterator;
@@ -96,13 +97,17 @@ typedef ObjectErrs (*TypeObject)(ObjectPara *P);
 #define OBJ_OUT_ADDR(P)                 ((P)->Output.Buffer)//ȡ׵ַ
 #define OBJ_OUT_SIZE(P)                 ((P)->Output.Size)//ȡֽڴС
 #define OBJ_PUSH_LENGTH(P, n)           ((P)->Output.Filled = (n))//ֽڳ
+#define OBJ_OUT_FILLED(P)               ((P)->Output.Filled)//ȡֽڳ
+#define OBJ_OUT_REMAIN(P)               ((uint16_t)((P)->Output.Size - (P)->Output.Filled))//ȡʣֽ
 
 #define OBJ_ITERATE_INIT(P, f, t)       (P)->Iterator.From = (f); \
                                         (P)->Iterator.To = (t); \
+                                        (P)->Iterator.Offset = 0; \
                                         if((P)->Iterator.From != P->Iterator.To) \
                                             {(P)->Iterator.Status = ITER_ONGOING;}//ʼ
 #define OBJ_ITERATE_FROM(P)             ((P)->Iterator.From)//ʼ
 #define OBJ_ITERATE_TO(P)               ((P)->Iterator.To)//
+#define OBJ_ITERATE_OFFSET(P)           ((P)->Iterator.Offset)//ǰĿֽ
 #define OBJ_ITERATE_STEPPING(P)         if((P)->Iterator.From < (P)->Iterator.To) \
                                             {(P)->Iterator.From += 1;} \
                                         else if((P)->Iterator.From > (P)->Iterator.To) \
@@ -402,7 +402,9 @@ typedef struct
 /* Exported constants --------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
 /* Exported function prototypes ----------------------------------------------*/
+extern const TypeObject *CosemLoadClass(uint16_t ClassID, uint8_t *Attr, uint8_t *Method);
 extern TypeObject CosemLoadAttribute(uint16_t ClassID, uint8_t Index, bool isSet);
 extern TypeObject CosemLoadMethod(uint16_t ClassID, uint8_t Index);
+extern bool CosemStreamPush(ObjectPara *P, const uint8_t *Entry, uint16_t Length);
 
 #endif /* __COSEM_OBJECTS_H__ */
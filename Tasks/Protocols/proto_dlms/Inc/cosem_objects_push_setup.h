@@ -0,0 +1,19 @@
+/**
+ * @brief		
+ * @details		
+ * @date		2026-10-19
+ **/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __COSEM_OBJECTS_PUSHSETUP_H__
+#define __COSEM_OBJECTS_PUSHSETUP_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "cosem_objects.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported macro ------------------------------------------------------------*/
+/* Exported function prototypes ----------------------------------------------*/
+extern const ClassPushSetup PushSetup;
+
+#endif /* __COSEM_OBJECTS_PUSHSETUP_H__ */
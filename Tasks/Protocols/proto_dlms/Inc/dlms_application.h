@@ -21,5 +21,6 @@ extern void dlms_appl_entrance(const uint8_t *info,
                                uint16_t buffer_length,
                                uint16_t *filled_length);
 extern uint8_t dlms_appl_instance(uint8_t *name);
+extern uint16_t dlms_appl_capture(const struct __cosem_descriptor *descriptor, uint8_t *buffer, uint16_t size);
 
 #endif /* __DLMS_APPLICATION_H__ */
@@ -20,6 +20,7 @@ struct __dlms_session
 {
     uint16_t session;
     uint16_t sap;
+    uint8_t channel;//ͨͬͨϵӻ
 };
 
 /**	
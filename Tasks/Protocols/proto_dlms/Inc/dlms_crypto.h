@@ -0,0 +1,42 @@
+/**
+ * @brief		Բǩ
+ * @details		HLS7 general-signing ǩǩ㣬Linux ½߳첽ִ
+ * @date		2026-10-19
+ **/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DLMS_CRYPTO_H__
+#define __DLMS_CRYPTO_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "stddef.h"
+#include "stdint.h"
+#include "stdbool.h"
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief 
+  */
+enum __crypto_result
+{
+    CRYPTO_SUCCESS = 0,
+    CRYPTO_PENDING, //δɣǰ󱻹Ժͬύ
+    CRYPTO_FAILED,
+};
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported macro ------------------------------------------------------------*/
+/* Exported function prototypes ----------------------------------------------*/
+extern void dlms_crypto_init(void);
+extern void dlms_crypto_exit(void);
+extern enum __crypto_result dlms_crypto_verify(const uint8_t *pubkey, uint8_t length, const uint8_t *hash, const uint8_t *signature);
+extern enum __crypto_result dlms_crypto_sign(const uint8_t *prikey, uint8_t length, const uint8_t *hash, uint8_t *signature);
+extern void dlms_crypto_clear(void);
+extern bool dlms_crypto_deferred(void);
+
+#if defined ( __linux )
+extern void *dlms_crypto_calloc(size_t n, size_t size);
+extern void dlms_crypto_free(void *ptr);
+#endif
+
+#endif /* __DLMS_CRYPTO_H__ */
@@ -7,6 +7,7 @@
 #include "stdbool.h"
 #include "proto_dlms.h"
 #include "dlms_types.h"
+#include "object_template.h"
 
 /* Exported types ------------------------------------------------------------*/
 /**
@@ -26,17 +27,33 @@ struct __cosem_object
 };
 
 /* Exported constants --------------------------------------------------------*/
+#if !defined(DLMS_LEX_VERIFY_BUDGET)
+#if defined (BUILD_REAL_WORLD)
+#define DLMS_LEX_VERIFY_BUDGET      ((uint16_t)8) //ÿУĲļ
+#else
+#define DLMS_LEX_VERIFY_BUDGET      ((uint16_t)64) //ÿУĲļ
+#endif
+#endif
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported function prototypes ----------------------------------------------*/
 extern void dlms_lex_parse(const struct __cosem_request_desc *desc,
                            union __dlms_right *right,
                            uint32_t *oid,
-                           uint32_t *mid);
+                           uint32_t *mid,
+                           TypeObject *object);
+extern void dlms_lex_parse_list(const struct __cosem_request_desc *desc,
+                                uint8_t amount,
+                                union __dlms_right *right,
+                                uint32_t *oid,
+                                uint32_t *mid,
+                                TypeObject *object);
 extern uint16_t dlms_lex_amount(uint8_t suit);
 extern uint16_t dlms_lex_entry(uint16_t index, struct __cosem_object *entry);
 extern uint64_t dlms_lex_version(void);
 extern uint64_t dlms_lex_date(void);
 extern uint8_t dlms_lex_signature(uint8_t *signature);
+extern bool dlms_lex_verify(uint16_t budget);
 extern bool dlms_lex_check(void);
 extern void dlms_lex_init(void);
 
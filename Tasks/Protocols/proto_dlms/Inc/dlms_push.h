@@ -0,0 +1,44 @@
+/**
+ * @brief
+ * @details
+ * @date		2026-10-19
+ **/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DLMS_PUSH_H__
+#define __DLMS_PUSH_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "stdint.h"
+#include "stdbool.h"
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief ʹ䷽ʽsend_destination_and_method.transport_service
+  */
+enum __push_transport
+{
+    PUSH_TRANSPORT_HDLC = 5,
+};
+
+/**
+  * @brief ͱĸʽsend_destination_and_method.message
+  */
+enum __push_message
+{
+    PUSH_MESSAGE_AXDR = 0, //A-XDR  DataNotification
+    PUSH_MESSAGE_AXDR_GLO = 128, //չgeneral-glo-ciphering ֤
+};
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported macro ------------------------------------------------------------*/
+/* Exported function prototypes ----------------------------------------------*/
+extern void dlms_push_init(void);
+extern void dlms_push_exit(void);
+extern void dlms_push_tick(uint16_t tick);
+extern uint8_t dlms_push_index(const uint8_t *obis);
+extern uint16_t dlms_push_load(uint8_t index, uint8_t attr, uint8_t *buffer, uint16_t size);
+extern bool dlms_push_write(uint8_t index, uint8_t attr, const uint8_t *buffer, uint16_t size);
+extern bool dlms_push_trigger(uint8_t index);
+
+#endif /* __DLMS_PUSH_H__ */
@@ -211,6 +211,15 @@ enum __dlms_response_type
 	GNL_SIGN_RESPONSE = 223,
 };
 
+/**
+  * DLMS ֪ͨͣͣͻ
+  *
+  */
+enum __dlms_notification_type
+{
+    DATA_NOTIFICATION = 15,
+};
+
 /**
   * DLMS GET Ӧ
   *
@@ -289,6 +298,7 @@ enum __dlms_class
     CLASS_REGISTER_MONITOR = 21,
     CLASS_SINGLE_ACTION = 22,
     CLASS_HDLC_SETUP = 23,
+    CLASS_PUSH_SETUP = 40,
     CLASS_MAC_ADDRESS_SETUP = 43,
     CLASS_RELAY = 70,
     CLASS_LIMITER = 71,
@@ -350,6 +360,19 @@ struct __cosem_request_desc
 											(R)->level = (l); \
 											(R)->request = (r); \
 											(R)->descriptor = *(d);//ʼ __cosem_request_desc
+
+//Linux ÿͨ·ӦòڸԵĹ߳д DLMS_CONFIG_SERIAL ڵ߳֡
+#if defined ( __linux ) && !defined ( DLMS_CONFIG_SERIAL )
+#define DLMS_CONFIG_PARALLEL
+#endif
+
+//ǰģдʱÿ̸߳һ
+#if defined ( DLMS_CONFIG_PARALLEL )
+#define DLMS_CHANNEL_LOCAL                  __thread
+#else
+#define DLMS_CHANNEL_LOCAL
+#endif
+
 /* Exported function prototypes ----------------------------------------------*/
 
 #endif /* __DLMS_TYPES_H__ */
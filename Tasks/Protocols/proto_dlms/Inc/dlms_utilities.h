@@ -4,9 +4,13 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stdint.h"
+#include "stdbool.h"
 
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
+#define DLMS_UTIL_PUSH_AMOUNT       ((uint8_t)4) //
+#define DLMS_UTIL_PUSH_SIZE         ((uint16_t)220) //ÿõĴ洢ռ
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported function prototypes ----------------------------------------------*/
 extern uint16_t dlms_util_load_hdlc_address(void);
@@ -44,4 +48,9 @@ extern uint8_t dlms_util_write_capubkey(uint8_t *buffer);
 extern uint8_t dlms_util_load_cspubkey(uint8_t *buffer);
 extern uint8_t dlms_util_write_cspubkey(uint8_t *buffer);
 
+extern uint16_t dlms_util_load_push(uint8_t index, uint8_t *buffer, uint16_t size);
+extern uint16_t dlms_util_write_push(uint8_t index, const uint8_t *buffer, uint16_t size);
+
+extern bool dlms_util_next_fc(uint32_t *fc);
+
 #endif /* __DLMS_UTILITIES_H__ */
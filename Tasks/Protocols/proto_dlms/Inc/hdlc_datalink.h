@@ -11,6 +11,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stdint.h"
 #include "stdbool.h"
+#include "dlms_types.h"
 
 /* Exported types ------------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
@@ -25,10 +26,18 @@ extern uint16_t hdlc_set_timeout(uint16_t sec);
 extern uint8_t hdlc_get_window_size(void);
 extern uint16_t hdlc_get_max_info_length(void);
 extern uint8_t hdlc_get_linked_channel(void);
+extern uint8_t hdlc_get_channel_amount(void);
+extern uint8_t hdlc_get_client_address(uint8_t channel);
 extern uint16_t hdlc_send_info(uint8_t channel, const uint8_t *frame, uint16_t length);
 extern bool hdlc_send_result(uint8_t channel);
 extern uint16_t hdlc_request(uint8_t channel, const uint8_t *frame, uint16_t length);
 extern uint16_t hdlc_response(uint8_t channel, uint8_t *frame, uint16_t length);
 
+#if defined ( DLMS_CONFIG_PARALLEL )
+extern void hdlc_worker_start(void);
+extern uint16_t hdlc_worker_post(uint8_t channel, const uint8_t *frame, uint16_t length);
+extern uint16_t hdlc_worker_fetch(uint8_t channel, uint8_t *frame, uint16_t length);
+#endif
+
 
 #endif /* __HDLC_DATALINK_H__ */
@@ -18,6 +18,7 @@
 #include "cosem_objects_hdlc_setup.h"
 #include "cosem_objects_register.h"
 #include "cosem_objects_imagetransfer.h"
+#include "cosem_objects_push_setup.h"
 
 
 /* Private typedef -----------------------------------------------------------*/
@@ -28,158 +29,119 @@
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 /**
-  * ȡһ
+  * ȡĺ
+  * ΪԵ Get/Set Ϊ
   *
   */
-TypeObject CosemLoadAttribute(uint16_t ClassID, uint8_t Index, bool isSet)
+const TypeObject *CosemLoadClass(uint16_t ClassID, uint8_t *Attr, uint8_t *Method)
 {
-    TypeObject *Obj = (TypeObject *)0;
-    
-    if(!Index)
-    {
-        return((TypeObject)0);
-    }
+    const TypeObject *Obj;
+    uint8_t NumAttr;
+    uint8_t NumMethod;
     
     switch(ClassID)
     {
         case CLASS_DATA:
         {
-            if(Index > 2)
-            {
-                return((TypeObject)0);
-            }
-            else
-            {
-                Obj = (TypeObject *)&Data;
-                Index -= 1;
-                Index *= 2;
-                Obj += Index;
-                if(isSet)
-                {
-                    Obj += 1;
-                }
-                return(*Obj);
-            }
+            Obj = (const TypeObject *)&Data;
+            NumAttr = 2;
+            NumMethod = 0;
+            break;
         }
         case CLASS_REGISTER:
         {
-            if(Index > 3)
-            {
-                return((TypeObject)0);
-            }
-            else
-            {
-                Obj = (TypeObject *)&Register;
-                Index -= 1;
-                Index *= 2;
-                Obj += Index;
-                if(isSet)
-                {
-                    Obj += 1;
-                }
-                return(*Obj);
-            }
+            Obj = (const TypeObject *)&Register;
+            NumAttr = 3;
+            NumMethod = 1;
+            break;
         }
         case CLASS_EXTREGISTER:
         {
-            if(Index > 5)
-            {
-                return((TypeObject)0);
-            }
-            else
-            {
-                Obj = (TypeObject *)&ExtRegister;
-                Index -= 1;
-                Index *= 2;
-                Obj += Index;
-                if(isSet)
-                {
-                    Obj += 1;
-                }
-                return(*Obj);
-            }
+            Obj = (const TypeObject *)&ExtRegister;
+            NumAttr = 5;
+            NumMethod = 1;
+            break;
         }
         case CLASS_CLOCK:
         {
-            if(Index > 9)
-            {
-                return((TypeObject)0);
-            }
-            else
-            {
-                Obj = (TypeObject *)&Clock;
-                Index -= 1;
-                Index *= 2;
-                Obj += Index;
-                if(isSet)
-                {
-                    Obj += 1;
-                }
-                return(*Obj);
-            }
+            Obj = (const TypeObject *)&Clock;
+            NumAttr = 9;
+            NumMethod = 6;
+            break;
         }
         case CLASS_ASSOCIATION_LN:
         {
-            if(Index > 11)
-            {
-                return((TypeObject)0);
-            }
-            else
-            {
-                Obj = (TypeObject *)&AssociationLN;
-                Index -= 1;
-                Index *= 2;
-                Obj += Index;
-                if(isSet)
-                {
-                    Obj += 1;
-                }
-                return(*Obj);
-            }
+            Obj = (const TypeObject *)&AssociationLN;
+            NumAttr = 11;
+            NumMethod = 6;
+            break;
         }
         case CLASS_IMAGE_TRANSFER:
         {
-            if(Index > 7)
-            {
-                return((TypeObject)0);
-            }
-            else
-            {
-                Obj = (TypeObject *)&ImageTransfer;
-                Index -= 1;
-                Index *= 2;
-                Obj += Index;
-                if(isSet)
-                {
-                    Obj += 1;
-                }
-                return(*Obj);
-            }
+            Obj = (const TypeObject *)&ImageTransfer;
+            NumAttr = 7;
+            NumMethod = 4;
+            break;
         }
         case CLASS_HDLC_SETUP:
         {
-            if(Index > 9)
-            {
-                return((TypeObject)0);
-            }
-            else
-            {
-                Obj = (TypeObject *)&ImageTransfer;
-                Index -= 1;
-                Index *= 2;
-                Obj += Index;
-                if(isSet)
-                {
-                    Obj += 1;
-                }
-                return(*Obj);
-            }
+            Obj = (const TypeObject *)&HDLCSetup;
+            NumAttr = 9;
+            NumMethod = 0;
+            break;
+        }
+        case CLASS_PUSH_SETUP:
+        {
+            Obj = (const TypeObject *)&PushSetup;
+            NumAttr = 7;
+            NumMethod = 1;
+            break;
         }
         default:
         {
-            return((TypeObject)0);
+            Obj = (const TypeObject *)0;
+            NumAttr = 0;
+            NumMethod = 0;
+            break;
         }
     }
+    
+    if(Attr)
+    {
+        *Attr = NumAttr;
+    }
+    
+    if(Method)
+    {
+        *Method = NumMethod;
+    }
+    
+    return(Obj);
+}
+
+/**
+  * ȡһ
+  *
+  */
+TypeObject CosemLoadAttribute(uint16_t ClassID, uint8_t Index, bool isSet)
+{
+    const TypeObject *Obj;
+    uint8_t Attr;
+    
+    Obj = CosemLoadClass(ClassID, &Attr, (uint8_t *)0);
+    
+    if(!Obj || !Index || (Index > Attr))
+    {
+        return((TypeObject)0);
+    }
+    
+    Obj += (Index - 1) * 2;
+    if(isSet)
+    {
+        Obj += 1;
+    }
+    
+    return(*Obj);
 }
 
 /**
@@ -188,93 +150,58 @@ TypeObject CosemLoadAttribute(uint16_t ClassID, uint8_t Index, bool isSet)
   */
 TypeObject CosemLoadMethod(uint16_t ClassID, uint8_t Index)
 {
-    TypeObject *Obj = (TypeObject *)0;
+    const TypeObject *Obj;
+    uint8_t Attr;
+    uint8_t Method;
     
-    if(!Index)
+    Obj = CosemLoadClass(ClassID, &Attr, &Method);
+    
+    if(!Obj || !Index || (Index > Method))
     {
         return((TypeObject)0);
     }
     
-    switch(ClassID)
+    Obj += Attr * 2;
+    Obj += (Index - 1);
+    
+    return(*Obj);
+}
+
+/**
+  * ʽһѱĿ
+  * Ŀ֮ǰݿѾĲ֣ʣಿ־
+  *  true ʾĿfalse ʾα걣ڵУһݿ
+  */
+bool CosemStreamPush(ObjectPara *P, const uint8_t *Entry, uint16_t Length)
+{
+    uint16_t Remain;
+    uint16_t Pending;
+    
+    if(!P || !Entry || (P->Output.Filled > P->Output.Size))
     {
-        case CLASS_REGISTER:
-        {
-            if(Index > 1)
-            {
-                return((TypeObject)0);
-            }
-            else
-            {
-                Obj = (TypeObject *)&Register;
-                Obj += 3 * 2;
-                Index -= 1;
-                Obj += Index;
-                return(*Obj);
-            }
-        }
-        case CLASS_EXTREGISTER:
-        {
-            if(Index > 1)
-            {
-                return((TypeObject)0);
-            }
-            else
-            {
-                Obj = (TypeObject *)&ExtRegister;
-                Obj += 5 * 2;
-                Index -= 1;
-                Obj += Index;
-                return(*Obj);
-            }
-        }
-        case CLASS_CLOCK:
-        {
-            if(Index > 6)
-            {
-                return((TypeObject)0);
-            }
-            else
-            {
-                Obj = (TypeObject *)&Clock;
-                Obj += 9 * 2;
-                Index -= 1;
-                Obj += Index;
-                return(*Obj);
-            }
-        }
-        case CLASS_ASSOCIATION_LN:
-        {
-            if(Index > 6)
-            {
-                return((TypeObject)0);
-            }
-            else
-            {
-                Obj = (TypeObject *)&AssociationLN;
-                Obj += 11 * 2;
-                Index -= 1;
-                Obj += Index;
-                return(*Obj);
-            }
-        }
-        case CLASS_IMAGE_TRANSFER:
-        {
-            if(Index > 4)
-            {
-                return((TypeObject)0);
-            }
-            else
-            {
-                Obj = (TypeObject *)&ImageTransfer;
-                Obj += 7 * 2;
-                Index -= 1;
-                Obj += Index;
-                return(*Obj);
-            }
-        }
-        default:
-        {
-            return((TypeObject)0);
-        }
+        return(false);
     }
+    
+    if(P->Iterator.Offset >= Length)
+    {
+        P->Iterator.Offset = 0;
+        return(true);
+    }
+    
+    Remain = P->Output.Size - P->Output.Filled;
+    Pending = Length - P->Iterator.Offset;
+    
+    if(Pending <= Remain)
+    {
+        memcpy(P->Output.Buffer + P->Output.Filled, Entry + P->Iterator.Offset, Pending);
+        P->Output.Filled += Pending;
+        P->Iterator.Offset = 0;
+        return(true);
+    }
+    
+    memcpy(P->Output.Buffer + P->Output.Filled, Entry + P->Iterator.Offset, Remain);
+    P->Output.Filled += Remain;
+    P->Iterator.Offset += Remain;
+    
+    return(false);
 }
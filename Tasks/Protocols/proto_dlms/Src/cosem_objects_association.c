@@ -9,12 +9,12 @@
 #include "system.h"
 #include "axdr.h"
 #include "mbedtls/gcm.h"
-#include "mbedtls/ecdsa.h"
 #include "mbedtls/sha256.h"
 #include "mbedtls/sha512.h"
-#include "mbedtls/bignum.h"
 #include "dlms_association.h"
 #include "dlms_application.h"
+#include "dlms_lexicon.h"
+#include "dlms_crypto.h"
 #include "cosem_objects_association.h"
 
 /* Private typedef -----------------------------------------------------------*/
@@ -58,32 +58,129 @@ static ObjectErrs SetLogicalName(ObjectPara *P)
 }
 
 /**	
-  * @brief 
+  * @brief һ object_list_element
+  */
+static uint16_t EncodeObjectListElement(const struct __cosem_object *Object, enum __dlms_access_level Level, uint8_t *Buffer)
+{
+    uint16_t Length = 0;
+    uint16_t ClassID = Object->classid;
+    uint8_t Version = 0;
+    uint8_t Mode;
+    uint8_t Right;
+    uint8_t cnt;
+    
+    Buffer[Length++] = AXDR_STRUCTURE;
+    Buffer[Length++] = 4;
+    Length += axdr.encode(&ClassID, 0, AXDR_LONG_UNSIGNED, &Buffer[Length]);
+    Length += axdr.encode(&Version, 0, AXDR_UNSIGNED, &Buffer[Length]);
+    Length += axdr.encode(Object->obis, 6, AXDR_OCTET_STRING, &Buffer[Length]);
+    
+    //access_rights
+    Buffer[Length++] = AXDR_STRUCTURE;
+    Buffer[Length++] = 2;
+    
+    //attribute_access
+    Buffer[Length++] = AXDR_ARRAY;
+    Length += axdr.length.encode(Object->amount_of_attr, &Buffer[Length]);
+    for(cnt=0; cnt<Object->amount_of_attr; cnt++)
+    {
+        Right = (Level > DLMS_ACCESS_NO) ? Object->right_attr[cnt][Level - 1] : ATTR_NONE;
+        Mode = Right & (ATTR_READ | ATTR_WRITE);
+        if(Mode && (Right & ATTR_AUTHREQ))
+        {
+            Mode += 3;//authenticated_read_only, authenticated_write_only, authenticated_read_and_write
+        }
+        
+        Buffer[Length++] = AXDR_STRUCTURE;
+        Buffer[Length++] = 3;
+        Buffer[Length++] = AXDR_INTEGER;
+        Buffer[Length++] = cnt + 1;
+        Buffer[Length++] = AXDR_ENUM;
+        Buffer[Length++] = Mode;
+        Buffer[Length++] = AXDR_NULL;
+    }
+    
+    //method_access
+    Buffer[Length++] = AXDR_ARRAY;
+    Length += axdr.length.encode(Object->amount_of_method, &Buffer[Length]);
+    for(cnt=0; cnt<Object->amount_of_method; cnt++)
+    {
+        Right = (Level > DLMS_ACCESS_NO) ? Object->right_method[cnt][Level - 1] : METHOD_NONE;
+        Mode = 0;
+        if(Right & METHOD_ACCESS)
+        {
+            Mode = (Right & METHOD_AUTHREQ) ? 2 : 1;
+        }
+        
+        Buffer[Length++] = AXDR_STRUCTURE;
+        Buffer[Length++] = 2;
+        Buffer[Length++] = AXDR_INTEGER;
+        Buffer[Length++] = cnt + 1;
+        Buffer[Length++] = AXDR_ENUM;
+        Buffer[Length++] = Mode;
+    }
+    
+    return(Length);
+}
+
+/**	
+  * @brief ȡб
+  * Ŀ룬ʱɵα꣬б
   */
 static ObjectErrs GetObjectList(ObjectPara *P)
 {
-    /** ȡݱ̷ */
+    struct __cosem_object Object;
+    uint8_t Element[320];
+    uint16_t Length;
+    uint16_t Index;
+    uint16_t Total;
+    uint16_t Amount;
+    uint8_t Suit = dlms_asso_suit();
+    enum __dlms_access_level Level = dlms_asso_level();
     
     //жϵǷѾ
     if(!OBJ_IS_ITERATING(P))
     {
+        //ͬͳԪظ֤ͷʵһ
+        Total = dlms_lex_amount(0xff);
+        Amount = 0;
+        
+        for(Index=0; Index<Total; Index++)
+        {
+            if(dlms_lex_entry(Index, &Object) && (Object.suit & Suit))
+            {
+                Amount += 1;
+            }
+        }
+        
+        //ͷ
+        OBJ_OUT_ADDR(P)[0] = AXDR_ARRAY;
+        Length = 1 + axdr.length.encode(Amount, &OBJ_OUT_ADDR(P)[1]);
+        OBJ_PUSH_LENGTH(P, Length);
+        
         //ʼ
-        OBJ_ITERATE_INIT(P, 0, 10);
+        OBJ_ITERATE_INIT(P, 0, Total);
     }
     
     //ȡĿ
-    for(; OBJ_ITERATE_FROM(P) != OBJ_ITERATE_TO(P);)
+    while(OBJ_IS_ITERATING(P))
     {
-        //...ݵ
-        
-        
+        if(dlms_lex_entry(OBJ_ITERATE_FROM(P), &Object) && (Object.suit & Suit))
+        {
+            Length = EncodeObjectListElement(&Object, Level, Element);
+            
+            //һӵǰĿʣಿּ
+            if(!CosemStreamPush(P, Element, Length))
+            {
+                break;
+            }
+        }
         
         //
         OBJ_ITERATE_STEPPING(P);
     }
     
-    
-    return(OBJECT_ERR_NODEF);
+    return(OBJECT_NOERR);
 }
 
 /**	
@@ -239,16 +336,6 @@ static ObjectErrs SetCurrentUser(ObjectPara *P)
     return(OBJECT_ERR_NODEF);
 }
 
-/**	
-  * @brief 
-  */
-static int rng(void *p, unsigned char *buf, size_t blen)
-{
-	dlms_asso_random(blen, buf);
-	
-	return(0);
-}
-
 /**	
   * @brief 
   */
@@ -332,6 +419,11 @@ static ObjectErrs ReplytoHLSAuthentication(ObjectPara *P)
 			len_iv = dlms_asso_localtitle(iv);
 			len_iv += dlms_asso_fc(&iv[8]);
 			
+			if(len_iv != 12)
+			{
+				return(OBJECT_ERR_ENCODE);
+			}
+			
 			mbedtls_gcm_init(&ctx);
 			
 			ret = mbedtls_gcm_setkey(&ctx,
@@ -374,14 +466,12 @@ static ObjectErrs ReplytoHLSAuthentication(ObjectPara *P)
 		}
 		case 7:
 		{
-			mbedtls_ecdsa_context ctx;
-			mbedtls_mpi r, s;
 			uint8_t hash[48];
 			uint8_t ssprikey[48];
 			uint8_t len_ssprikey;
 			uint8_t cspubkey[96];
 			uint8_t len_cspubkey;
-			uint8_t z[48];
+			enum __crypto_result result;
 			
 			len_ssprikey = dlms_asso_ssprikey(ssprikey);
 			len_cspubkey = dlms_asso_cspubkey(cspubkey);
@@ -401,82 +491,34 @@ static ObjectErrs ReplytoHLSAuthentication(ObjectPara *P)
 				return(OBJECT_ERR_LOWLEVEL);
 			}
 			
-			heap.set(z, 0, sizeof(z));
-			z[len_ssprikey - 1] = 1;
+			//֤ͻǩ f(CtoS)
+			len_message = dlms_asso_callingtitle(&message[0]);
+			len_message += dlms_asso_localtitle(&message[8]);
+			len_message += dlms_asso_stoc(&message[16]);
+			len_message += dlms_asso_ctos(&message[16 + len_message]);
 			
-			mbedtls_mpi_init( &r );
-			mbedtls_mpi_init( &s );
-			mbedtls_ecp_keypair_init( &ctx );
 			if(len_cspubkey == 64)
 			{
-				mbedtls_ecp_group_load( &ctx.grp, MBEDTLS_ECP_DP_SECP256R1 );
+				ret = mbedtls_sha256_ret( message, len_message, hash, 0 );
 			}
 			else
 			{
-				mbedtls_ecp_group_load( &ctx.grp, MBEDTLS_ECP_DP_SECP384R1 );
-			}
-			
-			if((ret = mbedtls_mpi_read_binary(&ctx.d, ssprikey, len_ssprikey)) != 0)
-			{
-				goto cleanup;
-			}
-			if((ret = mbedtls_mpi_read_binary( &ctx.Q.X, &cspubkey[0], len_ssprikey)) != 0)
-			{
-				goto cleanup;
-			}
-			if((ret = mbedtls_mpi_read_binary( &ctx.Q.Y, &cspubkey[len_cspubkey/2], len_ssprikey)) != 0)
-			{
-				goto cleanup;
-			}
-			if((ret = mbedtls_mpi_read_binary( &ctx.Q.Z, z, len_ssprikey)) != 0)
-			{
-				goto cleanup;
+				ret = mbedtls_sha512_ret( message, len_message, hash, 1 );
 			}
 			
-			if((ret = mbedtls_mpi_read_binary(&r, &OBJ_IN_ADDR(P)[2+0], len_ssprikey)) != 0)
-			{
-				goto cleanup;
-			}
-			if((ret = mbedtls_mpi_read_binary(&s, &OBJ_IN_ADDR(P)[2+len_ssprikey], len_ssprikey)) != 0)
+			if(ret != 0)
 			{
-				goto cleanup;
+				return(OBJECT_ERR_LOWLEVEL);
 			}
 			
-			len_message = dlms_asso_callingtitle(&message[0]);
-			len_message += dlms_asso_localtitle(&message[8]);
-			len_message += dlms_asso_stoc(&message[16]);
-			len_message += dlms_asso_ctos(&message[16 + len_message]);
-			
-			if(len_cspubkey == 64)
+			//ʱӦò㶪νԺύ
+			result = dlms_crypto_verify(cspubkey, len_ssprikey, hash, &OBJ_IN_ADDR(P)[2]);
+			if(result != CRYPTO_SUCCESS)
 			{
-				if( ( ret = mbedtls_sha256_ret( message, len_message, hash, 0 ) ) != 0 )
-				{
-					goto cleanup;
-				}
-				if( ( ret = mbedtls_ecdsa_verify( &ctx.grp, hash, 32, \
-													 &ctx.Q, &r, &s) ) != 0 )
-				{
-					goto cleanup;
-				}
-			}
-			else
-			{
-				if( ( ret = mbedtls_sha512_ret( message, len_message, hash, 1 ) ) != 0 )
-				{
-					goto cleanup;
-				}
-				if( ( ret = mbedtls_ecdsa_verify( &ctx.grp, hash, 48, \
-													 &ctx.Q, &r, &s) ) != 0 )
-				{
-					goto cleanup;
-				}
+				return(OBJECT_ERR_LOWLEVEL);
 			}
 			
-			mbedtls_mpi_free( &r );
-			mbedtls_mpi_free( &s );
-			mbedtls_mpi_init( &r );
-			mbedtls_mpi_init( &s );
-			
+			//ɷǩ f(StoC)
 			len_message = dlms_asso_localtitle(&message[0]);
 			len_message += dlms_asso_callingtitle(&message[8]);
 			len_message += dlms_asso_ctos(&message[16]);
@@ -484,55 +526,31 @@ static ObjectErrs ReplytoHLSAuthentication(ObjectPara *P)
 			
 			if(len_cspubkey == 64)
 			{
-				if( ( ret = mbedtls_sha256_ret( message, len_message, hash, 0 ) ) != 0 )
-				{
-					goto cleanup;
-				}
-				
-				if( ( ret = mbedtls_ecdsa_sign( &ctx.grp, &r, &s, &ctx.d, hash, 32, \
-												   rng, NULL) ) != 0 )
-				{
-					goto cleanup;
-				}
+				ret = mbedtls_sha256_ret( message, len_message, hash, 0 );
 			}
 			else
 			{
-				if( ( ret = mbedtls_sha512_ret( message, len_message, hash, 1 ) ) != 0 )
-				{
-					goto cleanup;
-				}
-				
-				if( ( ret = mbedtls_ecdsa_sign( &ctx.grp, &r, &s, &ctx.d, hash, 48, \
-												   rng, NULL) ) != 0 )
-				{
-					goto cleanup;
-				}
+				ret = mbedtls_sha512_ret( message, len_message, hash, 1 );
 			}
 			
-			axdr.type.encode(AXDR_OCTET_STRING, &OBJ_OUT_ADDR(P)[0]);
-			axdr.length.encode(len_cspubkey, &OBJ_OUT_ADDR(P)[1]);
-			
-			if( ( ret = mbedtls_mpi_write_binary( &r, &OBJ_OUT_ADDR(P)[2 + 0], len_ssprikey ) ) != 0 )
+			if(ret != 0)
 			{
-				goto cleanup;
+				return(OBJECT_ERR_LOWLEVEL);
 			}
-			if( ( ret = mbedtls_mpi_write_binary( &s, &OBJ_OUT_ADDR(P)[2 + len_ssprikey], len_ssprikey ) ) != 0 )
+			
+			result = dlms_crypto_sign(ssprikey, len_ssprikey, hash, &OBJ_OUT_ADDR(P)[2]);
+			heap.set(ssprikey, 0, sizeof(ssprikey));
+			if(result != CRYPTO_SUCCESS)
 			{
-				goto cleanup;
+				return(OBJECT_ERR_LOWLEVEL);
 			}
 			
+			axdr.type.encode(AXDR_OCTET_STRING, &OBJ_OUT_ADDR(P)[0]);
+			axdr.length.encode(len_cspubkey, &OBJ_OUT_ADDR(P)[1]);
+			
 			OBJ_PUSH_LENGTH(P, (2 + len_cspubkey));
 			
 			dlms_asso_accept_fctos();
-cleanup:
-			mbedtls_mpi_free( &r );
-			mbedtls_mpi_free( &s );
-			mbedtls_ecdsa_free( &ctx );
-			if(ret != 0)
-			{
-				return(OBJECT_ERR_LOWLEVEL);
-			}
-			
 			break;
 		}
 	}
@@ -8,17 +8,186 @@
 #include "system.h"
 #include "string.h"
 #include "axdr.h"
+#include "mbedtls/sha256.h"
+#include "dlms_association.h"
 #include "dlms_application.h"
 #include "cosem_objects_imagetransfer.h"
 #include "dlms_lexicon.h"
 
 /* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief ״̬image_transfer_status
+  */
+enum __image_status
+{
+    IMAGE_NOT_INITIATED = 0,
+    IMAGE_INITIATED,
+    IMAGE_VERIFY_INITIATED,
+    IMAGE_VERIFY_SUCCESSFUL,
+    IMAGE_VERIFY_FAILED,
+    IMAGE_ACTIVATION_INITIATED,
+    IMAGE_ACTIVATION_SUCCESSFUL,
+    IMAGE_ACTIVATION_FAILED,
+};
+
 /* Private define ------------------------------------------------------------*/
+#if !defined(IMAGE_CONTAINER)
+#define IMAGE_CONTAINER                 "firmware" //ŵ CT_PARALLEL 
+#endif
+
+#if !defined(IMAGE_PAGE_SIZE)
+#if defined (BUILD_REAL_WORLD)
+#define IMAGE_PAGE_SIZE                 ((uint32_t)512) //дϲλļϵͳСһ£Ϊ 2 ݣ
+#else
+#define IMAGE_PAGE_SIZE                 ((uint32_t)4096) //дϲλļϵͳСһ£Ϊ 2 ݣ
+#endif
+#endif
+
+#if !defined(IMAGE_SIZE_MAX)
+#define IMAGE_SIZE_MAX                  ((uint32_t)512*1024) //񳤶
+#endif
+
+#define IMAGE_BLOCK_MIN                 ((uint32_t)64) //С鳤
+#define IMAGE_BLOCK_OVERHEAD            ((uint32_t)64) //ACTION гıĿ
+#define IMAGE_IDENTIFIER_MAX            ((uint8_t)32) //ʶ󳤶
+#define IMAGE_BITMAP_SIZE               ((IMAGE_SIZE_MAX / IMAGE_BLOCK_MIN + 7) / 8)
+
 /* Private variables ---------------------------------------------------------*/
+/**
+  * @brief 
+  */
+static struct
+{
+    uint8_t                 Enabled; //image_transfer_enabled
+    uint8_t                 Status; //image_transfer_status
+    uint8_t                 Identifier[IMAGE_IDENTIFIER_MAX]; //ʶ
+    uint8_t                 IdentifierLength;
+    uint8_t                 Signature[32]; //Initiate Яľ SHA-256 ժҪΪУĲοֵ
+    uint8_t                 SignatureLength;
+    uint32_t                BlockSize; //δĿ鳤ȣ0 ʾʹĬֵ
+    uint32_t                Size; //񳤶
+    uint32_t                Blocks; //
+    uint32_t                Page; //ںϲҳţ֮ǰҳѰ˳д
+    uint8_t                 Buffer[IMAGE_PAGE_SIZE]; //ϲ壬ѯ֣ʹöʱڴ
+    mbedtls_sha256_context  Sha; //ʽժҪ
+    uint8_t                 Digest[32]; //ժҪ
+    uint8_t                 Bitmap[IMAGE_BITMAP_SIZE]; //Ѵλͼλǰ
+    
+} Image = {.Enabled = 1};
+
 /* Private macro -------------------------------------------------------------*/
+#define IMAGE_BLOCK_TRANSFERRED(n)      ((Image.Bitmap[(n) / 8] & (0x80 >> ((n) % 8))) != 0)
+#define IMAGE_BLOCK_MARK(n)             (Image.Bitmap[(n) / 8] |= (0x80 >> ((n) % 8)))
+#define IMAGE_BLOCK_CLEAR(n)            (Image.Bitmap[(n) / 8] &= ~(0x80 >> ((n) % 8)))
+
 /* Private variables ---------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
+/**
+  * @brief ĬϿ鳤ȣӦܷһ ACTION 
+  * ȡ 2 ݣʹÿҳǡ飬鲻ҳ
+  */
+static uint32_t ImageBlockDefault(void)
+{
+    uint32_t Limit = dlms_asso_mtu();
+    uint32_t Size = IMAGE_PAGE_SIZE;
+    
+    Limit = (Limit > (IMAGE_BLOCK_MIN + IMAGE_BLOCK_OVERHEAD))? (Limit - IMAGE_BLOCK_OVERHEAD) : IMAGE_BLOCK_MIN;
+    
+    while((Size > IMAGE_BLOCK_MIN) && (Size > Limit))
+    {
+        Size >>= 1;
+    }
+    
+    return(Size);
+}
+
+/**
+  * @brief  n ĳȣһܲһ鳤
+  */
+static uint32_t ImageBlockLength(uint32_t n)
+{
+    uint32_t Offset = n * Image.BlockSize;
+    
+    if(n >= Image.Blocks)
+    {
+        return(0);
+    }
+    
+    return(((Image.Size - Offset) < Image.BlockSize)? (Image.Size - Offset) : Image.BlockSize);
+}
+
+/**
+  * @brief ںϲҳпǷѵ
+  */
+static bool ImagePageComplete(void)
+{
+    uint32_t From = (Image.Page * IMAGE_PAGE_SIZE) / Image.BlockSize;
+    uint32_t To = ((Image.Page + 1) * IMAGE_PAGE_SIZE) / Image.BlockSize;
+    
+    if(To > Image.Blocks)
+    {
+        To = Image.Blocks;
+    }
+    
+    for(; From<To; From++)
+    {
+        if(!IMAGE_BLOCK_TRANSFERRED(From))
+        {
+            return(false);
+        }
+    }
+    
+    return(true);
+}
+
+/**
+  * @brief ϲɵҳ׷дժҪ
+  * ֻļĩβ׷ӣļϵͳΪмддļβ
+  */
+static bool ImagePageCommit(void)
+{
+    uint32_t Count = Image.Size - Image.Page * IMAGE_PAGE_SIZE;
+    
+    Count = (Count > IMAGE_PAGE_SIZE)? IMAGE_PAGE_SIZE : Count;
+    
+    if(file.parallel.write(IMAGE_CONTAINER, Image.Page, IMAGE_PAGE_SIZE, Image.Buffer) != IMAGE_PAGE_SIZE)
+    {
+        return(false);
+    }
+    
+    mbedtls_sha256_update_ret(&Image.Sha, Image.Buffer, Count);
+    
+    Image.Page += 1;
+    heap.set(Image.Buffer, 0xff, IMAGE_PAGE_SIZE);
+    
+    return(true);
+}
+
+/**
+  * @brief ȡ A-XDR λؽֽ
+  */
+static uint16_t DecodeOctetString(const uint8_t *In, uint16_t Size, const uint8_t **Data, uint16_t *Length)
+{
+    uint16_t Decoded;
+    
+    if((Size < 2) || (In[0] != AXDR_OCTET_STRING))
+    {
+        return(0);
+    }
+    
+    Decoded = 1 + axdr.length.decode(&In[1], Length);
+    
+    if((Decoded + *Length) > Size)
+    {
+        return(0);
+    }
+    
+    *Data = &In[Decoded];
+    
+    return(Decoded + *Length);
+}
+
 /**
   * 
   *
@@ -60,7 +229,14 @@ static ObjectErrs SetLogicalName(ObjectPara *P)
   */
 static ObjectErrs GetBlockSize(ObjectPara *P)
 {
-    return(OBJECT_ERR_LOWLEVEL);
+    uint16_t Length;
+    uint32_t Size = Image.BlockSize? Image.BlockSize : ImageBlockDefault();
+    
+    Length = axdr.encode(&Size, sizeof(Size), AXDR_DOUBLE_LONG_UNSIGNED, OBJ_OUT_ADDR(P));
+    
+    OBJ_PUSH_LENGTH(P, Length);
+    
+    return(OBJECT_NOERR);
 }
 
 /**
@@ -73,12 +249,34 @@ static ObjectErrs SetBlockSize(ObjectPara *P)
 }
 
 /**
-  * 
+  * λϳʱֿ
   *
   */
 static ObjectErrs GetTransferredBlocksStatus(ObjectPara *P)
 {
-    return(OBJECT_ERR_LOWLEVEL);
+    uint16_t Length;
+    
+    //жϵǷѾ
+    if(!OBJ_IS_ITERATING(P))
+    {
+        OBJ_OUT_ADDR(P)[0] = AXDR_BIT_STRING;
+        Length = 1 + axdr.length.encode(Image.Blocks, &OBJ_OUT_ADDR(P)[1]);
+        OBJ_PUSH_LENGTH(P, Length);
+        
+        OBJ_ITERATE_INIT(P, 0, ((Image.Blocks + 7) / 8));
+    }
+    
+    while(OBJ_IS_ITERATING(P))
+    {
+        if(!CosemStreamPush(P, &Image.Bitmap[OBJ_ITERATE_FROM(P)], 1))
+        {
+            break;
+        }
+        
+        OBJ_ITERATE_STEPPING(P);
+    }
+    
+    return(OBJECT_NOERR);
 }
 
 /**
@@ -96,7 +294,34 @@ static ObjectErrs SetTransferredBlocksStatus(ObjectPara *P)
   */
 static ObjectErrs GetFirstNotTransferredBlockNumber(ObjectPara *P)
 {
-    return(OBJECT_ERR_LOWLEVEL);
+    uint16_t Length;
+    uint32_t Number;
+    
+    for(Number=0; Number<Image.Blocks; Number++)
+    {
+        //ֽ
+        if(((Number % 8) == 0) && (Image.Bitmap[Number / 8] == 0xff))
+        {
+            Number += 7;
+            continue;
+        }
+        
+        if(!IMAGE_BLOCK_TRANSFERRED(Number))
+        {
+            break;
+        }
+    }
+    
+    if(Number > Image.Blocks)
+    {
+        Number = Image.Blocks;
+    }
+    
+    Length = axdr.encode(&Number, sizeof(Number), AXDR_DOUBLE_LONG_UNSIGNED, OBJ_OUT_ADDR(P));
+    
+    OBJ_PUSH_LENGTH(P, Length);
+    
+    return(OBJECT_NOERR);
 }
 
 /**
@@ -114,7 +339,13 @@ static ObjectErrs SetFirstNotTransferredBlockNumber(ObjectPara *P)
   */
 static ObjectErrs GetTransferEnabled(ObjectPara *P)
 {
-    return(OBJECT_ERR_LOWLEVEL);
+    uint16_t Length;
+    
+    Length = axdr.encode(&Image.Enabled, sizeof(Image.Enabled), AXDR_BOOLEAN, OBJ_OUT_ADDR(P));
+    
+    OBJ_PUSH_LENGTH(P, Length);
+    
+    return(OBJECT_NOERR);
 }
 
 /**
@@ -123,7 +354,14 @@ static ObjectErrs GetTransferEnabled(ObjectPara *P)
   */
 static ObjectErrs SetTransferEnabled(ObjectPara *P)
 {
-    return(OBJECT_ERR_LOWLEVEL);
+    if((OBJ_IN_SIZE(P) < 2) || (OBJ_IN_ADDR(P)[0] != AXDR_BOOLEAN))
+    {
+        return(OBJECT_ERR_TYPE);
+    }
+    
+    Image.Enabled = OBJ_IN_ADDR(P)[1]? 1 : 0;
+    
+    return(OBJECT_NOERR);
 }
 
 /**
@@ -132,7 +370,13 @@ static ObjectErrs SetTransferEnabled(ObjectPara *P)
   */
 static ObjectErrs GetTransferStatus(ObjectPara *P)
 {
-    return(OBJECT_ERR_LOWLEVEL);
+    uint16_t Length;
+    
+    Length = axdr.encode(&Image.Status, sizeof(Image.Status), AXDR_ENUM, OBJ_OUT_ADDR(P));
+    
+    OBJ_PUSH_LENGTH(P, Length);
+    
+    return(OBJECT_NOERR);
 }
 
 /**
@@ -145,12 +389,40 @@ static ObjectErrs SetTransferStatus(ObjectPara *P)
 }
 
 /**
-  * 
+  * ǩֶΪ Initiate Яľ SHA-256 ժҪ
   *
   */
 static ObjectErrs GetActivateInfo(ObjectPara *P)
 {
-    return(OBJECT_ERR_LOWLEVEL);
+    uint8_t *Buffer = OBJ_OUT_ADDR(P);
+    uint16_t Length;
+    
+    if(Image.Status == IMAGE_NOT_INITIATED)
+    {
+        Buffer[0] = AXDR_ARRAY;
+        Buffer[1] = 0;
+        OBJ_PUSH_LENGTH(P, 2);
+        return(OBJECT_NOERR);
+    }
+    
+    if(OBJ_OUT_SIZE(P) < (4 + 5 + 2 + Image.IdentifierLength + 2 + sizeof(Image.Signature)))
+    {
+        return(OBJECT_ERR_MEM);
+    }
+    
+    Buffer[0] = AXDR_ARRAY;
+    Buffer[1] = 1;
+    Buffer[2] = AXDR_STRUCTURE;
+    Buffer[3] = 3;
+    Length = 4;
+    
+    Length += axdr.encode(&Image.Size, sizeof(Image.Size), AXDR_DOUBLE_LONG_UNSIGNED, &Buffer[Length]);
+    Length += axdr.encode(Image.Identifier, Image.IdentifierLength, AXDR_OCTET_STRING, &Buffer[Length]);
+    Length += axdr.encode(Image.Signature, Image.SignatureLength, AXDR_OCTET_STRING, &Buffer[Length]);
+    
+    OBJ_PUSH_LENGTH(P, Length);
+    
+    return(OBJECT_NOERR);
 }
 
 /**
@@ -163,39 +435,263 @@ static ObjectErrs SetActivateInfo(ObjectPara *P)
 }
 
 /**
-  * 
-  *
+  *  structure{image_identifier, image_size, image_signature}
+  * image_signature Ϊ SHA-256 ժҪУʱΪοֵȱʡʱ޷ͨУ
+  * ղ³ʼ̼λͼʼʽժҪ
   */
 static ObjectErrs Initiate(ObjectPara *P)
 {
-    return(OBJECT_ERR_LOWLEVEL);
+    const uint8_t *In = OBJ_IN_ADDR(P);
+    const uint8_t *Identifier;
+    const uint8_t *Signature = (const uint8_t *)0;
+    uint16_t Size = OBJ_IN_SIZE(P);
+    uint16_t Length;
+    uint16_t SignatureLength = 0;
+    uint16_t Decoded;
+    uint32_t ImageSize = 0;
+    struct __parallel_info Info;
+    
+    if(!Image.Enabled)
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    if(!In || (Size < 4) || (In[0] != AXDR_STRUCTURE) || ((In[1] != 2) && (In[1] != 3)))
+    {
+        return(OBJECT_ERR_DECODE);
+    }
+    
+    Decoded = DecodeOctetString(&In[2], (Size - 2), &Identifier, &Length);
+    
+    if(!Decoded || (Length > IMAGE_IDENTIFIER_MAX))
+    {
+        return(OBJECT_ERR_DECODE);
+    }
+    
+    Decoded += 2;
+    
+    if(((Decoded + 5) > Size) || (In[Decoded] != AXDR_DOUBLE_LONG_UNSIGNED))
+    {
+        return(OBJECT_ERR_DECODE);
+    }
+    
+    axdr.decode(&In[Decoded], 0, &ImageSize);
+    
+    if(In[1] == 3)
+    {
+        Decoded += 5;
+        
+        if(!DecodeOctetString(&In[Decoded], (Size - Decoded), &Signature, &SignatureLength) || \
+            (SignatureLength != sizeof(Image.Signature)))
+        {
+            return(OBJECT_ERR_DECODE);
+        }
+    }
+    
+    if(!ImageSize || (ImageSize > IMAGE_SIZE_MAX))
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    Image.Status = IMAGE_NOT_INITIATED;
+    
+    //ҳžֻ֮ļĩβ׷
+    if(!file.parallel.reset(IMAGE_CONTAINER) || \
+        !file.parallel.init(IMAGE_CONTAINER, IMAGE_PAGE_SIZE) || \
+        !file.parallel.info(IMAGE_CONTAINER, &Info))
+    {
+        return(OBJECT_ERR_LOWLEVEL);
+    }
+    
+    if(((uint32_t)Info.capacity * Info.length) < ImageSize)
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    heap.copy(Image.Identifier, Identifier, Length);
+    Image.IdentifierLength = (uint8_t)Length;
+    heap.set(Image.Signature, 0, sizeof(Image.Signature));
+    if(Signature)
+    {
+        heap.copy(Image.Signature, Signature, SignatureLength);
+    }
+    Image.SignatureLength = (uint8_t)SignatureLength;
+    
+    Image.BlockSize = ImageBlockDefault();
+    Image.Size = ImageSize;
+    Image.Blocks = (ImageSize + Image.BlockSize - 1) / Image.BlockSize;
+    Image.Page = 0;
+    heap.set(Image.Buffer, 0xff, sizeof(Image.Buffer));
+    heap.set(Image.Bitmap, 0, sizeof(Image.Bitmap));
+    heap.set(Image.Digest, 0, sizeof(Image.Digest));
+    
+    //ͷһδδժҪ
+    mbedtls_sha256_free(&Image.Sha);
+    mbedtls_sha256_init(&Image.Sha);
+    mbedtls_sha256_starts_ret(&Image.Sha, 0);
+    
+    Image.Status = IMAGE_INITIATED;
+    
+    return(OBJECT_NOERR);
 }
 
 /**
-  * 
-  *
+  *  structure{image_block_number, image_block_value}
+  * ںϲҳڿ򵽴ظĿֱȷ
+  * ҳĿڵǰҳϲǰܾͻ˰ image_first_not_transferred_block_number ش
   */
 static ObjectErrs BlockTransfer(ObjectPara *P)
 {
-    return(OBJECT_ERR_LOWLEVEL);
+    const uint8_t *In = OBJ_IN_ADDR(P);
+    const uint8_t *Value;
+    uint16_t Size = OBJ_IN_SIZE(P);
+    uint16_t Length;
+    uint32_t Number = 0;
+    uint32_t Offset;
+    
+    if((Image.Status != IMAGE_INITIATED) || !Image.Enabled)
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    if(!In || (Size < 9) || (In[0] != AXDR_STRUCTURE) || (In[1] != 2) || \
+        (In[2] != AXDR_DOUBLE_LONG_UNSIGNED))
+    {
+        return(OBJECT_ERR_DECODE);
+    }
+    
+    axdr.decode(&In[2], 0, &Number);
+    
+    if(!DecodeOctetString(&In[7], (Size - 7), &Value, &Length))
+    {
+        return(OBJECT_ERR_DECODE);
+    }
+    
+    if((Number >= Image.Blocks) || (Length != ImageBlockLength(Number)))
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    if(IMAGE_BLOCK_TRANSFERRED(Number))
+    {
+        return(OBJECT_NOERR);
+    }
+    
+    Offset = Number * Image.BlockSize;
+    
+    //ֻ׷д룬ںϲҳ
+    if((Offset / IMAGE_PAGE_SIZE) != Image.Page)
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    heap.copy(&Image.Buffer[Offset % IMAGE_PAGE_SIZE], Value, Length);
+    IMAGE_BLOCK_MARK(Number);
+    
+    if(ImagePageComplete() && !ImagePageCommit())
+    {
+        //дʧܣҪششʱٴγд
+        IMAGE_BLOCK_CLEAR(Number);
+        return(OBJECT_ERR_LOWLEVEL);
+    }
+    
+    return(OBJECT_NOERR);
 }
 
 /**
-  * 
-  *
+  * п鵽ʽժҪٶݼժҪ
+  * ߶ Initiate ЯĲοժҪһ
   */
 static ObjectErrs Verify(ObjectPara *P)
 {
-    return(OBJECT_ERR_LOWLEVEL);
+    uint8_t Digest[32];
+    mbedtls_sha256_context Sha;
+    uint32_t Page;
+    uint32_t Count;
+    
+    if((Image.Status == IMAGE_VERIFY_SUCCESSFUL) || (Image.Status == IMAGE_ACTIVATION_SUCCESSFUL))
+    {
+        return(OBJECT_NOERR);
+    }
+    
+    if(Image.Status != IMAGE_INITIATED)
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    //ҳδд
+    if((Image.Page * IMAGE_PAGE_SIZE) < Image.Size)
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    Image.Status = IMAGE_VERIFY_INITIATED;
+    
+    mbedtls_sha256_finish_ret(&Image.Sha, Image.Digest);
+    mbedtls_sha256_free(&Image.Sha);
+    
+    mbedtls_sha256_init(&Sha);
+    mbedtls_sha256_starts_ret(&Sha, 0);
+    
+    for(Page=0; (Page * IMAGE_PAGE_SIZE)<Image.Size; Page++)
+    {
+        if(file.parallel.read(IMAGE_CONTAINER, Page, IMAGE_PAGE_SIZE, Image.Buffer) != IMAGE_PAGE_SIZE)
+        {
+            break;
+        }
+        
+        Count = Image.Size - Page * IMAGE_PAGE_SIZE;
+        Count = (Count > IMAGE_PAGE_SIZE)? IMAGE_PAGE_SIZE : Count;
+        
+        mbedtls_sha256_update_ret(&Sha, Image.Buffer, Count);
+    }
+    
+    mbedtls_sha256_finish_ret(&Sha, Digest);
+    mbedtls_sha256_free(&Sha);
+    
+    if(((Page * IMAGE_PAGE_SIZE) < Image.Size) || \
+        (Image.SignatureLength != sizeof(Image.Signature)) || \
+        (memcmp(Image.Digest, Image.Signature, sizeof(Image.Signature)) != 0) || \
+        (memcmp(Digest, Image.Signature, sizeof(Image.Signature)) != 0))
+    {
+        Image.Status = IMAGE_VERIFY_FAILED;
+        return(OBJECT_ERR_DATA);
+    }
+    
+    Image.Status = IMAGE_VERIFY_SUCCESSFUL;
+    
+    return(OBJECT_NOERR);
 }
 
 /**
-  * 
+  * ¼ǩжϾǷ
   *
   */
 static ObjectErrs Activate(ObjectPara *P)
 {
-    return(OBJECT_ERR_LOWLEVEL);
+    uint32_t Signature;
+    
+    if(Image.Status == IMAGE_ACTIVATION_SUCCESSFUL)
+    {
+        return(OBJECT_NOERR);
+    }
+    
+    if(Image.Status != IMAGE_VERIFY_SUCCESSFUL)
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    Image.Status = IMAGE_ACTIVATION_INITIATED;
+    
+    if(!file.parallel.signature(IMAGE_CONTAINER, &Signature))
+    {
+        Image.Status = IMAGE_ACTIVATION_FAILED;
+        return(OBJECT_ERR_LOWLEVEL);
+    }
+    
+    Image.Status = IMAGE_ACTIVATION_SUCCESSFUL;
+    
+    return(OBJECT_NOERR);
 }
 
 /**	
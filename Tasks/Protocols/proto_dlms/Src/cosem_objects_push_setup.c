@@ -0,0 +1,255 @@
+/**
+ * @brief
+ * @details
+ * @date		2026-10-19
+ **/
+
+/* Includes ------------------------------------------------------------------*/
+#include "system.h"
+#include "axdr.h"
+#include "dlms_application.h"
+#include "dlms_push.h"
+#include "cosem_objects_push_setup.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief ȡǰʵһ
+  */
+static ObjectErrs GetAttribute(ObjectPara *P, uint8_t Attr)
+{
+    uint16_t Length;
+    uint8_t Name[6] = {0};
+    uint8_t Index;
+    
+    if(!dlms_appl_instance(Name))
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    Index = dlms_push_index(Name);
+    
+    if(Index == 0xff)
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    Length = dlms_push_load(Index, Attr, OBJ_OUT_ADDR(P), OBJ_OUT_SIZE(P));
+    
+    if(!Length)
+	{
+		return(OBJECT_ERR_ENCODE);
+	}
+    
+    OBJ_PUSH_LENGTH(P, Length);
+    
+    return(OBJECT_NOERR);
+}
+
+/**
+  * @brief ޸ĵǰʵһ
+  */
+static ObjectErrs SetAttribute(ObjectPara *P, uint8_t Attr)
+{
+    uint8_t Name[6] = {0};
+    uint8_t Index;
+    
+    if(!dlms_appl_instance(Name))
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    Index = dlms_push_index(Name);
+    
+    if(Index == 0xff)
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    if(!OBJ_IN_SIZE(P))
+    {
+        return(OBJECT_ERR_TYPE);
+    }
+    
+    if(!dlms_push_write(Index, Attr, OBJ_IN_ADDR(P), OBJ_IN_SIZE(P)))
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    return(OBJECT_NOERR);
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs GetLogicalName(ObjectPara *P)
+{
+    uint16_t Length;
+    uint8_t Name[6] = {0};
+    
+    if(!dlms_appl_instance(Name))
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    Length = axdr.encode(Name, sizeof(Name), AXDR_OCTET_STRING, OBJ_OUT_ADDR(P));
+    
+    if(!Length)
+	{
+		return(OBJECT_ERR_ENCODE);
+	}
+    
+    OBJ_PUSH_LENGTH(P, Length);
+    
+    return(OBJECT_NOERR);
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs SetLogicalName(ObjectPara *P)
+{
+    return(OBJECT_ERR_LOWLEVEL);
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs GetPushObjectList(ObjectPara *P)
+{
+    return(GetAttribute(P, 2));
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs SetPushObjectList(ObjectPara *P)
+{
+    return(SetAttribute(P, 2));
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs GetSendDestinationAndMethod(ObjectPara *P)
+{
+    return(GetAttribute(P, 3));
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs SetSendDestinationAndMethod(ObjectPara *P)
+{
+    return(SetAttribute(P, 3));
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs GetCommunicationWindow(ObjectPara *P)
+{
+    return(GetAttribute(P, 4));
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs SetCommunicationWindow(ObjectPara *P)
+{
+    return(SetAttribute(P, 4));
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs GetRandomisationStartInterval(ObjectPara *P)
+{
+    return(GetAttribute(P, 5));
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs SetRandomisationStartInterval(ObjectPara *P)
+{
+    return(SetAttribute(P, 5));
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs GetNumberofRetries(ObjectPara *P)
+{
+    return(GetAttribute(P, 6));
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs SetNumberofRetries(ObjectPara *P)
+{
+    return(SetAttribute(P, 6));
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs GetRepetitionDelay(ObjectPara *P)
+{
+    return(GetAttribute(P, 7));
+}
+
+/**
+  * @brief
+  */
+static ObjectErrs SetRepetitionDelay(ObjectPara *P)
+{
+    return(SetAttribute(P, 7));
+}
+
+/**
+  * @brief һͣΪ integer(0)
+  */
+static ObjectErrs Push(ObjectPara *P)
+{
+    uint8_t Name[6] = {0};
+    
+    if(!dlms_appl_instance(Name))
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    if(!dlms_push_trigger(dlms_push_index(Name)))
+    {
+        return(OBJECT_ERR_DATA);
+    }
+    
+    return(OBJECT_NOERR);
+}
+
+
+
+const ClassPushSetup PushSetup =
+{
+    .GetLogicalName                 = GetLogicalName,
+    .SetLogicalName                 = SetLogicalName,
+    .GetPushObjectList              = GetPushObjectList,
+    .SetPushObjectList              = SetPushObjectList,
+    .GetSendDestinationAndMethod    = GetSendDestinationAndMethod,
+    .SetSendDestinationAndMethod    = SetSendDestinationAndMethod,
+    .GetCommunicationWindow         = GetCommunicationWindow,
+    .SetCommunicationWindow         = SetCommunicationWindow,
+    .GetRandomisationStartInterval  = GetRandomisationStartInterval,
+    .SetRandomisationStartInterval  = SetRandomisationStartInterval,
+    .GetNumberofRetries             = GetNumberofRetries,
+    .SetNumberofRetries             = SetNumberofRetries,
+    .GetRepetitionDelay             = GetRepetitionDelay,
+    .SetRepetitionDelay             = SetRepetitionDelay,
+    .Push                           = Push,
+};
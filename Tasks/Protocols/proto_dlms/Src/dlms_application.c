@@ -12,17 +12,26 @@
 #include "dlms_application.h"
 #include "dlms_association.h"
 #include "dlms_lexicon.h"
+#include "dlms_crypto.h"
 #include "cosem_objects.h"
 #include "axdr.h"
 #include "mids.h"
 #include "mbedtls/gcm.h"
-#include "mbedtls/ecdsa.h"
 #include "mbedtls/sha256.h"
 #include "mbedtls/sha512.h"
-#include "mbedtls/bignum.h"
+
+#if defined ( DLMS_CONFIG_PARALLEL )
+#include <pthread.h>
+#endif
 
 /* Private define ------------------------------------------------------------*/
-#define DLMS_REQ_LIST_MAX   ((uint8_t)6) //һɽܵ
+#if !defined(DLMS_REQ_LIST_MAX)
+#if defined (BUILD_REAL_WORLD)
+#define DLMS_REQ_LIST_MAX   ((uint8_t)6) //һɽܵڱʱã127
+#else
+#define DLMS_REQ_LIST_MAX   ((uint8_t)32) //һɽܵڱʱã127
+#endif
+#endif
 
 /* Private typedef -----------------------------------------------------------*/
 /**	
@@ -39,6 +48,7 @@ enum __appl_result
     APPL_OBJ_OVERFLOW,
     APPL_UNSUPPORT,
     APPL_ENC_FAILD,
+    APPL_DEFERRED,//ȴǩ
     APPL_OTHERS,
 };
 
@@ -122,20 +132,39 @@ struct __cosem_request
 {
     uint8_t Actived; //Ŀ
     uint32_t Block; //
-    struct __cosem_instance Entry[DLMS_REQ_LIST_MAX]; //Ŀ
+    struct __cosem_instance Entry[]; //ĿӸڴС
 };
 
 /* Private macro -------------------------------------------------------------*/
+// n ĿӸڴС
+#define COSEM_REQUEST_SIZE(n)       (sizeof(struct __cosem_request) + (n) * sizeof(struct __cosem_instance))
+
+#if defined ( DLMS_CONFIG_PARALLEL )
+//дͷöռݶ
+#define OBJECT_LOCK(exclusive)      ((exclusive)? pthread_rwlock_wrlock(&object_lock) : pthread_rwlock_rdlock(&object_lock))
+#define OBJECT_UNLOCK()             pthread_rwlock_unlock(&object_lock)
+#else
+#define OBJECT_LOCK(exclusive)
+#define OBJECT_UNLOCK()
+#endif
+
 /* Private variables ---------------------------------------------------------*/
 /**	
   * @brief ָǰڷʵݶ
   */
-static struct __cosem_request *Current = (struct __cosem_request *)0;
+static DLMS_CHANNEL_LOCAL struct __cosem_request *Current = (struct __cosem_request *)0;
 
 /**	
   * @brief ָǰڷʵݱʶ
   */
-static uint8_t *instance_name = (uint8_t *)0;
+static DLMS_CHANNEL_LOCAL uint8_t *instance_name = (uint8_t *)0;
+
+#if defined ( DLMS_CONFIG_PARALLEL )
+/**	
+  * @brief ݶͨĶȡԲдͷöռ
+  */
+static pthread_rwlock_t object_lock = PTHREAD_RWLOCK_INITIALIZER;
+#endif
 
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
@@ -145,7 +174,7 @@ static uint8_t *instance_name = (uint8_t *)0;
   */
 static uint8_t *request_formatter(uint32_t mid, const uint8_t *in, uint16_t size, uint16_t *out)
 {
-    static uint8_t result[9];
+    static DLMS_CHANNEL_LOCAL uint8_t result[9]; //ʽһֱõýֱͨʹ
     
     struct __meta_identifier id;
     enum __axdr_type type;
@@ -346,6 +375,77 @@ static uint16_t response_formatter(uint32_t mid, const uint8_t *in, uint16_t siz
     }
 }
 
+/**
+  * @brief һ AXDR ݣͱǩı볤ȣֽ֧ṹǶ
+  * 
+  */
+static uint16_t data_span(const uint8_t *src, uint16_t limit)
+{
+    uint16_t length;
+    uint16_t amount = 0;
+    uint16_t span;
+    uint16_t cnt;
+    
+    if(!src || !limit)
+    {
+        return(0);
+    }
+    
+    switch(src[0])
+    {
+        case AXDR_NULL:
+        {
+            length = 1;
+            break;
+        }
+        case AXDR_ARRAY:
+        case AXDR_STRUCTURE:
+        {
+            if(limit < 2)
+            {
+                return(0);
+            }
+            
+            length = 1 + axdr.length.decode(&src[1], &amount);
+            
+            for(cnt=0; cnt<amount; cnt++)
+            {
+                if(length >= limit)
+                {
+                    return(0);
+                }
+                
+                span = data_span(&src[length], (limit - length));
+                if(!span)
+                {
+                    return(0);
+                }
+                
+                length += span;
+            }
+            break;
+        }
+        default:
+        {
+            length = axdr.length.calc(src);
+            if(!length)
+            {
+                return(0);
+            }
+            
+            length += 1;
+            break;
+        }
+    }
+    
+    if(length > limit)
+    {
+        return(0);
+    }
+    
+    return(length);
+}
+
 /**
   * @brief ݱЧ
   * 
@@ -381,10 +481,7 @@ static enum __appl_result parse_dlms_frame(const uint8_t *info, \
 			uint8_t title[8];
 			uint8_t cspubkey[96];
 			uint8_t len_cspubkey;
-			uint8_t z[48];
 			unsigned char hash[48];
-			mbedtls_ecdsa_context ctx;
-			mbedtls_mpi r, s;
 			uint8_t len_signature;
 			uint8_t *ctext;
 			uint16_t len_ctext;
@@ -486,53 +583,16 @@ static enum __appl_result parse_dlms_frame(const uint8_t *info, \
 			
 			len_cspubkey = dlms_asso_cspubkey(cspubkey);
 			
-			if((len_cspubkey != 64) && (len_cspubkey != 96))
+			if(((len_cspubkey != 64) && (len_cspubkey != 96)) || (len_signature != len_cspubkey))
 			{
 				return(APPL_ENC_FAILD);
 			}
-			heap.set(z, 0, sizeof(z));
-			z[len_cspubkey / 2 - 1] = 1;
-			
-			mbedtls_mpi_init( &r );
-			mbedtls_mpi_init( &s );
-			mbedtls_ecp_keypair_init( &ctx );
-			if(len_cspubkey == 64)
-			{
-				mbedtls_ecp_group_load( &ctx.grp, MBEDTLS_ECP_DP_SECP256R1 );
-			}
-			else
-			{
-				mbedtls_ecp_group_load( &ctx.grp, MBEDTLS_ECP_DP_SECP384R1 );
-			}
-			
-			if((ret = mbedtls_mpi_read_binary( &ctx.Q.X, &cspubkey[0], len_cspubkey / 2)) != 0)
-			{
-				goto cleanup;
-			}
-			if((ret = mbedtls_mpi_read_binary( &ctx.Q.Y, &cspubkey[len_cspubkey / 2], len_cspubkey / 2)) != 0)
-			{
-				goto cleanup;
-			}
-			if((ret = mbedtls_mpi_read_binary( &ctx.Q.Z, z, len_cspubkey / 2)) != 0)
-			{
-				goto cleanup;
-			}
-			
-			if((ret = mbedtls_mpi_read_binary(&r, &request->general.sign.signature[1], len_signature / 2)) != 0)
-			{
-				goto cleanup;
-			}
-			if((ret = mbedtls_mpi_read_binary(&s, &request->general.sign.signature[1 + len_signature / 2], len_signature / 2)) != 0)
-			{
-				goto cleanup;
-			}
 			
 			len_ctext = (3 + 3 * 8) + (1 + request->general.sign.date[0]) + (1 + request->general.sign.others[0]) + frame_length;
 			ctext = heap.dalloc(len_ctext);
 			if(!ctext)
 			{
-				ret = MBEDTLS_ERR_MPI_ALLOC_FAILED;
-				goto cleanup;
+				return(APPL_ENC_FAILD);
 			}
 			
 			heap.copy(&ctext[0], request->general.sign.transaction, 9);
@@ -544,44 +604,36 @@ static enum __appl_result parse_dlms_frame(const uint8_t *info, \
 			
 			if(len_cspubkey == 64)
 			{
-				if( ( ret = mbedtls_sha256_ret( ctext, len_ctext, hash, 0 ) ) != 0 )
-				{
-					heap.free(ctext);
-					goto cleanup;
-				}
-				heap.free(ctext);
-				
-				if( ( ret = mbedtls_ecdsa_verify( &ctx.grp, hash, 32, \
-													 &ctx.Q, &r, &s) ) != 0 )
-				{
-					goto cleanup;
-				}
+				ret = mbedtls_sha256_ret( ctext, len_ctext, hash, 0 );
 			}
 			else
 			{
-				if( ( ret = mbedtls_sha512_ret( ctext, len_ctext, hash, 1 ) ) != 0 )
-				{
-					heap.free(ctext);
-					goto cleanup;
-				}
-				heap.free(ctext);
-				
-				if( ( ret = mbedtls_ecdsa_verify( &ctx.grp, hash, 48, \
-													 &ctx.Q, &r, &s) ) != 0 )
-				{
-					goto cleanup;
-				}
+				ret = mbedtls_sha512_ret( ctext, len_ctext, hash, 1 );
 			}
+			heap.free(ctext);
 			
-	cleanup:
-			mbedtls_mpi_free( &r );
-			mbedtls_mpi_free( &s );
-			mbedtls_ecdsa_free( &ctx );
 			if(ret != 0)
 			{
 				return(APPL_ENC_FAILD);
 			}
 			
+			//ǩ𣬽·ύ
+			switch(dlms_crypto_verify(cspubkey, len_cspubkey / 2, hash, &request->general.sign.signature[1]))
+			{
+				case CRYPTO_SUCCESS:
+				{
+					break;
+				}
+				case CRYPTO_PENDING:
+				{
+					return(APPL_DEFERRED);
+				}
+				default:
+				{
+					return(APPL_ENC_FAILD);
+				}
+			}
+			
 			return(parse_dlms_frame(request->general.sign.content, frame_length, request, false));
 			
             break;
@@ -1061,14 +1113,16 @@ static enum __appl_result parse_dlms_frame(const uint8_t *info, \
 						}
 						case GET_WITH_LIST:
 						{
-							if((!request->plain[3]) || (request->plain[3] > DLMS_REQ_LIST_MAX))
+							uint16_t amount = 0;
+							
+							ninfo = 3 + axdr.length.decode(&request->plain[3], &amount);
+							
+							if((!amount) || (amount > DLMS_REQ_LIST_MAX))
 							{
 								return(APPL_UNSUPPORT);
 							}
 							
-							ninfo = 4;
-							
-							for(nloop=0; nloop<request->plain[3]; nloop ++)
+							for(nloop=0; nloop<amount; nloop ++)
 							{
 								request->info[nloop].active = 0xff;
 								request->info[nloop].classid = &request->plain[ninfo + 0];
@@ -1158,6 +1212,74 @@ static enum __appl_result parse_dlms_frame(const uint8_t *info, \
 							break;
 						}
 						case SET_WITH_LIST:
+						{
+							uint16_t amount = 0;
+							uint16_t values = 0;
+							uint16_t span;
+							
+							ninfo = 3 + axdr.length.decode(&request->plain[3], &amount);
+							
+							if((!amount) || (amount > DLMS_REQ_LIST_MAX))
+							{
+								return(APPL_UNSUPPORT);
+							}
+							
+							//б
+							for(nloop=0; nloop<amount; nloop ++)
+							{
+								if(length < (ninfo + 10))
+								{
+									return(APPL_OTHERS);
+								}
+								
+								//֧ѡԷ
+								if(request->plain[ninfo + 9] != 0)
+								{
+									return(APPL_UNSUPPORT);
+								}
+								
+								request->info[nloop].active = 0xff;
+								request->info[nloop].classid = &request->plain[ninfo + 0];
+								request->info[nloop].obis = &request->plain[ninfo + 2];
+								request->info[nloop].index = &request->plain[ninfo + 8];
+								
+								ninfo += 10;
+							}
+							
+							//бĿбһ
+							if(length <= ninfo)
+							{
+								return(APPL_OTHERS);
+							}
+							
+							ninfo += axdr.length.decode(&request->plain[ninfo], &values);
+							
+							if(values != amount)
+							{
+								return(APPL_OTHERS);
+							}
+							
+							for(nloop=0; nloop<amount; nloop ++)
+							{
+								if(length <= ninfo)
+								{
+									return(APPL_OTHERS);
+								}
+								
+								span = data_span(&request->plain[ninfo], (length - ninfo));
+								if(!span)
+								{
+									return(APPL_OTHERS);
+								}
+								
+								request->info[nloop].data = &request->plain[ninfo];
+								request->info[nloop].length = span;
+								
+								ninfo += span;
+							}
+							
+							break;
+						}
 						case SET_WITH_LIST_AND_FIRST_BLOCK:
 						default:
 						{
@@ -1263,6 +1385,72 @@ static enum __appl_result parse_dlms_frame(const uint8_t *info, \
     }
 }
 
+/**
+  * @brief ǰӸڴɵĿ
+  */
+static uint8_t cosem_capacity(void)
+{
+    uint16_t size = dlms_asso_storage_size();
+    
+    if(size < sizeof(struct __cosem_request))
+    {
+        return(0);
+    }
+    
+    return((uint8_t)((size - sizeof(struct __cosem_request)) / sizeof(struct __cosem_instance)));
+}
+
+/**
+  * @brief бķʵ
+  * бڵһļֵֻһ
+  */
+static void make_cosem_list(const struct __appl_request *request, \
+                            const struct __cosem_request_desc *base)
+{
+    struct __cosem_request_desc desc[DLMS_REQ_LIST_MAX];
+    union __dlms_right right[DLMS_REQ_LIST_MAX];
+    uint32_t oid[DLMS_REQ_LIST_MAX];
+    uint32_t mid[DLMS_REQ_LIST_MAX];
+    TypeObject object[DLMS_REQ_LIST_MAX];
+    uint8_t amount;
+    uint8_t cnt;
+    
+    Current->Actived = 0;
+    
+    for(amount=0; amount<DLMS_REQ_LIST_MAX; amount++)
+    {
+        if(!request->info[amount].active)
+        {
+            break;
+        }
+        
+        desc[amount] = *base;
+        desc[amount].descriptor.classid = request->info[amount].classid[0];
+        desc[amount].descriptor.classid <<= 8;
+        desc[amount].descriptor.classid += request->info[amount].classid[1];
+        heap.copy(desc[amount].descriptor.obis, request->info[amount].obis, 6);
+        desc[amount].descriptor.index = request->info[amount].index[0];
+        desc[amount].descriptor.selector = 0;
+    }
+    
+    dlms_lex_parse_list(desc, amount, right, oid, mid, object);
+    
+    for(cnt=0; cnt<amount; cnt++)
+    {
+        heap.set(&Current->Entry[cnt], 0, sizeof(Current->Entry[cnt]));
+        
+        Current->Entry[cnt].Right = (uint8_t)right[cnt].attr;
+        Current->Entry[cnt].Para.Input.OID = oid[cnt];
+        Current->Entry[cnt].Para.Input.MID = mid[cnt];
+        
+        Current->Actived += 1;//һĿ
+        
+        Current->Entry[cnt].Para.Input.Buffer = request->info[cnt].data;
+        Current->Entry[cnt].Para.Input.Size = request->info[cnt].length;
+        Current->Entry[cnt].Object = object[cnt];
+    }
+}
+
 /**
   * @brief ɷʵ
   * 
@@ -1270,14 +1458,26 @@ static enum __appl_result parse_dlms_frame(const uint8_t *info, \
 static enum __appl_result make_cosem_instance(const struct __appl_request *request)
 {
     uint8_t cnt = 0;
+    uint8_t amount = 0;
     struct __cosem_request_desc desc;
     
+    //ЯĿ
+    while((amount < DLMS_REQ_LIST_MAX) && request->info[amount].active)
+    {
+        amount += 1;
+    }
+    
+    if(!amount)
+    {
+        amount = 1;
+    }
+    
     //ȡǰ¸Ķڴ
     Current = (struct __cosem_request *)dlms_asso_storage();
-    if(!Current)
+    if(!Current || (cosem_capacity() < amount))
     {
-        //ɵǰ¸Ķڴ
-        Current = (struct __cosem_request *)dlms_asso_attach_storage(sizeof(struct __cosem_request));
+        //Ŀɵǰ¸Ķڴ棬ֻ
+        Current = (struct __cosem_request *)dlms_asso_attach_storage(COSEM_REQUEST_SIZE(amount));
         
         if(!Current)
         {
@@ -1310,14 +1510,14 @@ static enum __appl_result make_cosem_instance(const struct __appl_request *reque
                     dlms_lex_parse(&desc, \
                                    (union __dlms_right *)&Current->Entry[0].Right, \
                                    &Current->Entry[0].Para.Input.OID, \
-                                   &Current->Entry[0].Para.Input.MID);
+                                   &Current->Entry[0].Para.Input.MID, \
+                                   &Current->Entry[0].Object);
                     
-                    Current->Block = 0;//
+                    Current->Block = 1;//ֿ鷵ʱ׿Ϊ1
                     Current->Actived = 1;//һĿ
                     
                     Current->Entry[0].Para.Input.Buffer = request->info[0].data;
                     Current->Entry[0].Para.Input.Size = request->info[0].length;
-                    Current->Entry[0].Object = CosemLoadAttribute(desc.descriptor.classid, desc.descriptor.index, false);
                     
                     break;
                 }
@@ -1329,14 +1529,14 @@ static enum __appl_result make_cosem_instance(const struct __appl_request *reque
                         return(APPL_OBJ_OVERFLOW);
                     }
                     
-                    //֤
-                    if((Current->Block + 1) != request->info->block)
+                    //֤ͻȷϵյĿ
+                    if(Current->Block != request->info->block)
                     {
                         return(APPL_BLOCK_MISS);
                     }
                     
                     //¿
-                    Current->Block = request->info->block;
+                    Current->Block = request->info->block + 1;
                     
                     Current->Entry[0].Para.Input.Buffer = (uint8_t *)0;
                     Current->Entry[0].Para.Input.Size = 0;
@@ -1346,33 +1546,8 @@ static enum __appl_result make_cosem_instance(const struct __appl_request *reque
                 case GET_WITH_LIST:
                 {
                     Current->Block = 0;//
-                    Current->Actived = 0;
                     
-                    for(cnt=0; cnt<DLMS_REQ_LIST_MAX; cnt++)
-                    {
-                        if(!request->info[cnt].active)
-                        {
-                            break;
-                        }
-                        
-                        heap.set(&Current->Entry[cnt], 0, sizeof(Current->Entry[cnt]));
-                        
-                        desc.descriptor.classid = request->info[cnt].classid[0];
-                        desc.descriptor.classid <<= 8;
-                        desc.descriptor.classid += request->info[cnt].classid[1];
-                        heap.copy(desc.descriptor.obis, request->info[cnt].obis, 6);
-                        desc.descriptor.index = request->info[cnt].index[0];
-                        desc.descriptor.selector = 0;
-                        dlms_lex_parse(&desc, (union __dlms_right *)&Current->Entry[cnt].Right, \
-                                       &Current->Entry[cnt].Para.Input.OID, \
-                                       &Current->Entry[cnt].Para.Input.MID);
-                        
-                        Current->Actived += 1;//һĿ
-                        
-                        Current->Entry[cnt].Para.Input.Buffer = request->info[cnt].data;
-                        Current->Entry[cnt].Para.Input.Size = request->info[cnt].length;
-                        Current->Entry[cnt].Object = CosemLoadAttribute(desc.descriptor.classid, desc.descriptor.index, false);
-                    }
+                    make_cosem_list(request, &desc);
                     
                     break;
                 }
@@ -1401,7 +1576,8 @@ static enum __appl_result make_cosem_instance(const struct __appl_request *reque
                     desc.descriptor.selector = 0;
                     dlms_lex_parse(&desc, (union __dlms_right *)&Current->Entry[0].Right, \
                                    &Current->Entry[0].Para.Input.OID, \
-                                   &Current->Entry[0].Para.Input.MID);
+                                   &Current->Entry[0].Para.Input.MID, \
+                                   &Current->Entry[0].Object);
                     
                     Current->Block = 0;//
                     Current->Actived = 1;//һĿ
@@ -1411,13 +1587,17 @@ static enum __appl_result make_cosem_instance(const struct __appl_request *reque
                                                                             request->info[0].data, \
                                                                             request->info[0].length, \
                                                                             &Current->Entry[0].Para.Input.Size);
-                    Current->Entry[0].Object = CosemLoadAttribute(desc.descriptor.classid, desc.descriptor.index, false);
                     break;
                 }
                 case SET_FIRST_BLOCK:
                 {
                     heap.set(&Current->Entry[0], 0, sizeof(Current->Entry[0]));
                     
+                    if(!request->info->block)
+                    {
+                        return(APPL_BLOCK_MISS);
+                    }
+                    
                     desc.descriptor.classid = request->info[0].classid[0];
                     desc.descriptor.classid <<= 8;
                     desc.descriptor.classid += request->info[0].classid[1];
@@ -1426,12 +1606,8 @@ static enum __appl_result make_cosem_instance(const struct __appl_request *reque
                     desc.descriptor.selector = 0;
                     dlms_lex_parse(&desc, (union __dlms_right *)&Current->Entry[0].Right, \
                                    &Current->Entry[0].Para.Input.OID, \
-                                   &Current->Entry[0].Para.Input.MID);
-                    
-                    if(!request->info->block)
-                    {
-                        return(APPL_BLOCK_MISS);
-                    }
+                                   &Current->Entry[0].Para.Input.MID, \
+                                   &Current->Entry[0].Object);
                     
                     Current->Block = request->info->block;//
                     Current->Actived = 1;//һĿ
@@ -1446,7 +1622,6 @@ static enum __appl_result make_cosem_instance(const struct __appl_request *reque
                     {
                         Current->Entry[0].Para.Iterator.Status = ITER_FINISHED;//ֵʶ
                     }
-                    Current->Entry[0].Object = CosemLoadAttribute(desc.descriptor.classid, desc.descriptor.index, false);
                     break;
                 }
                 case SET_WITH_BLOCK:
@@ -1474,6 +1649,13 @@ static enum __appl_result make_cosem_instance(const struct __appl_request *reque
                     break;
                 }
                 case SET_WITH_LIST:
+                {
+                    Current->Block = 0;//
+                    
+                    make_cosem_list(request, &desc);
+                    
+                    break;
+                }
                 case SET_WITH_LIST_AND_FIRST_BLOCK:
                 default:
                 {
@@ -1500,14 +1682,14 @@ static enum __appl_result make_cosem_instance(const struct __appl_request *reque
                     desc.descriptor.selector = 0;
                     dlms_lex_parse(&desc, (union __dlms_right *)&Current->Entry[0].Right, \
                                    &Current->Entry[0].Para.Input.OID, \
-                                   &Current->Entry[0].Para.Input.MID);
+                                   &Current->Entry[0].Para.Input.MID, \
+                                   &Current->Entry[0].Object);
                     
                     Current->Block = 0;//
                     Current->Actived = 1;//һĿ
                     
                     Current->Entry[0].Para.Input.Buffer = request->info[0].data;//ֵ
                     Current->Entry[0].Para.Input.Size = request->info[0].length;//ֵݳ
-                    Current->Entry[0].Object = CosemLoadMethod(desc.descriptor.classid, desc.descriptor.index);
                     break;
                 }
                 case ACTION_NEXT_BLOCK:
@@ -1538,6 +1720,11 @@ static enum __appl_result make_cosem_instance(const struct __appl_request *reque
                 {
                     heap.set(&Current->Entry[0], 0, sizeof(Current->Entry[0]));
                     
+                    if(!request->info->block)
+                    {
+                        return(APPL_BLOCK_MISS);
+                    }
+                    
                     desc.descriptor.classid = request->info[0].classid[0];
                     desc.descriptor.classid <<= 8;
                     desc.descriptor.classid += request->info[0].classid[1];
@@ -1546,12 +1733,8 @@ static enum __appl_result make_cosem_instance(const struct __appl_request *reque
                     desc.descriptor.selector = 0;
                     dlms_lex_parse(&desc, (union __dlms_right *)&Current->Entry[0].Right, \
                                    &Current->Entry[0].Para.Input.OID, \
-                                   &Current->Entry[0].Para.Input.MID);
-                    
-                    if(!request->info->block)
-                    {
-                        return(APPL_BLOCK_MISS);
-                    }
+                                   &Current->Entry[0].Para.Input.MID, \
+                                   &Current->Entry[0].Object);
                     
                     Current->Block = request->info->block;//
                     Current->Actived = 1;//һĿ
@@ -1566,7 +1749,6 @@ static enum __appl_result make_cosem_instance(const struct __appl_request *reque
                     {
                         Current->Entry[0].Para.Iterator.Status = ITER_FINISHED;//ֵʶ
                     }
-                    Current->Entry[0].Object = CosemLoadMethod(desc.descriptor.classid, desc.descriptor.index);
                     break;
                 }
                 case ACTION_WITH_LIST:
@@ -1591,13 +1773,13 @@ static enum __appl_result make_cosem_instance(const struct __appl_request *reque
                         desc.descriptor.selector = 0;
                         dlms_lex_parse(&desc, (union __dlms_right *)&Current->Entry[cnt].Right, \
                                        &Current->Entry[cnt].Para.Input.OID, \
-                                       &Current->Entry[cnt].Para.Input.MID);
+                                       &Current->Entry[cnt].Para.Input.MID, \
+                                       &Current->Entry[cnt].Object);
                         
                         Current->Actived += 1;//һĿ
                         
                         Current->Entry[cnt].Para.Input.Buffer = request->info[cnt].data;//ֵ
                         Current->Entry[cnt].Para.Input.Size = request->info[cnt].length;//ֵݳ
-                        Current->Entry[cnt].Object = CosemLoadMethod(desc.descriptor.classid, desc.descriptor.index);
                     }
                     break;
                 }
@@ -1758,6 +1940,7 @@ static enum __appl_result reply_normal(struct __appl_request *request, \
                                        uint16_t *filled_length)
 {
     uint8_t cnt = 0;
+    uint8_t capacity = cosem_capacity();
 	uint8_t service;
     uint8_t *plain = (uint8_t *)0;
     uint16_t plain_length = 0;
@@ -1817,7 +2000,8 @@ static enum __appl_result reply_normal(struct __appl_request *request, \
                         plain[4] = (uint8_t)OBJECT_ERR_MEM;
                         plain_length = 5;
                     }
-                    else if(Current->Entry[0].Para.Iterator.Status != ITER_NONE) //Get-Response-With-Datablock
+                    else if((Current->Entry[0].Para.Iterator.Status != ITER_NONE) && \
+                            (Current->Entry[0].Errs == OBJECT_NOERR)) //Get-Response-With-Datablock
                     {
                         if((Current->Entry[0].Para.Output.Filled > Current->Entry[0].Para.Output.Size) || \
                             (Current->Entry[0].Para.Output.Filled > (dlms_asso_mtu() - 20)))
@@ -1911,6 +2095,20 @@ static enum __appl_result reply_normal(struct __appl_request *request, \
                         plain[4] = (uint8_t)OBJECT_ERR_NODEF;
                         plain_length = 5;
                     }
+                    else if(Current->Entry[0].Errs != OBJECT_NOERR)
+                    {
+                        plain[3] = (uint8_t)IS_LAST_BLOCK;
+                        
+                        plain[4] = (uint8_t)(Current->Block >> 24);
+                        plain[5] = (uint8_t)(Current->Block >> 16);
+                        plain[6] = (uint8_t)(Current->Block >> 8);
+                        plain[7] = (uint8_t)(Current->Block >> 0);
+                        
+                        plain[8] = 1;
+                        plain[9] = (uint8_t)Current->Entry[0].Errs;
+                        
+                        plain_length = 10;
+                    }
                     else
                     {
                         if((Current->Entry[0].Para.Output.Filled > Current->Entry[0].Para.Output.Size) || \
@@ -1955,7 +2153,10 @@ static enum __appl_result reply_normal(struct __appl_request *request, \
                 {
                     plain[1] = GET_RESPONSE_WITH_LIST;
                     
-                    for(cnt=0; cnt<DLMS_REQ_LIST_MAX; cnt++)
+                    //Ŀ
+                    plain_length += axdr.length.encode(Current->Actived, &plain[plain_length]);
+                    
+                    for(cnt=0; cnt<capacity; cnt++)
                     {
                         if(!Current->Entry[cnt].Object)
                         {
@@ -1973,12 +2174,12 @@ static enum __appl_result reply_normal(struct __appl_request *request, \
                         if(Current->Entry[cnt].Errs == OBJECT_NOERR)
                         {
                             if((Current->Entry[cnt].Para.Output.Filled > Current->Entry[cnt].Para.Output.Size) || \
-                                ((Current->Entry[cnt].Para.Output.Filled + plain_length) > (dlms_asso_mtu() - 20)))
+                                ((Current->Entry[cnt].Para.Output.Filled + plain_length + 1) > (dlms_asso_mtu() - 20)))
                             {
-                                plain[3] = 1;
-                                plain[4] = (uint8_t)OBJECT_ERR_MEM;
-                                plain_length = 5;
-                                break;
+                                //ʣռ䲻㣬Ŀش
+                                plain[plain_length + 0] = 1;
+                                plain[plain_length + 1] = (uint8_t)OBJECT_ERR_MEM;
+                                plain_length += 2;
                             }
                             else
                             {
@@ -1998,13 +2199,6 @@ static enum __appl_result reply_normal(struct __appl_request *request, \
                             plain_length += 2;
                         }
                     }
-                    
-                    if(plain_length == 3)
-                    {
-                        plain[3] = 1;
-                        plain[4] = (uint8_t)OBJECT_ERR_MEM;
-                        plain_length = 5;
-                    }
                     break;
                 }
                 default:
@@ -2092,6 +2286,32 @@ static enum __appl_result reply_normal(struct __appl_request *request, \
                     break;
                 }
                 case SET_WITH_LIST:
+                {
+                    plain[1] = SET_RESPONSE_WITH_LIST;
+                    
+                    plain_length = 3;
+                    plain_length += axdr.length.encode(Current->Actived, &plain[plain_length]);
+                    
+                    for(cnt=0; cnt<capacity; cnt++)
+                    {
+                        if(!Current->Entry[cnt].Object)
+                        {
+                            continue;
+                        }
+                        
+                        //Set-Response-With-List ֿ
+                        if((Current->Entry[cnt].Para.Iterator.Status != ITER_NONE) || \
+                            (Current->Entry[cnt].Para.Iterator.From != Current->Entry[cnt].Para.Iterator.To))
+                        {
+                            Current->Entry[cnt].Para.Iterator.Status = ITER_NONE;
+                            Current->Entry[cnt].Errs = OBJECT_ERR_MEM;
+                        }
+                        
+                        plain[plain_length] = (uint8_t)Current->Entry[cnt].Errs;
+                        plain_length += 1;
+                    }
+                    break;
+                }
                 case SET_WITH_LIST_AND_FIRST_BLOCK:
                 default:
                 {
@@ -2202,7 +2422,11 @@ static enum __appl_result reply_normal(struct __appl_request *request, \
             ekey_length = dlms_asso_ekey(ekey);
             akey_length = dlms_asso_akey(akey);
             dlms_asso_localtitle(iv);
-            dlms_asso_fc(&iv[8]);
+            if(!dlms_asso_fc(&iv[8]))
+            {
+                heap.free(plain);
+                return(APPL_ENC_FAILD);
+            }
             break;
         }
         case DED_GET_REQUEST:
@@ -2213,7 +2437,11 @@ static enum __appl_result reply_normal(struct __appl_request *request, \
             ekey_length = dlms_asso_dedkey(ekey);
             akey_length = dlms_asso_akey(akey);
             dlms_asso_localtitle(iv);
-            dlms_asso_fc(&iv[8]);
+            if(!dlms_asso_fc(&iv[8]))
+            {
+                heap.free(plain);
+                return(APPL_ENC_FAILD);
+            }
             break;
         }
 		case GNL_SIGN_REQUEST:
@@ -2225,7 +2453,11 @@ static enum __appl_result reply_normal(struct __appl_request *request, \
 				ekey_length = dlms_asso_ekey(ekey);
 				akey_length = dlms_asso_akey(akey);
 				dlms_asso_localtitle(iv);
-				dlms_asso_fc(&iv[8]);
+				if(!dlms_asso_fc(&iv[8]))
+				{
+					heap.free(plain);
+					return(APPL_ENC_FAILD);
+				}
 			}
 			else if((request->general.sign.content[0] == DED_GET_REQUEST) || \
 				(request->general.sign.content[0] == DED_SET_REQUEST) || \
@@ -2234,7 +2466,11 @@ static enum __appl_result reply_normal(struct __appl_request *request, \
 				ekey_length = dlms_asso_dedkey(ekey);
 				akey_length = dlms_asso_akey(akey);
 				dlms_asso_localtitle(iv);
-				dlms_asso_fc(&iv[8]);
+				if(!dlms_asso_fc(&iv[8]))
+				{
+					heap.free(plain);
+					return(APPL_ENC_FAILD);
+				}
             }
 			else if((request->general.sign.content[0] == GET_REQUEST) || \
 					(request->general.sign.content[0] == SET_REQUEST) || \
@@ -2605,6 +2841,8 @@ void dlms_appl_entrance(const uint8_t *info,
 {
     uint8_t cnt = 0;
     uint8_t alive = 0;
+    uint8_t capacity = 0;
+    uint16_t used = 0;
     uint8_t *cosem_data = (uint8_t *)0;
     enum __appl_result result;
     struct __appl_request request;
@@ -2618,6 +2856,12 @@ void dlms_appl_entrance(const uint8_t *info,
     //ȥܣЧֶ
     result = parse_dlms_frame(info, length, &request, true);
     
+    //ȴǩݲظ
+    if(result == APPL_DEFERRED)
+    {
+        return;
+    }
+    
     //ʧ
     if(result != APPL_SUCCESS)
     {
@@ -2627,15 +2871,25 @@ void dlms_appl_entrance(const uint8_t *info,
     
     //step 2
     //ɷʶ
+    //дɷʶʱѸʽ￪ʼֱʽ
+    OBJECT_LOCK((request.service == SET_REQUEST) || \
+                (request.service == GLO_SET_REQUEST) || \
+                (request.service == DED_SET_REQUEST) || \
+                (request.service == ACTION_REQUEST) || \
+                (request.service == GLO_ACTION_REQUEST) || \
+                (request.service == DED_ACTION_REQUEST));
+    
     result = make_cosem_instance(&request);
     
     //ɷʶʧ
     if((result != APPL_SUCCESS) || (!Current))
     {
+        OBJECT_UNLOCK();
+        
         //ʶ
         if(Current)
         {
-            heap.set(Current, 0, sizeof(struct __cosem_request));
+            heap.set(Current, 0, dlms_asso_storage_size());
             Current = (struct __cosem_request *)0;
         }
         
@@ -2645,15 +2899,17 @@ void dlms_appl_entrance(const uint8_t *info,
     }
     
     //ɵķʶǷϷ
-    if((Current->Actived == 0) || (Current->Actived > DLMS_REQ_LIST_MAX))
+    capacity = cosem_capacity();
+    if((Current->Actived == 0) || (Current->Actived > capacity))
     {
+        OBJECT_UNLOCK();
         reply_exception(APPL_OBJ_OVERFLOW, buffer, buffer_length, filled_length);
         Current = (struct __cosem_request *)0;
         return;
     }
     else
     {
-        for(cnt=0; cnt<DLMS_REQ_LIST_MAX; cnt++)
+        for(cnt=0; cnt<capacity; cnt++)
         {
             if(Current->Entry[cnt].Object)
             {
@@ -2663,6 +2919,7 @@ void dlms_appl_entrance(const uint8_t *info,
         
         if(Current->Actived != alive)
         {
+            OBJECT_UNLOCK();
             reply_exception(APPL_OBJ_OVERFLOW, buffer, buffer_length, filled_length);
             Current = (struct __cosem_request *)0;
             return;
@@ -2674,40 +2931,58 @@ void dlms_appl_entrance(const uint8_t *info,
     cosem_data = heap.dalloc((dlms_asso_mtu() + Current->Actived * 16));
     if(!cosem_data)
     {
+        OBJECT_UNLOCK();
+        
         //ڴ
-        heap.set(Current, 0, sizeof(struct __cosem_request));
+        heap.set(Current, 0, dlms_asso_storage_size());
         reply_exception(APPL_NOMEM, buffer, buffer_length, filled_length);
         Current = (struct __cosem_request *)0;
         return;
     }
     
-    //ڴʶڵЧĿ
-    alive = 0;
-    for(cnt=0; cnt<DLMS_REQ_LIST_MAX; cnt++)
-    {
-        if(Current->Entry[cnt].Object)
-        {
-            Current->Entry[cnt].Para.Output.Buffer = cosem_data + (dlms_asso_mtu() / Current->Actived + 16) * alive;
-            Current->Entry[cnt].Para.Output.Size = (dlms_asso_mtu() - 20) / Current->Actived;
-            alive += 1;
-        }
-    }
-    
     //step 4
     //ÿĿ
-    for(cnt=0; cnt<DLMS_REQ_LIST_MAX; cnt++)
+    //Ŀʹʣռ䣬Убһ
+    used = 0;
+    for(cnt=0; cnt<capacity; cnt++)
     {
         if(Current->Entry[cnt].Object)
         {
+            Current->Entry[cnt].Para.Output.Buffer = cosem_data + used;
+            Current->Entry[cnt].Para.Output.Size = (dlms_asso_mtu() - 20) - used;
+            Current->Entry[cnt].Para.Output.Filled = 0;
+            
             if(request.info[cnt].active)
             {
                 instance_name = request.info[cnt].obis;
             }
             
+            //
+            if(used >= (dlms_asso_mtu() - 20))
+            {
+                Current->Entry[cnt].Errs = OBJECT_ERR_MEM;
+            }
             //жǷзȨ
-            if(check_accessibility(&request, &Current->Entry[cnt]))
+            else if(check_accessibility(&request, &Current->Entry[cnt]))
             {
+                //бдڵǰʽ
+                if(((request.service == SET_REQUEST) || \
+                    (request.service == GLO_SET_REQUEST) || \
+                    (request.service == DED_SET_REQUEST)) && \
+                    (request.type == SET_WITH_LIST))
+                {
+                    Current->Entry[cnt].Para.Input.Buffer = request_formatter(Current->Entry[cnt].Para.Input.MID, \
+                                                                              request.info[cnt].data, \
+                                                                              request.info[cnt].length, \
+                                                                              &Current->Entry[cnt].Para.Input.Size);
+                }
+                
                 Current->Entry[cnt].Errs = Current->Entry[cnt].Object(&Current->Entry[cnt].Para);
+                
+                if(Current->Entry[cnt].Para.Output.Filled <= Current->Entry[cnt].Para.Output.Size)
+                {
+                    used += Current->Entry[cnt].Para.Output.Filled;
+                }
             }
             else
             {
@@ -2727,6 +3002,17 @@ void dlms_appl_entrance(const uint8_t *info,
         }
     }
     
+    OBJECT_UNLOCK();
+    
+    //ȴǩηʽݲظ
+    if(dlms_crypto_deferred())
+    {
+        heap.set(Current, 0, dlms_asso_storage_size());
+        heap.free(cosem_data);
+        Current = (struct __cosem_request *)0;
+        return;
+    }
+    
     //step 5
     //
     result = reply_normal(&request, buffer, buffer_length, filled_length);
@@ -2738,7 +3024,7 @@ void dlms_appl_entrance(const uint8_t *info,
     
     //step 6
     //жĿǷ
-    for(cnt=0; cnt<DLMS_REQ_LIST_MAX; cnt++)
+    for(cnt=0; cnt<capacity; cnt++)
     {
         if(Current->Entry[cnt].Object)
         {
@@ -2755,7 +3041,7 @@ void dlms_appl_entrance(const uint8_t *info,
     
     //¼㼤Ŀ
     Current->Actived = 0;
-    for(cnt=0; cnt<DLMS_REQ_LIST_MAX; cnt++)
+    for(cnt=0; cnt<capacity; cnt++)
     {
         if(Current->Entry[cnt].Object)
         {
@@ -2783,3 +3069,60 @@ uint8_t dlms_appl_instance(uint8_t *name)
     
     return(0);
 }
+
+/**	
+  * @brief ɼһԵĵǰֵͱǩϱ
+  * ӵķȨ޼飬ԲڡȡʧܻҪֿʱ null-data
+  */
+uint16_t dlms_appl_capture(const struct __cosem_descriptor *descriptor, uint8_t *buffer, uint16_t size)
+{
+    struct __cosem_request_desc desc;
+    union __dlms_right right;
+    TypeObject Func;
+    ObjectPara P;
+    ObjectErrs Errs;
+    uint8_t *name = instance_name;
+    uint8_t *output;
+    uint16_t length;
+    
+    if(!descriptor || !buffer || !size)
+    {
+        return(0);
+    }
+    
+    buffer[0] = AXDR_NULL;
+    
+    output = heap.dalloc(size);
+    if(!output)
+    {
+        return(1);
+    }
+    
+    heap.set(&P, 0, sizeof(P));
+    OBJ_IO_INIT(&P, (uint8_t *)0, 0, output, size);
+    
+    MAKE_COSEM_REQUEST(&desc, 0xff, DLMS_ACCESS_HIGH, GET_REQUEST, descriptor);
+    dlms_lex_parse(&desc, &right, &P.Input.OID, &P.Input.MID, &Func);
+    
+    if(!Func || (P.Input.OID == 0xffffffff) || !(right.attr & ATTR_READ))
+    {
+        heap.free(output);
+        return(1);
+    }
+    
+    //ͨʵͬĲͬʵ
+    instance_name = (uint8_t *)descriptor->obis;
+    Errs = Func(&P);
+    instance_name = name;
+    
+    if((Errs != OBJECT_NOERR) || !P.Output.Filled || OBJ_IS_ITERATING(&P))
+    {
+        heap.free(output);
+        return(1);
+    }
+    
+    length = response_formatter(P.Input.MID, output, P.Output.Filled, buffer);
+    heap.free(output);
+    
+    return(length);
+}
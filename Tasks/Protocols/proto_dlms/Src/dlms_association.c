@@ -12,9 +12,14 @@
 #include "dlms_association.h"
 #include "dlms_application.h"
 #include "dlms_utilities.h"
+#include "dlms_crypto.h"
 #include "axdr.h"
 #include "mbedtls/gcm.h"
 
+#if defined ( DLMS_CONFIG_PARALLEL )
+#include <pthread.h>
+#endif
+
 /* Private typedef -----------------------------------------------------------*/
 /**	
   * @brief AP
@@ -62,6 +67,8 @@ struct __dlms_association
     enum __asso_diagnose diagnose;
     struct __ap ap;
     uint16_t session;
+    uint8_t channel;//ͨ
+    uint32_t keygen;//ѼԿӦ key_generation
     struct __object_identifier appl_name;
     struct __object_identifier mech_name;
     uint8_t callingtitle[8+2];
@@ -73,12 +80,45 @@ struct __dlms_association
     uint8_t ctos[64+2];
     uint8_t stoc[64+2];
     uint8_t sc;
-    uint32_t fc;
     struct __user_info info;
+    uint32_t ic;//AARQ пͻ˵ invocation counter֤ͨʱЧ
+    uint8_t resident;//Ԥӣ·Ͽʱͷ
+    uint8_t resumed;//ɻָ潨 HLS ֤
     void *appl;
     uint16_t sz_appl;
 };
 
+/**	
+  * @brief Pre-established association
+  */
+struct __asso_preset
+{
+    uint16_t session;//client SAP
+    uint16_t ld;//logic device
+    enum __dlms_access_level level;
+};
+
+/**	
+  * @brief Association resumption record
+  */
+struct __asso_resume
+{
+    uint16_t session;
+    uint16_t ld;
+    uint8_t callingtitle[8+2];
+    uint8_t localtitle[8+2];
+    uint8_t akey[32+2];
+    uint8_t ekey[32+2];
+    uint8_t dedkey[32+2];
+    uint8_t conformance[3];
+    uint8_t mech;
+    uint8_t appl;
+    uint8_t sc;
+    uint16_t max_pdu;
+    uint32_t ic;
+    uint32_t stamp;
+};
+
 /**	
   * @brief Association request type
   */
@@ -117,6 +157,12 @@ struct __aarq_request
 //DLMS ͬʱֵ֧ASSOCIATION
 #define DLMS_CONFIG_MAX_ASSO                    ((uint8_t)(6))
 
+//DLMS HLS ӻָ
+#define DLMS_CONFIG_MAX_RESUME                  ((uint8_t)(4))
+
+//DLMS HLS ӻָЧڣ룩
+#define DLMS_CONFIG_RESUME_LIFETIME             ((uint32_t)(60*60*1000))
+
 //ⲿӿ
 //COSEMinfo, length, buffer, max buffer length, filled buffer length
 #define DLMS_CONFIG_COSEM_REQUEST(i,l,b,m,f)    dlms_appl_entrance(i,l,b,m,f)
@@ -137,6 +183,16 @@ struct __aarq_request
 
 /* Private macro -------------------------------------------------------------*/
 #define DLMS_AP_AMOUNT                          ((uint8_t)(sizeof(ap_support_list) / sizeof(struct __ap)))
+#define DLMS_PRESET_AMOUNT                      ((uint8_t)(sizeof(asso_preset_list) / sizeof(struct __asso_preset)))
+
+#if defined ( DLMS_CONFIG_PARALLEL )
+//Ӷбָɸ̹ͨ߳ãѯɾʱ
+#define ASSO_LOCK()                             pthread_mutex_lock(&asso_lock)
+#define ASSO_UNLOCK()                           pthread_mutex_unlock(&asso_lock)
+#else
+#define ASSO_LOCK()
+#define ASSO_UNLOCK()
+#endif
 
 /* Private variables ---------------------------------------------------------*/
 /**	
@@ -154,20 +210,42 @@ static const struct __ap ap_support_list[] =
     {0x0003,{0x00, 0x30, 0x1D},(1<<2)},
 };
 
+/**	
+  * @brief Ԥ
+  * ͻ AARQ ֱӷʣHDLC ϿӶ󱣳פ
+  */
+static const struct __asso_preset asso_preset_list[] = 
+{
+    //Ϊ
+    //client SAP
+    //SAP
+    //ʵȼ
+    {0x0010, 0x0001, DLMS_ACCESS_LOWEST},//ͻ
+};
+
+/**	
+  * @brief HLS ӻָ
+  */
+static struct __asso_resume resume_list[DLMS_CONFIG_MAX_RESUME] = {0};
+
 /**	
   * @brief ѾӶ
   */
 static struct __dlms_association *asso_list[DLMS_CONFIG_MAX_ASSO] = {0};
 
 /**	
-  * @brief ǰڴӶ
+  * @brief ǰڴӶ󣬸ֱͨ¼
   */
-static struct __dlms_association *asso_current = (void *)0;
+static DLMS_CHANNEL_LOCAL struct __dlms_association *asso_current = (void *)0;
 
 /**	
-  * @brief ԿҪɱ֮ͨҪˢ
+  * @brief Կ¼Ӷ´ηʱּ仯¼Կ
   */
-static uint8_t key_is_eliminate = 0;
+static uint32_t key_generation = 0;
+
+#if defined ( DLMS_CONFIG_PARALLEL )
+static pthread_mutex_t asso_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
@@ -365,6 +443,149 @@ static void decode_object_identifier(const struct __object_identifier *object_id
     *(info + 6) = object_identifier->id;
 }
 
+/**
+  * @brief ѯӻָ棬 ASSO_LOCK
+  */
+static struct __asso_resume *asso_resume_find(const struct __dlms_association *asso)
+{
+    uint8_t cnt;
+    
+    if(asso->callingtitle[1] != 8)
+    {
+        return((void *)0);
+    }
+    
+    for(cnt=0; cnt<DLMS_CONFIG_MAX_RESUME; cnt++)
+    {
+        if(!resume_list[cnt].session)
+        {
+            continue;
+        }
+        
+        if((resume_list[cnt].session != asso->session) || \
+            (resume_list[cnt].ld != asso->ap.ld) || \
+            (memcmp(resume_list[cnt].callingtitle, asso->callingtitle, sizeof(asso->callingtitle)) != 0))
+        {
+            continue;
+        }
+        
+        //Чڵļ¼
+        if(jiffy.after(resume_list[cnt].stamp) > DLMS_CONFIG_RESUME_LIFETIME)
+        {
+            heap.set(&resume_list[cnt], 0, sizeof(struct __asso_resume));
+            return((void *)0);
+        }
+        
+        return(&resume_list[cnt]);
+    }
+    
+    return((void *)0);
+}
+
+/**
+  * @brief HLS ֤ͨ󱣴ӻָ¼
+  */
+static void asso_resume_save(const struct __dlms_association *asso)
+{
+    struct __asso_resume *resume;
+    uint32_t elapsed = 0;
+    uint8_t cnt;
+    
+    // AARQ ֤ӣָʱԴУͻ
+    if((asso->callingtitle[1] != 8) || !(asso->info.sc & 0x10) || !asso->ic)
+    {
+        return;
+    }
+    
+    ASSO_LOCK();
+    
+    resume = asso_resume_find(asso);
+    
+    //ûм¼ʱռÿнڵ㣬ûпнڵʱ滻δʹõļ¼
+    for(cnt=0; (!resume) && (cnt<DLMS_CONFIG_MAX_RESUME); cnt++)
+    {
+        if(!resume_list[cnt].session)
+        {
+            resume = &resume_list[cnt];
+        }
+    }
+    
+    for(cnt=0; (!resume) && (cnt<DLMS_CONFIG_MAX_RESUME); cnt++)
+    {
+        if(jiffy.after(resume_list[cnt].stamp) >= elapsed)
+        {
+            elapsed = jiffy.after(resume_list[cnt].stamp);
+            resume = &resume_list[cnt];
+        }
+    }
+    
+    if(!resume)
+    {
+        ASSO_UNLOCK();
+        return;
+    }
+    
+    heap.set(resume, 0, sizeof(struct __asso_resume));
+    resume->session = asso->session;
+    resume->ld = asso->ap.ld;
+    heap.copy(resume->callingtitle, asso->callingtitle, sizeof(resume->callingtitle));
+    heap.copy(resume->localtitle, asso->localtitle, sizeof(resume->localtitle));
+    heap.copy(resume->akey, asso->akey, sizeof(resume->akey));
+    heap.copy(resume->ekey, asso->ekey, sizeof(resume->ekey));
+    heap.copy(resume->dedkey, asso->info.dedkey, sizeof(resume->dedkey));
+    heap.copy(resume->conformance, asso->ap.conformance, sizeof(resume->conformance));
+    resume->mech = asso->mech_name.id;
+    resume->appl = asso->appl_name.id;
+    resume->sc = asso->info.sc;
+    resume->max_pdu = asso->info.max_pdu;
+    resume->ic = asso->ic;
+    resume->stamp = jiffy.value();
+    
+    ASSO_UNLOCK();
+}
+
+/**
+  * @brief ж AARQ ܷӻֱָӽ
+  */
+static void asso_resume_check(struct __dlms_association *asso)
+{
+    struct __asso_resume *resume;
+    
+    ASSO_LOCK();
+    
+    resume = asso_resume_find(asso);
+    if(!resume)
+    {
+        ASSO_UNLOCK();
+        return;
+    }
+    
+    //֤ơӦġȫЭ̽뻺һ
+    if((resume->mech != asso->mech_name.id) || \
+        (resume->appl != asso->appl_name.id) || \
+        (resume->sc != asso->info.sc) || \
+        (resume->max_pdu != asso->info.max_pdu) || \
+        (memcmp(resume->conformance, asso->ap.conformance, sizeof(resume->conformance)) != 0) || \
+        (memcmp(resume->dedkey, asso->info.dedkey, sizeof(resume->dedkey)) != 0))
+    {
+        ASSO_UNLOCK();
+        return;
+    }
+    
+    //AARQ ֤ͨ invocation counter ֹط
+    if(!(asso->info.sc & 0x10) || (asso->ic <= resume->ic))
+    {
+        ASSO_UNLOCK();
+        return;
+    }
+    
+    asso->resumed = 0xff;
+    resume->ic = asso->ic;
+    resume->stamp = jiffy.value();
+    
+    ASSO_UNLOCK();
+}
+
 /**
   * @brief  UserInformation
   */
@@ -378,6 +599,8 @@ static void parse_user_information(const uint8_t *info, struct __dlms_associatio
     uint8_t *iv = (void *)0;
     mbedtls_gcm_context ctx;
     int ret = 0;
+    const struct __asso_resume *resume;
+    const uint8_t *counter;
     
     if(!asso)
     {
@@ -393,13 +616,28 @@ static void parse_user_information(const uint8_t *info, struct __dlms_associatio
     if(((info[4] == 0x21) && ((info[5] + 4) == info[1])) || \
 		((info[4] == 0xDB) && (info[5] == 0x08) && ((info[3] + 2) == info[1])))
     {
-		// local_AP_title
-		DLMS_CONFIG_LOAD_TITLE(asso->localtitle);
-		// ekay
-		DLMS_CONFIG_LOAD_EKEY(asso->ekey);
-		// akey
-		DLMS_CONFIG_LOAD_AKEY(asso->akey);
-    	
+		ASSO_LOCK();
+		resume = asso_resume_find(asso);
+		if(resume)
+		{
+			//ʹûָеԿٶȡļ
+			heap.copy(asso->localtitle, resume->localtitle, sizeof(asso->localtitle));
+			heap.copy(asso->ekey, resume->ekey, sizeof(asso->ekey));
+			heap.copy(asso->akey, resume->akey, sizeof(asso->akey));
+			ASSO_UNLOCK();
+		}
+		else
+		{
+			ASSO_UNLOCK();
+			
+			// local_AP_title
+			DLMS_CONFIG_LOAD_TITLE(asso->localtitle);
+			// ekay
+			DLMS_CONFIG_LOAD_EKEY(asso->ekey);
+			// akey
+			DLMS_CONFIG_LOAD_AKEY(asso->akey);
+		}
+		
 		if(info[4] == 0x21)
 		{
 			asso->info.sc = info[6];
@@ -627,6 +865,13 @@ static void parse_user_information(const uint8_t *info, struct __dlms_associatio
             }
             return;
         }
+        
+        //¼֤ invocation counter
+        if(asso->info.sc & 0x10)
+        {
+            counter = (info[4] == 0x21) ? &info[7] : &info[16];
+            asso->ic = ((uint32_t)counter[0] << 24) | ((uint32_t)counter[1] << 16) | ((uint32_t)counter[2] << 8) | ((uint32_t)counter[3]);
+        }
     }
     
     //dedicated_key
@@ -708,32 +953,108 @@ static void parse_user_information(const uint8_t *info, struct __dlms_associatio
 }
 
 /**	
-  * @brief 
+  * @brief Կº¼ӶԿ
+  * ÿӶֻͨأдͨʹõԿ
+  */
+static void asso_keys_reload(struct __dlms_association *asso)
+{
+    if((asso->status == ASSOCIATED) && (asso->diagnose == SUCCESS_HLS) || \
+        (asso->status == ASSOCIATION_PENDING))
+    {
+        // ekay
+        DLMS_CONFIG_LOAD_EKEY(asso->ekey);
+        // akey
+        DLMS_CONFIG_LOAD_AKEY(asso->akey);
+		// server signing private key
+		DLMS_CONFIG_LOAD_SSKEY(asso->ssprikey);
+		// client signing public key
+		DLMS_CONFIG_LOAD_CSKEY(asso->cspubkey);
+    }
+}
+
+/**	
+  * @brief ԤӶ
   */
-static void asso_keys_flush(void)
+static struct __dlms_association *asso_preset(struct __dlms_session session)
 {
+    const struct __asso_preset *preset = (const struct __asso_preset *)0;
+    const struct __ap *ap_support = (const struct __ap *)0;
+    struct __dlms_association *asso = (void *)0;
     uint8_t cnt;
     
-    for(cnt=0; cnt<DLMS_CONFIG_MAX_ASSO; cnt++)
+    for(cnt=0; cnt<DLMS_PRESET_AMOUNT; cnt++)
     {
-        if(!asso_list[cnt])
+        if((asso_preset_list[cnt].session == session.session) && (asso_preset_list[cnt].ld == session.sap))
         {
-            continue;
+            preset = &asso_preset_list[cnt];
+            break;
         }
-        
-        if((asso_list[cnt]->status == ASSOCIATED) && (asso_list[cnt]->diagnose == SUCCESS_HLS) || \
-            (asso_list[cnt]->status == ASSOCIATION_PENDING))
+    }
+    
+    if(!preset)
+    {
+        return((void *)0);
+    }
+    
+    for(cnt=0; cnt<DLMS_AP_AMOUNT; cnt++)
+    {
+        if(ap_support_list[cnt].ld == session.sap)
+        {
+            ap_support = &ap_support_list[cnt];
+            break;
+        }
+    }
+    
+    if(!ap_support)
+    {
+        return((void *)0);
+    }
+    
+    for(cnt=0; cnt<DLMS_CONFIG_MAX_ASSO; cnt++)
+    {
+        if(!asso_list[cnt])
         {
-            // ekay
-            DLMS_CONFIG_LOAD_EKEY(asso_list[cnt]->ekey);
-            // akey
-            DLMS_CONFIG_LOAD_AKEY(asso_list[cnt]->akey);
-			// server signing private key
-			DLMS_CONFIG_LOAD_SSKEY(asso_list[cnt]->ssprikey);
-			// client signing public key
-			DLMS_CONFIG_LOAD_CSKEY(asso_list[cnt]->cspubkey);
+            asso_list[cnt] = heap.salloc(NAME_PROTOCOL, sizeof(struct __dlms_association));
+            asso = asso_list[cnt];
+            break;
         }
     }
+    
+    if(!asso)
+    {
+        return((void *)0);
+    }
+    
+    heap.set(asso, 0, sizeof(struct __dlms_association));
+    heap.copy(&asso->ap, ap_support, sizeof(struct __ap));
+    asso->session = session.session;
+    asso->channel = session.channel;
+    asso->keygen = key_generation;
+    asso->status = ASSOCIATED;
+    asso->level = preset->level;
+    asso->diagnose = SUCCESS_NOSEC_LLS;
+    asso->resident = 0xff;
+    
+    //2 16 756 5 8 1 1LN referencing, with no ciphering
+    asso->appl_name.joint_iso_ctt = 2;
+    asso->appl_name.country = 16;
+    asso->appl_name.name = 756;
+    asso->appl_name.organization = 5;
+    asso->appl_name.ua = 8;
+    asso->appl_name.context = 1;
+    asso->appl_name.id = 1;
+    
+    //2 16 756 5 8 2 0֤
+    heap.copy(&asso->mech_name, &asso->appl_name, sizeof(asso->mech_name));
+    asso->mech_name.context = 2;
+    asso->mech_name.id = 0;
+    
+    asso->info.version = 6;
+    asso->info.max_pdu = DLMS_CONFIG_MAX_APDU;
+    
+    DLMS_CONFIG_LOAD_TITLE(asso->localtitle);
+    
+    return(asso);
 }
 
 /**	
@@ -946,6 +1267,9 @@ static void asso_aarq_low(struct __dlms_association *asso,
     uint8_t input_length;
     uint8_t version = 0;
     
+    //ʧ·ͳһͷţȳʼ
+    mbedtls_gcm_init(&ctx);
+    
     *(buffer + 0) = (uint8_t)AARE;
     *(buffer + 1) = 0x00;
     
@@ -1194,7 +1518,10 @@ static void asso_aarq_low(struct __dlms_association *asso,
     {
         // user-information
         dlms_asso_localtitle(iv);
-        dlms_asso_fc(&iv[8]);
+        if(!dlms_asso_fc(&iv[8]))
+        {
+            goto enc_faild;
+        }
         
         *(buffer + *filled_length + 0) = 0xBE;
         *(buffer + *filled_length + 1) = input_length + 5 + 2 + 2;
@@ -1288,6 +1615,9 @@ static void asso_aarq_high(struct __dlms_association *asso,
     uint8_t input_length;
     uint8_t fail_version = 0;
     
+    //ʧ·ͳһͷţȳʼ
+    mbedtls_gcm_init(&ctx);
+    
     *(buffer + 0) = (uint8_t)AARE;
     *(buffer + 1) = 0x00;
     
@@ -1402,9 +1732,18 @@ static void asso_aarq_high(struct __dlms_association *asso,
     
 	if(asso->diagnose == SUCCESS_NOSEC_LLS)
 	{
-		asso->diagnose = SUCCESS_HLS;
-		asso->status = ASSOCIATION_PENDING;
-        asso->level = DLMS_ACCESS_LOW;
+		if(asso->resumed)
+		{
+			//ɻָ潨 HLS ֤ĺ
+			asso->status = ASSOCIATED;
+			asso->level = DLMS_ACCESS_HIGH;
+		}
+		else
+		{
+			asso->diagnose = SUCCESS_HLS;
+			asso->status = ASSOCIATION_PENDING;
+			asso->level = DLMS_ACCESS_LOW;
+		}
 	}
     
     //association-result
@@ -1552,7 +1891,10 @@ static void asso_aarq_high(struct __dlms_association *asso,
     {
         //֤ user-information
         dlms_asso_localtitle(iv);
-        dlms_asso_fc(&iv[8]);
+        if(!dlms_asso_fc(&iv[8]))
+        {
+            goto enc_faild;
+        }
         
         *(buffer + *filled_length + 0) = 0xBE;
         *(buffer + *filled_length + 1) = input_length + 5 + 2 + 2 + sizeof(tag);
@@ -1609,7 +1951,10 @@ static void asso_aarq_high(struct __dlms_association *asso,
     {
         // user-information
         dlms_asso_localtitle(iv);
-        dlms_asso_fc(&iv[8]);
+        if(!dlms_asso_fc(&iv[8]))
+        {
+            goto enc_faild;
+        }
         
         *(buffer + *filled_length + 0) = 0xBE;
         *(buffer + *filled_length + 1) = input_length + 5 + 2 + 2;
@@ -1654,7 +1999,10 @@ static void asso_aarq_high(struct __dlms_association *asso,
     {
         //֤ܺ user-information
         dlms_asso_localtitle(iv);
-        dlms_asso_fc(&iv[8]);
+        if(!dlms_asso_fc(&iv[8]))
+        {
+            goto enc_faild;
+        }
         
         *(buffer + *filled_length + 0) = 0xBE;
         *(buffer + *filled_length + 1) = input_length + 5 + 2 + 2 + sizeof(tag);
@@ -1709,7 +2057,10 @@ static void asso_aarq_high(struct __dlms_association *asso,
     {
         //֤ܺ user-information
         dlms_asso_localtitle(iv);
-        dlms_asso_fc(&iv[8]);
+        if(!dlms_asso_fc(&iv[8]))
+        {
+            goto enc_faild;
+        }
         
         *(buffer + *filled_length + 0) = 0xBE;
         *(buffer + *filled_length + 1) = input_length + 2 + 10 + 6 + sizeof(tag);
@@ -1860,6 +2211,12 @@ static void asso_aarq(struct __dlms_association *asso,
         encode_object_identifier((request.mechanism_name + 2), &asso->mech_name);
     }
     
+    //HLS Ȳѯָ
+    if(asso->mech_name.id > 1)
+    {
+        asso_resume_check(asso);
+    }
+    
     //ͨ mech_name id бҪʲô
     switch(asso->mech_name.id)
     {
@@ -1896,6 +2253,8 @@ static void asso_rlrq(struct __dlms_association *asso,
 {
     uint8_t cnt;
     
+    ASSO_LOCK();
+    
     for(cnt=0; cnt<DLMS_CONFIG_MAX_ASSO; cnt++)
     {
         if(!asso_list[cnt])
@@ -1908,12 +2267,22 @@ static void asso_rlrq(struct __dlms_association *asso,
             if(asso_list[cnt]->appl)
             {
                 heap.free(asso_list[cnt]->appl);
+                asso_list[cnt]->appl = (void *)0;
+            }
+            
+            //ԤӲͷ
+            if(asso_list[cnt]->resident)
+            {
+                continue;
             }
+            
             heap.free(asso_list[cnt]);
             asso_list[cnt] = (void *)0;
         }
     }
     
+    ASSO_UNLOCK();
+    
     if(buffer_length < 3)
     {
         return;
@@ -1956,6 +2325,7 @@ void dlms_asso_gateway(struct __dlms_session session,
                        uint16_t *filled_length)
 {
     uint8_t cnt;
+    uint32_t generation;
     const struct __ap *ap_support = (const struct __ap *)0;
     
     //Чж
@@ -1966,10 +2336,14 @@ void dlms_asso_gateway(struct __dlms_session session,
     
     //㷵رĳ
     *filled_length = 0;
+    //ϴĹ־
+    dlms_crypto_clear();
     //㵱ǰָ
     asso_current = (void *)0;
     
-    //ѯAPǷЭ
+    //ѯAPǷڱͨЭ
+    ASSO_LOCK();
+    
     for(cnt=0; cnt<DLMS_CONFIG_MAX_ASSO; cnt++)
     {
         if(!asso_list[cnt])
@@ -1977,12 +2351,18 @@ void dlms_asso_gateway(struct __dlms_session session,
             continue;
         }
         
-        if((asso_list[cnt]->ap.ld == session.sap) && (asso_list[cnt]->session == session.session))
+        if((asso_list[cnt]->ap.ld == session.sap) && \
+            (asso_list[cnt]->session == session.session) && \
+            (asso_list[cnt]->channel == session.channel))
         {
             asso_current = asso_list[cnt];
         }
     }
     
+    generation = key_generation;
+    
+    ASSO_UNLOCK();
+    
     //
     switch(*info)
     {
@@ -2008,6 +2388,8 @@ void dlms_asso_gateway(struct __dlms_session session,
 		    if(!asso_current)
 		    {
 			    //ѯһδռõĽڵ
+			    ASSO_LOCK();
+		        
 		        for(cnt=0; cnt<DLMS_CONFIG_MAX_ASSO; cnt++)
 		        {
 		            if(!asso_list[cnt])
@@ -2015,6 +2397,7 @@ void dlms_asso_gateway(struct __dlms_session session,
 		                asso_list[cnt] = heap.salloc(NAME_PROTOCOL, sizeof(struct __dlms_association));
 		                if(!asso_list[cnt])
 		                {
+		                    ASSO_UNLOCK();
 		                    return;
 		                }
 		                
@@ -2024,6 +2407,8 @@ void dlms_asso_gateway(struct __dlms_session session,
 		            }
 		        }
 		        
+		        ASSO_UNLOCK();
+		        
 		        //APʧ
 		        if(!asso_current)
 		        {
@@ -2039,11 +2424,9 @@ void dlms_asso_gateway(struct __dlms_session session,
     		heap.set(asso_current, 0, sizeof(struct __dlms_association));
     		heap.copy(&asso_current->ap, ap_support, sizeof(struct __ap));
     		asso_current->session = session.session;
-    		
-	        //ʼFC
-	        srand((unsigned int)jiffy.value());
-	        asso_current->fc = (uint32_t)rand();
-    		
+    		asso_current->channel = session.channel;
+    		asso_current->keygen = generation;
+            
             asso_aarq(asso_current, info, length, buffer, buffer_length, filled_length);
             break;
         }
@@ -2058,6 +2441,14 @@ void dlms_asso_gateway(struct __dlms_session session,
         }
         default:
         {
+        	//δʱѯԤ
+        	if(!asso_current)
+        	{
+        		ASSO_LOCK();
+        		asso_current = asso_preset(session);
+        		ASSO_UNLOCK();
+        	}
+        	
         	if(!asso_current)
         	{
         		return;
@@ -2065,13 +2456,14 @@ void dlms_asso_gateway(struct __dlms_session session,
 			
             if(asso_current->status != NON_ASSOCIATED)
             {
-                asso_request(info, length, buffer, buffer_length, filled_length);
-                
-                if(key_is_eliminate)
+                //Կϴη֮󱻸¹
+                if(asso_current->keygen != generation)
                 {
-                    key_is_eliminate = 0;
-                    asso_keys_flush();
+                    asso_current->keygen = generation;
+                    asso_keys_reload(asso_current);
                 }
+                
+                asso_request(info, length, buffer, buffer_length, filled_length);
             }
             break;
         }
@@ -2086,7 +2478,9 @@ void dlms_asso_cleanup(struct __dlms_session session)
 {
     uint8_t cnt;
     
-    //ѯAPǷѾЭб
+    ASSO_LOCK();
+    
+    //ѯAPǷѾڱͨЭб
     for(cnt=0; cnt<DLMS_CONFIG_MAX_ASSO; cnt++)
     {
         if(!asso_list[cnt])
@@ -2094,16 +2488,28 @@ void dlms_asso_cleanup(struct __dlms_session session)
             continue;
         }
         
-        if((asso_list[cnt]->ap.ld == session.sap) && (asso_list[cnt]->session == session.session))
+        if((asso_list[cnt]->ap.ld == session.sap) && \
+            (asso_list[cnt]->session == session.session) && \
+            (asso_list[cnt]->channel == session.channel))
         {
             if(asso_list[cnt]->appl)
             {
                 heap.free(asso_list[cnt]->appl);
+                asso_list[cnt]->appl = (void *)0;
+            }
+            
+            //Ԥ·Ͽ󱣳פ
+            if(asso_list[cnt]->resident)
+            {
+                continue;
             }
+            
             heap.free(asso_list[cnt]);
             asso_list[cnt] = (void *)0;
         }
     }
+    
+    ASSO_UNLOCK();
 }
 
 /**
@@ -2259,6 +2665,7 @@ uint8_t dlms_asso_accept_fctos(void)
     {
         asso_current->status = ASSOCIATED;
         asso_current->level = DLMS_ACCESS_HIGH;
+        asso_resume_save(asso_current);
         return(0xff);
     }
     
@@ -2279,21 +2686,27 @@ uint8_t dlms_asso_sc(void)
 }
 
 /**
-  * @brief ȡ Frame Counter 4 ֽ
+  * @brief ȡ Frame Counter 4 ֽڣʧʱ 0
   */
 uint8_t dlms_asso_fc(uint8_t *buffer)
 {
+    uint32_t fc;
+    
     if(!asso_current || !buffer)
     {
         return(0);
     }
     
-    asso_current->fc += 1;
+    //͹ó־ûļȡʱܼ
+    if(!dlms_util_next_fc(&fc))
+    {
+        return(0);
+    }
     
-    buffer[0] = (uint8_t)(asso_current->fc >> 24);
-    buffer[1] = (uint8_t)(asso_current->fc >> 16);
-    buffer[2] = (uint8_t)(asso_current->fc >> 8);
-    buffer[3] = (uint8_t)(asso_current->fc >> 0);
+    buffer[0] = (uint8_t)(fc >> 24);
+    buffer[1] = (uint8_t)(fc >> 16);
+    buffer[2] = (uint8_t)(fc >> 8);
+    buffer[3] = (uint8_t)(fc >> 0);
     
     return(4);
 }
@@ -2403,7 +2816,11 @@ uint8_t dlms_asso_cspubkey(uint8_t *buffer)
   */
 void dlms_asso_key_eliminate(void)
 {
-    key_is_eliminate = 0xff;
+    ASSO_LOCK();
+    key_generation += 1;
+    //ԿѸ£ָ
+    heap.set(resume_list, 0, sizeof(resume_list));
+    ASSO_UNLOCK();
 }
 
 /**
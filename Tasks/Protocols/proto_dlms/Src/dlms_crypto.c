@@ -0,0 +1,507 @@
+/**
+ * @brief		Բǩ
+ * @details		HLS7 general-signing ǩǩ
+ *              Linux 㽻ִ߳Уύߵõ CRYPTO_PENDING · RR/RNR Ӧ
+ *              ֮ͬύȡػĽƽֱ̨ͬ
+ * @date		2026-10-19
+ **/
+
+/* Includes ------------------------------------------------------------------*/
+#include "string.h"
+#include "system.h"
+#include "dlms_crypto.h"
+#include "dlms_association.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/hmac_drbg.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/platform_util.h"
+
+#if defined ( __linux )
+#include <stdlib.h>
+#include <pthread.h>
+#endif
+
+/* Private define ------------------------------------------------------------*/
+#if !defined(DLMS_CRYPTO_JOBS)
+#define DLMS_CRYPTO_JOBS                ((uint8_t)8) //񼰽ڱʱã
+#endif
+
+#if !defined(DLMS_CRYPTO_WORKERS)
+#define DLMS_CRYPTO_WORKERS             ((uint8_t)2) //߳ڱʱã
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief 
+  */
+enum __crypto_op
+{
+    CRYPTO_OP_VERIFY = 1,
+    CRYPTO_OP_SIGN,
+};
+
+/**
+  * @brief ״̬
+  */
+enum __crypto_state
+{
+    JOB_IDLE = 0,
+    JOB_QUEUED, //ȴ߳
+    JOB_RUNNING, //߳
+    JOB_DONE, //ɣ
+};
+
+/**
+  * @brief 
+  */
+struct __crypto_job
+{
+    uint8_t state; //enum __crypto_state
+    uint8_t op; //enum __crypto_op
+    uint8_t length; //ȣ32 Ϊ P-25648 Ϊ P-384
+    uint8_t result; //enum __crypto_result
+    uint32_t stamp; //ţʱɵĽ
+    uint8_t key[96]; //ǩΪԿ X||YǩΪ˽Կ߳ȡߺ󼴴ӻ
+    uint8_t digest[32]; //ǩ˽Կ SHA-256ƥ仺ǩ
+    uint8_t hash[48]; //ժҪ
+    uint8_t signature[96]; //ǩΪ룬ǩΪr||s
+    uint8_t seed[16]; //ǩ
+};
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/**
+  * @brief ǰǷȴ𣬸ֱͨ¼
+  */
+static DLMS_CHANNEL_LOCAL bool deferred = false;
+
+#if defined ( __linux )
+static struct __crypto_job jobs[DLMS_CRYPTO_JOBS];
+static pthread_mutex_t jobs_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobs_wakeup = PTHREAD_COND_INITIALIZER;
+static uint8_t workers = 0;
+static uint32_t finished = 0;
+
+/**
+  * @brief ǰ߳ǷΪ̣̲߳߳ʹ heap
+  */
+static __thread uint8_t in_worker = 0;
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief ִһǩǩ
+  */
+static enum __crypto_result crypto_execute(struct __crypto_job *job)
+{
+    mbedtls_ecdsa_context ctx;
+    mbedtls_hmac_drbg_context drbg;
+    mbedtls_mpi r, s;
+    int ret;
+    
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+    mbedtls_ecdsa_init(&ctx);
+    mbedtls_hmac_drbg_init(&drbg);
+    
+    if(job->length == 32)
+    {
+        ret = mbedtls_ecp_group_load(&ctx.grp, MBEDTLS_ECP_DP_SECP256R1);
+    }
+    else
+    {
+        ret = mbedtls_ecp_group_load(&ctx.grp, MBEDTLS_ECP_DP_SECP384R1);
+    }
+    
+    if(ret != 0)
+    {
+        goto cleanup;
+    }
+    
+    if(job->op == CRYPTO_OP_VERIFY)
+    {
+        if((ret = mbedtls_mpi_read_binary(&ctx.Q.X, &job->key[0], job->length)) != 0)
+        {
+            goto cleanup;
+        }
+        if((ret = mbedtls_mpi_read_binary(&ctx.Q.Y, &job->key[job->length], job->length)) != 0)
+        {
+            goto cleanup;
+        }
+        if((ret = mbedtls_mpi_lset(&ctx.Q.Z, 1)) != 0)
+        {
+            goto cleanup;
+        }
+        if((ret = mbedtls_mpi_read_binary(&r, &job->signature[0], job->length)) != 0)
+        {
+            goto cleanup;
+        }
+        if((ret = mbedtls_mpi_read_binary(&s, &job->signature[job->length], job->length)) != 0)
+        {
+            goto cleanup;
+        }
+        
+        ret = mbedtls_ecdsa_verify(&ctx.grp, job->hash, job->length, &ctx.Q, &r, &s);
+    }
+    else
+    {
+        if((ret = mbedtls_mpi_read_binary(&ctx.d, job->key, job->length)) != 0)
+        {
+            goto cleanup;
+        }
+        
+        //˽ԿժҪӹ̲ͬ߳ߵ
+        ret = mbedtls_hmac_drbg_seed_buf(&drbg, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), job->key, job->length);
+        if(ret != 0)
+        {
+            goto cleanup;
+        }
+        if((ret = mbedtls_hmac_drbg_update_ret(&drbg, job->hash, job->length)) != 0)
+        {
+            goto cleanup;
+        }
+        if((ret = mbedtls_hmac_drbg_update_ret(&drbg, job->seed, sizeof(job->seed))) != 0)
+        {
+            goto cleanup;
+        }
+        
+        ret = mbedtls_ecdsa_sign(&ctx.grp, &r, &s, &ctx.d, job->hash, job->length, mbedtls_hmac_drbg_random, &drbg);
+        if(ret != 0)
+        {
+            goto cleanup;
+        }
+        
+        if((ret = mbedtls_mpi_write_binary(&r, &job->signature[0], job->length)) != 0)
+        {
+            goto cleanup;
+        }
+        ret = mbedtls_mpi_write_binary(&s, &job->signature[job->length], job->length);
+    }
+
+cleanup:
+    mbedtls_hmac_drbg_free(&drbg);
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&s);
+    mbedtls_ecdsa_free(&ctx);
+    
+    if(ret != 0)
+    {
+        return(CRYPTO_FAILED);
+    }
+    
+    return(CRYPTO_SUCCESS);
+}
+
+#if defined ( __linux )
+/**
+  * @brief жϻǷύĲһ
+  */
+static bool job_matched(const struct __crypto_job *job, const struct __crypto_job *ask)
+{
+    if((job->op != ask->op) || (job->length != ask->length))
+    {
+        return(false);
+    }
+    
+    if(memcmp(job->hash, ask->hash, ask->length) != 0)
+    {
+        return(false);
+    }
+    
+    if(ask->op == CRYPTO_OP_VERIFY)
+    {
+        if(memcmp(job->key, ask->key, ask->length * 2) != 0)
+        {
+            return(false);
+        }
+        
+        return(memcmp(job->signature, ask->signature, ask->length * 2) == 0);
+    }
+    
+    //ǩ˽ԿժҪƥ䣬в˽Կ
+    return(memcmp(job->digest, ask->digest, sizeof(ask->digest)) == 0);
+}
+
+/**
+  * @brief ߳
+  */
+static void *crypto_worker(void *arg)
+{
+    struct __crypto_job job;
+    uint8_t cnt;
+    
+    in_worker = 1;
+    
+    pthread_mutex_lock(&jobs_lock);
+    
+    for(;;)
+    {
+        for(cnt=0; cnt<DLMS_CRYPTO_JOBS; cnt++)
+        {
+            if(jobs[cnt].state == JOB_QUEUED)
+            {
+                break;
+            }
+        }
+        
+        if(cnt >= DLMS_CRYPTO_JOBS)
+        {
+            pthread_cond_wait(&jobs_wakeup, &jobs_lock);
+            continue;
+        }
+        
+        //ڸ㣬ڼ䲻
+        jobs[cnt].state = JOB_RUNNING;
+        memcpy(&job, &jobs[cnt], sizeof(job));
+        mbedtls_platform_zeroize(jobs[cnt].key, sizeof(jobs[cnt].key));
+        pthread_mutex_unlock(&jobs_lock);
+        
+        job.result = crypto_execute(&job);
+        
+        pthread_mutex_lock(&jobs_lock);
+        memcpy(jobs[cnt].signature, job.signature, sizeof(job.signature));
+        jobs[cnt].result = job.result;
+        mbedtls_platform_zeroize(&job, sizeof(job));
+        finished += 1;
+        jobs[cnt].stamp = finished;
+        jobs[cnt].state = JOB_DONE;
+    }
+    
+    return((void *)0);
+}
+
+/**
+  * @brief ύ
+  */
+static enum __crypto_result crypto_submit(struct __crypto_job *ask)
+{
+    struct __crypto_job *slot = (struct __crypto_job *)0;
+    enum __crypto_result result;
+    uint8_t cnt;
+    
+    pthread_mutex_lock(&jobs_lock);
+    
+    //ѯύ
+    for(cnt=0; cnt<DLMS_CRYPTO_JOBS; cnt++)
+    {
+        if((jobs[cnt].state == JOB_IDLE) || !job_matched(&jobs[cnt], ask))
+        {
+            continue;
+        }
+        
+        if(jobs[cnt].state != JOB_DONE)
+        {
+            pthread_mutex_unlock(&jobs_lock);
+            deferred = true;
+            return(CRYPTO_PENDING);
+        }
+        
+        heap.copy(ask->signature, jobs[cnt].signature, sizeof(ask->signature));
+        result = (enum __crypto_result)jobs[cnt].result;
+        pthread_mutex_unlock(&jobs_lock);
+        return(result);
+    }
+    
+    //ѯнڵ㣬û򸲸ɵĽ
+    if(workers)
+    {
+        for(cnt=0; cnt<DLMS_CRYPTO_JOBS; cnt++)
+        {
+            if(jobs[cnt].state == JOB_IDLE)
+            {
+                slot = &jobs[cnt];
+                break;
+            }
+            
+            if((jobs[cnt].state == JOB_DONE) && (!slot || (jobs[cnt].stamp < slot->stamp)))
+            {
+                slot = &jobs[cnt];
+            }
+        }
+    }
+    
+    //̲߳ûͬ
+    if(!slot)
+    {
+        pthread_mutex_unlock(&jobs_lock);
+        return(crypto_execute(ask));
+    }
+    
+    heap.copy(slot, ask, sizeof(struct __crypto_job));
+    slot->state = JOB_QUEUED;
+    pthread_cond_signal(&jobs_wakeup);
+    pthread_mutex_unlock(&jobs_lock);
+    
+    deferred = true;
+    return(CRYPTO_PENDING);
+}
+#else
+/**
+  * @brief ύͬ㣩
+  */
+static enum __crypto_result crypto_submit(struct __crypto_job *ask)
+{
+    return(crypto_execute(ask));
+}
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief ߳
+  */
+void dlms_crypto_init(void)
+{
+#if defined ( __linux )
+    pthread_t thread;
+    pthread_attr_t thread_attr;
+    
+    pthread_mutex_lock(&jobs_lock);
+    
+    while(workers < DLMS_CRYPTO_WORKERS)
+    {
+        pthread_attr_init(&thread_attr);
+        pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_DETACHED);
+        if(pthread_create(&thread, &thread_attr, crypto_worker, NULL) != 0)
+        {
+            pthread_attr_destroy(&thread_attr);
+            break;
+        }
+        pthread_attr_destroy(&thread_attr);
+        workers += 1;
+    }
+    
+    pthread_mutex_unlock(&jobs_lock);
+#endif
+    
+    deferred = false;
+}
+
+/**
+  * @brief ŶӵͻĽеɺȻ
+  */
+void dlms_crypto_exit(void)
+{
+#if defined ( __linux )
+    uint8_t cnt;
+    
+    pthread_mutex_lock(&jobs_lock);
+    
+    for(cnt=0; cnt<DLMS_CRYPTO_JOBS; cnt++)
+    {
+        if(jobs[cnt].state != JOB_RUNNING)
+        {
+            heap.set(&jobs[cnt], 0, sizeof(jobs[cnt]));
+        }
+    }
+    
+    pthread_mutex_unlock(&jobs_lock);
+#endif
+    
+    deferred = false;
+}
+
+/**
+  * @brief ǩlength Ϊȣ32  48ԿǩΪ
+  */
+enum __crypto_result dlms_crypto_verify(const uint8_t *pubkey, uint8_t length, const uint8_t *hash, const uint8_t *signature)
+{
+    struct __crypto_job job;
+    
+    if(!pubkey || !hash || !signature || ((length != 32) && (length != 48)))
+    {
+        return(CRYPTO_FAILED);
+    }
+    
+    heap.set(&job, 0, sizeof(job));
+    job.op = CRYPTO_OP_VERIFY;
+    job.length = length;
+    heap.copy(job.key, pubkey, length * 2);
+    heap.copy(job.hash, hash, length);
+    heap.copy(job.signature, signature, length * 2);
+    
+    return(crypto_submit(&job));
+}
+
+/**
+  * @brief ǩlength Ϊȣ32  48ǩΪ
+  */
+enum __crypto_result dlms_crypto_sign(const uint8_t *prikey, uint8_t length, const uint8_t *hash, uint8_t *signature)
+{
+    struct __crypto_job job;
+    enum __crypto_result result;
+    
+    if(!prikey || !hash || !signature || ((length != 32) && (length != 48)))
+    {
+        return(CRYPTO_FAILED);
+    }
+    
+    heap.set(&job, 0, sizeof(job));
+    job.op = CRYPTO_OP_SIGN;
+    job.length = length;
+    heap.copy(job.key, prikey, length);
+    heap.copy(job.hash, hash, length);
+    dlms_asso_random(sizeof(job.seed), job.seed);
+    
+    if(mbedtls_sha256_ret(prikey, length, job.digest, 0) != 0)
+    {
+        heap.set(job.key, 0, sizeof(job.key));
+        return(CRYPTO_FAILED);
+    }
+    
+    result = crypto_submit(&job);
+    
+    if(result == CRYPTO_SUCCESS)
+    {
+        heap.copy(signature, job.signature, length * 2);
+    }
+    
+    heap.set(job.key, 0, sizeof(job.key));
+    
+    return(result);
+}
+
+/**
+  * @brief ־ÿδµǰ
+  */
+void dlms_crypto_clear(void)
+{
+    deferred = false;
+}
+
+/**
+  * @brief ǰǷȴ
+  */
+bool dlms_crypto_deferred(void)
+{
+    return(deferred);
+}
+
+#if defined ( __linux )
+/**
+  * @brief mbedtls ڴ䣬߳ʹñ׼⣨heap ̰߳ȫ
+  */
+void *dlms_crypto_calloc(size_t n, size_t size)
+{
+    if(in_worker)
+    {
+        return(calloc(n, size));
+    }
+    
+    return(heap.dcalloc(n, size));
+}
+
+/**
+  * @brief mbedtls ڴͷ
+  */
+void dlms_crypto_free(void *ptr)
+{
+    if(in_worker)
+    {
+        free(ptr);
+        return;
+    }
+    
+    heap.free(ptr);
+}
+#endif
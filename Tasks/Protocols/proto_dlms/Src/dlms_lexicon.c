@@ -13,10 +13,39 @@
 #include "cpu.h"
 #include "crc.h"
 #include "mbedtls/md5.h"
+#include "cosem_objects.h"
+
+#if defined ( DLMS_CONFIG_PARALLEL )
+#include <pthread.h>
+#endif
 
 /* Private define ------------------------------------------------------------*/
 #define MAX_LEX_CACHE_SIZE		((uint8_t)3)
 
+#if !defined(DLMS_LEX_RESOLVED_AMOUNT)
+#if defined (BUILD_REAL_WORLD)
+#define DLMS_LEX_RESOLVED_AMOUNT	((uint16_t)64) //פڴѽ
+#else
+#define DLMS_LEX_RESOLVED_AMOUNT	((uint16_t)1024) //פڴѽ
+#endif
+#endif
+
+#if !defined(DLMS_LEX_RIGHT_POOL)
+#if defined (BUILD_REAL_WORLD)
+#define DLMS_LEX_RIGHT_POOL			((uint16_t)1024) //ѽȨޱֽ
+#else
+#define DLMS_LEX_RIGHT_POOL			((uint16_t)(24*1024)) //ѽȨޱֽ
+#endif
+#endif
+
+#if !defined(DLMS_LEX_VERIFY_CHUNK)
+#if defined (BUILD_REAL_WORLD)
+#define DLMS_LEX_VERIFY_CHUNK		((uint16_t)4) //Уʱһ˳ȡ
+#else
+#define DLMS_LEX_VERIFY_CHUNK		((uint16_t)16) //Уʱһ˳ȡ
+#endif
+#endif
+
 #pragma pack(push)
 #pragma pack(4)
 
@@ -135,11 +164,83 @@ struct __cosem_entry_cache
 	uint32_t mid;
 };
 
+/**
+  * @brief  ѽ cosem 
+  * ڲļУɣֵ
+  * Ȩް {0..n 1..m}{lowest low high}  fright 
+  */
+struct __cosem_resolved
+{
+    uint64_t key;//8 {classID groupA groupB groupC groupD groupE groupF suit}
+    uint32_t oid;//4
+    uint32_t mid[3];//3*4
+    const TypeObject *handler;//ຯ
+    uint16_t right;//Ȩ fright еƫ
+    uint8_t attr;//Ը
+    uint8_t method;//
+};
+
+/**
+  * @brief  ļУ״̬
+  */
+enum __cosem_verify_state
+{
+    LEX_ABSENT = 0, //ļڻУʧ
+    LEX_VERIFYING, //У
+    LEX_READY, //Уͨ
+};
+
+/**
+  * @brief  ļУ
+  * У dlms_lex_verify зֽƽͬʱѽ
+  */
+struct __cosem_verify
+{
+    enum __cosem_verify_state state;
+    uint16_t cursor;//һУ
+    uint16_t used;//fright ֽ
+    bool overflow;//Ȩ޿ռĿٽ
+    uint64_t accumulate;//һĿļֵڼ
+    mbedtls_md5_context ctx;
+};
+
+/**
+  * @brief  ͨУĲļ
+  * ϢͷļϢУֵδ仯ʱΪļδ£ʱУ
+  */
+struct __cosem_stamp
+{
+    uint32_t header;
+    uint32_t info;
+};
+
 /* Private macro -------------------------------------------------------------*/
+#if defined ( DLMS_CONFIG_PARALLEL )
+//»ѽ̻ͨ߳
+#define LEX_LOCK()                  pthread_mutex_lock(&flock)
+#define LEX_UNLOCK()                pthread_mutex_unlock(&flock)
+#else
+#define LEX_LOCK()
+#define LEX_UNLOCK()
+#endif
+
 /* Private variables ---------------------------------------------------------*/
+#if defined ( DLMS_CONFIG_PARALLEL )
+static pthread_mutex_t flock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 static struct __cosem_param_header fheader;
+static struct __cosem_param_info finfo;
 static struct __cosem_entry_cache fcache[MAX_LEX_CACHE_SIZE];
 
+static struct __cosem_resolved ftable[DLMS_LEX_RESOLVED_AMOUNT];
+static uint8_t fright[DLMS_LEX_RIGHT_POOL];
+static uint16_t ftable_amount = 0;//ѽ
+static bool ftable_complete = false;//ļеȫ
+
+static struct __cosem_verify fverify;
+static struct __cosem_stamp fstamp;
+
 /**
   * @brief  
   */
@@ -167,6 +268,90 @@ static const struct __cosem_entry_high communal[] =
             {METHOD_NONE, METHOD_ACCESS, METHOD_ACCESS}, //method 4
         },
     },
+    
+    /** push setup 0 */
+    /** 0-0:25.9.0.255 */
+    {
+        0x280000190900FFFF,
+
+        0xffffff01, //oid
+
+        {
+            {ATTR_NONE, ATTR_NONE, ATTR_NONE}, //attribute 0
+            {ATTR_NONE, ATTR_READ, ATTR_READ}, //attribute 1
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 2
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 3
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 4
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 5
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 6
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 7
+
+            {METHOD_NONE, METHOD_NONE, METHOD_ACCESS}, //method 1
+        },
+    },
+    
+    /** push setup 1 */
+    /** 0-0:25.9.1.255 */
+    {
+        0x280000190901FFFF,
+
+        0xffffff02, //oid
+
+        {
+            {ATTR_NONE, ATTR_NONE, ATTR_NONE}, //attribute 0
+            {ATTR_NONE, ATTR_READ, ATTR_READ}, //attribute 1
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 2
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 3
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 4
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 5
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 6
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 7
+
+            {METHOD_NONE, METHOD_NONE, METHOD_ACCESS}, //method 1
+        },
+    },
+    
+    /** push setup 2 */
+    /** 0-0:25.9.2.255 */
+    {
+        0x280000190902FFFF,
+
+        0xffffff03, //oid
+
+        {
+            {ATTR_NONE, ATTR_NONE, ATTR_NONE}, //attribute 0
+            {ATTR_NONE, ATTR_READ, ATTR_READ}, //attribute 1
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 2
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 3
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 4
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 5
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 6
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 7
+
+            {METHOD_NONE, METHOD_NONE, METHOD_ACCESS}, //method 1
+        },
+    },
+    
+    /** push setup 3 */
+    /** 0-0:25.9.3.255 */
+    {
+        0x280000190903FFFF,
+
+        0xffffff04, //oid
+
+        {
+            {ATTR_NONE, ATTR_NONE, ATTR_NONE}, //attribute 0
+            {ATTR_NONE, ATTR_READ, ATTR_READ}, //attribute 1
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 2
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 3
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 4
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 5
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 6
+            {ATTR_NONE, ATTR_READ, (ATTR_READ | ATTR_WRITE)}, //attribute 7
+
+            {METHOD_NONE, METHOD_NONE, METHOD_ACCESS}, //method 1
+        },
+    },
 };
 
 /* Private function prototypes -----------------------------------------------*/
@@ -291,6 +476,7 @@ static void get_class_map(uint16_t id, uint8_t *attr, uint8_t *method)
         case CLASS_REGISTER_MONITOR: *attr = 4; *method = 0; return;
         case CLASS_SINGLE_ACTION: *attr = 4; *method = 0; return;
         case CLASS_HDLC_SETUP: *attr = 9; *method = 0; return;
+        case CLASS_PUSH_SETUP: *attr = 7; *method = 1; return;
         case CLASS_MAC_ADDRESS_SETUP: *attr = 2; *method = 0; return;
         case CLASS_RELAY: *attr = 4; *method = 2; return;
         case CLASS_LIMITER: *attr = 11; *method = 0; return;
@@ -304,7 +490,7 @@ static void get_class_map(uint16_t id, uint8_t *attr, uint8_t *method)
   * @brief   ȡ   ڲݱʶ
   */
 static void get_class_mid(const struct __cosem_request_desc *desc,
-                          const struct __cosem_entry_low *entry,
+                          const uint32_t *entry,
                           uint32_t *mid)
 {
     if((!desc) || (!entry) || (!mid))
@@ -320,7 +506,7 @@ static void get_class_mid(const struct __cosem_request_desc *desc,
         {
             if(desc->descriptor.index == 2)
             {
-                *mid = entry->mid[0];
+                *mid = entry[0];
             }
             
             break;
@@ -329,11 +515,11 @@ static void get_class_mid(const struct __cosem_request_desc *desc,
         {
             if(desc->descriptor.index == 2)
             {
-                *mid = entry->mid[0];
+                *mid = entry[0];
             }
             else if(desc->descriptor.index == 3)
             {
-                *mid = entry->mid[1];
+                *mid = entry[1];
             }
             
             break;
@@ -342,15 +528,15 @@ static void get_class_mid(const struct __cosem_request_desc *desc,
         {
             if(desc->descriptor.index == 2)
             {
-                *mid = entry->mid[0];
+                *mid = entry[0];
             }
             else if(desc->descriptor.index == 3)
             {
-                *mid = entry->mid[1];
+                *mid = entry[1];
             }
             else if(desc->descriptor.index == 5)
             {
-                *mid = entry->mid[2];
+                *mid = entry[2];
             }
             
             break;
@@ -359,15 +545,15 @@ static void get_class_mid(const struct __cosem_request_desc *desc,
         {
             if(desc->descriptor.index == 2)
             {
-                *mid = entry->mid[0];
+                *mid = entry[0];
             }
             else if(desc->descriptor.index == 3)
             {
-                *mid = entry->mid[1];
+                *mid = entry[1];
             }
             else if(desc->descriptor.index == 4)
             {
-                *mid = entry->mid[2];
+                *mid = entry[2];
             }
             
             break;
@@ -376,15 +562,15 @@ static void get_class_mid(const struct __cosem_request_desc *desc,
         {
             if(desc->descriptor.index == 4)
             {
-                *mid = entry->mid[0];
+                *mid = entry[0];
             }
             else if(desc->descriptor.index == 7)
             {
-                *mid = entry->mid[1];
+                *mid = entry[1];
             }
             else if(desc->descriptor.index == 8)
             {
-                *mid = entry->mid[2];
+                *mid = entry[2];
             }
             
             break;
@@ -393,11 +579,11 @@ static void get_class_mid(const struct __cosem_request_desc *desc,
         {
             if(desc->descriptor.index == 2)
             {
-                *mid = entry->mid[0];
+                *mid = entry[0];
             }
             else if(desc->descriptor.index == 3)
             {
-                *mid = entry->mid[1];
+                *mid = entry[1];
             }
             
             break;
@@ -453,7 +639,7 @@ static void prase_cosem_entry_low(const struct __cosem_request_desc *desc,
             return;
         }
         
-        get_class_mid(desc, entry, mid);
+        get_class_mid(desc, entry->mid, mid);
         
         if(desc->level == DLMS_ACCESS_LOWEST)
         {
@@ -597,230 +783,900 @@ static void prase_cosem_entry_high(const struct __cosem_request_desc *desc,
 }
 
 /**
-  * @brief   struct __cosem_request_desc еݣȡϢ
-  * @param  desc Լǰ״̬ϳ
-  * @param  right ǰķȨ
-  * @param  oid 
-  * @param  mid ڲݱʶ
-  * @retval None
+  * @brief  ɱȶԼֵ
   */
-void dlms_lex_parse(const struct __cosem_request_desc *desc,
-                    union __dlms_right *right,
-                    uint32_t *oid,
-                    uint32_t *mid)
+static uint64_t make_key(const struct __cosem_descriptor *descriptor)
 {
     uint64_t key;
-    uint16_t cnt;
-    uint16_t position;
-    uint16_t step;
-    union __cosem_entry_file entry;
-    
-    if((!right) || (!oid) || (!mid))
-    {
-        return;
-    }
-    
-    right->attr = ATTR_NONE;
-    *oid = 0xffffffff;
-    *mid = 0;
-    
-    if(!desc)
-    {
-        return;
-    }
-	
-	//һ
-	for(cnt=0; cnt<MAX_LEX_CACHE_SIZE; cnt++)
-	{
-		if(desc->request != fcache[cnt].request)
-		{
-			continue;
-		}
-		if(desc->level != fcache[cnt].level)
-		{
-			continue;
-		}
-		if(!(desc->suit & fcache[cnt].suit))
-		{
-			continue;
-		}
-		if(desc->descriptor.classid != fcache[cnt].descriptor.classid)
-		{
-			continue;
-		}
-		if(desc->descriptor.index != fcache[cnt].descriptor.index)
-		{
-			continue;
-		}
-		if(memcmp(desc->descriptor.obis, fcache[cnt].descriptor.obis, 6))
-		{
-			continue;
-		}
-		
-		right->attr = fcache[cnt].right.attr;
-		*oid = fcache[cnt].oid;
-		*mid = fcache[cnt].mid;
-		if(fcache[cnt].hit < 255)
-		{
-			fcache[cnt].hit += 1;
-		}
-		
-		return;
-	}
     
-    //ɱȶԼֵ
-    key = (desc->descriptor.classid & 0xff);
+    key = (descriptor->classid & 0xff);
     key <<= 8;
-    key += (desc->descriptor.obis[0] & 0xff);
+    key += (descriptor->obis[0] & 0xff);
     key <<= 8;
-    key += (desc->descriptor.obis[1] & 0xff);
+    key += (descriptor->obis[1] & 0xff);
     key <<= 8;
-    key += (desc->descriptor.obis[2] & 0xff);
+    key += (descriptor->obis[2] & 0xff);
     key <<= 8;
-    key += (desc->descriptor.obis[3] & 0xff);
+    key += (descriptor->obis[3] & 0xff);
     key <<= 8;
-    key += (desc->descriptor.obis[4] & 0xff);
+    key += (descriptor->obis[4] & 0xff);
     key <<= 8;
-    key += (desc->descriptor.obis[5] & 0xff);
+    key += (descriptor->obis[5] & 0xff);
     key <<= 8;
     
-    //ұ
-    if(desc->descriptor.classid > 8)
+    return(key);
+}
+
+/**
+  * @brief  ϢͷǷȷȷʱ´ļ
+  */
+static bool load_header(void)
+{
+    if(crc32(&fheader, (sizeof(struct __cosem_param_header) - sizeof(uint32_t)), 0) == \
+            fheader.check)
     {
-        for(cnt=0; cnt<(sizeof(communal)/sizeof(struct __cosem_entry_high)); cnt++)
-        {
-            if(key == ((communal + cnt)->key & 0xffffffffffffff00))
-            {
-                prase_cosem_entry_high(desc, (communal + cnt), right, oid);
-                return;
-            }
-        }
+        return(true);
+    }
+    
+    if(file.parameter.read("lexicon", STRUCT_OFFSET(struct __cosem_param, header), sizeof(struct __cosem_param_header), &fheader) != \
+        sizeof(struct __cosem_param_header))
+    {
+        heap.set(&fheader, 0, sizeof(fheader));
+        return(false);
     }
     
-    //ϢͷǷȷ
     if(crc32(&fheader, (sizeof(struct __cosem_param_header) - sizeof(uint32_t)), 0) != \
             fheader.check)
     {
-		if(file.parameter.read("lexicon", STRUCT_OFFSET(struct __cosem_param, header), sizeof(struct __cosem_param_header), &fheader) != \
-			sizeof(struct __cosem_param_header))
-		{
-			heap.set(&fheader, 0, sizeof(fheader));
-			return;
-		}
-		
-		if(crc32(&fheader, (sizeof(struct __cosem_param_header) - sizeof(uint32_t)), 0) != \
-				fheader.check)
-		{
-			heap.set(&fheader, 0, sizeof(fheader));
-			return;
-		}
+        heap.set(&fheader, 0, sizeof(fheader));
+        return(false);
     }
-	
-	if(!fheader.amount)
-	{
-		return;
-	}
-    
-    //ʼַ
     
-    //м俪ʼ
-    position = fheader.amount / 2;
-    step = position;
+    return(true);
+}
+
+/**
+  * @brief   [*from, amount) ΧڶֲҼֵ
+  * ҵʱ *from Ϊƥλãδҵʱ *from Ϊλ
+  * ֵʱҴխ
+  */
+static bool search_entry(uint64_t key, uint16_t *from, union __cosem_entry_file *entry)
+{
+    uint16_t low = *from;
+    uint16_t high = fheader.amount;
+    uint16_t middle;
     
-    for(cnt=0; cnt<(fastlog2(fheader.amount) + 2); cnt++)
+    while(low < high)
     {
         cpu.watchdog.feed();
         
-        //ȡ
+        middle = low + (high - low) / 2;
+        
         if(file.parameter.read("lexicon", \
-                     STRUCT_OFFSET(struct __cosem_param, entry[position]), \
-                     sizeof(entry), \
-                     &entry) != sizeof(entry))
+                     STRUCT_OFFSET(struct __cosem_param, entry[middle]), \
+                     sizeof(union __cosem_entry_file), \
+                     entry) != sizeof(union __cosem_entry_file))
         {
             break;
         }
         
-        step = step / 2;
-        
-        //ֵȶ
-        if(key < (entry.key & 0xffffffffffffff00))
+        if((entry->key & 0xffffffffffffff00) < key)
         {
-			if(step == 0)
-			{
-				step = 1;
-			}
-			
-            if(position > step)
-            {
-                position -= step;
-            }
-            else
-            {
-                position = 0;
-            }
-            
-            continue;
-        }
-        else if(key > (entry.key & 0xffffffffffffff00))
-        {
-			if(step == 0)
-			{
-				step = 1;
-			}
-			
-            if((position + step) < fheader.amount)
-            {
-                position += step;
-            }
-            else
-            {
-                position = fheader.amount - 1;
-            }
-            
-            continue;
+            low = middle + 1;
         }
-        
-        //ֵƥ
-        if(desc->descriptor.classid <= 8)
+        else if((entry->key & 0xffffffffffffff00) > key)
         {
-            //У
-            if(crc32(&entry.low.entry, sizeof(entry.low.entry), 0) != entry.low.check)
-            {
-                //Уʧ
-                break;
-            }
-            
-            prase_cosem_entry_low(desc, &entry.low.entry, right, oid, mid);
-            break;
+            high = middle;
         }
         else
         {
-            //У
-            if(crc32(&entry.high.entry, sizeof(entry.high.entry), 0) != entry.high.check)
-            {
-                //Уʧ
-                break;
-            }
-            
-            prase_cosem_entry_high(desc, &entry.high.entry, right, oid);
-            break;
+            *from = middle;
+            return(true);
         }
     }
     
-    return;
+    *from = low;
+    
+    return(false);
 }
 
 /**
-  * @brief  ȡָsuitϢ
+  * @brief  ʹຯѡȡ Get/Set 򷽷
   */
-uint16_t dlms_lex_amount(uint8_t suit)
+static TypeObject select_object(const struct __cosem_request_desc *desc,
+                                const TypeObject *handler,
+                                uint8_t attr,
+                                uint8_t method)
 {
-    uint16_t cnt;
-    uint16_t amount = 0;
-	
-	if(!suit)
-	{
-		return(0);
+    if(!handler || !desc->descriptor.index)
+    {
+        return((TypeObject)0);
+    }
+    
+    if( desc->request == ACTION_REQUEST || \
+        desc->request == GLO_ACTION_REQUEST || \
+        desc->request == DED_ACTION_REQUEST)
+    {
+        if(desc->descriptor.index > method)
+        {
+            return((TypeObject)0);
+        }
+        
+        return(handler[attr * 2 + (desc->descriptor.index - 1)]);
+    }
+    
+    if(desc->descriptor.index > attr)
+    {
+        return((TypeObject)0);
+    }
+    
+    if( desc->request == SET_REQUEST || \
+        desc->request == GLO_SET_REQUEST || \
+        desc->request == DED_SET_REQUEST)
+    {
+        return(handler[(desc->descriptor.index - 1) * 2 + 1]);
+    }
+    
+    return(handler[(desc->descriptor.index - 1) * 2]);
+}
+
+/**
+  * @brief  Żȡ
+  */
+static TypeObject load_object(const struct __cosem_request_desc *desc)
+{
+    const TypeObject *handler;
+    uint8_t attr;
+    uint8_t method;
+    
+    handler = CosemLoadClass(desc->descriptor.classid, &attr, &method);
+    
+    return(select_object(desc, handler, attr, method));
+}
+
+/**
+  * @brief  һУѽ
+  * Ȩ޿ռ䲻ʱֻǰĿĿԴӲļ
+  */
+static void resolve_entry(const union __cosem_entry_file *entry)
+{
+    uint16_t rows;
+    uint8_t classid;
+    uint8_t attr = 0;
+    uint8_t method = 0;
+    uint8_t hattr = 0;
+    uint8_t hmethod = 0;
+    struct __cosem_resolved *resolved;
+    
+    if(fverify.overflow)
+    {
+        return;
+    }
+    
+    if(ftable_amount >= DLMS_LEX_RESOLVED_AMOUNT)
+    {
+        fverify.overflow = true;
+        return;
+    }
+    
+    classid = ((entry->key >> 56) & 0xff);
+    
+    get_class_map(classid, &attr, &method);
+    
+    //δ֪ûԺͷѽ
+    if(!attr && !method)
+    {
+        return;
+    }
+    
+    //һ£Ժͷ洢ΧĿΪЧ
+    if((attr + method) > ((classid <= 8)? 16 : 24))
+    {
+        return;
+    }
+    
+    //ȨްԺֱ 0 б
+    rows = attr + method + 1;
+    
+    if((fverify.used + rows * 3) > DLMS_LEX_RIGHT_POOL)
+    {
+        fverify.overflow = true;
+        return;
+    }
+    
+    resolved = &ftable[ftable_amount];
+    
+    resolved->key = entry->key;
+    resolved->attr = attr;
+    resolved->method = method;
+    resolved->right = fverify.used;
+    
+    heap.set(&fright[fverify.used], 0, rows * 3);
+    
+    if(classid <= 8)
+    {
+        resolved->oid = entry->low.entry.oid;
+        heap.copy(resolved->mid, entry->low.entry.mid, sizeof(resolved->mid));
+        heap.copy(&fright[fverify.used], \
+                  &entry->low.entry.right[0][0], \
+                  sizeof(entry->low.entry.right[0]) * ((rows < 16)? rows : 16));
+    }
+    else
+    {
+        resolved->oid = entry->high.entry.oid;
+        heap.set(resolved->mid, 0, sizeof(resolved->mid));
+        heap.copy(&fright[fverify.used], \
+                  &entry->high.entry.right[0][0], \
+                  sizeof(entry->high.entry.right[0]) * ((rows < 24)? rows : 24));
+    }
+    
+    resolved->handler = CosemLoadClass(classid, &hattr, &hmethod);
+    
+    if((hattr != attr) || (hmethod != method))
+    {
+        resolved->handler = (const TypeObject *)0;
+    }
+    
+    fverify.used += rows * 3;
+    ftable_amount += 1;
+}
+
+/**
+  * @brief  Уһۼ md5ֵĿУ
+  */
+static bool verify_entry(const union __cosem_entry_file *entry)
+{
+    if(mbedtls_md5_update_ret(&fverify.ctx, (const unsigned char *)entry, sizeof(union __cosem_entry_file)) != 0)
+    {
+        return(false);
+    }
+    
+    if((entry->key & 0xffffffffffffff00) < fverify.accumulate)
+    {
+        return(false);
+    }
+    
+    fverify.accumulate = (entry->key & 0xffffffffffffff00);
+    
+    if(((entry->key >> 56) & 0xff) <= 8)
+    {
+        if(crc32(&entry->low.entry, sizeof(entry->low.entry), 0) != entry->low.check)
+        {
+            return(false);
+        }
+    }
+    else
+    {
+        if(crc32(&entry->high.entry, sizeof(entry->high.entry), 0) != entry->high.check)
+        {
+            return(false);
+        }
+    }
+    
+    return(true);
+}
+
+/**
+  * @brief  Уʧܣϲļѽ
+  */
+static void verify_abort(void)
+{
+    if(fverify.state == LEX_VERIFYING)
+    {
+        mbedtls_md5_free(&fverify.ctx);
+    }
+    
+    fverify.state = LEX_ABSENT;
+    ftable_amount = 0;
+    ftable_complete = false;
+    heap.set(&fstamp, 0, sizeof(fstamp));
+}
+
+/**
+  * @brief  Уȫȶ md5ͨ¼ļ
+  */
+static void verify_finish(void)
+{
+    uint8_t md5_output[16] = {0};
+    
+    if(mbedtls_md5_finish_ret(&fverify.ctx, md5_output) != 0)
+    {
+        verify_abort();
+        return;
+    }
+    
+    if(memcmp(md5_output, finfo.md5, 16) != 0)
+    {
+        verify_abort();
+        return;
+    }
+    
+    mbedtls_md5_free(&fverify.ctx);
+    
+    ftable_complete = !fverify.overflow;
+    fstamp.header = fheader.check;
+    fstamp.info = finfo.check;
+    fverify.state = LEX_READY;
+}
+
+/**
+  * @brief  ļУڼĶ
+  * DATA_TEMPORARY_FAILURE  ACTION_TEMPORARY_FAILURE ȡֵͬԺͷظʱʧ
+  */
+static ObjectErrs lex_unavailable(ObjectPara *P)
+{
+    return((ObjectErrs)DATA_TEMPORARY_FAILURE);
+}
+
+/**
+  * @brief  ļУڼ䣬ͳһظʱʧ
+  * Ȩ޽ͨʼ飬oid  mid Чڲȡȡ
+  */
+static void lex_pending(const struct __cosem_request_desc *desc,
+                        union __dlms_right *right,
+                        TypeObject *object)
+{
+    if( desc->request == ACTION_REQUEST || \
+        desc->request == GLO_ACTION_REQUEST || \
+        desc->request == DED_ACTION_REQUEST)
+    {
+        right->method = METHOD_ACCESS;
+    }
+    else
+    {
+        right->attr = (enum __dlms_attr_right)(ATTR_READ | ATTR_WRITE);
+    }
+    
+    if(object)
+    {
+        *object = lex_unavailable;
+    }
+}
+
+/**
+  * @brief  ѽв
+  * @retval true ѵõ󲻴ڣfalse ҪӲļ
+  */
+static bool lookup_table(const struct __cosem_request_desc *desc,
+                         union __dlms_right *right,
+                         uint32_t *oid,
+                         uint32_t *mid,
+                         TypeObject *object)
+{
+    uint64_t key;
+    uint16_t low = 0;
+    uint16_t high = ftable_amount;
+    uint16_t middle;
+    uint8_t level;
+    const uint8_t *rights;
+    const struct __cosem_resolved *resolved = (const struct __cosem_resolved *)0;
+    
+    key = make_key(&desc->descriptor);
+    
+    while(low < high)
+    {
+        middle = low + (high - low) / 2;
+        
+        if((ftable[middle].key & 0xffffffffffffff00) < key)
+        {
+            low = middle + 1;
+        }
+        else if((ftable[middle].key & 0xffffffffffffff00) > key)
+        {
+            high = middle;
+        }
+        else
+        {
+            resolved = &ftable[middle];
+            break;
+        }
+    }
+    
+    if(!resolved)
+    {
+        if(ftable_complete && object)
+        {
+            *object = load_object(desc);
+        }
+        
+        return(ftable_complete);
+    }
+    
+    if(object)
+    {
+        if(resolved->handler)
+        {
+            *object = select_object(desc, resolved->handler, resolved->attr, resolved->method);
+        }
+        else
+        {
+            *object = load_object(desc);
+        }
+    }
+    
+    if(!(desc->suit & (resolved->key & 0xff)))
+    {
+        return(true);
+    }
+    
+    *oid = resolved->oid;
+    
+    rights = &fright[resolved->right];
+    
+    //޷ʵȼʱȨޱΪ NONE
+    if((desc->level >= DLMS_ACCESS_LOWEST) && (desc->level <= DLMS_ACCESS_HIGH))
+    {
+        level = desc->level - DLMS_ACCESS_LOWEST;
+    }
+    else
+    {
+        level = 0xff;
+    }
+    
+    if( desc->request == GET_REQUEST || \
+        desc->request == GLO_GET_REQUEST || \
+        desc->request == DED_GET_REQUEST || \
+        desc->request == SET_REQUEST || \
+        desc->request == GLO_SET_REQUEST || \
+        desc->request == DED_SET_REQUEST)
+    {
+        if(desc->descriptor.index > resolved->attr)
+        {
+            return(true);
+        }
+        
+        if(desc->descriptor.classid <= 8)
+        {
+            get_class_mid(desc, resolved->mid, mid);
+        }
+        
+        if(level != 0xff)
+        {
+            right->attr = (enum __dlms_attr_right)rights[desc->descriptor.index * 3 + level];
+        }
+    }
+    else if(desc->request == ACTION_REQUEST || \
+            desc->request == GLO_ACTION_REQUEST || \
+            desc->request == DED_ACTION_REQUEST)
+    {
+        if(desc->descriptor.index > resolved->method)
+        {
+            return(true);
+        }
+        
+        if(level != 0xff)
+        {
+            right->method = (enum __dlms_method_right)rights[(resolved->attr + desc->descriptor.index) * 3 + level];
+        }
+    }
+    
+    return(true);
+}
+
+/**
+  * @brief   struct __cosem_request_desc еݣȡϢ
+  * @param  desc Լǰ״̬ϳ
+  * @param  right ǰķȨ
+  * @param  oid 
+  * @param  mid ڲݱʶ
+  * @param  object Ϊʱȡ
+  * @retval None
+  */
+static void lex_parse(const struct __cosem_request_desc *desc,
+                      union __dlms_right *right,
+                      uint32_t *oid,
+                      uint32_t *mid,
+                      TypeObject *object)
+{
+    uint64_t key;
+    uint16_t cnt;
+    uint16_t position;
+    uint16_t step;
+    union __cosem_entry_file entry;
+    
+    if((!right) || (!oid) || (!mid))
+    {
+        return;
+    }
+    
+    right->attr = ATTR_NONE;
+    *oid = 0xffffffff;
+    *mid = 0;
+    
+    if(object)
+    {
+        *object = (TypeObject)0;
+    }
+    
+    if(!desc)
+    {
+        return;
+    }
+    
+    //ұ
+    if(desc->descriptor.classid > 8)
+    {
+        key = make_key(&desc->descriptor);
+        
+        for(cnt=0; cnt<(sizeof(communal)/sizeof(struct __cosem_entry_high)); cnt++)
+        {
+            if(key == ((communal + cnt)->key & 0xffffffffffffff00))
+            {
+                if(object)
+                {
+                    *object = load_object(desc);
+                }
+                
+                prase_cosem_entry_high(desc, (communal + cnt), right, oid);
+                return;
+            }
+        }
+    }
+    
+    //ļδУ
+    if(fverify.state == LEX_VERIFYING)
+    {
+        lex_pending(desc, right, object);
+        return;
+    }
+    
+    if(fverify.state != LEX_READY)
+    {
+        if(object)
+        {
+            *object = load_object(desc);
+        }
+        
+        return;
+    }
+    
+    //ѽ
+    if(lookup_table(desc, right, oid, mid, object))
+    {
+        return;
+    }
+    
+    if(object)
+    {
+        *object = load_object(desc);
+    }
+	
+	//һ
+	for(cnt=0; cnt<MAX_LEX_CACHE_SIZE; cnt++)
+	{
+		if(desc->request != fcache[cnt].request)
+		{
+			continue;
+		}
+		if(desc->level != fcache[cnt].level)
+		{
+			continue;
+		}
+		if(!(desc->suit & fcache[cnt].suit))
+		{
+			continue;
+		}
+		if(desc->descriptor.classid != fcache[cnt].descriptor.classid)
+		{
+			continue;
+		}
+		if(desc->descriptor.index != fcache[cnt].descriptor.index)
+		{
+			continue;
+		}
+		if(memcmp(desc->descriptor.obis, fcache[cnt].descriptor.obis, 6))
+		{
+			continue;
+		}
+		
+		right->attr = fcache[cnt].right.attr;
+		*oid = fcache[cnt].oid;
+		*mid = fcache[cnt].mid;
+		if(fcache[cnt].hit < 255)
+		{
+			fcache[cnt].hit += 1;
+		}
+		
+		return;
+	}
+    
+    //ɱȶԼֵ
+    key = make_key(&desc->descriptor);
+    
+    //ϢͷǷȷ
+    if(!load_header())
+    {
+        return;
+    }
+	
+	if(!fheader.amount)
+	{
+		return;
+	}
+    
+    //ʼַ
+    
+    //м俪ʼ
+    position = fheader.amount / 2;
+    step = position;
+    
+    for(cnt=0; cnt<(fastlog2(fheader.amount) + 2); cnt++)
+    {
+        cpu.watchdog.feed();
+        
+        //ȡ
+        if(file.parameter.read("lexicon", \
+                     STRUCT_OFFSET(struct __cosem_param, entry[position]), \
+                     sizeof(entry), \
+                     &entry) != sizeof(entry))
+        {
+            break;
+        }
+        
+        step = step / 2;
+        
+        //ֵȶ
+        if(key < (entry.key & 0xffffffffffffff00))
+        {
+			if(step == 0)
+			{
+				step = 1;
+			}
+			
+            if(position > step)
+            {
+                position -= step;
+            }
+            else
+            {
+                position = 0;
+            }
+            
+            continue;
+        }
+        else if(key > (entry.key & 0xffffffffffffff00))
+        {
+			if(step == 0)
+			{
+				step = 1;
+			}
+			
+            if((position + step) < fheader.amount)
+            {
+                position += step;
+            }
+            else
+            {
+                position = fheader.amount - 1;
+            }
+            
+            continue;
+        }
+        
+        //ֵƥ
+        if(desc->descriptor.classid <= 8)
+        {
+            //У
+            if(crc32(&entry.low.entry, sizeof(entry.low.entry), 0) != entry.low.check)
+            {
+                //Уʧ
+                break;
+            }
+            
+            prase_cosem_entry_low(desc, &entry.low.entry, right, oid, mid);
+            break;
+        }
+        else
+        {
+            //У
+            if(crc32(&entry.high.entry, sizeof(entry.high.entry), 0) != entry.high.check)
+            {
+                //Уʧ
+                break;
+            }
+            
+            prase_cosem_entry_high(desc, &entry.high.entry, right, oid);
+            break;
+        }
+    }
+    
+    return;
+}
+
+/**
+  * @brief  дʱͨʻ
+  */
+void dlms_lex_parse(const struct __cosem_request_desc *desc,
+                    union __dlms_right *right,
+                    uint32_t *oid,
+                    uint32_t *mid,
+                    TypeObject *object)
+{
+    LEX_LOCK();
+    lex_parse(desc, right, oid, mid, object);
+    LEX_UNLOCK();
+}
+
+/**
+  * @brief  ȡϢ
+  * ȰֵٶԲļһңͬĶֻȡһ
+  * @param  desc 
+  * @param  amount Ŀ
+  * @param  right ķȨ
+  * @param  oid 
+  * @param  mid ڲݱʶ
+  * @retval None
+  */
+static void lex_parse_list(const struct __cosem_request_desc *desc,
+                           uint8_t amount,
+                           union __dlms_right *right,
+                           uint32_t *oid,
+                           uint32_t *mid,
+                           TypeObject *object)
+{
+    uint8_t *order;
+    uint8_t cnt;
+    uint8_t n;
+    uint8_t tmp;
+    uint16_t from = 0;
+    uint16_t loop;
+    uint64_t key;
+    bool header = false;
+    bool loaded = false;
+    const struct __cosem_request_desc *d;
+    union __cosem_entry_file entry;
+    
+    if((!desc) || (!right) || (!oid) || (!mid) || (!amount))
+    {
+        return;
+    }
+    
+    order = heap.dalloc(amount);
+    
+    //ڴ治ʱ
+    if(!order)
+    {
+        for(cnt=0; cnt<amount; cnt++)
+        {
+            lex_parse(&desc[cnt], &right[cnt], &oid[cnt], &mid[cnt], (object ? &object[cnt] : (TypeObject *)0));
+        }
+        
+        return;
+    }
+    
+    //ֵĿ
+    for(cnt=0; cnt<amount; cnt++)
+    {
+        right[cnt].attr = ATTR_NONE;
+        oid[cnt] = 0xffffffff;
+        mid[cnt] = 0;
+        
+        order[cnt] = cnt;
+        
+        for(n=cnt; n>0; n--)
+        {
+            if(make_key(&desc[order[n - 1]].descriptor) <= make_key(&desc[order[n]].descriptor))
+            {
+                break;
+            }
+            
+            tmp = order[n - 1];
+            order[n - 1] = order[n];
+            order[n] = tmp;
+        }
+    }
+    
+    header = load_header();
+    
+    //
+    for(cnt=0; cnt<amount; cnt++)
+    {
+        n = order[cnt];
+        d = &desc[n];
+        key = make_key(&d->descriptor);
+        
+        if(object)
+        {
+            object[n] = load_object(d);
+        }
+        
+        //ұ
+        if(d->descriptor.classid > 8)
+        {
+            for(loop=0; loop<(sizeof(communal)/sizeof(struct __cosem_entry_high)); loop++)
+            {
+                if(key == ((communal + loop)->key & 0xffffffffffffff00))
+                {
+                    break;
+                }
+            }
+            
+            if(loop < (sizeof(communal)/sizeof(struct __cosem_entry_high)))
+            {
+                prase_cosem_entry_high(d, (communal + loop), &right[n], &oid[n]);
+                continue;
+            }
+        }
+        
+        //ļδУ
+        if(fverify.state == LEX_VERIFYING)
+        {
+            lex_pending(d, &right[n], (object ? &object[n] : (TypeObject *)0));
+            continue;
+        }
+        
+        if(fverify.state != LEX_READY)
+        {
+            continue;
+        }
+        
+        //ѽ
+        if(lookup_table(d, &right[n], &oid[n], &mid[n], (object ? &object[n] : (TypeObject *)0)))
+        {
+            continue;
+        }
+        
+        if(!header)
+        {
+            continue;
+        }
+        
+        //һĿΪͬһʱظȡ
+        if(!loaded || (key != (entry.key & 0xffffffffffffff00)))
+        {
+            loaded = search_entry(key, &from, &entry);
+            
+            if(!loaded)
+            {
+                continue;
+            }
+        }
+        
+        if(d->descriptor.classid <= 8)
+        {
+            if(crc32(&entry.low.entry, sizeof(entry.low.entry), 0) == entry.low.check)
+            {
+                prase_cosem_entry_low(d, &entry.low.entry, &right[n], &oid[n], &mid[n]);
+            }
+        }
+        else
+        {
+            if(crc32(&entry.high.entry, sizeof(entry.high.entry), 0) == entry.high.check)
+            {
+                prase_cosem_entry_high(d, &entry.high.entry, &right[n], &oid[n]);
+            }
+        }
+    }
+    
+    heap.free(order);
+}
+
+/**
+  * @brief  дʱͨʻ
+  */
+void dlms_lex_parse_list(const struct __cosem_request_desc *desc,
+                         uint8_t amount,
+                         union __dlms_right *right,
+                         uint32_t *oid,
+                         uint32_t *mid,
+                         TypeObject *object)
+{
+    LEX_LOCK();
+    lex_parse_list(desc, amount, right, oid, mid, object);
+    LEX_UNLOCK();
+}
+
+/**
+  * @brief  ȡָsuitϢ
+  */
+static uint16_t lex_amount(uint8_t suit)
+{
+    uint16_t cnt;
+    uint16_t amount = 0;
+	
+	if(!suit)
+	{
+		return(0);
 	}
     
     //ұ
@@ -844,9 +1700,10 @@ uint16_t dlms_lex_amount(uint8_t suit)
         return(amount);
     }
 	
+	//ڲļ֮ǰһ
 	if(suit == 0xff)
 	{
-		amount = fheader.amount;
+		amount += fheader.amount;
 	}
 	else
 	{
@@ -854,7 +1711,7 @@ uint16_t dlms_lex_amount(uint8_t suit)
 		{
 			if((suit >> cnt) & 0x01)
 			{
-				amount = fheader.spread[cnt];
+				amount += fheader.spread[cnt];
 				break;
 			}
 		}
@@ -863,10 +1720,59 @@ uint16_t dlms_lex_amount(uint8_t suit)
 	return(amount);
 }
 
+/**
+  * @brief  ȡָsuitϢ
+  */
+uint16_t dlms_lex_amount(uint8_t suit)
+{
+    uint16_t result;
+    
+    LEX_LOCK();
+    result = lex_amount(suit);
+    LEX_UNLOCK();
+    
+    return(result);
+}
+
+/**
+  * @brief  keyȨޱתΪ
+  */
+static uint16_t fill_object(uint64_t key, const uint8_t (*right)[3], struct __cosem_object *entry)
+{
+    //ȡԺͷ
+    get_class_map(((key >> 56) & 0xff), &entry->amount_of_attr, &entry->amount_of_method);
+    
+    if(!(entry->amount_of_attr) && !(entry->amount_of_method))
+    {
+        return(0);
+    }
+    
+    //
+    entry->classid = ((key >> 56) & 0xff);
+    entry->obis[0] = ((key >> 48) & 0xff);
+    entry->obis[1] = ((key >> 40) & 0xff);
+    entry->obis[2] = ((key >> 32) & 0xff);
+    entry->obis[3] = ((key >> 24) & 0xff);
+    entry->obis[4] = ((key >> 16) & 0xff);
+    entry->obis[5] = ((key >> 8) & 0xff);
+    entry->suit = ((key >> 0) & 0xff);
+    
+    heap.copy(&entry->right_attr[0][0], \
+              &right[0][0], \
+              sizeof(right[0])*entry->amount_of_attr);
+    
+    heap.copy(&entry->right_method[0][0], \
+              &right[entry->amount_of_attr][0], \
+              sizeof(right[0])*entry->amount_of_method);
+    
+    return(1);
+}
+
 /**
   * @brief  ȡָĿϢ
+  *  0 Ϊ֮Ϊļе lex_amount ļһ
   */
-uint16_t dlms_lex_entry(uint16_t index, struct __cosem_object *entry)
+static uint16_t lex_entry(uint16_t index, struct __cosem_object *entry)
 {
     union __cosem_entry_file fil;
     
@@ -877,6 +1783,19 @@ uint16_t dlms_lex_entry(uint16_t index, struct __cosem_object *entry)
     
     heap.set(entry, 0, sizeof(struct __cosem_object));
     
+    //
+    if(index < (sizeof(communal)/sizeof(struct __cosem_entry_high)))
+    {
+        if(!fill_object((communal + index)->key, (communal + index)->right, entry))
+        {
+            return(0);
+        }
+        
+        return(sizeof(struct __cosem_entry_high));
+    }
+    
+    index -= (sizeof(communal)/sizeof(struct __cosem_entry_high));
+    
     if((sizeof(fil) * index) >= sizeof((struct __cosem_param *)0)->entry)
     {
         return(0);
@@ -900,31 +1819,10 @@ uint16_t dlms_lex_entry(uint16_t index, struct __cosem_object *entry)
             return(0);
         }
         
-        //ȡԺͷ
-        get_class_map(((fil.low.entry.key >> 56) & 0xff), &entry->amount_of_attr, &entry->amount_of_method);
-        
-        if(!(entry->amount_of_attr) && !(entry->amount_of_method))
+        if(!fill_object(fil.low.entry.key, fil.low.entry.right, entry))
         {
             return(0);
         }
-        
-        //
-        entry->classid = ((fil.low.entry.key >> 56) & 0xff);
-        entry->obis[0] = ((fil.low.entry.key >> 48) & 0xff);
-        entry->obis[1] = ((fil.low.entry.key >> 40) & 0xff);
-        entry->obis[2] = ((fil.low.entry.key >> 32) & 0xff);
-        entry->obis[3] = ((fil.low.entry.key >> 24) & 0xff);
-        entry->obis[4] = ((fil.low.entry.key >> 16) & 0xff);
-        entry->obis[5] = ((fil.low.entry.key >> 8) & 0xff);
-        entry->suit = ((fil.low.entry.key >> 0) & 0xff);
-        
-        heap.copy(&entry->right_attr[0][0], \
-                  &fil.low.entry.right[0][0], \
-                  sizeof(fil.low.entry.right[0])*entry->amount_of_attr);
-        
-        heap.copy(&entry->right_method[0][0], \
-                  &fil.low.entry.right[entry->amount_of_attr][0], \
-                  sizeof(fil.low.entry.right[0])*entry->amount_of_method);
     }
     else
     {
@@ -934,36 +1832,29 @@ uint16_t dlms_lex_entry(uint16_t index, struct __cosem_object *entry)
             return(0);
         }
         
-        //ȡԺͷ
-        get_class_map(((fil.high.entry.key >> 56) & 0xff), &entry->amount_of_attr, &entry->amount_of_method);
-        
-        if(!(entry->amount_of_attr) && !(entry->amount_of_method))
+        if(!fill_object(fil.high.entry.key, fil.high.entry.right, entry))
         {
             return(0);
         }
-        
-        //
-        entry->classid = ((fil.high.entry.key >> 56) & 0xff);
-        entry->obis[0] = ((fil.high.entry.key >> 48) & 0xff);
-        entry->obis[1] = ((fil.high.entry.key >> 40) & 0xff);
-        entry->obis[2] = ((fil.high.entry.key >> 32) & 0xff);
-        entry->obis[3] = ((fil.high.entry.key >> 24) & 0xff);
-        entry->obis[4] = ((fil.high.entry.key >> 16) & 0xff);
-        entry->obis[5] = ((fil.high.entry.key >> 8) & 0xff);
-        entry->suit = ((fil.high.entry.key >> 0) & 0xff);
-        
-        heap.copy(&entry->right_attr[0][0], \
-                  &fil.high.entry.right[0][0], \
-                  sizeof(fil.high.entry.right[0])*entry->amount_of_attr);
-        
-        heap.copy(&entry->right_method[0][0], \
-                  &fil.high.entry.right[entry->amount_of_attr][0], \
-                  sizeof(fil.high.entry.right[0])*entry->amount_of_method);
     }
     
     return(sizeof(fil));
 }
 
+/**
+  * @brief  ȡָĿϢ
+  */
+uint16_t dlms_lex_entry(uint16_t index, struct __cosem_object *entry)
+{
+    uint16_t result;
+    
+    LEX_LOCK();
+    result = lex_entry(index, entry);
+    LEX_UNLOCK();
+    
+    return(result);
+}
+
 /**
   * @brief  ȡĿϢļİ汾
   */
@@ -1030,138 +1921,206 @@ uint8_t dlms_lex_signature(uint8_t *signature)
 }
 
 /**
-  * @brief  ֤ĿϢļǷЧ
+  * @brief  ƽļУ
+  * ϴελ˳ȡÿȡ DLMS_LEX_VERIFY_CHUNK У budget 
+  * УڼظʱʧܣУͨʹòļ
+  * @param  budget У
+  * @retval true Уѽͨʧܣfalse ĿУ
   */
-bool dlms_lex_check(void)
+static bool lex_verify(uint16_t budget)
 {
+    union __cosem_entry_file single;
+    union __cosem_entry_file *chunk;
+    uint16_t capacity = DLMS_LEX_VERIFY_CHUNK;
+    uint16_t amount;
     uint16_t cnt;
-    uint64_t accumulate = 0;
-    struct __cosem_param_info info;
-    union __cosem_entry_file entry;
-    mbedtls_md5_context ctx;
-    uint8_t md5_output[16] = {0};
-    
-    //ȡļеϢͷǷȷ
-    if(file.parameter.read("lexicon", STRUCT_OFFSET(struct __cosem_param, header), sizeof(struct __cosem_param_header), &fheader) != \
-        sizeof(struct __cosem_param_header))
-    {
-        return(false);
-    }
-    
-    if(crc32(&fheader, (sizeof(struct __cosem_param_header) - sizeof(uint32_t)), 0) != \
-            fheader.check)
-    {
-        return(false);
-    }
-    
-	for(cnt=0; cnt<8; cnt++)
-	{
-		if(fheader.spread[cnt] > fheader.amount)
-		{
-			return(false);
-		}
-	}
     
-    //ȡļеϢǷȷ
-    if(file.parameter.read("lexicon", STRUCT_OFFSET(struct __cosem_param, info), sizeof(struct __cosem_param_info), &info) != \
-        sizeof(struct __cosem_param_info))
+    if(fverify.state != LEX_VERIFYING)
     {
-        return(false);
+        return(true);
     }
     
-    if(crc32(&info, (sizeof(struct __cosem_param_info) - sizeof(uint32_t)), 0) != \
-            info.check)
+    //ڴ治ʱȡ
+    chunk = heap.dalloc(sizeof(union __cosem_entry_file) * DLMS_LEX_VERIFY_CHUNK);
+    if(!chunk)
     {
-        return(false);
+        chunk = &single;
+        capacity = 1;
     }
     
-    mbedtls_md5_init(&ctx);
-    if(mbedtls_md5_starts_ret(&ctx) != 0 )
+    while(budget && (fverify.cursor < fheader.amount))
     {
-        goto exit;
-    }
-    
-	for(cnt=0; cnt<fheader.amount; cnt++)
-	{
         cpu.watchdog.feed();
         
-        //ȡ
-        if(file.parameter.read("lexicon", \
-                     STRUCT_OFFSET(struct __cosem_param, entry[cnt]), \
-                     sizeof(entry), \
-                     &entry) != sizeof(entry))
+        amount = fheader.amount - fverify.cursor;
+        
+        if(amount > capacity)
         {
-            goto exit;
+            amount = capacity;
         }
         
-        if(mbedtls_md5_update_ret(&ctx, (const unsigned char *)&entry, sizeof(entry) ) != 0)
+        if(amount > budget)
         {
-            goto exit;
+            amount = budget;
         }
         
-        if((entry.key & 0xffffffffffffff00) < accumulate)
+        if(file.parameter.read("lexicon", \
+                     STRUCT_OFFSET(struct __cosem_param, entry[fverify.cursor]), \
+                     sizeof(union __cosem_entry_file) * amount, \
+                     chunk) != (sizeof(union __cosem_entry_file) * amount))
         {
-            goto exit;
+            break;
         }
         
-        accumulate = (entry.key & 0xffffffffffffff00);
-        
-        if(((entry.key >> 56) & 0xff) <= 8)
+        for(cnt=0; cnt<amount; cnt++)
         {
-            //У
-            if(crc32(&entry.low.entry, sizeof(entry.low.entry), 0) != entry.low.check)
+            if(!verify_entry(&chunk[cnt]))
             {
-                goto exit;
+                break;
             }
+            
+            resolve_entry(&chunk[cnt]);
         }
-        else
+        
+        if(cnt < amount)
         {
-            //У
-            if(crc32(&entry.high.entry, sizeof(entry.high.entry), 0) != entry.high.check)
-            {
-                goto exit;
-            }
+            break;
         }
-	}
-
-    if(mbedtls_md5_finish_ret(&ctx, md5_output) != 0)
+        
+        fverify.cursor += amount;
+        budget -= amount;
+    }
+    
+    if(chunk != &single)
+    {
+        heap.free(chunk);
+    }
+    
+    //ȡʧܻĿУʧ
+    if(budget && (fverify.cursor < fheader.amount))
     {
-        goto exit;
+        verify_abort();
+        return(true);
     }
     
-    if(memcmp(md5_output, info.md5, 16) != 0)
+    if(fverify.cursor < fheader.amount)
     {
-        goto exit;
+        return(false);
     }
     
+    verify_finish();
     
-    mbedtls_md5_free(&ctx);
     return(true);
+}
+
+/**
+  * @brief  ƽļУ飬
+  */
+bool dlms_lex_verify(uint16_t budget)
+{
+    bool result;
+    
+    LEX_LOCK();
+    result = lex_verify(budget);
+    LEX_UNLOCK();
+    
+    return(result);
+}
+
+/**
+  * @brief  ֤ĿϢļǷЧ
+  * δУ飬زļǷͨУ
+  */
+bool dlms_lex_check(void)
+{
+    while(!dlms_lex_verify(DLMS_LEX_VERIFY_BUDGET));
     
-exit:
-    mbedtls_md5_free(&ctx);
-    return( false );
+    return(fverify.state == LEX_READY);
 }
 
 /**
   * @brief  ʼ
+  * ֻȡϢͷļϢУ dlms_lex_verify ֽ
+  * ļϴУͨʱһʱѽУ
   */
 void dlms_lex_init(void)
 {
+    struct
+    {
+        struct __cosem_param_header header;
+        struct __cosem_param_info info;
+    } head;
+    uint8_t cnt;
+	
 	heap.set(fcache, 0, sizeof(fcache));
 	
-    if(file.parameter.read("lexicon", STRUCT_OFFSET(struct __cosem_param, header), sizeof(struct __cosem_param_header), &fheader) != \
-        sizeof(struct __cosem_param_header))
+	if(fverify.state == LEX_VERIFYING)
+	{
+		mbedtls_md5_free(&fverify.ctx);
+	}
+	
+	fverify.state = LEX_ABSENT;
+    
+    //ϢͷļϢڣһζȡ
+    if(file.parameter.read("lexicon", STRUCT_OFFSET(struct __cosem_param, header), sizeof(head), &head) != \
+        sizeof(head))
     {
 		heap.set(&fheader, 0, sizeof(fheader));
+		verify_abort();
         return;
     }
-    if(crc32(&fheader, (sizeof(struct __cosem_param_header) - sizeof(uint32_t)), 0) != \
-            fheader.check)
+    if(crc32(&head.header, (sizeof(struct __cosem_param_header) - sizeof(uint32_t)), 0) != \
+            head.header.check)
     {
 		heap.set(&fheader, 0, sizeof(fheader));
+		verify_abort();
+        return;
+    }
+	
+	heap.copy(&fheader, &head.header, sizeof(fheader));
+	
+	for(cnt=0; cnt<8; cnt++)
+	{
+		if(fheader.spread[cnt] > fheader.amount)
+		{
+			verify_abort();
+			return;
+		}
+	}
+    
+    if(crc32(&head.info, (sizeof(struct __cosem_param_info) - sizeof(uint32_t)), 0) != \
+            head.info.check)
+    {
+		verify_abort();
+        return;
+    }
+	
+	heap.copy(&finfo, &head.info, sizeof(finfo));
+	
+	//ļδ£ѽȻЧ
+	if((fstamp.header == fheader.check) && (fstamp.info == finfo.check))
+	{
+		fverify.state = LEX_READY;
+		return;
+	}
+	
+	ftable_amount = 0;
+	ftable_complete = false;
+	heap.set(&fstamp, 0, sizeof(fstamp));
+	
+	fverify.cursor = 0;
+	fverify.used = 0;
+	fverify.overflow = false;
+	fverify.accumulate = 0;
+    
+    mbedtls_md5_init(&fverify.ctx);
+    if(mbedtls_md5_starts_ret(&fverify.ctx) != 0)
+    {
+        mbedtls_md5_free(&fverify.ctx);
         return;
     }
+	
+	fverify.state = LEX_VERIFYING;
 }
 
 #pragma pack(pop)
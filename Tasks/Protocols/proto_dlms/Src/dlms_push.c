@@ -0,0 +1,1108 @@
+/**
+ * @brief		ϱ
+ * @details		Push setupclass 40Ĳɼ뷢ͣĿǰֻ֧־ HDLC UI ֡
+ * @date		2026-10-19
+ **/
+
+/* Includes ------------------------------------------------------------------*/
+#include <time.h>
+#include "system.h"
+#include "rtc.h"
+#include "axdr.h"
+#include "types_timed.h"
+#include "types_logger.h"
+#include "mbedtls/gcm.h"
+#include "dlms_types.h"
+#include "dlms_push.h"
+#include "dlms_application.h"
+#include "dlms_association.h"
+#include "dlms_utilities.h"
+#include "hdlc_datalink.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DLMS_PUSH_AMOUNT                ((uint8_t)4) //ʵΪ 0-0:25.9.E.255E Ϊ
+#define DLMS_PUSH_OBJECTS_MAX           ((uint8_t)12) //push_object_list 
+#define DLMS_PUSH_DESTINATION_MAX       ((uint8_t)16) //destination 󳤶
+#define DLMS_PUSH_WINDOWS_MAX           ((uint8_t)2) //communication_window 󴰿
+
+#if !defined(DLMS_PUSH_BATCH_MAX)
+#define DLMS_PUSH_BATCH_MAX             ((uint8_t)8) //һϲĲɼ
+#endif
+
+#if !defined(DLMS_PUSH_BUFFER_SIZE)
+#define DLMS_PUSH_BUFFER_SIZE           ((uint16_t)384) //ÿõĲɼ棬С APDU ȼȥͷͼܿ
+#endif
+
+#define DLMS_PUSH_OVERHEAD              ((uint16_t)64) //DataNotification ͷܿ
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief push_object_list еһ
+  */
+struct __push_object
+{
+    uint16_t classid;
+    uint8_t obis[6];
+    int8_t index; //
+    uint16_t data; //data_indexĿǰֻ֧
+};
+
+/**
+  * @brief communication_window еһ
+  */
+struct __push_window
+{
+    uint8_t start[12];
+    uint8_t end[12];
+};
+
+/**
+  * @brief ãڲļ
+  */
+struct __push_setup
+{
+    uint8_t amount; //
+    struct __push_object object[DLMS_PUSH_OBJECTS_MAX];
+    uint8_t transport; //enum __push_transport
+    uint8_t message; //enum __push_message
+    uint8_t length; //destination 
+    uint8_t destination[DLMS_PUSH_DESTINATION_MAX]; //HDLC Ϊ1ֽڿͻ˵ַΪʱӵĿͻ
+    uint8_t windows; //Ϊ0ʱ
+    struct __push_window window[DLMS_PUSH_WINDOWS_MAX];
+    uint16_t randomisation; //randomisation_start_interval룩
+    uint8_t retries; //number_of_retries
+    uint16_t delay; //repetition_delay룩
+};
+
+/**
+  * @brief ״̬
+  */
+enum __push_state
+{
+    PUSH_IDLE = 0,
+    PUSH_DELAY, //ʱڵȴԼ
+    PUSH_SENDING, //ύ·㣬ȴͻȡ
+};
+
+/**
+  * @brief ״̬
+  */
+struct __push_runtime
+{
+    uint8_t triggered; //Ĵ
+    uint8_t state; //enum __push_state
+    uint8_t retries; //ʣԴ
+    uint8_t channels; //ڷ͵ͨλͼ
+    uint32_t timer; //ʱ룩
+    uint8_t captured; //ѻĲɼ
+    uint16_t filled; //ѻݳ
+    uint8_t buffer[DLMS_PUSH_BUFFER_SIZE]; //ɼ棬ÿβɼΪһ structure
+};
+
+/**
+  * @brief ʹ
+  */
+struct __push_trigger
+{
+    uint32_t period; //ϵͳʱӶڣ룩0 
+    enum __event_id event; //¼ʼʱEVI_ALL 
+};
+
+/* Private variables ---------------------------------------------------------*/
+/**
+  * @brief õĴpush ǿԴ
+  */
+static const struct __push_trigger push_trigger_list[DLMS_PUSH_AMOUNT] =
+{
+    {900,   EVI_ALL}, //0-0:25.9.0.255 ÿ
+    {0,     EVI_POWERUP}, //0-0:25.9.1.255 ϵ
+    {0,     EVI_POWERDOWN}, //0-0:25.9.2.255 
+    {0,     EVI_ALL}, //0-0:25.9.3.255 ֻ push 
+};
+
+static const struct __axdr_member push_object_members[] =
+{
+    AXDR_MEMBER(struct __push_object, classid, AXDR_LONG_UNSIGNED, 0),
+    AXDR_MEMBER(struct __push_object, obis, AXDR_OCTET_STRING, 6),
+    AXDR_MEMBER(struct __push_object, index, AXDR_INTEGER, 0),
+    AXDR_MEMBER(struct __push_object, data, AXDR_LONG_UNSIGNED, 0),
+};
+
+static const struct __axdr_schema push_object_schema = AXDR_SCHEMA(struct __push_object, push_object_members);
+
+static const struct __axdr_member push_window_members[] =
+{
+    AXDR_MEMBER(struct __push_window, start, AXDR_DATE_TIME, 0),
+    AXDR_MEMBER(struct __push_window, end, AXDR_DATE_TIME, 0),
+};
+
+static const struct __axdr_schema push_window_schema = AXDR_SCHEMA(struct __push_window, push_window_members);
+
+static struct __push_setup setups[DLMS_PUSH_AMOUNT];
+static struct __push_runtime runtime[DLMS_PUSH_AMOUNT];
+static uint32_t invocation = 0; //η͵ invocation counterӹó־ûļ
+static uint8_t armed = 0; //ѵǼǵĶʱλͼ
+static uint16_t elapsed = 0;
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void push_timed_0(void);
+static void push_timed_1(void);
+static void push_timed_2(void);
+static void push_timed_3(void);
+
+/**
+  * @brief õĶʱصʱԻص
+  */
+static void (* const push_timed_list[DLMS_PUSH_AMOUNT])(void) =
+{
+    push_timed_0,
+    push_timed_1,
+    push_timed_2,
+    push_timed_3,
+};
+
+/* Private functions ---------------------------------------------------------*/
+static void push_timed_0(void)
+{
+    dlms_push_trigger(0);
+}
+
+static void push_timed_1(void)
+{
+    dlms_push_trigger(1);
+}
+
+static void push_timed_2(void)
+{
+    dlms_push_trigger(2);
+}
+
+static void push_timed_3(void)
+{
+    dlms_push_trigger(3);
+}
+
+/**
+  * @brief ¼ʼʱӦ
+  */
+static void push_event(enum __event_id id, enum __event_status status, uint16_t mapping)
+{
+    uint8_t n;
+    
+    if(status != EVS_STARTED)
+    {
+        return;
+    }
+    
+    for(n=0; n<DLMS_PUSH_AMOUNT; n++)
+    {
+        if((push_trigger_list[n].event != EVI_ALL) && (push_trigger_list[n].event == id))
+        {
+            dlms_push_trigger(n);
+        }
+    }
+}
+
+/**
+  * @brief Ĭãϱ߼ӵĿͻ
+  */
+static void push_default(uint8_t index, struct __push_setup *setup)
+{
+    heap.set(setup, 0, sizeof(struct __push_setup));
+    
+    setup->amount = 1;
+    setup->object[0].classid = CLASS_PUSH_SETUP;
+    heap.copy(setup->object[0].obis, "\x00\x00\x19\x09\x00\xff", 6);
+    setup->object[0].obis[4] = index;
+    setup->object[0].index = 1;
+    setup->transport = PUSH_TRANSPORT_HDLC;
+    setup->message = PUSH_MESSAGE_AXDR;
+    setup->retries = 3;
+    setup->delay = 10;
+}
+
+/**
+  * @brief ǼǶʱ¼ģδʱ´
+  */
+static void push_arm(void)
+{
+    struct __timed *timed = api("task_timed");
+    struct __logger *logger = api("task_logger");
+    struct __timed_conf conf;
+    uint8_t n;
+    
+    for(n=0; n<DLMS_PUSH_AMOUNT; n++)
+    {
+        if(!timed || !push_trigger_list[n].period || (armed & (1 << n)))
+        {
+            continue;
+        }
+        
+        conf.callback = push_timed_list[n];
+        conf.period = push_trigger_list[n].period;
+        conf.flags = TIMD_FLAG_ABSOLUTE | TIMD_FLAG_PERIODIC;
+        timed->remove(&conf);
+        
+        if(timed->create(&conf) == TIMD_SUCCESS)
+        {
+            armed |= (1 << n);
+        }
+    }
+    
+    //¼³ʼʱռбظӲЧ
+    if(logger)
+    {
+        logger->monitor.add(push_event);
+    }
+}
+
+/**
+  * @brief 뱾ʱΪ date-time
+  */
+static void push_datetime(uint8_t *buffer)
+{
+    time_t stamp = (time_t)rtc.read();
+    struct tm *ptm = localtime(&stamp);
+    
+    heap.set(buffer, 0xff, 12);
+    
+    if(!ptm)
+    {
+        return;
+    }
+    
+    buffer[0] = (uint8_t)((ptm->tm_year + 1900) >> 8);
+    buffer[1] = (uint8_t)((ptm->tm_year + 1900) >> 0);
+    buffer[2] = ptm->tm_mon + 1;
+    buffer[3] = ptm->tm_mday;
+    buffer[4] = ptm->tm_wday? ptm->tm_wday : 7;
+    buffer[5] = ptm->tm_hour;
+    buffer[6] = ptm->tm_min;
+    buffer[7] = ptm->tm_sec;
+    buffer[8] = 0;
+    buffer[9] = 0x80;
+    buffer[10] = 0x00;
+    buffer[11] = 0x00;
+}
+
+/**
+  * @brief date-time תΪɱȽϵֵֶͨȡǰʱ
+  */
+static uint64_t push_datetime_key(const uint8_t *dt, const uint8_t *now)
+{
+    uint64_t key;
+    uint16_t year = ((uint16_t)dt[0] << 8) + dt[1];
+    
+    key = (year == 0xffff)? (((uint16_t)now[0] << 8) + now[1]) : year;
+    key = (key << 8) + ((dt[2] >= 0xfd)? now[2] : dt[2]);
+    key = (key << 8) + ((dt[3] >= 0xfd)? now[3] : dt[3]);
+    key = (key << 8) + ((dt[5] == 0xff)? now[5] : dt[5]);
+    key = (key << 8) + ((dt[6] == 0xff)? now[6] : dt[6]);
+    key = (key << 8) + ((dt[7] == 0xff)? now[7] : dt[7]);
+    
+    return(key);
+}
+
+/**
+  * @brief ǰǷڷʹڣʼʱڽʱʱΪԽͨ
+  */
+static bool push_window_open(const struct __push_setup *setup)
+{
+    uint8_t now[12];
+    uint64_t current, start, end;
+    uint8_t n;
+    
+    if(!setup->windows)
+    {
+        return(true);
+    }
+    
+    push_datetime(now);
+    current = push_datetime_key(now, now);
+    
+    for(n=0; n<setup->windows; n++)
+    {
+        start = push_datetime_key(setup->window[n].start, now);
+        end = push_datetime_key(setup->window[n].end, now);
+        
+        if(start <= end)
+        {
+            if((current >= start) && (current <= end))
+            {
+                return(true);
+            }
+        }
+        else if((current >= start) || (current <= end))
+        {
+            return(true);
+        }
+    }
+    
+    return(false);
+}
+
+/**
+  * @brief ɼһζбΪһ structure ׷ӵ
+  * ʱβɼ
+  */
+static void push_capture(uint8_t index)
+{
+    const struct __push_setup *setup = &setups[index];
+    struct __push_runtime *rt = &runtime[index];
+    struct __cosem_descriptor descriptor;
+    uint8_t *record;
+    uint16_t length;
+    uint8_t n;
+    
+    if(rt->captured >= DLMS_PUSH_BATCH_MAX)
+    {
+        return;
+    }
+    
+    record = heap.dalloc(DLMS_PUSH_BUFFER_SIZE);
+    if(!record)
+    {
+        return;
+    }
+    
+    record[0] = AXDR_STRUCTURE;
+    length = 1 + axdr.length.encode(setup->amount, &record[1]);
+    
+    for(n=0; n<setup->amount; n++)
+    {
+        MAKE_COSEM_DESC(&descriptor, \
+                        setup->object[n].classid, \
+                        setup->object[n].obis, \
+                        (uint8_t)setup->object[n].index, \
+                        0);
+        
+        length += dlms_appl_capture(&descriptor, &record[length], (DLMS_PUSH_BUFFER_SIZE - length));
+        
+        if(length >= DLMS_PUSH_BUFFER_SIZE)
+        {
+            heap.free(record);
+            return;
+        }
+    }
+    
+    if((rt->filled + length) <= DLMS_PUSH_BUFFER_SIZE)
+    {
+        heap.copy(&rt->buffer[rt->filled], record, length);
+        rt->filled += length;
+        rt->captured += 1;
+    }
+    
+    heap.free(record);
+}
+
+/**
+  * @brief  DataNotificationβɼϲΪ array
+  */
+static uint16_t push_notification(const struct __push_runtime *rt, uint8_t *buffer, uint16_t size)
+{
+    uint16_t length = 0;
+    
+    if(size < (DLMS_PUSH_OVERHEAD + rt->filled))
+    {
+        return(0);
+    }
+    
+    buffer[length++] = DATA_NOTIFICATION;
+    
+    //long-invoke-id-and-priority
+    buffer[length++] = (uint8_t)((invocation >> 24) & 0x0f);
+    buffer[length++] = (uint8_t)(invocation >> 16);
+    buffer[length++] = (uint8_t)(invocation >> 8);
+    buffer[length++] = (uint8_t)(invocation >> 0);
+    
+    //date-time
+    buffer[length++] = 12;
+    push_datetime(&buffer[length]);
+    length += 12;
+    
+    //notification-body
+    if(rt->captured > 1)
+    {
+        buffer[length++] = AXDR_ARRAY;
+        length += axdr.length.encode(rt->captured, &buffer[length]);
+    }
+    
+    length += heap.copy(&buffer[length], rt->buffer, rt->filled);
+    
+    return(length);
+}
+
+/**
+  * @brief general-glo-cipheringʹõԿ֤Կsecurity control ̶Ϊ 0x30
+  */
+static uint16_t push_cipher(const uint8_t *plain, uint16_t length, uint8_t *buffer, uint16_t size)
+{
+    mbedtls_gcm_context ctx;
+    uint8_t ekey[2+32];
+    uint8_t akey[2+32];
+    uint8_t title[2+8];
+    uint8_t iv[12];
+    uint8_t tag[12];
+    uint8_t add[1+32];
+    uint16_t cipher = 0;
+    int ret;
+    
+    dlms_util_load_uekey(ekey);
+    dlms_util_load_akey(akey);
+    dlms_util_load_title(title);
+    
+    if((ekey[1] > 32) || (akey[1] > 32))
+    {
+        return(0);
+    }
+    
+    heap.copy(&iv[0], &title[2], 8);
+    iv[8] = (uint8_t)(invocation >> 24);
+    iv[9] = (uint8_t)(invocation >> 16);
+    iv[10] = (uint8_t)(invocation >> 8);
+    iv[11] = (uint8_t)(invocation >> 0);
+    
+    buffer[cipher++] = GNL_GLO_CIPHER_RESPONSE;
+    buffer[cipher++] = 8;
+    cipher += heap.copy(&buffer[cipher], &title[2], 8);
+    cipher += axdr.length.encode((5 + length + sizeof(tag)), &buffer[cipher]);
+    
+    if(size < (cipher + 5 + length + sizeof(tag)))
+    {
+        return(0);
+    }
+    
+    buffer[cipher++] = 0x30;
+    cipher += heap.copy(&buffer[cipher], &iv[8], 4);
+    
+    add[0] = 0x30;
+    heap.copy(&add[1], &akey[2], akey[1]);
+    
+    mbedtls_gcm_init(&ctx);
+    
+    ret = mbedtls_gcm_setkey(&ctx, MBEDTLS_CIPHER_ID_AES, &ekey[2], ekey[1]*8);
+    
+    if(ret == 0)
+    {
+        ret = mbedtls_gcm_crypt_and_tag(&ctx,
+                                        MBEDTLS_GCM_ENCRYPT,
+                                        length,
+                                        iv,
+                                        sizeof(iv),
+                                        add,
+                                        (1 + akey[1]),
+                                        plain,
+                                        &buffer[cipher],
+                                        sizeof(tag),
+                                        tag);
+    }
+    
+    mbedtls_gcm_free(&ctx);
+    
+    if(ret != 0)
+    {
+        return(0);
+    }
+    
+    cipher += length;
+    cipher += heap.copy(&buffer[cipher], tag, sizeof(tag));
+    
+    return(cipher);
+}
+
+/**
+  * @brief ѻĲɼύĿͨ
+  * һͨʱջ棬 false ʾҪ
+  */
+static bool push_send(uint8_t index)
+{
+    const struct __push_setup *setup = &setups[index];
+    struct __push_runtime *rt = &runtime[index];
+    uint8_t *plain;
+    uint8_t *apdu;
+    uint16_t length;
+    uint8_t address;
+    uint8_t channel;
+    
+    plain = heap.dalloc(dlms_asso_mtu());
+    if(!plain)
+    {
+        return(false);
+    }
+    
+    //ȡʱͣԺ
+    if(!dlms_util_next_fc(&invocation))
+    {
+        heap.free(plain);
+        return(false);
+    }
+    
+    length = push_notification(rt, plain, dlms_asso_mtu());
+    apdu = plain;
+    
+    if(length && (setup->message == PUSH_MESSAGE_AXDR_GLO))
+    {
+        apdu = heap.dalloc(dlms_asso_mtu());
+        
+        if(apdu)
+        {
+            length = push_cipher(plain, length, apdu, dlms_asso_mtu());
+        }
+        else
+        {
+            length = 0;
+        }
+    }
+    
+    rt->channels = 0;
+    
+    for(channel=0; length && (channel<hdlc_get_channel_amount()) && (channel<8); channel++)
+    {
+        address = hdlc_get_client_address(channel);
+        
+        if(!address)
+        {
+            continue;
+        }
+        
+        if(setup->length && (setup->destination[0] != address))
+        {
+            continue;
+        }
+        
+        if(hdlc_send_info(channel, apdu, length) == length)
+        {
+            rt->channels |= (1 << channel);
+        }
+    }
+    
+    if(apdu && (apdu != plain))
+    {
+        heap.free(apdu);
+    }
+    
+    heap.free(plain);
+    
+    if(!rt->channels)
+    {
+        return(false);
+    }
+    
+    rt->captured = 0;
+    rt->filled = 0;
+    
+    return(true);
+}
+
+/**
+  * @brief ʱ״̬ʱ 0 ~ randomisation_start_interval ֮
+  */
+static void push_schedule(uint8_t index)
+{
+    struct __push_runtime *rt = &runtime[index];
+    uint8_t random[2];
+    uint16_t val;
+    
+    rt->state = PUSH_DELAY;
+    rt->retries = setups[index].retries;
+    rt->timer = 0;
+    
+    if(setups[index].randomisation)
+    {
+        dlms_asso_random(sizeof(random), random);
+        val = ((uint16_t)random[0] << 8) + random[1];
+        rt->timer = (uint32_t)(val % ((uint32_t)setups[index].randomisation + 1)) * 1000;
+    }
+}
+
+/**
+  * @brief  push_object_list
+  */
+static bool push_parse_objects(struct __push_setup *setup, const uint8_t *buffer, uint16_t size)
+{
+    uint16_t amount;
+    uint16_t offset;
+    uint8_t n;
+    
+    if((size < 2) || (buffer[0] != AXDR_ARRAY))
+    {
+        return(false);
+    }
+    
+    offset = 1 + axdr.length.decode(&buffer[1], &amount);
+    
+    if(amount > DLMS_PUSH_OBJECTS_MAX)
+    {
+        return(false);
+    }
+    
+    for(n=0; n<amount; n++)
+    {
+        //structure{long-unsigned, octet-string(6), integer, long-unsigned}
+        if((offset + 18) > size)
+        {
+            return(false);
+        }
+        
+        if((buffer[offset + 0] != AXDR_STRUCTURE) || (buffer[offset + 1] != 4) || \
+            (buffer[offset + 2] != AXDR_LONG_UNSIGNED) || \
+            (buffer[offset + 5] != AXDR_OCTET_STRING) || (buffer[offset + 6] != 6) || \
+            (buffer[offset + 13] != AXDR_INTEGER) || \
+            (buffer[offset + 15] != AXDR_LONG_UNSIGNED))
+        {
+            return(false);
+        }
+        
+        setup->object[n].classid = ((uint16_t)buffer[offset + 3] << 8) + buffer[offset + 4];
+        heap.copy(setup->object[n].obis, &buffer[offset + 7], 6);
+        setup->object[n].index = (int8_t)buffer[offset + 14];
+        setup->object[n].data = ((uint16_t)buffer[offset + 16] << 8) + buffer[offset + 17];
+        
+        offset += 18;
+    }
+    
+    setup->amount = (uint8_t)amount;
+    
+    return(true);
+}
+
+/**
+  * @brief  send_destination_and_methodֻ HDLC
+  */
+static bool push_parse_destination(struct __push_setup *setup, const uint8_t *buffer, uint16_t size)
+{
+    uint16_t length;
+    uint16_t offset;
+    
+    if((size < 8) || (buffer[0] != AXDR_STRUCTURE) || (buffer[1] != 3) || \
+        (buffer[2] != AXDR_ENUM) || (buffer[4] != AXDR_OCTET_STRING))
+    {
+        return(false);
+    }
+    
+    offset = 5 + axdr.length.decode(&buffer[5], &length);
+    
+    if((length > DLMS_PUSH_DESTINATION_MAX) || ((offset + length + 2) > size) || \
+        (buffer[offset + length] != AXDR_ENUM))
+    {
+        return(false);
+    }
+    
+    if(buffer[3] != PUSH_TRANSPORT_HDLC)
+    {
+        return(false);
+    }
+    
+    if((buffer[offset + length + 1] != PUSH_MESSAGE_AXDR) && \
+        (buffer[offset + length + 1] != PUSH_MESSAGE_AXDR_GLO))
+    {
+        return(false);
+    }
+    
+    //HDLC ĿΪ1ֽڿͻ˵ַ
+    if(length > 1)
+    {
+        return(false);
+    }
+    
+    setup->transport = buffer[3];
+    setup->length = (uint8_t)length;
+    heap.copy(setup->destination, &buffer[offset], length);
+    setup->message = buffer[offset + length + 1];
+    
+    return(true);
+}
+
+/**
+  * @brief  communication_window
+  */
+static bool push_parse_window(struct __push_setup *setup, const uint8_t *buffer, uint16_t size)
+{
+    uint16_t amount;
+    uint16_t offset;
+    uint8_t n;
+    
+    if((size < 2) || (buffer[0] != AXDR_ARRAY))
+    {
+        return(false);
+    }
+    
+    offset = 1 + axdr.length.decode(&buffer[1], &amount);
+    
+    if(amount > DLMS_PUSH_WINDOWS_MAX)
+    {
+        return(false);
+    }
+    
+    for(n=0; n<amount; n++)
+    {
+        //structure{octet-string(12), octet-string(12)}
+        if((offset + 30) > size)
+        {
+            return(false);
+        }
+        
+        if((buffer[offset + 0] != AXDR_STRUCTURE) || (buffer[offset + 1] != 2) || \
+            (buffer[offset + 2] != AXDR_OCTET_STRING) || (buffer[offset + 3] != 12) || \
+            (buffer[offset + 16] != AXDR_OCTET_STRING) || (buffer[offset + 17] != 12))
+        {
+            return(false);
+        }
+        
+        heap.copy(setup->window[n].start, &buffer[offset + 4], 12);
+        heap.copy(setup->window[n].end, &buffer[offset + 18], 12);
+        
+        offset += 30;
+    }
+    
+    setup->windows = (uint8_t)amount;
+    
+    return(true);
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief ã״̬
+  */
+void dlms_push_init(void)
+{
+    uint8_t n;
+    
+    heap.set(runtime, 0, sizeof(runtime));
+    
+    for(n=0; n<DLMS_PUSH_AMOUNT; n++)
+    {
+        if(dlms_util_load_push(n, (uint8_t *)&setups[n], sizeof(struct __push_setup)) != sizeof(struct __push_setup))
+        {
+            push_default(n, &setups[n]);
+        }
+    }
+    
+    armed = 0;
+    elapsed = 0;
+}
+
+/**
+  * @brief עʱ¼
+  */
+void dlms_push_exit(void)
+{
+    struct __timed *timed = api("task_timed");
+    struct __logger *logger = api("task_logger");
+    struct __timed_conf conf;
+    uint8_t n;
+    
+    if(timed)
+    {
+        for(n=0; n<DLMS_PUSH_AMOUNT; n++)
+        {
+            conf.callback = push_timed_list[n];
+            timed->remove(&conf);
+        }
+    }
+    
+    if(logger)
+    {
+        logger->monitor.remove(push_event);
+    }
+    
+    heap.set(runtime, 0, sizeof(runtime));
+    armed = 0;
+}
+
+/**
+  * @brief ״̬Эڵ
+  */
+void dlms_push_tick(uint16_t tick)
+{
+    struct __push_runtime *rt;
+    uint8_t channel;
+    uint8_t n;
+    
+    if(system_status() != SYSTEM_RUN)
+    {
+        return;
+    }
+    
+    //Ǽʧܣ綨ʱδʱÿ
+    elapsed += tick;
+    if(elapsed >= 1000)
+    {
+        elapsed = 0;
+        push_arm();
+    }
+    
+    for(n=0; n<DLMS_PUSH_AMOUNT; n++)
+    {
+        rt = &runtime[n];
+        
+        if(rt->triggered)
+        {
+            rt->triggered = 0;
+            push_capture(n);
+            
+            if((rt->state == PUSH_IDLE) && rt->captured)
+            {
+                push_schedule(n);
+            }
+        }
+        
+        switch(rt->state)
+        {
+            case PUSH_DELAY:
+            {
+                if(rt->timer > tick)
+                {
+                    rt->timer -= tick;
+                    break;
+                }
+                
+                rt->timer = 0;
+                
+                if(!push_window_open(&setups[n]))
+                {
+                    break;
+                }
+                
+                if(push_send(n))
+                {
+                    rt->state = PUSH_SENDING;
+                }
+                else if(rt->retries)
+                {
+                    rt->retries -= 1;
+                    rt->timer = (uint32_t)setups[n].delay * 1000;
+                }
+                else
+                {
+                    rt->captured = 0;
+                    rt->filled = 0;
+                    rt->state = PUSH_IDLE;
+                }
+                
+                break;
+            }
+            case PUSH_SENDING:
+            {
+                for(channel=0; channel<8; channel++)
+                {
+                    if((rt->channels & (1 << channel)) && hdlc_send_result(channel))
+                    {
+                        rt->channels &= ~(1 << channel);
+                    }
+                }
+                
+                if(rt->channels)
+                {
+                    break;
+                }
+                
+                //ڼµĲɼϲһ
+                if(rt->captured)
+                {
+                    push_schedule(n);
+                }
+                else
+                {
+                    rt->state = PUSH_IDLE;
+                }
+                
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+}
+
+/**
+  * @brief ߼ȡţʱ 0xff
+  */
+uint8_t dlms_push_index(const uint8_t *obis)
+{
+    if(!obis)
+    {
+        return(0xff);
+    }
+    
+    if((obis[0] != 0) || (obis[1] != 0) || (obis[2] != 25) || (obis[3] != 9) || (obis[5] != 0xff))
+    {
+        return(0xff);
+    }
+    
+    if(obis[4] >= DLMS_PUSH_AMOUNT)
+    {
+        return(0xff);
+    }
+    
+    return(obis[4]);
+}
+
+/**
+  * @brief ȡõԣ2~7 A-XDR 
+  */
+uint16_t dlms_push_load(uint8_t index, uint8_t attr, uint8_t *buffer, uint16_t size)
+{
+    const struct __push_setup *setup;
+    uint16_t length = 0;
+    
+    if((index >= DLMS_PUSH_AMOUNT) || !buffer || (size < 32))
+    {
+        return(0);
+    }
+    
+    setup = &setups[index];
+    
+    switch(attr)
+    {
+        case 2:
+        {
+            length = axdr.schema.encode(&push_object_schema, setup->object, setup->amount, buffer, size);
+            break;
+        }
+        case 3:
+        {
+            buffer[length++] = AXDR_STRUCTURE;
+            buffer[length++] = 3;
+            length += axdr.encode(&setup->transport, sizeof(setup->transport), AXDR_ENUM, &buffer[length]);
+            length += axdr.encode(setup->destination, setup->length, AXDR_OCTET_STRING, &buffer[length]);
+            length += axdr.encode(&setup->message, sizeof(setup->message), AXDR_ENUM, &buffer[length]);
+            break;
+        }
+        case 4:
+        {
+            length = axdr.schema.encode(&push_window_schema, setup->window, setup->windows, buffer, size);
+            break;
+        }
+        case 5:
+        {
+            length = axdr.encode(&setup->randomisation, sizeof(setup->randomisation), AXDR_LONG_UNSIGNED, buffer);
+            break;
+        }
+        case 6:
+        {
+            length = axdr.encode(&setup->retries, sizeof(setup->retries), AXDR_UNSIGNED, buffer);
+            break;
+        }
+        case 7:
+        {
+            length = axdr.encode(&setup->delay, sizeof(setup->delay), AXDR_LONG_UNSIGNED, buffer);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+    
+    return(length);
+}
+
+/**
+  * @brief ޸õԣ2~7дļЧ
+  */
+bool dlms_push_write(uint8_t index, uint8_t attr, const uint8_t *buffer, uint16_t size)
+{
+    struct __push_setup setup;
+    bool result = false;
+    
+    if((index >= DLMS_PUSH_AMOUNT) || !buffer || !size)
+    {
+        return(false);
+    }
+    
+    heap.copy(&setup, &setups[index], sizeof(setup));
+    
+    switch(attr)
+    {
+        case 2:
+        {
+            result = push_parse_objects(&setup, buffer, size);
+            break;
+        }
+        case 3:
+        {
+            result = push_parse_destination(&setup, buffer, size);
+            break;
+        }
+        case 4:
+        {
+            result = push_parse_window(&setup, buffer, size);
+            break;
+        }
+        case 5:
+        {
+            if((size >= 3) && (buffer[0] == AXDR_LONG_UNSIGNED))
+            {
+                axdr.decode(buffer, 0, &setup.randomisation);
+                result = true;
+            }
+            break;
+        }
+        case 6:
+        {
+            if((size >= 2) && (buffer[0] == AXDR_UNSIGNED))
+            {
+                setup.retries = buffer[1];
+                result = true;
+            }
+            break;
+        }
+        case 7:
+        {
+            if((size >= 3) && (buffer[0] == AXDR_LONG_UNSIGNED))
+            {
+                axdr.decode(buffer, 0, &setup.delay);
+                result = true;
+            }
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+    
+    if(!result)
+    {
+        return(false);
+    }
+    
+    if(dlms_util_write_push(index, (const uint8_t *)&setup, sizeof(setup)) != sizeof(setup))
+    {
+        return(false);
+    }
+    
+    heap.copy(&setups[index], &setup, sizeof(setup));
+    
+    //бıѻĲɼ֮Ӧ
+    if(attr == 2)
+    {
+        runtime[index].captured = 0;
+        runtime[index].filled = 0;
+    }
+    
+    return(true);
+}
+
+/**
+  * @brief һͣЭвɼ
+  */
+bool dlms_push_trigger(uint8_t index)
+{
+    if(index >= DLMS_PUSH_AMOUNT)
+    {
+        return(false);
+    }
+    
+    if(runtime[index].triggered < 0xff)
+    {
+        runtime[index].triggered += 1;
+    }
+    
+    return(true);
+}
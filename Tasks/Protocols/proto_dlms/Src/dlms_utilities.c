@@ -7,10 +7,15 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "system.h"
+#include "dlms_types.h"
 #include "dlms_utilities.h"
 #include "crc.h"
 #include "info.h"
 
+#if defined ( DLMS_CONFIG_PARALLEL )
+#include <pthread.h>
+#endif
+
 /* Private typedef -----------------------------------------------------------*/
 /**	
   * @brief 
@@ -53,6 +58,24 @@ struct __dlms_asym_pub_key
 };
 
 
+/**	
+  * @brief ã dlms_push 
+  */
+struct __dlms_push_params
+{
+    uint8_t val[DLMS_UTIL_PUSH_SIZE];//
+    uint32_t check;
+};
+
+/**	
+  * @brief  invocation counter Ԥ
+  */
+struct __dlms_fc_params
+{
+    uint32_t limit;//ֻʹСڸֵĲ
+    uint32_t check;
+};
+
 /**	
   * @brief 
   */
@@ -71,11 +94,34 @@ struct __dlms_params
 	struct __dlms_asym_pub_key sspubkey; //Server Signing Public Key
 	struct __dlms_asym_pub_key capubkey; //Client Agreement Public Key
 	struct __dlms_asym_pub_key cspubkey; //Client Signing Public Key
+    struct __dlms_push_params push[DLMS_UTIL_PUSH_AMOUNT]; //Push setup
+    struct __dlms_fc_params fc; //Server invocation counter
 };
 
 /* Private define ------------------------------------------------------------*/
+#if !defined ( DLMS_UTIL_FC_WINDOW )
+#define DLMS_UTIL_FC_WINDOW         ((uint32_t)1024) //ÿԤļһڲдһβļ
+#endif
+
 /* Private macro -------------------------------------------------------------*/
+#if defined ( DLMS_CONFIG_PARALLEL )
+//ӺͿڲͬ߳ȡ
+#define FC_LOCK()                   pthread_mutex_lock(&fc_lock)
+#define FC_UNLOCK()                 pthread_mutex_unlock(&fc_lock)
+#else
+#define FC_LOCK()
+#define FC_UNLOCK()
+#endif
+
 /* Private variables ---------------------------------------------------------*/
+#if defined ( DLMS_CONFIG_PARALLEL )
+static pthread_mutex_t fc_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static uint32_t fc_next = 0; //һõļ
+static uint32_t fc_limit = 0; //Ԥ
+static bool fc_loaded = false;
+
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 /**	
@@ -987,3 +1033,152 @@ uint8_t dlms_util_write_cspubkey(uint8_t *buffer)
     
     return(key.length + 2);
 }
+
+/**	
+  * @brief ȡãУʧʱ 0
+  */
+uint16_t dlms_util_load_push(uint8_t index, uint8_t *buffer, uint16_t size)
+{
+    struct __dlms_push_params push;
+    
+    if((index >= DLMS_UTIL_PUSH_AMOUNT) || (size > DLMS_UTIL_PUSH_SIZE))
+    {
+        return(0);
+    }
+    
+    if(file.parameter.read("dlms", \
+                 STRUCT_OFFSET(struct __dlms_params, push[index]), \
+                 sizeof(push), \
+                 (void *)&push) != sizeof(push))
+    {
+        return(0);
+    }
+    
+    if(crc32(push.val, sizeof(push.val), 0) != push.check)
+    {
+        return(0);
+    }
+    
+    return(heap.copy(buffer, push.val, size));
+}
+
+/**	
+  * @brief 
+  */
+uint16_t dlms_util_write_push(uint8_t index, const uint8_t *buffer, uint16_t size)
+{
+    struct __dlms_push_params push;
+    
+    if((index >= DLMS_UTIL_PUSH_AMOUNT) || (size > DLMS_UTIL_PUSH_SIZE))
+    {
+        return(0);
+    }
+    
+    heap.set(&push, 0, sizeof(push));
+    heap.copy(push.val, buffer, size);
+    push.check = crc32(push.val, sizeof(push.val), 0);
+    
+    if(file.parameter.write("dlms", \
+                  STRUCT_OFFSET(struct __dlms_params, push[index]), \
+                  sizeof(push), \
+                  (void *)&push) != sizeof(push))
+    {
+        return(0);
+    }
+    
+    return(size);
+}
+
+/**	
+  * @brief ȡԤļ
+  * ļδʱ 0 ʼʱ޷ȷЩֵѾù false
+  */
+static bool fc_load(uint32_t *limit)
+{
+    struct __dlms_fc_params fc;
+    
+    if(file.parameter.read("dlms", \
+                 STRUCT_OFFSET(struct __dlms_params, fc), \
+                 sizeof(fc), \
+                 (void *)&fc) != sizeof(fc))
+    {
+        fc.limit = 0;
+        fc.check = 0;
+    }
+    
+    if(!fc.limit && !fc.check)
+    {
+        *limit = 0;
+        return(true);
+    }
+    
+    if(crc32(&fc.limit, sizeof(fc.limit), 0) != fc.check)
+    {
+        return(false);
+    }
+    
+    *limit = fc.limit;
+    
+    return(true);
+}
+
+/**	
+  * @brief ȡһ invocation counterͺӹ
+  * ʱӣʹǰȰԤڵдļ
+  * ѱ޼ʱδĲֱظ
+  * ޷Ԥþʱ false÷øԿ
+  */
+bool dlms_util_next_fc(uint32_t *fc)
+{
+    struct __dlms_fc_params param;
+    
+    if(!fc)
+    {
+        return(false);
+    }
+    
+    FC_LOCK();
+    
+    if(!fc_loaded)
+    {
+        if(!fc_load(&fc_next))
+        {
+            FC_UNLOCK();
+            TRACE(TRACE_ERR, "Invocation counter record damaged, ciphering disabled.");
+            return(false);
+        }
+        
+        fc_limit = fc_next;
+        fc_loaded = true;
+    }
+    
+    if(fc_next >= fc_limit)
+    {
+        if(fc_next > (0xffffffff - DLMS_UTIL_FC_WINDOW))
+        {
+            FC_UNLOCK();
+            return(false);
+        }
+        
+        param.limit = fc_next + DLMS_UTIL_FC_WINDOW;
+        param.check = crc32(&param.limit, sizeof(param.limit), 0);
+        
+        if(file.parameter.write("dlms", \
+                      STRUCT_OFFSET(struct __dlms_params, fc), \
+                      sizeof(param), \
+                      (void *)&param) != sizeof(param))
+        {
+            FC_UNLOCK();
+            return(false);
+        }
+        
+        fc_limit = param.limit;
+    }
+    
+    *fc = fc_next;
+    fc_next += 1;
+    
+    FC_UNLOCK();
+    
+    return(true);
+}
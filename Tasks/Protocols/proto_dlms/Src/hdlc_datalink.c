@@ -13,10 +13,16 @@
 #include "hdlc_datalink.h"
 #include "dlms_utilities.h"
 #include "dlms_association.h"
+#include "dlms_crypto.h"
 #include "types_comm.h"
 
 #include "types_protocol.h"
 
+#if defined ( DLMS_CONFIG_PARALLEL )
+#include "allocator_ctrl.h"
+#include <pthread.h>
+#endif
+
 /* Private define ------------------------------------------------------------*/
 //HDLCò
 
@@ -38,6 +44,15 @@
 #define HDLC_CONFIG_APPL_RELEASE(s)             dlms_asso_cleanup(s)
 //Ӧòĳ
 #define HDLC_CONFIG_APPL_MTU()                  dlms_asso_mtu()
+//ӦòǷ𣨵ȴǩ
+#define HDLC_CONFIG_APPL_DEFERRED()             dlms_crypto_deferred()
+
+//߳շ峤ȣСͨߵշ
+#define HDLC_CONFIG_FRAME_SIZE          		((uint16_t)(256))
+//֡г information ־ַ֡͡HCSLLCFCS
+#define HDLC_FRAME_OVERHEAD          		    ((uint16_t)(17))
+//߳֡ȣڴڴС̵߳ȴڼյ֡Ŷ
+#define HDLC_CONFIG_WORKER_QUEUE          		((uint8_t)(4))
 
 /* Private typedef -----------------------------------------------------------*/
 /**	
@@ -108,6 +123,7 @@ struct __hdlc_info_recv
     uint16_t length; //̬ڴС
     uint16_t filled; //ڴдָ
     uint8_t *data; //̬ڴ׵ַ¼
+    uint8_t deferred; //Ӧòѹݱύ
 };
 
 /**	
@@ -167,6 +183,30 @@ struct __hdlc_link
 	struct __hdlc_info_unconfirmed unconfirmed; //UIϢݽṹ
 };
 
+#if defined ( DLMS_CONFIG_PARALLEL )
+/**	
+  * @brief ͨ߳
+  * ̰߳յ֡η inbox У̴߳Ӧ֡ outboxɵ߳ȡ߷
+  */
+struct __hdlc_worker
+{
+    pthread_mutex_t lock; //³Ա
+    pthread_cond_t wakeup;
+    uint8_t started; //߳
+    uint8_t kick; //Ӧ֡ѱȡߣһ֡
+    uint32_t generation; //·ʼʼ֮ǰյ֡
+    uint8_t head; //յ֡
+    uint8_t queued; //е֡
+    uint16_t inbox_length[HDLC_CONFIG_WORKER_QUEUE];
+    uint16_t outbox_length;
+    uint8_t inbox[HDLC_CONFIG_WORKER_QUEUE][HDLC_CONFIG_FRAME_SIZE];
+    uint8_t outbox[HDLC_CONFIG_FRAME_SIZE];
+};
+
+//֡ information Ϊ󳤶ȵ֡ʧ
+typedef char hdlc_frame_size_check[(HDLC_CONFIG_FRAME_SIZE >= (HDLC_CONFIG_INFO_LEN_MAX + HDLC_FRAME_OVERHEAD))? 1 : -1];
+#endif
+
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 /**	
@@ -211,7 +251,16 @@ static const uint16_t fcstab[256] =
 //ͨϢ
 static struct __hdlc_link hdlc_links[HDLC_CONFIG_MAX_CHANNEL];
 
+#if defined ( DLMS_CONFIG_PARALLEL )
+//ͨ߳
+static struct __hdlc_worker hdlc_workers[HDLC_CONFIG_MAX_CHANNEL];
+#endif
+
 /* Private function prototypes -----------------------------------------------*/
+#if defined ( DLMS_CONFIG_PARALLEL )
+static void hdlc_oversize(uint8_t channel, const uint8_t *frame, uint16_t length);
+#endif
+
 /* Private functions ---------------------------------------------------------*/
 /**
   * @brief ֽ CRC16
@@ -712,6 +761,7 @@ static enum __hdlc_errors link_cleanup(struct __hdlc_link *link)
     {
         id.session = link->client_address;
         id.sap = link->logic_address;
+        id.channel = (uint8_t)(link - hdlc_links);
         //ȡӦò
         HDLC_CONFIG_APPL_RELEASE(id);
     }
@@ -804,11 +854,11 @@ static enum __hdlc_errors encode_frmr(const struct __hdlc_frame_desc *hdlc_desc,
 }
 
 /**
-  * @brief RR֡
+  * @brief S֡RR/RNR
   * @param  
   * @retval 
   */
-static enum __hdlc_errors encode_rr(const struct __hdlc_frame_desc *hdlc_desc, struct __hdlc_link *link)
+static enum __hdlc_errors encode_supervisory(const struct __hdlc_frame_desc *hdlc_desc, struct __hdlc_link *link, uint8_t type)
 {
     uint16_t frame_encode = 0;
     
@@ -851,7 +901,7 @@ static enum __hdlc_errors encode_rr(const struct __hdlc_frame_desc *hdlc_desc, s
     }
     
     //
-    *(link->send.segment.data + frame_encode) = (((link->rrr << 5) + 0x01) | 0x10);
+    *(link->send.segment.data + frame_encode) = (((link->rrr << 5) + type) | 0x10);
     frame_encode += 1;
     
     //֡
@@ -870,6 +920,26 @@ static enum __hdlc_errors encode_rr(const struct __hdlc_frame_desc *hdlc_desc, s
     return(HDLC_NO_ERR);
 }
 
+/**
+  * @brief RR֡
+  * @param  
+  * @retval 
+  */
+static enum __hdlc_errors encode_rr(const struct __hdlc_frame_desc *hdlc_desc, struct __hdlc_link *link)
+{
+    return(encode_supervisory(hdlc_desc, link, 0x01));
+}
+
+/**
+  * @brief RNR֡
+  * @param  
+  * @retval 
+  */
+static enum __hdlc_errors encode_rnr(const struct __hdlc_frame_desc *hdlc_desc, struct __hdlc_link *link)
+{
+    return(encode_supervisory(hdlc_desc, link, 0x05));
+}
+
 /**
   * @brief  HDLC SNRM ֡
   * @param  
@@ -1072,18 +1142,105 @@ static enum __hdlc_errors request_snrm(struct __hdlc_link *link, \
 }
 
 /**
-  * @brief  HDLC I ֡
+  * @brief Ӧòظ I ֡ʱƬ
   * @param  
   * @retval 
   */
-static enum __hdlc_errors request_info(struct __hdlc_link *link, \
-                          const struct __hdlc_frame_desc *hdlc_desc)
+static enum __hdlc_errors encode_info(const struct __hdlc_frame_desc *hdlc_desc, struct __hdlc_link *link)
 {
     uint16_t frame_encode = 0;
     uint16_t info_length;
     uint16_t index_hcs;
+    
+    //ص
+    *(link->send.segment.data + frame_encode) = 0x7e;
+    frame_encode += 1;
+    
+    //жǷҪƬͣ֡Լ Segment λ
+    if((link->send.filled + 3) > link->max_len_trans)
+    {
+        *(link->send.segment.data + frame_encode) = 0xA8;
+        frame_encode += 1;
+        info_length = link->max_len_trans - 3;
+        link->send.sent = link->max_len_trans - 3;
+    }
+    else
+    {
+        *(link->send.segment.data + frame_encode) = 0xA0;
+        frame_encode += 1;
+        info_length = link->send.filled;
+        link->send.sent = 0;
+        link->send.filled = 0;
+    }
+    
+    //֡
+    frame_encode += 1;
+    
+    //Ŀĵַ
+    frame_encode += fill_client_address(link->client_address, (link->send.segment.data+frame_encode));
+    
+    //Դַ
+    frame_encode += fill_server_address(link->device_address, link->logic_address, hdlc_desc->length_dst, (link->send.segment.data+frame_encode));
+    
+    //
+    *(link->send.segment.data + frame_encode) = (((link->rrr << 5) + (link->sss << 1)) | 0x10);
+    link->sss += 1;
+    link->sss &= 0x07;
+    
+    frame_encode += 1;
+    
+    index_hcs = frame_encode;
+    //֡ͷУ HCS
+    frame_encode += 2;
+    
+    //LLC ʶ
+    *(link->send.segment.data + frame_encode + 0) = 0xE6;
+    *(link->send.segment.data + frame_encode + 1) = 0xE7;
+    *(link->send.segment.data + frame_encode + 2) = 0x00;
+    frame_encode += 3;
+    
+    //Ӧò
+    heap.copy((link->send.segment.data + frame_encode), link->send.data, info_length);
+    frame_encode += info_length;
+    
+    //֡
+    *(link->send.segment.data + 1) += (((frame_encode - 1 + 2) >> 8) & 0x1f);
+    *(link->send.segment.data + 2) = ((frame_encode - 1 + 2) & 0x00ff);
+    
+    //֡ͷУ HCS
+    add_check((link->send.segment.data + 1), (index_hcs - 1), (link->send.segment.data + index_hcs + 0));
+    //֡У FCS
+    frame_encode += add_check((link->send.segment.data + 1), (frame_encode - 1), (link->send.segment.data + frame_encode + 0));
+    
+    //ص
+    *(link->send.segment.data + frame_encode) = 0x7e;
+    frame_encode += 1;
+    
+    link->send.segment.length = frame_encode;
+    link->send.segment.confirming = frame_encode;
+    
+    link->unconfirmed.talk = 1;
+    
+    return(HDLC_NO_ERR);
+}
+
+/**
+  * @brief  HDLC I ֡
+  * @param  
+  * @retval 
+  */
+static enum __hdlc_errors request_info(struct __hdlc_link *link, \
+                          const struct __hdlc_frame_desc *hdlc_desc)
+{
     struct __dlms_session id;
     
+    //һԹݲµ
+    if(link->recv.deferred)
+    {
+        //RNR
+        return(encode_rnr(hdlc_desc, link));
+    }
+    
     //ж information Ƿ񳬹Э󳤶
     if(hdlc_desc->llc)
     {
@@ -1156,6 +1313,7 @@ static enum __hdlc_errors request_info(struct __hdlc_link *link, \
     //ʹ HDLC е info  application 
     id.session = link->client_address;
     id.sap = link->logic_address;
+    id.channel = (uint8_t)(link - hdlc_links);
     HDLC_CONFIG_APPL_REQUEST(id,
                              link->recv.data,
                              link->recv.filled,
@@ -1163,6 +1321,16 @@ static enum __hdlc_errors request_info(struct __hdlc_link *link, \
                              link->send.length,
                              &link->send.filled);
     
+    //Ӧò𣬱ջ壬ȷ I ֡ȴͻѯ
+    if(!link->send.filled && HDLC_CONFIG_APPL_DEFERRED())
+    {
+        link->recv.deferred = 1;
+        link->rrr += 1;
+        link->rrr &= 0x07;
+        //RR
+        return(encode_rr(hdlc_desc, link));
+    }
+    
     //սջ
     link->recv.filled = 0;
     
@@ -1171,78 +1339,50 @@ static enum __hdlc_errors request_info(struct __hdlc_link *link, \
         return(HDLC_ERR_LENGTH);
     }
     
-    //ص
-    *(link->send.segment.data + frame_encode) = 0x7e;
-    frame_encode += 1;
-    
-    //жǷҪƬͣ֡Լ Segment λ
-    if((link->send.filled + 3) > link->max_len_trans)
-    {
-        *(link->send.segment.data + frame_encode) = 0xA8;
-        frame_encode += 1;
-        info_length = link->max_len_trans - 3;
-        link->send.sent = link->max_len_trans - 3;
-    }
-    else
-    {
-        *(link->send.segment.data + frame_encode) = 0xA0;
-        frame_encode += 1;
-        info_length = link->send.filled;
-        link->send.sent = 0;
-        link->send.filled = 0;
-    }
-    
-    //֡
-    frame_encode += 1;
-    
-    //Ŀĵַ
-    frame_encode += fill_client_address(link->client_address, (link->send.segment.data+frame_encode));
-    
-    //Դַ
-    frame_encode += fill_server_address(link->device_address, link->logic_address, hdlc_desc->length_dst, (link->send.segment.data+frame_encode));
-    
-    //
     link->rrr += 1;
     link->rrr &= 0x07;
-    *(link->send.segment.data + frame_encode) = (((link->rrr << 5) + (link->sss << 1)) | 0x10);
-    link->sss += 1;
-    link->sss &= 0x07;
-    
-    frame_encode += 1;
-    
-    index_hcs = frame_encode;
-    //֡ͷУ HCS
-    frame_encode += 2;
-    
-    //LLC ʶ
-    *(link->send.segment.data + frame_encode + 0) = 0xE6;
-    *(link->send.segment.data + frame_encode + 1) = 0xE7;
-    *(link->send.segment.data + frame_encode + 2) = 0x00;
-    frame_encode += 3;
-    
-    //Ӧò
-    heap.copy((link->send.segment.data + frame_encode), link->send.data, info_length);
-    frame_encode += info_length;
     
-    //֡
-    *(link->send.segment.data + 1) += (((frame_encode - 1 + 2) >> 8) & 0x1f);
-    *(link->send.segment.data + 2) = ((frame_encode - 1 + 2) & 0x00ff);
+    return(encode_info(hdlc_desc, link));
+}
+
+/**
+  * @brief ύӦò
+  * @param  
+  * @retval 
+  */
+static enum __hdlc_errors request_resume(struct __hdlc_link *link, \
+                               const struct __hdlc_frame_desc *hdlc_desc)
+{
+    struct __dlms_session id;
     
-    //֡ͷУ HCS
-    add_check((link->send.segment.data + 1), (index_hcs - 1), (link->send.segment.data + index_hcs + 0));
-    //֡У FCS
-    frame_encode += add_check((link->send.segment.data + 1), (frame_encode - 1), (link->send.segment.data + frame_encode + 0));
+    id.session = link->client_address;
+    id.sap = link->logic_address;
+    id.channel = (uint8_t)(link - hdlc_links);
+    HDLC_CONFIG_APPL_REQUEST(id,
+                             link->recv.data,
+                             link->recv.filled,
+                             link->send.data,
+                             link->send.length,
+                             &link->send.filled);
     
-    //ص
-    *(link->send.segment.data + frame_encode) = 0x7e;
-    frame_encode += 1;
+    //δ
+    if(!link->send.filled && HDLC_CONFIG_APPL_DEFERRED())
+    {
+        //RNR
+        return(encode_rnr(hdlc_desc, link));
+    }
     
-    link->send.segment.length = frame_encode;
-    link->send.segment.confirming = frame_encode;
+    //սջ
+    link->recv.deferred = 0;
+    link->recv.filled = 0;
     
-    link->unconfirmed.talk = 1;
+    if(!link->send.filled)
+    {
+        //RR
+        return(encode_rr(hdlc_desc, link));
+    }
     
-    return(HDLC_NO_ERR);
+    return(encode_info(hdlc_desc, link));
 }
 
 /**
@@ -1257,6 +1397,12 @@ static enum __hdlc_errors request_rr(struct __hdlc_link *link, \
     uint16_t index_hcs;
     uint16_t info_length;
     
+    //ӦòУѯʱύظ I ֡
+    if(link->recv.deferred)
+    {
+        return(request_resume(link, hdlc_desc));
+    }
+    
     //֡Чж
     //еRRRϴеһʱΪط
     if(hdlc_desc->rrr == link->crrr)
@@ -1497,7 +1643,7 @@ static uint16_t response_ui(struct __hdlc_link *link, \
     else
     {
         *(frame + frame_encode) = 0x13;
-        info_length = link->unconfirmed.length;
+        info_length = link->unconfirmed.length - link->unconfirmed.sent;
     }
     
     frame_encode += 1;
@@ -1538,6 +1684,91 @@ static uint16_t response_ui(struct __hdlc_link *link, \
 
 
 
+#if defined ( DLMS_CONFIG_PARALLEL )
+/**
+  * @brief ̣ͨ߳ͨյ֡Ӧ֡
+  * ڼ乲е֮ͨ䲢߳е task 
+  */
+static void *hdlc_worker(void *arg)
+{
+    struct __hdlc_worker *worker = (struct __hdlc_worker *)arg;
+    uint8_t channel = (uint8_t)(worker - hdlc_workers);
+    uint8_t frame[HDLC_CONFIG_FRAME_SIZE];
+    uint16_t length;
+    uint32_t generation;
+    bool produce;
+    
+    pthread_mutex_lock(&worker->lock);
+    
+    for(;;)
+    {
+        //ûյµ֡ҲҪһӦ֡
+        if(!worker->queued && (!worker->kick || worker->outbox_length))
+        {
+            pthread_cond_wait(&worker->wakeup, &worker->lock);
+            continue;
+        }
+        
+        //յ˳֡
+        length = 0;
+        if(worker->queued)
+        {
+            length = worker->inbox_length[worker->head];
+            memcpy(frame, worker->inbox[worker->head], ((length > sizeof(frame))? sizeof(frame) : length));
+            worker->head = (worker->head + 1) % HDLC_CONFIG_WORKER_QUEUE;
+            worker->queued -= 1;
+        }
+        worker->kick = 0;
+        //һӦ֡δȡʱֻӦ֡·е´ȡߺ
+        produce = (worker->outbox_length == 0);
+        generation = worker->generation;
+        pthread_mutex_unlock(&worker->lock);
+        
+        system_lock_shared();
+        
+        //ȴڼ·ѱ³ʼһ֡
+        if(generation == worker->generation)
+        {
+            if(length > sizeof(frame))
+            {
+                //ֻ֡֡ͷظ FRMR
+                hdlc_oversize(channel, frame, sizeof(frame));
+            }
+            else if(length)
+            {
+                hdlc_request(channel, frame, length);
+            }
+            
+            length = 0;
+            
+            if(produce)
+            {
+                length = hdlc_response(channel, frame, sizeof(frame));
+            }
+        }
+        else
+        {
+            length = 0;
+        }
+        
+        system_unlock_shared();
+        
+        //ʱڴ水̹߳һ֡ͷ
+        heap_ctrl.dinit();
+        
+        pthread_mutex_lock(&worker->lock);
+        
+        if(length && (generation == worker->generation))
+        {
+            memcpy(worker->outbox, frame, length);
+            worker->outbox_length = length;
+        }
+    }
+    
+    return((void *)0);
+}
+#endif
+
 /**
   * @brief ·ʼ
   * @param  
@@ -1553,6 +1784,25 @@ void hdlc_init(void)
     }
     
     heap.set((void *)hdlc_links, 0, sizeof(hdlc_links));
+
+#if defined ( DLMS_CONFIG_PARALLEL )
+    //߳δ֡δȡߵӦ֡
+    for(cnt=0; cnt<HDLC_CONFIG_MAX_CHANNEL; cnt++)
+    {
+        if(!hdlc_workers[cnt].started)
+        {
+            continue;
+        }
+        
+        pthread_mutex_lock(&hdlc_workers[cnt].lock);
+        hdlc_workers[cnt].generation += 1;
+        hdlc_workers[cnt].head = 0;
+        hdlc_workers[cnt].queued = 0;
+        hdlc_workers[cnt].outbox_length = 0;
+        hdlc_workers[cnt].kick = 0;
+        pthread_mutex_unlock(&hdlc_workers[cnt].lock);
+    }
+#endif
 }
 
 /**
@@ -1702,6 +1952,36 @@ uint8_t hdlc_get_linked_channel(void)
     return(0xff);
 }
 
+/**
+  * @brief ȡͨ
+  * @param  
+  * @retval 
+  */
+uint8_t hdlc_get_channel_amount(void)
+{
+    return(HDLC_CONFIG_MAX_CHANNEL);
+}
+
+/**
+  * @brief ȡָͨӵĿͻ˵ַ
+  * @param  
+  * @retval ͨδʱ0
+  */
+uint8_t hdlc_get_client_address(uint8_t channel)
+{
+    if(channel >= HDLC_CONFIG_MAX_CHANNEL)
+    {
+        return(0);
+    }
+    
+    if(hdlc_links[channel].link_status != LINK_CONNECTED)
+    {
+        return(0);
+    }
+    
+    return(hdlc_links[channel].client_address);
+}
+
 /**
   * @brief ָͨUI
   * @param  
@@ -1977,4 +2257,158 @@ uint16_t hdlc_response(uint8_t channel, uint8_t *frame, uint16_t length)
     }
 }
 
+#if defined ( DLMS_CONFIG_PARALLEL )
+/**
+  * @brief ճ߳֡֡
+  * ֻ֡ͷã֡ͷУͨҷ·ʱظ FRMRinformation ȳޣ
+  */
+static void hdlc_oversize(uint8_t channel, const uint8_t *frame, uint16_t length)
+{
+    struct __hdlc_frame_desc frame_desc;
+    enum __hdlc_errors hdlc_errors;
+    
+    hdlc_errors = decode_hdlc_frame(frame, length, &frame_desc);
+    
+    //֡βѽضϣFCS УȻʧ
+    if((hdlc_errors != HDLC_NO_ERR) && (hdlc_errors != HDLC_ERR_FCS))
+    {
+        return;
+    }
+    
+    if(broadcast_matched(&frame_desc) || !address_matched(channel, &frame_desc))
+    {
+        return;
+    }
+    
+    if(hdlc_links[channel].link_status != LINK_CONNECTED)
+    {
+        return;
+    }
+    
+    encode_frmr(&frame_desc, &hdlc_links[channel], FRMR_INFOLENGTH);
+}
+
+/**
+  * @brief ͨ߳
+  * ߳һֱפʧܵͨڵ߳д
+  */
+void hdlc_worker_start(void)
+{
+    pthread_t thread;
+    pthread_attr_t thread_attr;
+    uint8_t cnt;
+    
+    for(cnt=0; cnt<HDLC_CONFIG_MAX_CHANNEL; cnt++)
+    {
+        if(hdlc_workers[cnt].started)
+        {
+            continue;
+        }
+        
+        pthread_mutex_init(&hdlc_workers[cnt].lock, NULL);
+        pthread_cond_init(&hdlc_workers[cnt].wakeup, NULL);
+        
+        pthread_attr_init(&thread_attr);
+        pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_DETACHED);
+        if(pthread_create(&thread, &thread_attr, hdlc_worker, &hdlc_workers[cnt]) != 0)
+        {
+            pthread_attr_destroy(&thread_attr);
+            pthread_cond_destroy(&hdlc_workers[cnt].wakeup);
+            pthread_mutex_destroy(&hdlc_workers[cnt].lock);
+            continue;
+        }
+        pthread_attr_destroy(&thread_attr);
+        
+        hdlc_workers[cnt].started = 0xff;
+    }
+}
+
+/**
+  * @brief յ֡ͨ߳ŶӴ
+  * ʱղ 0Ϊ 1 Ŀͻֻط֡ſɿͻ˳ʱٴط
+  * ֻ֡֡֡ͷ¼ʵʳȣɹ̻߳ظ FRMR
+  * @param  
+  * @retval 
+  */
+uint16_t hdlc_worker_post(uint8_t channel, const uint8_t *frame, uint16_t length)
+{
+    struct __hdlc_worker *worker;
+    uint8_t tail;
+    
+    if((channel >= HDLC_CONFIG_MAX_CHANNEL) || (!frame) || (!length))
+    {
+        return(0);
+    }
+    
+    worker = &hdlc_workers[channel];
+    
+    if(!worker->started)
+    {
+        return(hdlc_request(channel, frame, length));
+    }
+    
+    if(length > HDLC_CONFIG_FRAME_SIZE)
+    {
+        TRACE(TRACE_WARN, "HDLC channel %d received a %d bytes frame, larger than %d, rejected.", channel, length, HDLC_CONFIG_FRAME_SIZE);
+    }
+    
+    pthread_mutex_lock(&worker->lock);
+    
+    if(worker->queued >= HDLC_CONFIG_WORKER_QUEUE)
+    {
+        pthread_mutex_unlock(&worker->lock);
+        return(0);
+    }
+    
+    tail = (worker->head + worker->queued) % HDLC_CONFIG_WORKER_QUEUE;
+    memcpy(worker->inbox[tail], frame, ((length > HDLC_CONFIG_FRAME_SIZE)? HDLC_CONFIG_FRAME_SIZE : length));
+    worker->inbox_length[tail] = length;
+    worker->queued += 1;
+    pthread_cond_signal(&worker->wakeup);
+    pthread_mutex_unlock(&worker->lock);
+    
+    return(length);
+}
+
+/**
+  * @brief ȡͨ߳ɵӦ֡
+  * @param  
+  * @retval 
+  */
+uint16_t hdlc_worker_fetch(uint8_t channel, uint8_t *frame, uint16_t length)
+{
+    struct __hdlc_worker *worker;
+    uint16_t filled = 0;
+    
+    if((channel >= HDLC_CONFIG_MAX_CHANNEL) || (!frame) || (!length))
+    {
+        return(0);
+    }
+    
+    worker = &hdlc_workers[channel];
+    
+    if(!worker->started)
+    {
+        return(hdlc_response(channel, frame, length));
+    }
+    
+    pthread_mutex_lock(&worker->lock);
+    
+    if(worker->outbox_length)
+    {
+        filled = (worker->outbox_length <= length)? worker->outbox_length : length;
+        memcpy(frame, worker->outbox, filled);
+        worker->outbox_length = 0;
+        
+        //·пܻд͵֡UI֮֡I֡ȣ
+        worker->kick = 0xff;
+        pthread_cond_signal(&worker->wakeup);
+    }
+    
+    pthread_mutex_unlock(&worker->lock);
+    
+    return(filled);
+}
+#endif
+
 
@@ -13,7 +13,10 @@
 #include "axdr.h"
 #include "dlms_lexicon.h"
 #include "dlms_utilities.h"
+#include "dlms_association.h"
 #include "hdlc_datalink.h"
+#include "dlms_push.h"
+#include "dlms_crypto.h"
 #include "types_comm.h"
 
 /* Private typedef -----------------------------------------------------------*/
@@ -26,23 +29,37 @@ static void dlms_init(void)
 {
 	hdlc_init();
 	dlms_lex_init();
+	dlms_push_init();
+	dlms_crypto_init();
+
+#if defined ( DLMS_CONFIG_PARALLEL )
+	//ÿͨıĽԵĹ̴߳
+	hdlc_worker_start();
+#endif
 }
 
 static void dlms_loop(void)
 {
+	dlms_lex_verify(DLMS_LEX_VERIFY_BUDGET);
 	hdlc_tick(KERNEL_PERIOD);
+	dlms_push_tick(KERNEL_PERIOD);
 }
 
 static void dlms_exit(void)
 {
+	dlms_push_exit();
 	hdlc_init();
+	dlms_crypto_exit();
 }
 
 static void dlms_reset(void)
 {
 	hdlc_init();
 	dlms_lex_init();
-    
+	dlms_push_init();
+	dlms_crypto_exit();
+	dlms_crypto_init();
+
 #if defined ( MAKE_RUN_FOR_DEBUG )
     {
         uint8_t buff[34];
@@ -62,6 +79,9 @@ static void dlms_reset(void)
         dlms_util_write_title(buff);//system title
     }
 #endif // #if defined ( MAKE_RUN_FOR_DEBUG )
+    
+    //ԿѸı䣬ӻָ
+    dlms_asso_key_eliminate();
 }
 
 static enum __task_status dlms_status(void)
@@ -95,14 +115,12 @@ static uint16_t dlms_read(enum  __protocol_family pf, uint8_t *descriptor, uint8
 					((((uint16_t)descriptor[9]) << 8) + descriptor[10]));
 	MAKE_COSEM_REQUEST(&desc, 0xff, DLMS_ACCESS_HIGH, GET_REQUEST, &cosem_descriptor);
 	
-    dlms_lex_parse(&desc, &right, &P.Input.OID, &P.Input.MID);
+    dlms_lex_parse(&desc, &right, &P.Input.OID, &P.Input.MID, &Func);
     if((P.Input.MID == 0) || (P.Input.OID == 0xffffffff) || (*((uint8_t *)&right) == 0))
     {
         return(0);
     }
     
-	Func = CosemLoadAttribute(cosem_descriptor.classid, cosem_descriptor.index, false);
-    
     if(!Func)
     {
     	return(0);
@@ -142,14 +160,12 @@ static uint16_t dlms_write(enum  __protocol_family pf, uint8_t *descriptor, uint
 					((((uint16_t)descriptor[9]) << 8) + descriptor[10]));
 	MAKE_COSEM_REQUEST(&desc, 0xff, DLMS_ACCESS_HIGH, SET_REQUEST, &cosem_descriptor);
 	
-    dlms_lex_parse(&desc, &right, &P.Input.OID, &P.Input.MID);
+    dlms_lex_parse(&desc, &right, &P.Input.OID, &P.Input.MID, &Func);
     if((P.Input.MID == 0) || (P.Input.OID == 0xffffffff) || (*((uint8_t *)&right) == 0))
     {
         return(0);
     }
     
-	Func = CosemLoadAttribute(cosem_descriptor.classid, cosem_descriptor.index, true);
-    
     if(!Func)
     {
     	return(0);
@@ -179,7 +195,11 @@ static uint16_t dlms_stream_in(uint8_t channel, const uint8_t *frame, uint16_t f
 	
     if(hdlc_matched(frame, frame_length))
     {
+#if defined ( DLMS_CONFIG_PARALLEL )
+        return(hdlc_worker_post(channel, frame, frame_length));
+#else
         return(hdlc_request(channel, frame, frame_length));
+#endif
     }
     
 	return(0);
@@ -187,7 +207,11 @@ static uint16_t dlms_stream_in(uint8_t channel, const uint8_t *frame, uint16_t f
 
 static uint16_t dlms_stream_out(uint8_t channel, uint8_t *frame, uint16_t buff_length)
 {
+#if defined ( DLMS_CONFIG_PARALLEL )
+	return(hdlc_worker_fetch(channel, frame, buff_length));
+#else
 	return(hdlc_response(channel, frame, buff_length));
+#endif
 }
 
 
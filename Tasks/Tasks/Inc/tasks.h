@@ -41,6 +41,9 @@ struct __task_sched
     void                            (*reset)(void); //ӦûָĬֵ(ʼ)
     enum            __task_status   (*status)(void); //Ӧõǰ״̬
     
+    uint16_t                        period; //ѯڣms0 ʾÿĶѯ
+    uint16_t                        phase; //ʼ״ѯǰʱmsڴͬӦ
+    
     void                            *api;
 };
 
@@ -55,6 +58,7 @@ struct __task_ctrl
     const struct __task_sched		*(*current)(void); //ǰӦ
     const struct __task_sched		*(*search)(const char *name); //ƲӦ
 	uint8_t							(*reset)(const char *name); //ƸλӦ
+	uint16_t						(*elapsed)(void); //ǰӦþϴѯʱ䣨ms
 };
 
 /* Exported constants --------------------------------------------------------*/
@@ -9,16 +9,14 @@
 #include "string.h"
 #include "trace.h"
 #include "cpu.h"
+#include "kernel.h"
+#include "allocator.h"
 #include "allocator_ctrl.h"
 #include "api.h"
+#include "jiffy.h"
 
 #if defined ( BUILD_DAEMON )
 #undef __TASKS_MONITOR
-#else
-#if defined ( __TASKS_MONITOR )
-#include "jiffy.h"
-#include "allocator.h"
-#endif
 #endif
 /** tasksͷļ */
 #if defined ( _WIN32 ) || defined ( _WIN64 ) || defined ( __linux )
@@ -81,6 +79,7 @@ static const struct __task_table task_tables[] =
     
     /** tasksĽṹַ */
     { {0x02, 0x02, 0x02, 0xfe}, &task_timed },
+    { {0x04, 0x03, 0x02, 0xfe}, &task_calendar },
     { {0x01, 0x01, 0x02, 0xfe}, &task_metering },
     { {0x03, 0x09, 0x02, 0xfe}, &task_disconnect },
     { {0x06, 0x05, 0x02, 0xfe}, &task_display },
@@ -90,6 +89,32 @@ static const struct __task_table task_tables[] =
     { {0x0a, 0x11, 0x02, 0xfe}, &task_comm },
 };
 
+/**
+  * @brief  ˳źõִУ״ʹʱ
+  * ˳ͬ񱣳беȺ˳Ϊ 0  0xff ִ
+  */
+struct __task_sequence
+{
+    uint8_t                         amount;
+    uint8_t                         index[TASK_AMOUNT];
+};
+
+static struct
+{
+    bool                            ready;
+    struct __task_sequence          init;
+    struct __task_sequence          exit;
+    struct __task_sequence          reset;
+    struct __task_sequence          loop;
+    
+}                                   sequences = {0};
+
+static uint32_t task_stamp[TASK_AMOUNT] = {0}; //ѯƻĻ׼
+static uint32_t task_last[TASK_AMOUNT] = {0}; //ϴѯʼʱĽ
+static uint16_t task_wait[TASK_AMOUNT] = {0}; // task_stamp ´ѯʱ䣨ms
+static uint16_t task_elapsed = 0; //ǰѯӦþϴѯʱ䣨ms
+static bool task_looping = false; //ѯӦ
+
 static uint16_t task_id = 0xffff;
 
 #if defined ( __TASKS_MONITOR )
@@ -111,6 +136,60 @@ static void __monitor_stop_loop(uint8_t index);
 
 /* Private functions ---------------------------------------------------------*/
 
+/**
+  * @brief   struct __task_order ƫΪ member ˳ִ
+  */
+static void sequence_make(struct __task_sequence *sequence, uint8_t member)
+{
+    uint8_t cnt;
+    uint8_t n;
+    uint8_t order;
+    
+    sequence->amount = 0;
+    
+    for(cnt = 0; cnt < TASK_AMOUNT; cnt ++)
+    {
+        order = ((const uint8_t *)&task_tables[cnt].order)[member];
+        
+        if((order == 0) || (order == 0xff))
+        {
+            continue;
+        }
+        
+        //˳ͬʱں
+        for(n = sequence->amount; n > 0; n --)
+        {
+            if(((const uint8_t *)&task_tables[sequence->index[n - 1]].order)[member] <= order)
+            {
+                break;
+            }
+            
+            sequence->index[n] = sequence->index[n - 1];
+        }
+        
+        sequence->index[n] = cnt;
+        sequence->amount += 1;
+    }
+}
+
+/**
+  * @brief  ɸִУб䣬ֻһ
+  */
+static void sequence_prepare(void)
+{
+    if(sequences.ready)
+    {
+        return;
+    }
+    
+    sequence_make(&sequences.init, STRUCT_OFFSET(struct __task_order, init));
+    sequence_make(&sequences.exit, STRUCT_OFFSET(struct __task_order, exit));
+    sequence_make(&sequences.reset, STRUCT_OFFSET(struct __task_order, reset));
+    sequence_make(&sequences.loop, STRUCT_OFFSET(struct __task_order, loop));
+    
+    sequences.ready = true;
+}
+
 /**
   * @brief  
   */
@@ -125,33 +204,43 @@ static void tasks_init(void)
     
     cpu.watchdog.feed();
     disk_ctrl.start();
+    nvram_ctrl.release();
     
     TRACE(TRACE_INFO, "Tasks initializing.");
     
-    for(loop = 1; loop < 255; loop ++)
+    sequence_prepare();
+    
+    for(loop = 0; loop < sequences.init.amount; loop ++)
     {
-        for(cnt = 0; cnt < TASK_AMOUNT; cnt ++)
+        cnt = sequences.init.index[loop];
+        
+        if(task_tables[cnt].task && task_tables[cnt].task->init)
         {
-            if(task_tables[cnt].order.init != loop)
-            {
-                continue;
-            }
-            
-            if(task_tables[cnt].task && task_tables[cnt].task->init)
-            {
-                task_id = cnt;
-                cpu.watchdog.feed();
+            task_id = cnt;
+            cpu.watchdog.feed();
 #if defined ( __TASKS_MONITOR )
-                __monitor_start(cnt);
+            __monitor_start(cnt);
 #endif
-                disk_ctrl.unlock();
-                task_tables[cnt].task->init();
-                disk_ctrl.lock();
+            disk_ctrl.unlock();
+            task_tables[cnt].task->init();
+            disk_ctrl.lock();
 #if defined ( __TASKS_MONITOR )
-                __monitor_stop_init(cnt);
+            __monitor_stop_init(cnt);
 #endif
-                task_id = 0xffff;
-            }
+            task_id = 0xffff;
+        }
+    }
+    
+    //м仯¿ʼʱԵλ״ѯ
+    for(cnt = 0; cnt < TASK_AMOUNT; cnt ++)
+    {
+        task_stamp[cnt] = jiffy.value();
+        task_last[cnt] = task_stamp[cnt];
+        task_wait[cnt] = 0;
+        
+        if(task_tables[cnt].task)
+        {
+            task_wait[cnt] = task_tables[cnt].task->phase;
         }
     }
     
@@ -165,47 +254,77 @@ static void tasks_loop(void)
 {
     uint8_t loop;
     uint8_t cnt;
+    uint32_t span;
     enum  __task_status task_status;
     
     cpu.watchdog.feed();
     heap_ctrl.dinit();
     
-    for(loop = 1; loop < 255; loop ++)
+    sequence_prepare();
+    
+    for(loop = 0; loop < sequences.loop.amount; loop ++)
     {
-        for(cnt = 0; cnt < TASK_AMOUNT; cnt ++)
+        cnt = sequences.loop.index[loop];
+        
+        if(!task_tables[cnt].task)
         {
-            if(task_tables[cnt].order.loop != loop)
-            {
-                continue;
-            }
+            continue;
+        }
+        
+        //ʵʾĽжǷѯʱ䣬ں˽ĳٵǰӰ
+        span = jiffy.after(task_stamp[cnt]);
+        
+        if(span < task_wait[cnt])
+        {
+            continue;
+        }
+        
+        //ƻ׼ƽٵۻ󳬹һʱӵǰ¼ƻ
+        if((span - task_wait[cnt]) < task_tables[cnt].task->period)
+        {
+            task_stamp[cnt] += task_wait[cnt];
+        }
+        else
+        {
+            task_stamp[cnt] = jiffy.value();
+        }
+        
+        task_wait[cnt] = task_tables[cnt].task->period;
+        
+        span = jiffy.after(task_last[cnt]);
+        task_last[cnt] = jiffy.value();
+        task_elapsed = (span > 0xffff)? 0xffff : (uint16_t)span;
+        task_looping = true;
+        
+        if(task_tables[cnt].task->status)
+        {
+            task_status = task_tables[cnt].task->status();
             
-            if(task_tables[cnt].task->status)
+            if((task_status != TASK_INIT) && (task_status != TASK_RUN))
             {
-                task_status = task_tables[cnt].task->status();
-                
-                if((task_status != TASK_INIT) && (task_status != TASK_RUN))
-                {
-                    continue;
-                }
+                continue;
             }
-            
-            if(task_tables[cnt].task && task_tables[cnt].task->loop)
-            {
-                task_id = cnt;
-                cpu.watchdog.feed();
+        }
+        
+        if(task_tables[cnt].task && task_tables[cnt].task->loop)
+        {
+            task_id = cnt;
+            cpu.watchdog.feed();
 #if defined ( __TASKS_MONITOR )
-                __monitor_start(cnt);
+            __monitor_start(cnt);
 #endif
-                disk_ctrl.unlock();
-                task_tables[cnt].task->loop();
-                disk_ctrl.lock();
+            disk_ctrl.unlock();
+            task_tables[cnt].task->loop();
+            disk_ctrl.lock();
 #if defined ( __TASKS_MONITOR )
-                __monitor_stop_loop(cnt);
+            __monitor_stop_loop(cnt);
 #endif
-                task_id = 0xffff;
-            }
+            task_id = 0xffff;
         }
     }
+    
+    task_elapsed = 0;
+    task_looping = false;
 }
 
 /**
@@ -213,7 +332,7 @@ static void tasks_loop(void)
   */
 static void tasks_exit(void)
 {
-    uint16_t loop;
+    uint8_t loop;
     uint8_t cnt;
     
     cpu.watchdog.feed();
@@ -221,31 +340,27 @@ static void tasks_exit(void)
     
     TRACE(TRACE_INFO, "Tasks quitting.");
     
-    for(loop = 1; loop < 255; loop ++)
+    sequence_prepare();
+    
+    for(loop = 0; loop < sequences.exit.amount; loop ++)
     {
-        for(cnt = 0; cnt < TASK_AMOUNT; cnt ++)
+        cnt = sequences.exit.index[loop];
+        
+        if(task_tables[cnt].task && task_tables[cnt].task->exit)
         {
-            if(task_tables[cnt].order.exit != loop)
-            {
-                continue;
-            }
-            
-            if(task_tables[cnt].task && task_tables[cnt].task->exit)
-            {
-                task_id = cnt;
-                cpu.watchdog.feed();
+            task_id = cnt;
+            cpu.watchdog.feed();
 #if defined ( __TASKS_MONITOR )
-                __monitor_start(cnt);
+            __monitor_start(cnt);
 #endif
-                disk_ctrl.unlock();
-                task_tables[cnt].task->exit();
-                disk_ctrl.lock();
-                heap_ctrl.recycle();
+            disk_ctrl.unlock();
+            task_tables[cnt].task->exit();
+            disk_ctrl.lock();
+            heap_ctrl.recycle();
 #if defined ( __TASKS_MONITOR )
-                __monitor_stop_exit(cnt);
+            __monitor_stop_exit(cnt);
 #endif
-                task_id = 0xffff;
-            }
+            task_id = 0xffff;
         }
     }
     
@@ -270,25 +385,21 @@ static void tasks_reset(void)
     
     TRACE(TRACE_INFO, "Tasks resetting.");
     
-    for(loop = 1; loop < 255; loop ++)
+    sequence_prepare();
+    
+    for(loop = 0; loop < sequences.reset.amount; loop ++)
     {
-        for(cnt = 0; cnt < TASK_AMOUNT; cnt ++)
+        cnt = sequences.reset.index[loop];
+        
+        if(task_tables[cnt].task && task_tables[cnt].task->reset)
         {
-            if(task_tables[cnt].order.reset != loop)
-            {
-                continue;
-            }
-            
-            if(task_tables[cnt].task && task_tables[cnt].task->reset)
-            {
-                task_id = cnt;
-                cpu.watchdog.feed();
-                disk_ctrl.unlock();
-                task_tables[cnt].task->reset();
-                disk_ctrl.lock();
-                heap_ctrl.recycle();
-                task_id = 0xffff;
-            }
+            task_id = cnt;
+            cpu.watchdog.feed();
+            disk_ctrl.unlock();
+            task_tables[cnt].task->reset();
+            disk_ctrl.lock();
+            heap_ctrl.recycle();
+            task_id = 0xffff;
         }
     }
     
@@ -777,6 +888,20 @@ static uint8_t task_ctrl_reset(const char *name)
     return(0);
 }
 
+/**
+  * @brief  ǰӦþϴѯʵʾʱ䣨ms
+  * Ӧ loop  KERNEL_PERIOD ʱѯʱ KERNEL_PERIOD
+  */
+static uint16_t task_ctrl_elapsed(void)
+{
+    if(task_looping)
+    {
+        return(task_elapsed);
+    }
+    
+    return(KERNEL_PERIOD);
+}
+
 /**
   * @brief  
   */
@@ -788,6 +913,7 @@ const struct __task_ctrl task_ctrl =
     .current        = task_ctrl_current,
     .search         = task_ctrl_search,
 	.reset			= task_ctrl_reset,
+	.elapsed		= task_ctrl_elapsed,
 };
 
 
@@ -12,6 +12,13 @@
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
 #define TIMD_CONF_ENTRY_MAX			((uint8_t)16) //最大定时任务个数
+#define TIMD_WHEEL_TICK				((uint32_t)10) //时间轮最小刻度，单位毫秒
+#define TIMD_RTC_TOLERANCE			((uint32_t)2) //系统时钟与 jiffy 偏差超过该值（秒）视为时钟被修改
+
+#define TIMD_SECOND					((uint32_t)(1000 / TIMD_WHEEL_TICK)) //每秒刻度数
+#define TIMD_WHEEL_LEVELS			5 //时间轮层数：毫秒/秒/分/时/日
+#define TIMD_WHEEL_SLOTS			(TIMD_SECOND + 60 + 60 + 24 + 32) //各层格数之和
+#define TIMD_HASH_SIZE				16 //回调函数散列表大小，须为 2 的幂
 
 /* Exported macro ------------------------------------------------------------*/
 #define NAME_TIMED   "task_timed"
@@ -24,6 +24,11 @@ enum __timd_status
 
 /**
   * @brief  timed task 
+  * period ĺ flags 
+  * RELATIVE + PERIODIC/ONCE   ʱ䣬λ
+  * ABSOLUTE + ONCE            ʱλ
+  * ABSOLUTE + PERIODIC        ϵͳʱӶڣλ루 900 Ϊÿ㣩
+  * CHANGE                     ʹ periodϵͳʱӱ޸ʱִ
   */
 struct __timed_conf
 {
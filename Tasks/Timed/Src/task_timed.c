@@ -11,142 +11,575 @@
 #include "config_timed.h"
 
 #include "rtc.h"
+#include "jiffy.h"
 #include "crc.h"
 
 /* Private typedef -----------------------------------------------------------*/
 struct __timed_entry
 {
-    uint16_t                        counter; //ʱ
     struct      __timed_conf        conf; //涨ʱ
+    uint64_t                        expires; //ڿ̶
+    uint64_t                        target; //ԶʱĿʱ
+    uint16_t                        slot; //Ͱ
+    uint8_t                         level; //ڲ㼶
+    uint8_t                         next; //ͰںһĿʱΪ
+    uint8_t                         prev; //ͰǰһĿ
+    uint8_t                         link; //ɢ
     uint16_t                        check; //У
 };
 
+/**
+  * @brief  ֲʱ֣///ʱ/ 
+  */
+struct __timed_wheel
+{
+    struct __timed_entry            entry[TIMD_CONF_ENTRY_MAX];
+    uint8_t                         bucket[TIMD_WHEEL_SLOTS]; //Ͱͷ
+    uint8_t                         hash[TIMD_HASH_SIZE]; //صɢ
+    uint8_t                         amount[TIMD_WHEEL_LEVELS]; //Ŀ
+    uint8_t                         idle; //Ŀ
+    
+    uint64_t                        now; //ǰ̶
+    uint64_t                        elapsed; //ۼк
+    uint32_t                        jiffy; //ϴζȡ jiffy
+    uint64_t                        stamp; //ϴУԵϵͳʱ
+    uint64_t                        base; //ϴУʱ elapsed
+};
+
 /* Private define ------------------------------------------------------------*/
+#define TIMD_NIL                ((uint8_t)0xff)
+
 /* Private macro -------------------------------------------------------------*/
+#define TIMD_IS_ABSOLUTE(f)     (((f) & TIMD_FLAG_ABSOLUTE) == TIMD_FLAG_ABSOLUTE)
+#define TIMD_IS_CHANGE(f)       (((f) & TIMD_FLAG_ONCE) == TIMD_FLAG_CHANGE)
+#define TIMD_IS_PERIODIC(f)     (((f) & TIMD_FLAG_ONCE) == TIMD_FLAG_PERIODIC)
+#define TIMD_HASH(cb)           ((uint8_t)(((size_t)(cb) >> 2) & (TIMD_HASH_SIZE - 1)))
+
 /* Private variables ---------------------------------------------------------*/
 static enum __task_status status = TASK_NOTINIT;
-static struct __timed_entry *entries = (struct __timed_entry *)0;
+static struct __timed_wheel *wheel = (struct __timed_wheel *)0;
+
+/**
+  * @brief  ̶ȣһһһһȦ
+  */
+static const struct
+{
+    uint32_t                        unit; //ÿ̶
+    uint16_t                        slots; //
+    uint16_t                        offset; // bucket еʼλ
+} levels[TIMD_WHEEL_LEVELS] =
+{
+    {1,                     TIMD_SECOND,    0},
+    {TIMD_SECOND,           60,             TIMD_SECOND},
+    {TIMD_SECOND*60,        60,             TIMD_SECOND + 60},
+    {TIMD_SECOND*3600,      24,             TIMD_SECOND + 120},
+    {TIMD_SECOND*86400,     32,             TIMD_SECOND + 144},
+};
 
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 /**
-  * @brief  
+  * @brief  ʱеȫĿʱ׼
   */
-static enum __timd_status timed_create(const struct __timed_conf *conf)
+static void wheel_clear(void)
 {
-	uint8_t cnt;
-	 
-	if((!conf) || (!conf->callback))
-	{
-		return(TIMD_NOEXIST);
-	}
+    uint8_t cnt;
     
-    if(!entries)
+    heap.set((void *)wheel->entry, 0, sizeof(wheel->entry));
+    heap.set((void *)wheel->bucket, TIMD_NIL, sizeof(wheel->bucket));
+    heap.set((void *)wheel->hash, TIMD_NIL, sizeof(wheel->hash));
+    heap.set((void *)wheel->amount, 0, sizeof(wheel->amount));
+    
+    for(cnt=0; cnt<TIMD_CONF_ENTRY_MAX; cnt++)
     {
-        return(TIMD_CONFLICT);
+        wheel->entry[cnt].level = TIMD_NIL;
+        wheel->entry[cnt].next = ((cnt + 1) < TIMD_CONF_ENTRY_MAX)? (cnt + 1) : TIMD_NIL;
     }
-	
-    for(cnt=0; cnt<TIMD_CONF_ENTRY_MAX; cnt++)
+    
+    wheel->idle = 0;
+}
+
+/**
+  * @brief  ڿ̶ȹӦͰ
+  */
+static void wheel_insert(uint8_t index)
+{
+    struct __timed_entry *entry = &wheel->entry[index];
+    uint64_t when = entry->expires;
+    uint8_t level;
+    
+    if(when < wheel->now)
+    {
+        when = wheel->now;
+        entry->expires = when;
+    }
+    
+    for(level=0; level<(TIMD_WHEEL_LEVELS - 1); level++)
     {
-        if(entries[cnt].conf.callback == conf->callback)
+        if((when - wheel->now) < ((uint64_t)levels[level].unit * levels[level].slots))
         {
-        	return(TIMD_CONFLICT);
+            break;
         }
     }
     
-    for(cnt=0; cnt<TIMD_CONF_ENTRY_MAX; cnt++)
+    //߲㷶ΧʱȹԶһ񣬻ʱ¼
+    if((when - wheel->now) >= ((uint64_t)levels[level].unit * levels[level].slots))
+    {
+        when = wheel->now + (uint64_t)levels[level].unit * (levels[level].slots - 1);
+    }
+    
+    entry->level = level;
+    entry->slot = levels[level].offset + (uint16_t)((when / levels[level].unit) % levels[level].slots);
+    entry->prev = TIMD_NIL;
+    entry->next = wheel->bucket[entry->slot];
+    
+    if(entry->next != TIMD_NIL)
+    {
+        wheel->entry[entry->next].prev = index;
+    }
+    
+    wheel->bucket[entry->slot] = index;
+    wheel->amount[level] += 1;
+}
+
+/**
+  * @brief  ڵͰժ
+  */
+static void wheel_detach(uint8_t index)
+{
+    struct __timed_entry *entry = &wheel->entry[index];
+    
+    if(entry->level == TIMD_NIL)
+    {
+        return;
+    }
+    
+    if(entry->prev != TIMD_NIL)
     {
-        if(entries[cnt].conf.callback)
+        wheel->entry[entry->prev].next = entry->next;
+    }
+    else
+    {
+        wheel->bucket[entry->slot] = entry->next;
+    }
+    
+    if(entry->next != TIMD_NIL)
+    {
+        wheel->entry[entry->next].prev = entry->prev;
+    }
+    
+    wheel->amount[entry->level] -= 1;
+    entry->level = TIMD_NIL;
+    entry->next = TIMD_NIL;
+    entry->prev = TIMD_NIL;
+}
+
+/**
+  * @brief  صĿ
+  */
+static uint8_t wheel_find(void (*callback)(void))
+{
+    uint8_t index = wheel->hash[TIMD_HASH(callback)];
+    
+    while(index != TIMD_NIL)
+    {
+        if(wheel->entry[index].conf.callback == callback)
         {
-            continue;
+            break;
         }
         
-        heap.set((void *)&entries[cnt], 0, sizeof(struct __timed_entry));
-        heap.copy((void *)&entries[cnt].conf, (void *)conf, sizeof(entries[cnt].conf));
-        entries[cnt].check = crc16((const uint8_t *)&entries[cnt], (sizeof(struct __timed_entry) - sizeof(entries[cnt].check)), 0xffff);
+        index = wheel->entry[index].link;
+    }
+    
+    return(index);
+}
+
+/**
+  * @brief  ͷĿ
+  */
+static void wheel_release(uint8_t index)
+{
+    uint8_t *link;
+    
+    wheel_detach(index);
+    
+    link = &wheel->hash[TIMD_HASH(wheel->entry[index].conf.callback)];
+    
+    while(*link != TIMD_NIL)
+    {
+        if(*link == index)
+        {
+            *link = wheel->entry[index].link;
+            break;
+        }
         
-        return(TIMD_SUCCESS);
+        link = &wheel->entry[*link].link;
     }
     
-    return(TIMD_NOEXIST);
+    heap.set((void *)&wheel->entry[index], 0, sizeof(struct __timed_entry));
+    wheel->entry[index].level = TIMD_NIL;
+    wheel->entry[index].next = wheel->idle;
+    wheel->idle = index;
 }
 
 /**
-  * @brief  
+  * @brief  ǰϵͳʱӹֵδУԹʱֱӶȡ
   */
-static enum __timd_status timed_query(const struct __timed_conf *conf)
+static uint64_t wheel_clock(void)
 {
-	uint8_t cnt;
-	
-	if((!conf) || (!conf->callback))
-	{
-		return(TIMD_NOEXIST);
-	}
+    if(!wheel->stamp)
+    {
+        return(rtc.read());
+    }
     
-    if(!entries)
+    return(wheel->stamp + (wheel->elapsed - wheel->base) / 1000);
+}
+
+/**
+  * @brief  һεڿ̶
+  * @param  stamp ǰϵͳʱӣΪ 0 ʾϵͳʱӲ
+  */
+static void wheel_arm(uint8_t index, uint64_t stamp)
+{
+    struct __timed_entry *entry = &wheel->entry[index];
+    uint64_t ticks;
+    
+    if(!TIMD_IS_ABSOLUTE(entry->conf.flags))
     {
-        return(TIMD_CONFLICT);
+        ticks = (entry->conf.period + TIMD_WHEEL_TICK - 1) / TIMD_WHEEL_TICK;
+        entry->expires = wheel->now + (ticks? ticks : 1);
+        return;
     }
-	
+    
+    if(TIMD_IS_PERIODIC(entry->conf.flags))
+    {
+        entry->target = stamp? ((stamp / entry->conf.period + 1) * entry->conf.period) : 0;
+    }
+    else
+    {
+        entry->target = entry->conf.period;
+    }
+    
+    //ϵͳʱӲʱÿ
+    if(!stamp)
+    {
+        entry->expires = wheel->now + TIMD_SECOND;
+    }
+    else if(entry->target > (stamp + 1))
+    {
+        //ǰһ뵽ٰ 100ms ȡϵͳʱӶ߽
+        entry->expires = wheel->now + (entry->target - stamp - 1) * TIMD_SECOND;
+    }
+    else if(entry->target > stamp)
+    {
+        entry->expires = wheel->now + ((TIMD_SECOND / 10)? (TIMD_SECOND / 10) : 1);
+    }
+    else
+    {
+        entry->expires = wheel->now + 1;
+    }
+}
+
+/**
+  * @brief  Ŀ
+  */
+static void wheel_fire(uint8_t index)
+{
+    struct __timed_entry *entry = &wheel->entry[index];
+    void (*callback)(void) = entry->conf.callback;
+    uint64_t stamp = 0;
+    
+    if(entry->check != crc16((const uint8_t *)&entry->conf, sizeof(entry->conf), 0xffff))
+    {
+        wheel_release(index);
+        return;
+    }
+    
+    if(TIMD_IS_ABSOLUTE(entry->conf.flags))
+    {
+        stamp = rtc.read();
+        
+        //δĿʱ䣬¹
+        if(!stamp || !entry->target || (stamp < entry->target))
+        {
+            wheel_arm(index, stamp);
+            wheel_insert(index);
+            return;
+        }
+    }
+    
+    if(TIMD_IS_PERIODIC(entry->conf.flags))
+    {
+        wheel_arm(index, stamp);
+        wheel_insert(index);
+    }
+    else
+    {
+        wheel_release(index);
+    }
+    
+    callback();
+}
+
+/**
+  * @brief  ߹һ̶ȣֻڵͰ
+  */
+static void wheel_tick(void)
+{
+    uint8_t level;
+    uint16_t slot;
+    uint8_t index;
+    
+    //²תһȦʱϲ㵱ǰеĿ
+    for(level=1; level<TIMD_WHEEL_LEVELS; level++)
+    {
+        if(wheel->now % levels[level].unit)
+        {
+            break;
+        }
+        
+        slot = levels[level].offset + (uint16_t)((wheel->now / levels[level].unit) % levels[level].slots);
+        
+        while((index = wheel->bucket[slot]) != TIMD_NIL)
+        {
+            wheel_detach(index);
+            wheel_insert(index);
+        }
+    }
+    
+    slot = levels[0].offset + (uint16_t)(wheel->now % levels[0].slots);
+    
+    while((index = wheel->bucket[slot]) != TIMD_NIL)
+    {
+        wheel_detach(index);
+        wheel_fire(index);
+    }
+}
+
+/**
+  * @brief  ƽ̶ָȣ²Ϊʱֱϲһ
+  */
+static void wheel_advance(uint64_t target)
+{
+    uint8_t level;
+    uint64_t step;
+    
+    while(wheel->now < target)
+    {
+        for(level=0; level<TIMD_WHEEL_LEVELS; level++)
+        {
+            if(wheel->amount[level])
+            {
+                break;
+            }
+        }
+        
+        if(level >= TIMD_WHEEL_LEVELS)
+        {
+            wheel->now = target;
+            break;
+        }
+        
+        step = levels[level].unit - (wheel->now % levels[level].unit);
+        
+        if((target - wheel->now) < step)
+        {
+            wheel->now = target;
+            break;
+        }
+        
+        wheel->now += step;
+        wheel_tick();
+    }
+}
+
+/**
+  * @brief  Уϵͳʱӣʱӱ޸ʱžԶʱִ TIMD_FLAG_CHANGE Ŀ
+  */
+static void wheel_sync(void)
+{
+    uint64_t stamp;
+    uint64_t expect;
+    uint8_t cnt;
+    bool changed;
+    
+    stamp = rtc.read();
+    
+    if(!stamp)
+    {
+        return;
+    }
+    
+    expect = wheel->stamp + (wheel->elapsed - wheel->base) / 1000;
+    changed = (wheel->stamp && \
+              ((stamp > (expect + TIMD_RTC_TOLERANCE)) || ((stamp + TIMD_RTC_TOLERANCE) < expect)));
+    
+    wheel->stamp = stamp;
+    wheel->base = wheel->elapsed;
+    
+    if(!changed)
+    {
+        return;
+    }
+    
     for(cnt=0; cnt<TIMD_CONF_ENTRY_MAX; cnt++)
     {
-        if(!entries[cnt].conf.callback)
+        if(!wheel->entry[cnt].conf.callback)
         {
             continue;
         }
         
-        if(entries[cnt].conf.callback != conf->callback)
+        if(TIMD_IS_CHANGE(wheel->entry[cnt].conf.flags) || !TIMD_IS_ABSOLUTE(wheel->entry[cnt].conf.flags))
         {
-			continue;
+            continue;
         }
         
-        if(entries[cnt].check != crc16((const uint8_t *)&entries[cnt], (sizeof(struct __timed_entry) - sizeof(entries[cnt].check)), 0xffff))
+        wheel_detach(cnt);
+        wheel_arm(cnt, stamp);
+        wheel_insert(cnt);
+    }
+    
+    for(cnt=0; cnt<TIMD_CONF_ENTRY_MAX; cnt++)
+    {
+        if(!wheel->entry[cnt].conf.callback)
         {
-            heap.set((void *)&entries[cnt], 0, sizeof(struct __timed_entry));
             continue;
         }
         
-    	heap.copy((void *)conf, (void *)&entries[cnt].conf, sizeof(entries[cnt].conf));
-    	
-    	return(TIMD_SUCCESS);
+        if(!TIMD_IS_CHANGE(wheel->entry[cnt].conf.flags))
+        {
+            continue;
+        }
+        
+        if(wheel->entry[cnt].check != crc16((const uint8_t *)&wheel->entry[cnt].conf, sizeof(wheel->entry[cnt].conf), 0xffff))
+        {
+            wheel_release(cnt);
+            continue;
+        }
+        
+        wheel->entry[cnt].conf.callback();
     }
+}
+
+/**
+  * @brief  
+  */
+static enum __timd_status timed_create(const struct __timed_conf *conf)
+{
+	uint8_t index;
+	struct __timed_entry *entry;
+	
+	if((!conf) || (!conf->callback))
+	{
+		return(TIMD_NOEXIST);
+	}
     
-    return(TIMD_NOEXIST);
+    if(!wheel)
+    {
+        return(TIMD_CONFLICT);
+    }
+    
+    if(wheel_find(conf->callback) != TIMD_NIL)
+    {
+        return(TIMD_CONFLICT);
+    }
+    
+    //Ϊ 0 ڶʱ
+    if(TIMD_IS_PERIODIC(conf->flags) && !conf->period)
+    {
+        return(TIMD_NOEXIST);
+    }
+    
+    index = wheel->idle;
+    
+    if(index == TIMD_NIL)
+    {
+        return(TIMD_NOEXIST);
+    }
+    
+    entry = &wheel->entry[index];
+    wheel->idle = entry->next;
+    
+    heap.set((void *)entry, 0, sizeof(struct __timed_entry));
+    heap.copy((void *)&entry->conf, (void *)conf, sizeof(entry->conf));
+    entry->check = crc16((const uint8_t *)&entry->conf, sizeof(entry->conf), 0xffff);
+    entry->level = TIMD_NIL;
+    entry->next = TIMD_NIL;
+    entry->prev = TIMD_NIL;
+    entry->link = wheel->hash[TIMD_HASH(conf->callback)];
+    wheel->hash[TIMD_HASH(conf->callback)] = index;
+    
+    if(!TIMD_IS_CHANGE(conf->flags))
+    {
+        wheel_arm(index, TIMD_IS_ABSOLUTE(conf->flags)? wheel_clock() : 0);
+        wheel_insert(index);
+    }
+    
+    return(TIMD_SUCCESS);
 }
 
 /**
   * @brief  
   */
-static enum __timd_status timed_remove(const struct __timed_conf *conf)
+static enum __timd_status timed_query(const struct __timed_conf *conf)
 {
-	uint8_t cnt;
+	uint8_t index;
 	
 	if((!conf) || (!conf->callback))
 	{
 		return(TIMD_NOEXIST);
 	}
     
-    if(!entries)
+    if(!wheel)
     {
         return(TIMD_CONFLICT);
     }
+    
+    index = wheel_find(conf->callback);
+    
+    if(index == TIMD_NIL)
+    {
+        return(TIMD_NOEXIST);
+    }
+    
+    if(wheel->entry[index].check != crc16((const uint8_t *)&wheel->entry[index].conf, sizeof(wheel->entry[index].conf), 0xffff))
+    {
+        wheel_release(index);
+        return(TIMD_NOEXIST);
+    }
 	
-    for(cnt=0; cnt<TIMD_CONF_ENTRY_MAX; cnt++)
+	heap.copy((void *)conf, (void *)&wheel->entry[index].conf, sizeof(wheel->entry[index].conf));
+	
+	return(TIMD_SUCCESS);
+}
+
+/**
+  * @brief  
+  */
+static enum __timd_status timed_remove(const struct __timed_conf *conf)
+{
+	uint8_t index;
+	
+	if((!conf) || (!conf->callback))
+	{
+		return(TIMD_NOEXIST);
+	}
+    
+    if(!wheel)
     {
-        if(!entries[cnt].conf.callback)
-        {
-            continue;
-        }
-        
-        if(entries[cnt].conf.callback == conf->callback)
-        {
-            heap.set((void *)&entries[cnt], 0, sizeof(struct __timed_entry));
-            
-            return(TIMD_SUCCESS);
-        }
+        return(TIMD_CONFLICT);
     }
     
-    return(TIMD_NOEXIST);
+    index = wheel_find(conf->callback);
+    
+    if(index == TIMD_NIL)
+    {
+        return(TIMD_NOEXIST);
+    }
+    
+    wheel_release(index);
+    
+    return(TIMD_SUCCESS);
 }
 
 /**
@@ -154,12 +587,12 @@ static enum __timd_status timed_remove(const struct __timed_conf *conf)
   */
 static enum __timd_status timed_empty(void)
 {
-    if(!entries)
+    if(!wheel)
     {
         return(TIMD_CONFLICT);
     }
     
-    heap.set((void *)entries, 0, (sizeof(struct __timed_entry)*TIMD_CONF_ENTRY_MAX));
+    wheel_clear();
     
     return(TIMD_SUCCESS);
 }
@@ -185,24 +618,28 @@ static const struct __timed timed =
   */
 static void timed_init(void)
 {
-    entries = (struct __timed_entry *)0;
-    
+    wheel = (struct __timed_wheel *)0;
+	
 	//ֻϵ״̬²У״̬²
     if(system_status() == SYSTEM_RUN)
     {
-        entries = heap.salloc(NAME_TIMED, sizeof(struct __timed_entry)*TIMD_CONF_ENTRY_MAX);
-        if(!entries)
+        wheel = heap.salloc(NAME_TIMED, sizeof(struct __timed_wheel));
+        if(!wheel)
         {
             status = TASK_ERROR;
             return;
         }
         
-        heap.set((void *)entries, 0, (sizeof(struct __timed_entry)*TIMD_CONF_ENTRY_MAX));
+        heap.set((void *)wheel, 0, sizeof(struct __timed_wheel));
+        wheel_clear();
         
         status = TASK_INIT;
         
         rtc.control.init(DEVICE_NORMAL);
         
+        wheel->jiffy = jiffy.value();
+        wheel->stamp = rtc.read();
+        
         TRACE(TRACE_INFO, "Task timed initialized.");
 	}
 }
@@ -212,32 +649,28 @@ static void timed_init(void)
   */
 static void timed_loop(void)
 {
-    uint8_t cnt;
-    
+    uint32_t current;
+	
 	//ֻϵ״̬²У״̬²
     if(system_status() == SYSTEM_RUN)
     {
-    	//...ж仯
-        
-        if(!entries)
+        if(!wheel)
         {
             status = TASK_ERROR;
             return;
         }
         
-	    for(cnt=0; cnt<TIMD_CONF_ENTRY_MAX; cnt++)
-	    {
-	        if(!entries[cnt].conf.callback)
-	        {
-	            continue;
-	        }
-	        
-	        if(entries[cnt].check != crc16((const uint8_t *)&entries[cnt], (sizeof(struct __timed_entry)) - sizeof(entries[cnt].check), 0xffff))
-	        {
-                heap.set((void *)&entries[cnt], 0, sizeof(struct __timed_entry));
-	            continue;
-	        }
-	    }
+        current = jiffy.value();
+        wheel->elapsed += (uint32_t)(current - wheel->jiffy);
+        wheel->jiffy = current;
+        
+        //ÿУһϵͳʱ
+        if((wheel->elapsed - wheel->base) >= 1000)
+        {
+            wheel_sync();
+        }
+        
+        wheel_advance(wheel->elapsed / TIMD_WHEEL_TICK);
         
         status = TASK_RUN;
 	}